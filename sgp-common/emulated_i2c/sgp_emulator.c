@@ -0,0 +1,950 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_emulator.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_bus.h"
+
+#define SGP_EMULATOR_NO_DEVICE 0xFFFF
+#define SGP_EMULATOR_MAX_ARGS 2
+#define SGP_EMULATOR_MAX_WORDS 3
+#define SGP_EMULATOR_MAX_COMMANDS 16
+#define SGP_EMULATOR_NUM_CHANNELS 8
+#define SGP_EMULATOR_GENERAL_CALL_ADDRESS 0x00
+#define SGP_EMULATOR_GENERAL_CALL_RESET 0x06
+#define SGP_EMULATOR_MEASURE_TEST_OK 0xd400
+/* the SGP30 returns fixed values during the first 15s after iaq init */
+#define SGP30_EMULATOR_INIT_TIME_US 15000000
+#define SGP30_EMULATOR_INIT_CO2_EQ 400
+/* the SGPC3 returns 0 ppb during the preheating of the 64s init */
+#define SGPC3_EMULATOR_PREHEAT_TIME_US 64000000
+#define SHTC1_EMULATOR_CMD_WAKE_UP 0x3517
+/* clock cycles per byte on the bus, 8 data bits and the acknowledge bit */
+#define SGP_EMULATOR_CYCLES_PER_BYTE 9
+/* size of the per bus counters, so that buses do not share a cache line */
+#define SGP_EMULATOR_CACHE_LINE_SIZE 64
+
+/* type of the default SGP at 0x58, the SGPC3 builds select the SGPC3 */
+#ifndef SGP_EMULATOR_DEFAULT_SGP
+#define SGP_EMULATOR_DEFAULT_SGP SGP_EMULATOR_SGP30
+#endif
+
+/**
+ * struct sgp_emulator_command - command of an emulated sensor
+ *
+ * @command:         The command word
+ * @num_args:        Number of argument words sent with the command
+ * @num_words:       Number of words to read as result
+ * @min_feature_set: Feature set version needed for the command
+ * @duration_us:     Execution time, during which the sensor does not
+ *                   acknowledge any transfer
+ */
+typedef struct {
+    uint16_t command;
+    uint8_t num_args;
+    uint8_t num_words;
+    uint8_t min_feature_set;
+    uint32_t duration_us;
+} sgp_emulator_command;
+
+static const sgp_emulator_command sgp30_emulator_commands[] = {
+    {0x3682, 0, 3, 0, 500},    /* get serial id */
+    {0x202f, 0, 1, 0, 1000},   /* get feature set */
+    {0x2032, 0, 1, 0, 200000}, /* measure test */
+    {0x2003, 0, 0, 0, 10000},  /* iaq init */
+    {0x2008, 0, 2, 0, 12000},  /* measure iaq */
+    {0x2015, 0, 2, 0, 10000},  /* get iaq baseline */
+    {0x201e, 2, 0, 0, 10000},  /* set iaq baseline */
+    {0x2050, 0, 2, 0, 25000},  /* measure raw */
+    {0x2061, 1, 0, 0, 10000},  /* set absolute humidity */
+    {0x20b3, 0, 1, 33, 10000}, /* get tvoc inceptive baseline */
+    {0x2077, 1, 0, 33, 10000}, /* set tvoc baseline */
+};
+
+static const sgp_emulator_command sgpc3_emulator_commands[] = {
+    {0x3682, 0, 3, 0, 500},    /* get serial id */
+    {0x202f, 0, 1, 0, 1000},   /* get feature set */
+    {0x2032, 0, 1, 0, 200000}, /* measure test */
+    {0x2089, 0, 0, 0, 10000},  /* iaq init without preheating */
+    {0x2003, 0, 0, 0, 10000},  /* iaq init with 64s preheating */
+    {0x20ae, 0, 0, 6, 10000},  /* iaq init continuous */
+    {0x2008, 0, 1, 0, 50000},  /* measure iaq */
+    {0x2015, 0, 1, 0, 10000},  /* get iaq baseline */
+    {0x201e, 1, 0, 0, 10000},  /* set iaq baseline */
+    {0x20b3, 0, 1, 5, 10000},  /* get iaq inceptive baseline */
+    {0x204d, 0, 1, 0, 50000},  /* measure raw */
+    {0x2046, 0, 2, 0, 50000},  /* measure iaq and raw */
+    {0x2061, 1, 0, 6, 10000},  /* set absolute humidity */
+    {0x209f, 1, 0, 6, 10000},  /* set power mode */
+};
+
+static const sgp_emulator_command sgp40_emulator_commands[] = {
+    {0x3682, 0, 3, 0, 500},    /* get serial id */
+    {0x202f, 0, 1, 0, 1000},   /* get feature set */
+    {0x280e, 0, 1, 0, 320000}, /* measure test */
+    {0x260f, 2, 1, 0, 30000},  /* measure raw */
+    {0x3615, 0, 0, 0, 1000},   /* heater off */
+};
+
+static const sgp_emulator_command shtc1_emulator_commands[] = {
+    {0x7866, 0, 2, 0, 12100}, /* measure, temperature first */
+    {0x58e0, 0, 2, 0, 12100}, /* measure, humidity first */
+    {0x609c, 0, 2, 0, 800},   /* measure low power, temperature first */
+    {0x401a, 0, 2, 0, 800},   /* measure low power, humidity first */
+    {0xefc8, 0, 1, 0, 0},     /* read id register */
+    {0x805d, 0, 0, 0, 240},   /* soft reset */
+    {0xb098, 0, 0, 0, 0},     /* sleep */
+    {0x3517, 0, 0, 0, 240},   /* wake up */
+};
+
+/**
+ * struct sgp_emulator_device - state of an emulated device
+ *
+ * Multiplexers only use @control and @first_child, sensors all other members.
+ */
+typedef struct {
+    uint8_t type;
+    uint8_t bus_idx;
+    uint8_t i2c_address;
+    uint16_t next_sibling;
+    uint16_t first_child[SGP_EMULATOR_NUM_CHANNELS];
+    uint8_t control;
+    const sgp_emulator_command* commands;
+    uint8_t num_commands;
+    uint16_t feature_set;
+    uint64_t serial_id;
+    sgp_emulator_signal signals[SGP_EMULATOR_NUM_SIGNALS];
+    uint64_t busy_until_us;
+    uint64_t init_time_us;
+    uint64_t preheat_time_us;
+    bool initialized;
+    bool sleeping;
+    uint16_t result[SGP_EMULATOR_MAX_WORDS];
+    uint8_t num_result_words;
+    uint16_t baseline[2];
+    uint16_t inceptive_baseline;
+    uint16_t absolute_humidity;
+    uint16_t power_mode;
+    uint32_t command_counts[SGP_EMULATOR_MAX_COMMANDS];
+    uint32_t random_state;
+} sgp_emulator_device;
+
+typedef union {
+    sgp_emulator_stats stats;
+    uint8_t cache_line[SGP_EMULATOR_CACHE_LINE_SIZE];
+} sgp_emulator_bus_stats;
+
+static struct {
+    sgp_emulator_device devices[SGP_EMULATOR_MAX_DEVICES];
+    uint16_t num_devices;
+    bool initialized;
+    uint16_t first_on_bus[SGP_EMULATOR_MAX_BUSES];
+    uint32_t bus_clock_hz;
+    void (*wait_usec)(uint32_t useconds);
+    sgp_emulator_bus_stats bus_stats[SGP_EMULATOR_MAX_BUSES];
+} sgp_emulator;
+
+/*
+ * The selected bus and the virtual time belong to the calling thread, so that
+ * each thread driving its own buses has its own timeline.
+ */
+static SGP_THREAD_LOCAL uint8_t sgp_emulator_bus_idx;
+static SGP_THREAD_LOCAL uint64_t sgp_emulator_time_us;
+
+static uint64_t sgp_emulator_clock_now_us(sgp_clock* clock) {
+    (void)clock;
+    return sgp_emulator_time_us;
+}
+
+static void sgp_emulator_clock_sleep_usec(sgp_clock* clock,
+                                          uint32_t useconds) {
+    (void)clock;
+    sgp_emulator_time_us += useconds;
+}
+
+static sgp_clock sgp_emulator_clock = {sgp_emulator_clock_now_us,
+                                       sgp_emulator_clock_sleep_usec, NULL};
+
+static uint16_t sgp_emulator_random(sgp_emulator_device* dev) {
+    dev->random_state = dev->random_state * 1103515245u + 12345u;
+    return (uint16_t)(dev->random_state >> 16);
+}
+
+static sgp_emulator_stats* sgp_emulator_bus_stats_get(void) {
+    return &sgp_emulator.bus_stats[sgp_emulator_bus_idx].stats;
+}
+
+/**
+ * sgp_emulator_transfer() - account for the time a transfer takes on the bus
+ *
+ * @num_bytes:  Bytes on the bus including the address byte
+ */
+static void sgp_emulator_transfer(uint16_t num_bytes) {
+    uint32_t duration_us;
+
+    if (!sgp_emulator.bus_clock_hz)
+        return;
+    duration_us = (uint32_t)((uint64_t)num_bytes *
+                             SGP_EMULATOR_CYCLES_PER_BYTE * 1000000 /
+                             sgp_emulator.bus_clock_hz);
+    sgp_emulator_time_us += duration_us;
+    if (sgp_emulator.wait_usec)
+        sgp_emulator.wait_usec(duration_us);
+}
+
+static int32_t sgp_emulator_signal_value(sgp_emulator_device* dev,
+                                         uint8_t signal) {
+    const sgp_emulator_signal* model = &dev->signals[signal];
+    int32_t value = model->base;
+
+    if (model->period_ms > 0) {
+        int64_t period_us = (int64_t)model->period_ms * 1000;
+        int64_t phase = (int64_t)(sgp_emulator_time_us % (uint64_t)period_us);
+        int64_t rising = phase < period_us / 2 ? phase : period_us - phase;
+
+        /* triangle from -amplitude at phase 0 to +amplitude at half period */
+        value += (int32_t)(2 * model->amplitude * rising * 2 / period_us) -
+                 model->amplitude;
+    }
+    if (model->noise > 0)
+        value += (int32_t)(sgp_emulator_random(dev) % (2u * model->noise + 1)) -
+                 model->noise;
+    return value;
+}
+
+static uint16_t sgp_emulator_word(int64_t value) {
+    if (value < 0)
+        return 0;
+    if (value > 0xFFFF)
+        return 0xFFFF;
+    return (uint16_t)value;
+}
+
+static uint16_t sgp_emulator_signal_word(sgp_emulator_device* dev,
+                                         uint8_t signal) {
+    return sgp_emulator_word(sgp_emulator_signal_value(dev, signal));
+}
+
+static uint16_t shtc1_emulator_temperature_ticks(sgp_emulator_device* dev) {
+    int64_t temperature =
+        sgp_emulator_signal_value(dev, SGP_EMULATOR_SIGNAL_TEMPERATURE);
+
+    return sgp_emulator_word((temperature + 45000) * 65536 / 175000);
+}
+
+static uint16_t shtc1_emulator_humidity_ticks(sgp_emulator_device* dev) {
+    int64_t humidity =
+        sgp_emulator_signal_value(dev, SGP_EMULATOR_SIGNAL_HUMIDITY);
+
+    return sgp_emulator_word(humidity * 65536 / 100000);
+}
+
+static void sgp_emulator_set_default_signal(sgp_emulator_device* dev,
+                                            uint8_t signal, int32_t base) {
+    dev->signals[signal].base = base;
+    dev->signals[signal].amplitude = 0;
+    dev->signals[signal].period_ms = 0;
+    dev->signals[signal].noise = 0;
+}
+
+static void sgp_emulator_reset_device(sgp_emulator_device* dev) {
+    dev->control = 0;
+    dev->busy_until_us = sgp_emulator_time_us;
+    dev->init_time_us = 0;
+    dev->preheat_time_us = 0;
+    dev->initialized = false;
+    dev->sleeping = false;
+    dev->num_result_words = 0;
+    dev->baseline[0] = 0;
+    dev->baseline[1] = 0;
+    dev->absolute_humidity = 0;
+    dev->power_mode = 0;
+}
+
+/**
+ * sgp_emulator_find_in() - find the device answering at an address among a
+ *                          list of devices and behind the enabled channels of
+ *                          the multiplexers in it
+ *
+ * Return:  false if several devices answer, true otherwise
+ */
+static bool sgp_emulator_find_in(uint16_t first, uint8_t address,
+                                 sgp_emulator_device** found) {
+    uint16_t i;
+    uint8_t ch;
+
+    for (i = first; i != SGP_EMULATOR_NO_DEVICE;
+         i = sgp_emulator.devices[i].next_sibling) {
+        sgp_emulator_device* dev = &sgp_emulator.devices[i];
+
+        if (dev->i2c_address == address) {
+            if (*found)
+                return false;
+            *found = dev;
+        }
+        if (dev->type != SGP_EMULATOR_TCA9548A || !dev->control)
+            continue;
+        for (ch = 0; ch < SGP_EMULATOR_NUM_CHANNELS; ++ch) {
+            if ((dev->control & (1 << ch)) &&
+                !sgp_emulator_find_in(dev->first_child[ch], address, found))
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * sgp_emulator_find() - find the device answering at an address
+ *
+ * Return:  The device, NULL if no device or several devices answer
+ */
+static sgp_emulator_device* sgp_emulator_find(uint8_t address) {
+    sgp_emulator_device* found = NULL;
+
+    if (!sgp_emulator_find_in(sgp_emulator.first_on_bus[sgp_emulator_bus_idx],
+                              address, &found))
+        return NULL;
+    return found;
+}
+
+/**
+ * sgp_emulator_reset_in() - reset all sensors in a list of devices and behind
+ *                           the enabled channels of the multiplexers in it
+ *
+ * Return:  true if at least one sensor was reset
+ */
+static bool sgp_emulator_reset_in(uint16_t first) {
+    bool reset = false;
+    uint16_t i;
+    uint8_t ch;
+
+    for (i = first; i != SGP_EMULATOR_NO_DEVICE;
+         i = sgp_emulator.devices[i].next_sibling) {
+        sgp_emulator_device* dev = &sgp_emulator.devices[i];
+
+        if (dev->type != SGP_EMULATOR_TCA9548A) {
+            sgp_emulator_reset_device(dev);
+            reset = true;
+            continue;
+        }
+        /* multiplexers do not support the general call */
+        for (ch = 0; ch < SGP_EMULATOR_NUM_CHANNELS; ++ch) {
+            if ((dev->control & (1 << ch)) &&
+                sgp_emulator_reset_in(dev->first_child[ch]))
+                reset = true;
+        }
+    }
+    return reset;
+}
+
+static int16_t sgp_emulator_general_call_reset(void) {
+    if (!sgp_emulator_reset_in(
+            sgp_emulator.first_on_bus[sgp_emulator_bus_idx]))
+        return STATUS_FAIL;
+    return STATUS_OK;
+}
+
+static void sgp30_emulator_execute(sgp_emulator_device* dev, uint16_t command,
+                                   const uint16_t* args) {
+    uint16_t* result = dev->result;
+
+    switch (command) {
+        case 0x2003:
+            dev->initialized = true;
+            dev->init_time_us = sgp_emulator_time_us;
+            dev->baseline[0] = 0;
+            dev->baseline[1] = 0;
+            break;
+        case 0x2008:
+            if (!dev->initialized ||
+                sgp_emulator_time_us - dev->init_time_us <
+                    SGP30_EMULATOR_INIT_TIME_US) {
+                result[0] = SGP30_EMULATOR_INIT_CO2_EQ;
+                result[1] = 0;
+                break;
+            }
+            result[0] = sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_CO2_EQ);
+            result[1] = sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_TVOC);
+            break;
+        case 0x2015:
+            /* co2eq baseline first, but set with the tvoc baseline first */
+            result[0] = dev->baseline[0];
+            result[1] = dev->baseline[1];
+            break;
+        case 0x201e:
+            dev->baseline[1] = args[0];
+            dev->baseline[0] = args[1];
+            break;
+        case 0x2050:
+            result[0] = sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_H2);
+            result[1] =
+                sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_ETHANOL);
+            break;
+        case 0x2061:
+            dev->absolute_humidity = args[0];
+            break;
+        case 0x20b3:
+            result[0] = dev->inceptive_baseline;
+            break;
+        case 0x2077:
+            dev->baseline[1] = args[0];
+            break;
+    }
+}
+
+static void sgpc3_emulator_execute(sgp_emulator_device* dev, uint16_t command,
+                                   const uint16_t* args) {
+    uint16_t* result = dev->result;
+    uint16_t tvoc_ppb = 0;
+
+    if (dev->initialized &&
+        sgp_emulator_time_us - dev->init_time_us >= dev->preheat_time_us)
+        tvoc_ppb = sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_TVOC);
+
+    switch (command) {
+        case 0x2089:
+        case 0x2003:
+        case 0x20ae:
+            dev->initialized = true;
+            dev->init_time_us = sgp_emulator_time_us;
+            dev->preheat_time_us =
+                command == 0x2003 ? SGPC3_EMULATOR_PREHEAT_TIME_US : 0;
+            break;
+        case 0x2008:
+            result[0] = tvoc_ppb;
+            break;
+        case 0x2015:
+            result[0] = dev->baseline[0];
+            break;
+        case 0x201e:
+            dev->baseline[0] = args[0];
+            break;
+        case 0x20b3:
+            result[0] = dev->inceptive_baseline;
+            break;
+        case 0x204d:
+            result[0] =
+                sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_ETHANOL);
+            break;
+        case 0x2046:
+            result[0] =
+                sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_ETHANOL);
+            result[1] = tvoc_ppb;
+            break;
+        case 0x2061:
+            dev->absolute_humidity = args[0];
+            break;
+        case 0x209f:
+            dev->power_mode = args[0];
+            break;
+    }
+}
+
+static void sgp40_emulator_execute(sgp_emulator_device* dev, uint16_t command,
+                                   const uint16_t* args) {
+    (void)args;
+
+    if (command == 0x260f)
+        dev->result[0] =
+            sgp_emulator_signal_word(dev, SGP_EMULATOR_SIGNAL_SRAW);
+}
+
+static void shtc1_emulator_execute(sgp_emulator_device* dev, uint16_t command,
+                                   const uint16_t* args) {
+    uint16_t* result = dev->result;
+    (void)args;
+
+    switch (command) {
+        case 0x7866:
+        case 0x609c:
+            result[0] = shtc1_emulator_temperature_ticks(dev);
+            result[1] = shtc1_emulator_humidity_ticks(dev);
+            break;
+        case 0x58e0:
+        case 0x401a:
+            result[0] = shtc1_emulator_humidity_ticks(dev);
+            result[1] = shtc1_emulator_temperature_ticks(dev);
+            break;
+        case 0xefc8:
+            result[0] = dev->feature_set;
+            break;
+        case 0x805d:
+            sgp_emulator_reset_device(dev);
+            break;
+        case 0xb098:
+            dev->sleeping = true;
+            break;
+        case 0x3517:
+            dev->sleeping = false;
+            break;
+    }
+}
+
+static void sgp_emulator_execute(sgp_emulator_device* dev, uint16_t command,
+                                 const uint16_t* args) {
+    /* commands shared by all SGP sensors */
+    switch (command) {
+        case 0x3682:
+            dev->result[0] = (uint16_t)(dev->serial_id >> 32);
+            dev->result[1] = (uint16_t)(dev->serial_id >> 16);
+            dev->result[2] = (uint16_t)dev->serial_id;
+            return;
+        case 0x202f:
+            dev->result[0] = dev->feature_set;
+            return;
+        case 0x2032:
+        case 0x280e:
+            dev->result[0] = SGP_EMULATOR_MEASURE_TEST_OK;
+            return;
+    }
+
+    switch (dev->type) {
+        case SGP_EMULATOR_SGP30:
+            sgp30_emulator_execute(dev, command, args);
+            break;
+        case SGP_EMULATOR_SGPC3:
+            sgpc3_emulator_execute(dev, command, args);
+            break;
+        case SGP_EMULATOR_SGP40:
+            sgp40_emulator_execute(dev, command, args);
+            break;
+        case SGP_EMULATOR_SHTC1:
+            shtc1_emulator_execute(dev, command, args);
+            break;
+    }
+}
+
+static int8_t sgp_emulator_write_sensor(sgp_emulator_device* dev,
+                                        const uint8_t* data, uint16_t count) {
+    const sgp_emulator_command* cmd = NULL;
+    uint16_t args[SGP_EMULATOR_MAX_ARGS];
+    uint16_t command;
+    uint8_t i;
+
+    if (sgp_emulator_time_us < dev->busy_until_us || count < 2)
+        return STATUS_FAIL;
+
+    command = sensirion_bytes_to_uint16_t(data);
+    if (dev->sleeping && command != SHTC1_EMULATOR_CMD_WAKE_UP)
+        return STATUS_FAIL;
+
+    for (i = 0; i < dev->num_commands; ++i) {
+        if (dev->commands[i].command == command) {
+            cmd = &dev->commands[i];
+            break;
+        }
+    }
+    if (!cmd || count != 2 + 3 * cmd->num_args)
+        return STATUS_FAIL;
+    if (dev->type != SGP_EMULATOR_SHTC1 &&
+        (dev->feature_set & 0x00FF) < cmd->min_feature_set)
+        return STATUS_FAIL;
+
+    for (i = 0; i < cmd->num_args; ++i) {
+        const uint8_t* arg = &data[2 + 3 * i];
+
+        if (sensirion_common_check_crc(arg, 2, arg[2]) != STATUS_OK)
+            return STATUS_FAIL;
+        args[i] = sensirion_bytes_to_uint16_t(arg);
+    }
+
+    ++dev->command_counts[cmd - dev->commands];
+    sgp_emulator_execute(dev, command, args);
+    dev->num_result_words = cmd->num_words;
+    dev->busy_until_us = sgp_emulator_time_us + cmd->duration_us;
+    return STATUS_OK;
+}
+
+static int8_t sgp_emulator_read_sensor(sgp_emulator_device* dev, uint8_t* data,
+                                       uint16_t count) {
+    uint16_t num_words = count / 3;
+    uint16_t i;
+
+    if (sgp_emulator_time_us < dev->busy_until_us || dev->sleeping ||
+        count == 0 || count % 3 != 0 || num_words > dev->num_result_words)
+        return STATUS_FAIL;
+
+    for (i = 0; i < num_words; ++i) {
+        data[3 * i] = (uint8_t)(dev->result[i] >> 8);
+        data[3 * i + 1] = (uint8_t)(dev->result[i] & 0xFF);
+        data[3 * i + 2] = sensirion_common_generate_crc(&data[3 * i], 2);
+    }
+    dev->num_result_words = 0;
+    return STATUS_OK;
+}
+
+static sgp_emulator_device* sgp_emulator_get(uint16_t id) {
+    if (id >= sgp_emulator.num_devices)
+        return NULL;
+    return &sgp_emulator.devices[id];
+}
+
+static int16_t sgp_emulator_add(uint8_t bus_idx, uint16_t parent,
+                                uint8_t channel, uint8_t type,
+                                uint8_t i2c_address, uint16_t* id) {
+    sgp_emulator_device* dev;
+
+    if (!sgp_emulator.initialized)
+        sgp_emulator_reset();
+    if (sgp_emulator.num_devices >= SGP_EMULATOR_MAX_DEVICES ||
+        type > SGP_EMULATOR_SHTC1 || i2c_address > 0x7F)
+        return STATUS_FAIL;
+
+    *id = sgp_emulator.num_devices++;
+    dev = &sgp_emulator.devices[*id];
+    dev->type = type;
+    dev->bus_idx = bus_idx;
+    dev->i2c_address = i2c_address;
+    if (parent == SGP_EMULATOR_NO_DEVICE) {
+        dev->next_sibling = sgp_emulator.first_on_bus[bus_idx];
+        sgp_emulator.first_on_bus[bus_idx] = *id;
+    } else {
+        sgp_emulator_device* mux = &sgp_emulator.devices[parent];
+
+        dev->next_sibling = mux->first_child[channel];
+        mux->first_child[channel] = *id;
+    }
+    for (uint8_t i = 0; i < SGP_EMULATOR_NUM_CHANNELS; ++i)
+        dev->first_child[i] = SGP_EMULATOR_NO_DEVICE;
+    dev->serial_id = 0x000012340000ull + *id;
+    dev->inceptive_baseline = 0;
+    dev->random_state = 1u + *id;
+    for (uint8_t i = 0; i < SGP_EMULATOR_MAX_COMMANDS; ++i)
+        dev->command_counts[i] = 0;
+    for (uint8_t i = 0; i < SGP_EMULATOR_NUM_SIGNALS; ++i)
+        sgp_emulator_set_default_signal(dev, i, 0);
+    sgp_emulator_reset_device(dev);
+
+    switch (type) {
+        case SGP_EMULATOR_TCA9548A:
+            dev->commands = NULL;
+            dev->num_commands = 0;
+            break;
+        case SGP_EMULATOR_SGP30:
+            dev->commands = sgp30_emulator_commands;
+            dev->num_commands = ARRAY_SIZE(sgp30_emulator_commands);
+            dev->feature_set = 0x0022;
+            dev->inceptive_baseline = 0x8f00;
+            break;
+        case SGP_EMULATOR_SGPC3:
+            dev->commands = sgpc3_emulator_commands;
+            dev->num_commands = ARRAY_SIZE(sgpc3_emulator_commands);
+            dev->feature_set = 0x1006;
+            dev->inceptive_baseline = 0x8f00;
+            break;
+        case SGP_EMULATOR_SGP40:
+            dev->commands = sgp40_emulator_commands;
+            dev->num_commands = ARRAY_SIZE(sgp40_emulator_commands);
+            dev->feature_set = 0x3220;
+            break;
+        case SGP_EMULATOR_SHTC1:
+            dev->commands = shtc1_emulator_commands;
+            dev->num_commands = ARRAY_SIZE(shtc1_emulator_commands);
+            /* ID register of an SHTC3 */
+            dev->feature_set = 0x0887;
+            break;
+    }
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_TVOC, 25);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_CO2_EQ, 450);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_ETHANOL, 17500);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_H2, 13500);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_SRAW, 30000);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_TEMPERATURE,
+                                    25000);
+    sgp_emulator_set_default_signal(dev, SGP_EMULATOR_SIGNAL_HUMIDITY, 50000);
+    return STATUS_OK;
+}
+
+static void sgp_emulator_clear_stats(sgp_emulator_stats* stats) {
+    stats->reads = 0;
+    stats->writes = 0;
+    stats->nacks = 0;
+}
+
+void sgp_emulator_reset(void) {
+    uint8_t i;
+
+    sgp_emulator.num_devices = 0;
+    sgp_emulator.initialized = true;
+    sgp_emulator.bus_clock_hz = 0;
+    sgp_emulator.wait_usec = NULL;
+    sgp_emulator_bus_idx = 0;
+    sgp_emulator_time_us = 0;
+    for (i = 0; i < SGP_EMULATOR_MAX_BUSES; ++i) {
+        sgp_emulator.first_on_bus[i] = SGP_EMULATOR_NO_DEVICE;
+        sgp_emulator_clear_stats(&sgp_emulator.bus_stats[i].stats);
+    }
+}
+
+int16_t sgp_emulator_add_device(uint8_t bus_idx, uint8_t type,
+                                uint8_t i2c_address, uint16_t* id) {
+    if (bus_idx >= SGP_EMULATOR_MAX_BUSES)
+        return STATUS_FAIL;
+    return sgp_emulator_add(bus_idx, SGP_EMULATOR_NO_DEVICE, 0, type,
+                            i2c_address, id);
+}
+
+int16_t sgp_emulator_add_device_on_mux(uint16_t mux_id, uint8_t channel,
+                                       uint8_t type, uint8_t i2c_address,
+                                       uint16_t* id) {
+    sgp_emulator_device* mux = sgp_emulator_get(mux_id);
+
+    if (!mux || mux->type != SGP_EMULATOR_TCA9548A ||
+        channel >= SGP_EMULATOR_NUM_CHANNELS)
+        return STATUS_FAIL;
+    return sgp_emulator_add(mux->bus_idx, mux_id, channel, type, i2c_address,
+                            id);
+}
+
+int16_t sgp_emulator_set_signal(uint16_t id, uint8_t signal,
+                                const sgp_emulator_signal* model) {
+    sgp_emulator_device* dev = sgp_emulator_get(id);
+
+    if (!dev || signal >= SGP_EMULATOR_NUM_SIGNALS)
+        return STATUS_FAIL;
+    dev->signals[signal] = *model;
+    return STATUS_OK;
+}
+
+int16_t sgp_emulator_set_feature_set(uint16_t id, uint16_t feature_set) {
+    sgp_emulator_device* dev = sgp_emulator_get(id);
+
+    if (!dev)
+        return STATUS_FAIL;
+    dev->feature_set = feature_set;
+    return STATUS_OK;
+}
+
+int16_t sgp_emulator_set_serial_id(uint16_t id, uint64_t serial_id) {
+    sgp_emulator_device* dev = sgp_emulator_get(id);
+
+    if (!dev)
+        return STATUS_FAIL;
+    dev->serial_id = serial_id;
+    return STATUS_OK;
+}
+
+int16_t sgp_emulator_get_command_count(uint16_t id, uint16_t command,
+                                       uint32_t* count) {
+    sgp_emulator_device* dev = sgp_emulator_get(id);
+    uint8_t i;
+
+    if (!dev)
+        return STATUS_FAIL;
+
+    *count = 0;
+    for (i = 0; i < dev->num_commands; ++i) {
+        if (command == 0 || dev->commands[i].command == command)
+            *count += dev->command_counts[i];
+    }
+    return STATUS_OK;
+}
+
+int16_t sgp_emulator_get_absolute_humidity(uint16_t id,
+                                           uint16_t* absolute_humidity) {
+    sgp_emulator_device* dev = sgp_emulator_get(id);
+
+    if (!dev)
+        return STATUS_FAIL;
+    *absolute_humidity = dev->absolute_humidity;
+    return STATUS_OK;
+}
+
+uint64_t sgp_emulator_get_time_us(void) {
+    return sgp_emulator_time_us;
+}
+
+void sgp_emulator_advance_time_us(uint32_t useconds) {
+    sgp_emulator_time_us += useconds;
+}
+
+sgp_clock* sgp_emulator_get_clock(void) {
+    return &sgp_emulator_clock;
+}
+
+void sgp_emulator_set_transfer_time(uint32_t bus_clock_hz,
+                                    void (*wait_usec)(uint32_t useconds)) {
+    sgp_emulator.bus_clock_hz = bus_clock_hz;
+    sgp_emulator.wait_usec = wait_usec;
+}
+
+int16_t sgp_emulator_get_bus_stats(uint8_t bus_idx, sgp_emulator_stats* stats,
+                                   bool reset) {
+    sgp_emulator_stats* bus_stats;
+
+    if (bus_idx >= SGP_EMULATOR_MAX_BUSES)
+        return STATUS_FAIL;
+    bus_stats = &sgp_emulator.bus_stats[bus_idx].stats;
+    *stats = *bus_stats;
+    if (reset)
+        sgp_emulator_clear_stats(bus_stats);
+    return STATUS_OK;
+}
+
+void sgp_emulator_get_stats(sgp_emulator_stats* stats, bool reset) {
+    sgp_emulator_stats bus_stats;
+    uint8_t i;
+
+    sgp_emulator_clear_stats(stats);
+    for (i = 0; i < SGP_EMULATOR_MAX_BUSES; ++i) {
+        (void)sgp_emulator_get_bus_stats(i, &bus_stats, reset);
+        stats->reads += bus_stats.reads;
+        stats->writes += bus_stats.writes;
+        stats->nacks += bus_stats.nacks;
+    }
+}
+
+/**
+ * Select the current i2c bus by index.
+ * All following i2c operations will be directed at that bus.
+ *
+ * @param bus_idx   Bus index to select
+ * @returns         0 on success, an error code otherwise
+ */
+int16_t sensirion_i2c_select_bus(uint8_t bus_idx) {
+    if (bus_idx >= SGP_EMULATOR_MAX_BUSES)
+        return STATUS_FAIL;
+
+    sgp_emulator_bus_idx = bus_idx;
+    return STATUS_OK;
+}
+
+/**
+ * Initialize all hard- and software components that are needed for the I2C
+ * communication. Installs the virtual clock of the emulator and adds the
+ * default devices if none were added.
+ */
+void sensirion_i2c_init(void) {
+    uint16_t id;
+
+    if (sgp_emulator.num_devices > 0) {
+        sgp_clock_set(sgp_emulator_get_clock());
+        return;
+    }
+
+    sgp_emulator_reset();
+    sgp_clock_set(sgp_emulator_get_clock());
+    (void)sgp_emulator_add_device(0, SGP_EMULATOR_DEFAULT_SGP, 0x58, &id);
+    (void)sgp_emulator_add_device(0, SGP_EMULATOR_SGP40, 0x59, &id);
+    (void)sgp_emulator_add_device(0, SGP_EMULATOR_SHTC1, 0x70, &id);
+}
+
+/**
+ * Release all resources initialized by sensirion_i2c_init().
+ * The emulated devices and their time are kept.
+ */
+void sensirion_i2c_release(void) {
+    if (sgp_clock_get() == sgp_emulator_get_clock())
+        sgp_clock_set(NULL);
+}
+
+/**
+ * Execute one read transaction on the I2C bus, reading a given number of
+ * bytes. If the device does not acknowledge the read command, an error shall
+ * be returned.
+ *
+ * @param address 7-bit I2C address to read from
+ * @param data    pointer to the buffer where the data is to be stored
+ * @param count   number of bytes to read from I2C and store in the buffer
+ * @returns 0 on success, error code otherwise
+ */
+int8_t sensirion_i2c_read(uint8_t address, uint8_t* data, uint16_t count) {
+    sgp_emulator_stats* stats = sgp_emulator_bus_stats_get();
+    sgp_emulator_device* dev = sgp_emulator_find(address);
+    int8_t ret = STATUS_FAIL;
+
+    ++stats->reads;
+    if (dev && dev->type == SGP_EMULATOR_TCA9548A) {
+        if (count == 1) {
+            data[0] = dev->control;
+            ret = STATUS_OK;
+        }
+    } else if (dev) {
+        ret = sgp_emulator_read_sensor(dev, data, count);
+    }
+
+    if (ret != STATUS_OK)
+        ++stats->nacks;
+    sgp_emulator_transfer(ret == STATUS_OK ? 1 + count : 1);
+    return ret;
+}
+
+/**
+ * Execute one write transaction on the I2C bus, sending a given number of
+ * bytes. The bytes in the supplied buffer must be sent to the given address. If
+ * the slave device does not acknowledge any of the bytes, an error shall be
+ * returned.
+ *
+ * @param address 7-bit I2C address to write to
+ * @param data    pointer to the buffer containing the data to write
+ * @param count   number of bytes to read from the buffer and send over I2C
+ * @returns 0 on success, error code otherwise
+ */
+int8_t sensirion_i2c_write(uint8_t address, const uint8_t* data,
+                           uint16_t count) {
+    sgp_emulator_stats* stats = sgp_emulator_bus_stats_get();
+    sgp_emulator_device* dev;
+    int8_t ret = STATUS_FAIL;
+
+    ++stats->writes;
+    if (address == SGP_EMULATOR_GENERAL_CALL_ADDRESS) {
+        if (count == 1 && data[0] == SGP_EMULATOR_GENERAL_CALL_RESET)
+            ret = (int8_t)sgp_emulator_general_call_reset();
+    } else {
+        dev = sgp_emulator_find(address);
+        if (dev && dev->type == SGP_EMULATOR_TCA9548A) {
+            if (count == 1) {
+                dev->control = data[0];
+                ret = STATUS_OK;
+            }
+        } else if (dev) {
+            ret = sgp_emulator_write_sensor(dev, data, count);
+        }
+    }
+
+    if (ret != STATUS_OK)
+        ++stats->nacks;
+    sgp_emulator_transfer(ret == STATUS_OK ? 1 + count : 1);
+    return ret;
+}
+
+/**
+ * Sleep for a given number of microseconds. The emulator advances its virtual
+ * time instead of sleeping.
+ *
+ * @param useconds the sleep time in microseconds
+ */
+void sensirion_sleep_usec(uint32_t useconds) {
+    sgp_emulator_time_us += useconds;
+}
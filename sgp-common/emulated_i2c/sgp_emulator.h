@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_EMULATOR_H
+#define SGP_EMULATOR_H
+#include "sensirion_arch_config.h"
+#include "sgp_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Emulated implementation of sensirion_i2c.h, selected with
+ * CONFIG_I2C_TYPE=emulated_i2c, to run the drivers without hardware.
+ *
+ * The emulated sensors decode the command words, check the CRC of the
+ * arguments and answer with CRC-protected words. Like the real sensors, they
+ * do not acknowledge any transfer until a command has finished, and reading
+ * without a result fails. The time is virtual: sensirion_sleep_usec() returns
+ * immediately and advances the time, so programs run as fast as the CPU
+ * allows while the timing of the sensors is still enforced.
+ * sensirion_i2c_init() installs the virtual clock of the emulator with
+ * sgp_clock_set(), so sgp_clock_now_us() returns the emulated time.
+ *
+ * Sensors are added to the buses selected with sensirion_i2c_select_bus()
+ * or behind the channels of emulated TCA9548A multiplexers. If no device was
+ * added when sensirion_i2c_init() is called, bus 0 gets an SGP30, an SGP40
+ * and an SHTC1 at their default addresses. Define SGP_EMULATOR_DEFAULT_SGP as
+ * SGP_EMULATOR_SGPC3 to get an SGPC3 instead of the SGP30.
+ *
+ * The selected bus and the virtual time are per thread, so that several
+ * threads can drive different buses at the same time, each on its own
+ * timeline starting at 0. A bus and the devices on it must only be used by one
+ * thread at a time. Adding devices and the other configuration functions are
+ * not thread-safe and belong before the threads are started.
+ */
+
+#define SGP_EMULATOR_MAX_BUSES 64
+#define SGP_EMULATOR_MAX_DEVICES 2048
+
+/* Device types */
+#define SGP_EMULATOR_TCA9548A 0
+#define SGP_EMULATOR_SGP30 1
+#define SGP_EMULATOR_SGPC3 2
+#define SGP_EMULATOR_SGP40 3
+#define SGP_EMULATOR_SHTC1 4
+
+/* Signals of the sensors and their units */
+#define SGP_EMULATOR_SIGNAL_TVOC 0        /* ppb, SGP30 and SGPC3 */
+#define SGP_EMULATOR_SIGNAL_CO2_EQ 1      /* ppm, SGP30 */
+#define SGP_EMULATOR_SIGNAL_ETHANOL 2     /* ticks, SGP30 and SGPC3 */
+#define SGP_EMULATOR_SIGNAL_H2 3          /* ticks, SGP30 */
+#define SGP_EMULATOR_SIGNAL_SRAW 4        /* ticks, SGP40 */
+#define SGP_EMULATOR_SIGNAL_TEMPERATURE 5 /* milli degree celsius, SHTC1 */
+#define SGP_EMULATOR_SIGNAL_HUMIDITY 6    /* milli percent RH, SHTC1 */
+#define SGP_EMULATOR_NUM_SIGNALS 7
+
+/**
+ * struct sgp_emulator_signal - model of a signal of an emulated sensor
+ *
+ * The value at time t is base + a triangle wave between -amplitude and
+ * +amplitude with the given period, plus uniformly distributed pseudo-random
+ * noise between -noise and +noise. The noise is reproducible after
+ * sgp_emulator_reset().
+ *
+ * @base:      Value without wave and noise
+ * @amplitude: Amplitude of the triangle wave
+ * @period_ms: Period of the triangle wave, 0 for a constant signal
+ * @noise:     Amplitude of the noise
+ */
+typedef struct {
+    int32_t base;
+    int32_t amplitude;
+    uint32_t period_ms;
+    uint16_t noise;
+} sgp_emulator_signal;
+
+/**
+ * struct sgp_emulator_stats - counters of the emulated buses
+ *
+ * @reads:  Read transfers
+ * @writes: Write transfers
+ * @nacks:  Transfers which were not acknowledged, e.g. because the sensor was
+ *          busy, the address is unknown or the CRC of an argument was wrong
+ */
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t nacks;
+} sgp_emulator_stats;
+
+/**
+ * sgp_emulator_reset() - remove all devices, reset the counters and the
+ *                        transfer time, and reset the time of the calling
+ *                        thread to 0
+ */
+void sgp_emulator_reset(void);
+
+/**
+ * sgp_emulator_add_device() - add an emulated device to a bus
+ *
+ * @bus_idx:     Bus of the device, as passed to sensirion_i2c_select_bus()
+ * @type:        Device type, SGP_EMULATOR_SGP30, SGP_EMULATOR_TCA9548A, ...
+ * @i2c_address: I2C address of the device
+ * @id:          Output for the id of the device used by the other functions
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if there is no space left or an
+ *          argument is invalid
+ */
+int16_t sgp_emulator_add_device(uint8_t bus_idx, uint8_t type,
+                                uint8_t i2c_address, uint16_t* id);
+
+/**
+ * sgp_emulator_add_device_on_mux() - add an emulated device behind a channel
+ *                                    of an emulated multiplexer
+ *
+ * @mux_id:      Id of the multiplexer
+ * @channel:     Channel of the multiplexer, 0 to 7
+ * @type:        Device type, SGP_EMULATOR_SGP30, SGP_EMULATOR_TCA9548A, ...
+ * @i2c_address: I2C address of the device
+ * @id:          Output for the id of the device used by the other functions
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if there is no space left or an
+ *          argument is invalid
+ */
+int16_t sgp_emulator_add_device_on_mux(uint16_t mux_id, uint8_t channel,
+                                       uint8_t type, uint8_t i2c_address,
+                                       uint16_t* id);
+
+/**
+ * sgp_emulator_set_signal() - set the model of a signal of a sensor
+ *
+ * @id:     Id of the sensor
+ * @signal: Signal to set, SGP_EMULATOR_SIGNAL_*
+ * @model:  The model of the signal
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if an argument is invalid
+ */
+int16_t sgp_emulator_set_signal(uint16_t id, uint8_t signal,
+                                const sgp_emulator_signal* model);
+
+/**
+ * sgp_emulator_set_feature_set() - set the feature set word of an SGP sensor
+ *
+ * The word contains the product type in the upper and the version in the lower
+ * bits, e.g. 0x0022 for an SGP30 or 0x1006 for an SGPC3, as returned by the
+ * get feature set command. For an SHTC1, it sets the ID register instead.
+ *
+ * @id:          Id of the sensor
+ * @feature_set: The feature set word
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the id is invalid
+ */
+int16_t sgp_emulator_set_feature_set(uint16_t id, uint16_t feature_set);
+
+/**
+ * sgp_emulator_set_serial_id() - set the serial id of an SGP sensor
+ *
+ * @id:        Id of the sensor
+ * @serial_id: The 48 bit serial id
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the id is invalid
+ */
+int16_t sgp_emulator_set_serial_id(uint16_t id, uint64_t serial_id);
+
+/**
+ * sgp_emulator_get_command_count() - number of commands a sensor executed
+ *
+ * @id:       Id of the sensor
+ * @command:  Command to count, 0 for all commands
+ * @count:    Output for the number of commands since the device was added
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the id is invalid
+ */
+int16_t sgp_emulator_get_command_count(uint16_t id, uint16_t command,
+                                       uint32_t* count);
+
+/**
+ * sgp_emulator_get_absolute_humidity() - humidity compensation of a sensor
+ *
+ * @id:                Id of the SGP30 or SGPC3
+ * @absolute_humidity: Output for the value of the last set absolute humidity
+ *                     command in the format of the sensor, 0 if none was sent
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the id is invalid
+ */
+int16_t sgp_emulator_get_absolute_humidity(uint16_t id,
+                                           uint16_t* absolute_humidity);
+
+/**
+ * sgp_emulator_get_time_us() - virtual time of the calling thread since
+ *                              sgp_emulator_reset() or the start of the thread
+ *
+ * Return:  The time in microseconds
+ */
+uint64_t sgp_emulator_get_time_us(void);
+
+/**
+ * sgp_emulator_advance_time_us() - advance the virtual time
+ *
+ * sensirion_sleep_usec() advances the time by the sleep duration. This
+ * function is for time spent otherwise, e.g. by computations.
+ *
+ * @useconds: Time to add in microseconds
+ */
+void sgp_emulator_advance_time_us(uint32_t useconds);
+
+/**
+ * sgp_emulator_get_clock() - the virtual clock of the emulator
+ *
+ * Return:  The clock to install with sgp_clock_set()
+ */
+sgp_clock* sgp_emulator_get_clock(void);
+
+/**
+ * sgp_emulator_set_transfer_time() - emulate the duration of the transfers
+ *
+ * By default, transfers take no time. With a bus clock, each transfer advances
+ * the virtual time of the calling thread by its duration on the bus, 9 clock
+ * cycles per byte including the address byte. @wait_usec is called with the
+ * same duration, e.g. to block the thread like the driver of a real bus does,
+ * so that benchmarks of threads driving several buses see the bus latency.
+ *
+ * @bus_clock_hz: Clock of the emulated buses, 0 for instant transfers
+ * @wait_usec:    Optional function called with the duration of each
+ *                transfer, NULL for none
+ */
+void sgp_emulator_set_transfer_time(uint32_t bus_clock_hz,
+                                    void (*wait_usec)(uint32_t useconds));
+
+/**
+ * sgp_emulator_get_bus_stats() - read the counters of an emulated bus
+ *
+ * The counters are kept per bus, so that threads driving different buses do
+ * not write to shared counters.
+ *
+ * @bus_idx: The bus
+ * @stats:   Output for the counters
+ * @reset:   true to reset the counters
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the bus index is invalid
+ */
+int16_t sgp_emulator_get_bus_stats(uint8_t bus_idx, sgp_emulator_stats* stats,
+                                   bool reset);
+
+/**
+ * sgp_emulator_get_stats() - read the counters of all emulated buses
+ *
+ * @stats: Output for the sums of the counters of all buses
+ * @reset: true to reset the counters
+ */
+void sgp_emulator_get_stats(sgp_emulator_stats* stats, bool reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_EMULATOR_H */
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_linux_i2c.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_i2c_bus.h"
+
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+static int sgp_linux_i2c_sys_open(const char* path, int flags) {
+    return open(path, flags);
+}
+
+static int sgp_linux_i2c_sys_ioctl(int fd, unsigned long request, void* arg) {
+    return ioctl(fd, request, arg);
+}
+
+static void sgp_linux_i2c_sys_sleep_usec(uint32_t useconds) {
+    usleep(useconds);
+}
+
+static uint64_t sgp_linux_i2c_sys_now_us(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+static const sgp_linux_i2c_ops sgp_linux_i2c_sys_ops = {
+    sgp_linux_i2c_sys_open, sgp_linux_i2c_sys_ioctl, close,
+    sgp_linux_i2c_sys_sleep_usec, sgp_linux_i2c_sys_now_us};
+
+/* size of the per bus counters, so that buses do not share a cache line */
+#define SGP_LINUX_I2C_CACHE_LINE_SIZE 64
+
+typedef union {
+    sgp_linux_i2c_stats stats;
+    uint8_t cache_line[SGP_LINUX_I2C_CACHE_LINE_SIZE];
+} sgp_linux_i2c_bus_stats;
+
+static struct {
+    const sgp_linux_i2c_ops* ops;
+    const char* paths[SGP_LINUX_I2C_MAX_BUSES];
+    int fds[SGP_LINUX_I2C_MAX_BUSES];
+    bool fd_valid[SGP_LINUX_I2C_MAX_BUSES];
+    bool can_batch[SGP_LINUX_I2C_MAX_BUSES];
+    bool batching;
+    sgp_linux_i2c_bus_stats bus_stats[SGP_LINUX_I2C_MAX_BUSES];
+} sgp_linux_i2c;
+
+/* selected bus and queued writes of a thread */
+typedef struct {
+    uint8_t bus_idx;
+    int16_t pending_error;
+    /* queued writes, whose data is copied to buffer */
+    struct i2c_msg messages[SGP_LINUX_I2C_MAX_MESSAGES];
+    uint8_t buffer[SGP_LINUX_I2C_BUFFER_SIZE];
+    uint16_t num_messages;
+    uint16_t buffer_used;
+} sgp_linux_i2c_queue;
+
+static SGP_THREAD_LOCAL sgp_linux_i2c_queue sgp_linux_i2c_thread;
+
+static const sgp_linux_i2c_ops* sgp_linux_i2c_ops_get(void) {
+    if (!sgp_linux_i2c.ops)
+        return &sgp_linux_i2c_sys_ops;
+    return sgp_linux_i2c.ops;
+}
+
+static sgp_linux_i2c_stats* sgp_linux_i2c_stats_get(uint8_t bus_idx) {
+    return &sgp_linux_i2c.bus_stats[bus_idx].stats;
+}
+
+/*
+ * The counters are updated by all threads on the bus and read by
+ * sgp_linux_i2c_get_stats(), relaxed atomics suffice as they order nothing
+ */
+static void sgp_linux_i2c_count(uint32_t* counter, uint32_t n) {
+    __atomic_add_fetch(counter, n, __ATOMIC_RELAXED);
+}
+
+static uint32_t sgp_linux_i2c_count_read(uint32_t* counter, bool reset) {
+    if (reset)
+        return __atomic_exchange_n(counter, 0, __ATOMIC_RELAXED);
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+/**
+ * sgp_linux_i2c_open() - open the device of the selected bus unless it is open
+ */
+static int16_t sgp_linux_i2c_open(void) {
+    const sgp_linux_i2c_ops* ops = sgp_linux_i2c_ops_get();
+    uint8_t bus_idx = sgp_linux_i2c_thread.bus_idx;
+    sgp_linux_i2c_stats* stats = sgp_linux_i2c_stats_get(bus_idx);
+    const char* path = sgp_linux_i2c.paths[bus_idx];
+    char default_path[32];
+    unsigned long funcs = 0;
+    int fd;
+
+    if (sgp_linux_i2c.fd_valid[bus_idx])
+        return STATUS_OK;
+
+    if (!path) {
+        snprintf(default_path, sizeof(default_path),
+                 SGP_LINUX_I2C_DEVICE_FORMAT, bus_idx);
+        path = default_path;
+    }
+
+    sgp_linux_i2c_count(&stats->syscalls, 1);
+    fd = ops->open(path, O_RDWR);
+    if (fd < 0) {
+        sgp_linux_i2c_count(&stats->errors, 1);
+        return STATUS_FAIL;
+    }
+
+    sgp_linux_i2c_count(&stats->syscalls, 1);
+    if (ops->ioctl(fd, I2C_FUNCS, &funcs) < 0) {
+        sgp_linux_i2c_count(&stats->errors, 1);
+        funcs = 0;
+    }
+
+    sgp_linux_i2c.fds[bus_idx] = fd;
+    sgp_linux_i2c.fd_valid[bus_idx] = true;
+    sgp_linux_i2c.can_batch[bus_idx] =
+        (funcs & I2C_FUNC_PROTOCOL_MANGLING) != 0;
+    return STATUS_OK;
+}
+
+/**
+ * sgp_linux_i2c_transfer() - send the queued writes and one more message
+ *
+ * @message: Message to send after the queued writes, NULL for none
+ */
+static int16_t sgp_linux_i2c_transfer(struct i2c_msg* message) {
+    const sgp_linux_i2c_ops* ops = sgp_linux_i2c_ops_get();
+    sgp_linux_i2c_stats* stats;
+    struct i2c_rdwr_ioctl_data data;
+    uint16_t num_messages = sgp_linux_i2c_thread.num_messages;
+    uint16_t i;
+    int16_t ret;
+
+    if (message)
+        sgp_linux_i2c_thread.messages[num_messages++] = *message;
+    if (num_messages == 0)
+        return STATUS_OK;
+
+    sgp_linux_i2c_thread.num_messages = 0;
+    sgp_linux_i2c_thread.buffer_used = 0;
+
+    ret = sgp_linux_i2c_open();
+    if (ret != STATUS_OK)
+        return ret;
+
+    /* keep the STOP conditions between the transfers of the batch */
+    for (i = 0; i + 1 < num_messages; ++i)
+        sgp_linux_i2c_thread.messages[i].flags |= I2C_M_STOP;
+
+    data.msgs = sgp_linux_i2c_thread.messages;
+    data.nmsgs = num_messages;
+    stats = sgp_linux_i2c_stats_get(sgp_linux_i2c_thread.bus_idx);
+    sgp_linux_i2c_count(&stats->syscalls, 1);
+    sgp_linux_i2c_count(&stats->transfers, 1);
+    sgp_linux_i2c_count(&stats->messages, num_messages);
+    if (ops->ioctl(sgp_linux_i2c.fds[sgp_linux_i2c_thread.bus_idx], I2C_RDWR,
+                   &data) != num_messages) {
+        sgp_linux_i2c_count(&stats->errors, 1);
+        return STATUS_FAIL;
+    }
+    return STATUS_OK;
+}
+
+static int16_t sgp_linux_i2c_take_pending_error(void) {
+    int16_t ret = sgp_linux_i2c_thread.pending_error;
+
+    sgp_linux_i2c_thread.pending_error = STATUS_OK;
+    return ret;
+}
+
+int16_t sgp_linux_i2c_set_device(uint8_t bus_idx, const char* path) {
+    if (bus_idx >= SGP_LINUX_I2C_MAX_BUSES)
+        return STATUS_FAIL;
+
+    sgp_linux_i2c.paths[bus_idx] = path;
+    return STATUS_OK;
+}
+
+/* the error is returned by the next transfer or flush of the thread */
+static void sgp_linux_i2c_send_queue(void) {
+    int16_t ret = sgp_linux_i2c_transfer(NULL);
+
+    if (ret != STATUS_OK)
+        sgp_linux_i2c_thread.pending_error = ret;
+}
+
+void sgp_linux_i2c_set_batching(bool enable) {
+    sgp_linux_i2c.batching = enable;
+    sgp_i2c_bus_set_flush(enable ? sgp_linux_i2c_send_queue : NULL);
+}
+
+int16_t sgp_linux_i2c_flush(void) {
+    int16_t ret = sgp_linux_i2c_take_pending_error();
+
+    if (ret != STATUS_OK) {
+        sgp_linux_i2c_thread.num_messages = 0;
+        sgp_linux_i2c_thread.buffer_used = 0;
+        return ret;
+    }
+    return sgp_linux_i2c_transfer(NULL);
+}
+
+void sgp_linux_i2c_get_stats(sgp_linux_i2c_stats* stats, bool reset) {
+    uint8_t i;
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0; i < SGP_LINUX_I2C_MAX_BUSES; ++i) {
+        sgp_linux_i2c_stats* bus_stats = sgp_linux_i2c_stats_get(i);
+
+        stats->syscalls +=
+            sgp_linux_i2c_count_read(&bus_stats->syscalls, reset);
+        stats->transfers +=
+            sgp_linux_i2c_count_read(&bus_stats->transfers, reset);
+        stats->messages +=
+            sgp_linux_i2c_count_read(&bus_stats->messages, reset);
+        stats->errors += sgp_linux_i2c_count_read(&bus_stats->errors, reset);
+    }
+}
+
+static uint64_t sgp_linux_i2c_clock_now_us(sgp_clock* clock) {
+    (void)clock;
+    return sgp_linux_i2c_ops_get()->now_us();
+}
+
+static void sgp_linux_i2c_clock_sleep_usec(sgp_clock* clock,
+                                           uint32_t useconds) {
+    (void)clock;
+    sensirion_sleep_usec(useconds);
+}
+
+static sgp_clock sgp_linux_i2c_clock = {sgp_linux_i2c_clock_now_us,
+                                        sgp_linux_i2c_clock_sleep_usec, NULL};
+
+sgp_clock* sgp_linux_i2c_get_clock(void) {
+    return &sgp_linux_i2c_clock;
+}
+
+void sgp_linux_i2c_set_ops(const sgp_linux_i2c_ops* ops) {
+    sgp_linux_i2c.ops = ops;
+}
+
+/**
+ * Select the current i2c bus by index.
+ * All following i2c operations will be directed at that bus.
+ *
+ * Writes queued for the previous bus are sent first.
+ *
+ * @param bus_idx   Bus index to select
+ * @returns         0 on success, an error code otherwise
+ */
+int16_t sensirion_i2c_select_bus(uint8_t bus_idx) {
+    int16_t ret;
+
+    if (bus_idx >= SGP_LINUX_I2C_MAX_BUSES)
+        return STATUS_FAIL;
+
+    if (bus_idx != sgp_linux_i2c_thread.bus_idx) {
+        ret = sgp_linux_i2c_flush();
+        if (ret != STATUS_OK)
+            return ret;
+        sgp_linux_i2c_thread.bus_idx = bus_idx;
+    }
+    return sgp_linux_i2c_open();
+}
+
+/**
+ * Initialize all hard- and software components that are needed for the I2C
+ * communication. The devices are opened on the first transfer. Installs the
+ * CLOCK_MONOTONIC clock of the backend unless another clock is installed.
+ */
+void sensirion_i2c_init(void) {
+    if (!sgp_clock_is_set())
+        sgp_clock_set(sgp_linux_i2c_get_clock());
+}
+
+/**
+ * Release all resources initialized by sensirion_i2c_init().
+ *
+ * Queued writes are sent, all devices are closed and the clock of the backend
+ * is uninstalled.
+ */
+void sensirion_i2c_release(void) {
+    const sgp_linux_i2c_ops* ops = sgp_linux_i2c_ops_get();
+    uint8_t i;
+
+    if (sgp_clock_get() == sgp_linux_i2c_get_clock())
+        sgp_clock_set(NULL);
+    (void)sgp_linux_i2c_flush();
+    for (i = 0; i < SGP_LINUX_I2C_MAX_BUSES; ++i) {
+        if (!sgp_linux_i2c.fd_valid[i])
+            continue;
+        sgp_linux_i2c_count(&sgp_linux_i2c_stats_get(i)->syscalls, 1);
+        if (ops->close(sgp_linux_i2c.fds[i]) < 0)
+            sgp_linux_i2c_count(&sgp_linux_i2c_stats_get(i)->errors, 1);
+        sgp_linux_i2c.fd_valid[i] = false;
+    }
+}
+
+/**
+ * Execute one read transaction on the I2C bus, reading a given number of
+ * bytes. Queued writes are sent in the same ioctl. If the device does not
+ * acknowledge the read command, an error shall be returned.
+ *
+ * @param address 7-bit I2C address to read from
+ * @param data    pointer to the buffer where the data is to be stored
+ * @param count   number of bytes to read from I2C and store in the buffer
+ * @returns 0 on success, error code otherwise
+ */
+int8_t sensirion_i2c_read(uint8_t address, uint8_t* data, uint16_t count) {
+    struct i2c_msg message;
+    int16_t ret;
+
+    ret = sgp_linux_i2c_take_pending_error();
+    if (ret != STATUS_OK)
+        return (int8_t)ret;
+
+    message.addr = address;
+    message.flags = I2C_M_RD;
+    message.len = count;
+    message.buf = data;
+    return (int8_t)sgp_linux_i2c_transfer(&message);
+}
+
+/**
+ * Execute one write transaction on the I2C bus, sending a given number of
+ * bytes. When batching, the data is queued and sent with the next read, sleep
+ * or flush. If the device does not acknowledge the write command, an error
+ * shall be returned.
+ *
+ * @param address 7-bit I2C address to write to
+ * @param data    pointer to the buffer containing the data to write
+ * @param count   number of bytes to read from the buffer and send over I2C
+ * @returns 0 on success, error code otherwise
+ */
+int8_t sensirion_i2c_write(uint8_t address, const uint8_t* data,
+                           uint16_t count) {
+    sgp_linux_i2c_queue* queue;
+    struct i2c_msg* message;
+    int16_t ret;
+
+    ret = sgp_linux_i2c_take_pending_error();
+    if (ret != STATUS_OK)
+        return (int8_t)ret;
+
+    ret = sgp_linux_i2c_open();
+    if (ret != STATUS_OK)
+        return (int8_t)ret;
+
+    if (!sgp_linux_i2c.batching ||
+        !sgp_linux_i2c.can_batch[sgp_linux_i2c_thread.bus_idx] ||
+        count > SGP_LINUX_I2C_BUFFER_SIZE) {
+        struct i2c_msg direct;
+
+        direct.addr = address;
+        direct.flags = 0;
+        direct.len = count;
+        direct.buf = (uint8_t*)data;
+        return (int8_t)sgp_linux_i2c_transfer(&direct);
+    }
+
+    /* one message stays free for the read sent with the queue */
+    if (sgp_linux_i2c_thread.num_messages + 1 >= SGP_LINUX_I2C_MAX_MESSAGES ||
+        sgp_linux_i2c_thread.buffer_used + count > SGP_LINUX_I2C_BUFFER_SIZE) {
+        ret = sgp_linux_i2c_transfer(NULL);
+        if (ret != STATUS_OK)
+            return (int8_t)ret;
+    }
+
+    queue = &sgp_linux_i2c_thread;
+    message = &queue->messages[queue->num_messages++];
+    message->addr = address;
+    message->flags = 0;
+    message->len = count;
+    message->buf = &queue->buffer[queue->buffer_used];
+    memcpy(message->buf, data, count);
+    queue->buffer_used += count;
+    return STATUS_OK;
+}
+
+/**
+ * Sleep for a given number of microseconds. Queued writes are sent first, so
+ * the sleep starts after the commands were sent.
+ *
+ * @param useconds the sleep time in microseconds
+ */
+void sensirion_sleep_usec(uint32_t useconds) {
+    sgp_linux_i2c_send_queue();
+
+    sgp_linux_i2c_count(
+        &sgp_linux_i2c_stats_get(sgp_linux_i2c_thread.bus_idx)->syscalls, 1);
+    sgp_linux_i2c_ops_get()->sleep_usec(useconds);
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_LINUX_I2C_H
+#define SGP_LINUX_I2C_H
+#include "sensirion_arch_config.h"
+#include "sgp_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Linux user space implementation of sensirion_i2c.h for the i2c-dev
+ * interface. Build it instead of the default hardware I2C implementation,
+ * e.g. with
+ *
+ *     make hw_i2c_impl_src=../sgp-common/linux_i2c/sgp_linux_i2c.c
+ *
+ * The device of each bus is opened once and kept open until
+ * sensirion_i2c_release(). Every transfer is a single I2C_RDWR ioctl, which
+ * carries the I2C address, so no I2C_SLAVE ioctl is needed when switching
+ * between sensors.
+ *
+ * The selected bus and the queued writes are per thread, so one thread per bus
+ * can poll its sensors in parallel. Threads sharing a bus need an
+ * sgp_i2c_bus_lock on it, and the configuration functions and
+ * sensirion_i2c_release() must not run while other threads transfer.
+ *
+ * sensirion_i2c_init() installs a CLOCK_MONOTONIC sgp_clock unless another
+ * clock is installed, so that sgp_periodic compensates the transfer time and
+ * counts jitter and overruns.
+ */
+
+#define SGP_LINUX_I2C_DEVICE_FORMAT "/dev/i2c-%u"
+#define SGP_LINUX_I2C_MAX_BUSES 8
+#define SGP_LINUX_I2C_MAX_MESSAGES 16
+#define SGP_LINUX_I2C_BUFFER_SIZE 128
+
+/**
+ * struct sgp_linux_i2c_stats - counters of the I2C backend
+ *
+ * @syscalls:  All system calls: open, close, ioctl and sleep
+ * @transfers: I2C_RDWR ioctls, each of which is one transfer on the bus
+ * @messages:  I2C messages in these transfers
+ * @errors:    Failed system calls
+ */
+typedef struct {
+    uint32_t syscalls;
+    uint32_t transfers;
+    uint32_t messages;
+    uint32_t errors;
+} sgp_linux_i2c_stats;
+
+/**
+ * struct sgp_linux_i2c_ops - system calls used by the backend
+ *
+ * Replaced to run the backend against an emulated i2c-dev device in tests.
+ */
+typedef struct {
+    int (*open)(const char* path, int flags);
+    int (*ioctl)(int fd, unsigned long request, void* arg);
+    int (*close)(int fd);
+    void (*sleep_usec)(uint32_t useconds);
+    uint64_t (*now_us)(void);
+} sgp_linux_i2c_ops;
+
+/**
+ * sgp_linux_i2c_set_device() - set the i2c-dev device of a bus
+ *
+ * The device is opened on the next transfer on the bus. Without this call,
+ * bus n uses the device SGP_LINUX_I2C_DEVICE_FORMAT with n, i.e. /dev/i2c-n.
+ *
+ * @bus_idx: Bus index, as passed to sensirion_i2c_select_bus()
+ * @path:    Path of the device, which must remain valid. NULL for the default.
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the bus index is too large
+ */
+int16_t sgp_linux_i2c_set_device(uint8_t bus_idx, const char* path);
+
+/**
+ * sgp_linux_i2c_set_batching() - combine consecutive transfers into one ioctl
+ *
+ * When enabled, writes are queued and sent together with the next read, before
+ * the next sleep, when a bus lock is given back, or with
+ * sgp_linux_i2c_flush(), e.g. the channel switch of a multiplexer and the
+ * command which follows it. A STOP condition is forced after each message, so
+ * the bus sees the same transfers as without batching.
+ * This needs an adapter supporting I2C_FUNC_PROTOCOL_MANGLING; on other
+ * adapters the transfers are sent one by one.
+ *
+ * An error of a write is reported by the read or flush which sends it. If it is
+ * sent by a sleep or the release of a bus lock, the error is returned by the
+ * next transfer or flush of the thread.
+ *
+ * @enable: true to batch transfers, false to send each transfer immediately
+ *          (the default)
+ */
+void sgp_linux_i2c_set_batching(bool enable);
+
+/**
+ * sgp_linux_i2c_flush() - send the queued writes
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp_linux_i2c_flush(void);
+
+/**
+ * sgp_linux_i2c_get_stats() - read the counters of the backend
+ *
+ * The counters are kept per bus and summed up. They may be read and reset
+ * while other threads use the buses, each counter is read and reset
+ * atomically, but not all of them together.
+ *
+ * @stats: Output for the counters since the last reset
+ * @reset: true to reset the counters, e.g. to get them per polling round
+ */
+void sgp_linux_i2c_get_stats(sgp_linux_i2c_stats* stats, bool reset);
+
+/**
+ * sgp_linux_i2c_get_clock() - the CLOCK_MONOTONIC clock of the backend
+ *
+ * Sleeps with sensirion_sleep_usec(), i.e. sends the queued writes first.
+ *
+ * Return:  The clock to install with sgp_clock_set()
+ */
+sgp_clock* sgp_linux_i2c_get_clock(void);
+
+/**
+ * sgp_linux_i2c_set_ops() - replace the system calls used by the backend
+ *
+ * Must be called while no device is open, i.e. before the first transfer or
+ * after sensirion_i2c_release().
+ *
+ * @ops: The system calls, which must remain valid. NULL for the real ones.
+ */
+void sgp_linux_i2c_set_ops(const sgp_linux_i2c_ops* ops);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_LINUX_I2C_H */
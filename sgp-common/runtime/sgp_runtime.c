@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_runtime.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_clock.h"
+#include "sgp_periodic.h"
+
+#include <time.h>
+
+static void* sgp_runtime_bus_main(void* arg) {
+    sgp_runtime_bus* bus = (sgp_runtime_bus*)arg;
+    sgp_runtime* rt = bus->runtime;
+    sgp_periodic periodic;
+    uint32_t round;
+
+    /* the selection is per thread and kept for all rounds */
+    if (sensirion_i2c_select_bus(bus->bus_idx) != STATUS_OK)
+        ++bus->stats.errors;
+    if (rt->period_us)
+        sgp_periodic_init(&periodic, rt->period_us);
+
+    for (round = 0; rt->num_rounds == 0 || round < rt->num_rounds; ++round) {
+        if (__atomic_load_n(&rt->stopping, __ATOMIC_ACQUIRE))
+            break;
+        /* the results of the previous round are processed in order */
+        sgp_work_pool_wait(&rt->pool, &bus->group);
+        if (rt->poll(bus) != STATUS_OK)
+            ++bus->stats.errors;
+        ++bus->stats.rounds;
+        if (rt->period_us)
+            bus->stats.missed_periods += sgp_periodic_wait(&periodic);
+    }
+    sgp_work_pool_wait(&rt->pool, &bus->group);
+    return NULL;
+}
+
+int16_t sgp_runtime_init(sgp_runtime* rt, uint16_t num_workers,
+                         int16_t (*poll)(sgp_runtime_bus* bus),
+                         uint32_t period_us) {
+    rt->num_buses = 0;
+    rt->poll = poll;
+    rt->period_us = period_us;
+    rt->num_rounds = 0;
+    rt->stopping = false;
+    return sgp_work_pool_init(&rt->pool, num_workers);
+}
+
+int16_t sgp_runtime_add_bus(sgp_runtime* rt, uint8_t bus_idx,
+                            void* user_data) {
+    sgp_runtime_bus* bus;
+
+    if (rt->num_buses >= SGP_RUNTIME_MAX_BUSES)
+        return STATUS_FAIL;
+
+    bus = &rt->buses[rt->num_buses++];
+    bus->runtime = rt;
+    bus->bus_idx = bus_idx;
+    bus->user_data = user_data;
+    sgp_work_group_init(&bus->group);
+    bus->stats.rounds = 0;
+    bus->stats.errors = 0;
+    bus->stats.missed_periods = 0;
+    return STATUS_OK;
+}
+
+int16_t sgp_runtime_start(sgp_runtime* rt, uint32_t num_rounds) {
+    uint8_t i;
+
+    rt->num_rounds = num_rounds;
+    rt->stopping = false;
+    for (i = 0; i < rt->num_buses; ++i) {
+        if (pthread_create(&rt->buses[i].thread, NULL, sgp_runtime_bus_main,
+                           &rt->buses[i])) {
+            /* stop and join the threads which were started */
+            rt->num_buses = i;
+            sgp_runtime_stop(rt);
+            return STATUS_FAIL;
+        }
+    }
+    return STATUS_OK;
+}
+
+void sgp_runtime_submit(sgp_runtime_bus* bus, void (*run)(void* arg),
+                        void* arg) {
+    sgp_work_pool_submit(&bus->runtime->pool, &bus->group, run, arg,
+                         bus->bus_idx);
+}
+
+void sgp_runtime_join(sgp_runtime* rt) {
+    uint8_t i;
+
+    for (i = 0; i < rt->num_buses; ++i)
+        pthread_join(rt->buses[i].thread, NULL);
+}
+
+void sgp_runtime_stop(sgp_runtime* rt) {
+    __atomic_store_n(&rt->stopping, true, __ATOMIC_RELEASE);
+    sgp_runtime_join(rt);
+}
+
+void sgp_runtime_destroy(sgp_runtime* rt) {
+    sgp_work_pool_destroy(&rt->pool);
+}
+
+void sgp_runtime_get_stats(sgp_runtime* rt, sgp_runtime_bus_stats* stats) {
+    uint8_t i;
+
+    stats->rounds = 0;
+    stats->errors = 0;
+    stats->missed_periods = 0;
+    for (i = 0; i < rt->num_buses; ++i) {
+        stats->rounds += rt->buses[i].stats.rounds;
+        stats->errors += rt->buses[i].stats.errors;
+        stats->missed_periods += rt->buses[i].stats.missed_periods;
+    }
+}
+
+static uint64_t sgp_runtime_clock_now_us(sgp_clock* clock) {
+    struct timespec now;
+    (void)clock;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+static void sgp_runtime_clock_sleep_usec(sgp_clock* clock, uint32_t useconds) {
+    (void)clock;
+    sensirion_sleep_usec(useconds);
+}
+
+static sgp_clock sgp_runtime_system_clock = {
+    sgp_runtime_clock_now_us, sgp_runtime_clock_sleep_usec, NULL};
+
+sgp_clock* sgp_runtime_get_system_clock(void) {
+    return &sgp_runtime_system_clock;
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_RUNTIME_H
+#define SGP_RUNTIME_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sgp_clock.h"
+#include "sgp_work_pool.h"
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Runtime for gateways with sensors on several physical I2C buses. The
+ * transfers on a bus are serialized, but the buses work in parallel: each bus
+ * gets an I/O thread, which polls the sensors on it and submits the
+ * processing of the results to a work-stealing pool (sgp_work_pool.h), so the
+ * processing of all buses runs on all CPUs.
+ *
+ * The I2C implementation must keep the selected bus per thread, like the
+ * Linux and emulated implementations in sgp-common. The sgp_clock is shared
+ * by all threads: install a thread-safe clock like the one of
+ * sgp_runtime_get_system_clock() or the one of the emulator before starting.
+ */
+
+#define SGP_RUNTIME_MAX_BUSES 64
+
+struct sgp_runtime;
+
+/**
+ * struct sgp_runtime_bus_stats - counters of the I/O thread of a bus
+ *
+ * @rounds:         Polling rounds
+ * @errors:         Rounds whose poll function failed
+ * @missed_periods: Periods skipped because a round took longer than a period
+ */
+typedef struct {
+    uint32_t rounds;
+    uint32_t errors;
+    uint32_t missed_periods;
+} sgp_runtime_bus_stats;
+
+/**
+ * struct sgp_runtime_bus - bus polled by an I/O thread
+ *
+ * @runtime:    The runtime
+ * @bus_idx:    Index of the bus passed to sensirion_i2c_select_bus()
+ * @user_data:  Data for the poll function, e.g. the devices on the bus
+ * @thread:     The I/O thread
+ * @group:      Processing tasks submitted for the bus
+ * @stats:      Counters, written by the I/O thread
+ */
+typedef struct sgp_runtime_bus {
+    struct sgp_runtime* runtime;
+    uint8_t bus_idx;
+    void* user_data;
+    pthread_t thread;
+    sgp_work_group group;
+    sgp_runtime_bus_stats stats;
+} sgp_runtime_bus;
+
+/**
+ * struct sgp_runtime - I/O threads of the buses and the shared work pool
+ *
+ * @pool:       Pool running the processing of all buses
+ * @buses:      The buses
+ * @num_buses:  Number of buses
+ * @poll:       Polls the sensors on a bus once, see sgp_runtime_init()
+ * @period_us:  Period of the polling rounds, 0 to poll continuously
+ * @num_rounds: Rounds per bus, 0 to poll until sgp_runtime_stop()
+ * @stopping:   Set by sgp_runtime_stop()
+ */
+typedef struct sgp_runtime {
+    sgp_work_pool pool;
+    sgp_runtime_bus buses[SGP_RUNTIME_MAX_BUSES];
+    uint8_t num_buses;
+    int16_t (*poll)(sgp_runtime_bus* bus);
+    uint32_t period_us;
+    uint32_t num_rounds;
+    bool stopping;
+} sgp_runtime;
+
+/**
+ * sgp_runtime_init() - initialize a runtime and start its work pool
+ *
+ * The I/O thread of each bus calls @poll once per period. @poll runs the I2C
+ * transfers of the sensors on the bus and passes their results to
+ * sgp_runtime_submit(). Before the next round, the I/O thread waits until the
+ * tasks of the previous round finished, so the results of a sensor are
+ * processed in order and its buffers can be reused in every round.
+ *
+ * @rt:          The runtime
+ * @num_workers: Threads of the work pool, 0 for one per online CPU
+ * @poll:        Polls the sensors on a bus once
+ * @period_us:   Period of the polling rounds, 0 to poll continuously
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the pool could not be started
+ */
+int16_t sgp_runtime_init(sgp_runtime* rt, uint16_t num_workers,
+                         int16_t (*poll)(sgp_runtime_bus* bus),
+                         uint32_t period_us);
+
+/**
+ * sgp_runtime_add_bus() - add a bus to poll with its own I/O thread
+ *
+ * @rt:        The runtime
+ * @bus_idx:   Index of the bus passed to sensirion_i2c_select_bus()
+ * @user_data: Data for the poll function, e.g. the devices on the bus
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if there are too many buses
+ */
+int16_t sgp_runtime_add_bus(sgp_runtime* rt, uint8_t bus_idx, void* user_data);
+
+/**
+ * sgp_runtime_start() - start the I/O threads of all buses
+ *
+ * @rt:         The runtime
+ * @num_rounds: Rounds per bus, 0 to poll until sgp_runtime_stop()
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if a thread could not be started
+ */
+int16_t sgp_runtime_start(sgp_runtime* rt, uint32_t num_rounds);
+
+/**
+ * sgp_runtime_submit() - process a result on the work pool
+ *
+ * Called by the poll function.
+ *
+ * @bus:  The bus passed to the poll function
+ * @run:  The processing task
+ * @arg:  Argument of @run
+ */
+void sgp_runtime_submit(sgp_runtime_bus* bus, void (*run)(void* arg),
+                        void* arg);
+
+/**
+ * sgp_runtime_join() - wait until the I/O threads finished their rounds and
+ *                      the processing of their results finished
+ *
+ * @rt: The runtime
+ */
+void sgp_runtime_join(sgp_runtime* rt);
+
+/**
+ * sgp_runtime_stop() - stop the I/O threads after their current round
+ *
+ * Waits like sgp_runtime_join(), i.e. at most one period and the processing.
+ *
+ * @rt: The runtime
+ */
+void sgp_runtime_stop(sgp_runtime* rt);
+
+/**
+ * sgp_runtime_destroy() - stop the work pool
+ *
+ * @rt: The runtime, whose I/O threads were joined or stopped
+ */
+void sgp_runtime_destroy(sgp_runtime* rt);
+
+/**
+ * sgp_runtime_get_stats() - sum up the counters of all buses
+ *
+ * @rt:    The runtime, whose I/O threads were joined or stopped
+ * @stats: Output for the sums of the counters
+ */
+void sgp_runtime_get_stats(sgp_runtime* rt, sgp_runtime_bus_stats* stats);
+
+/**
+ * sgp_runtime_get_system_clock() - thread-safe clock of the system
+ *
+ * Reads CLOCK_MONOTONIC and sleeps with sensirion_sleep_usec(). The default
+ * sgp_clock counts the time slept by all threads together, so it is no time
+ * source for several I/O threads.
+ *
+ * Return:  The clock to install with sgp_clock_set()
+ */
+sgp_clock* sgp_runtime_get_system_clock(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_RUNTIME_H */
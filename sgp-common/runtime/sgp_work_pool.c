@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_work_pool.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#include <unistd.h>
+
+static void sgp_work_pool_finish(sgp_work_pool* pool, sgp_work_item* item) {
+    if (!item->group ||
+        __atomic_sub_fetch(&item->group->pending, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+    pthread_mutex_lock(&pool->idle_lock);
+    pthread_cond_broadcast(&pool->done_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+static bool sgp_work_pool_push(sgp_work_pool_worker* worker,
+                               const sgp_work_item* item) {
+    bool pushed = false;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->tail - worker->head < SGP_WORK_POOL_QUEUE_SIZE) {
+        worker->items[worker->tail % SGP_WORK_POOL_QUEUE_SIZE] = *item;
+        ++worker->tail;
+        pushed = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+    return pushed;
+}
+
+/**
+ * sgp_work_pool_take() - take the newest task of the own queue or the oldest
+ *                        task of another queue
+ *
+ * Return:  true if a task was taken
+ */
+static bool sgp_work_pool_take(sgp_work_pool* pool, uint16_t self,
+                               sgp_work_item* item) {
+    sgp_work_pool_worker* worker = &pool->workers[self];
+    bool taken = false;
+    uint16_t i;
+
+    pthread_mutex_lock(&worker->lock);
+    if (worker->tail != worker->head) {
+        --worker->tail;
+        *item = worker->items[worker->tail % SGP_WORK_POOL_QUEUE_SIZE];
+        taken = true;
+    }
+    pthread_mutex_unlock(&worker->lock);
+
+    for (i = 1; !taken && i < pool->num_workers; ++i) {
+        sgp_work_pool_worker* victim =
+            &pool->workers[(self + i) % pool->num_workers];
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->tail != victim->head) {
+            *item = victim->items[victim->head % SGP_WORK_POOL_QUEUE_SIZE];
+            ++victim->head;
+            taken = true;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (taken)
+            __atomic_add_fetch(&worker->stolen, 1, __ATOMIC_RELAXED);
+    }
+    if (taken)
+        __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+    return taken;
+}
+
+static void* sgp_work_pool_worker_main(void* arg) {
+    sgp_work_pool_worker* worker = (sgp_work_pool_worker*)arg;
+    sgp_work_pool* pool = worker->pool;
+    uint16_t self = (uint16_t)(worker - pool->workers);
+    sgp_work_item item;
+
+    for (;;) {
+        if (sgp_work_pool_take(pool, self, &item)) {
+            item.run(item.arg);
+            __atomic_add_fetch(&worker->executed, 1, __ATOMIC_RELAXED);
+            sgp_work_pool_finish(pool, &item);
+            continue;
+        }
+
+        /*
+         * Announce the sleeper before checking the queues again. A submitter
+         * increments the number of queued tasks before checking for sleepers,
+         * so either this worker sees the task or the submitter wakes it up.
+         */
+        pthread_mutex_lock(&pool->idle_lock);
+        __atomic_add_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+        while (!pool->stopping &&
+               __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0)
+            pthread_cond_wait(&pool->work_cond, &pool->idle_lock);
+        __atomic_sub_fetch(&pool->sleepers, 1, __ATOMIC_SEQ_CST);
+        if (pool->stopping &&
+            __atomic_load_n(&pool->queued, __ATOMIC_SEQ_CST) == 0) {
+            pthread_mutex_unlock(&pool->idle_lock);
+            return NULL;
+        }
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+}
+
+void sgp_work_group_init(sgp_work_group* group) {
+    group->pending = 0;
+}
+
+/**
+ * sgp_work_pool_stop() - stop the workers once the queues are empty
+ *
+ * @num_threads:    Number of workers whose threads were started
+ */
+static void sgp_work_pool_stop(sgp_work_pool* pool, uint16_t num_threads) {
+    uint16_t i;
+
+    pthread_mutex_lock(&pool->idle_lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (i = 0; i < num_threads; ++i)
+        pthread_join(pool->workers[i].thread, NULL);
+    for (i = 0; i < pool->num_workers; ++i)
+        pthread_mutex_destroy(&pool->workers[i].lock);
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->idle_lock);
+}
+
+int16_t sgp_work_pool_init(sgp_work_pool* pool, uint16_t num_workers) {
+    uint16_t i;
+
+    if (num_workers == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        num_workers = cpus > 0 ? (uint16_t)cpus : 1;
+    }
+    if (num_workers > SGP_WORK_POOL_MAX_WORKERS)
+        num_workers = SGP_WORK_POOL_MAX_WORKERS;
+
+    pool->num_workers = num_workers;
+    pool->queued = 0;
+    pool->sleepers = 0;
+    pool->inline_runs = 0;
+    pool->stopping = false;
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    /* the workers steal from all queues, so they exist before any starts */
+    for (i = 0; i < num_workers; ++i) {
+        sgp_work_pool_worker* worker = &pool->workers[i];
+
+        worker->pool = pool;
+        worker->head = 0;
+        worker->tail = 0;
+        worker->executed = 0;
+        worker->stolen = 0;
+        pthread_mutex_init(&worker->lock, NULL);
+    }
+    for (i = 0; i < num_workers; ++i) {
+        if (pthread_create(&pool->workers[i].thread, NULL,
+                           sgp_work_pool_worker_main, &pool->workers[i])) {
+            sgp_work_pool_stop(pool, i);
+            return STATUS_FAIL;
+        }
+    }
+    return STATUS_OK;
+}
+
+void sgp_work_pool_submit(sgp_work_pool* pool, sgp_work_group* group,
+                          void (*run)(void* arg), void* arg, uint16_t hint) {
+    sgp_work_item item;
+    uint16_t i;
+
+    item.run = run;
+    item.arg = arg;
+    item.group = group;
+    if (group)
+        __atomic_add_fetch(&group->pending, 1, __ATOMIC_ACQ_REL);
+
+    /* counted before pushing, so a worker never sees a negative count */
+    __atomic_add_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+    for (i = 0; i < pool->num_workers; ++i) {
+        if (sgp_work_pool_push(
+                &pool->workers[(hint + i) % pool->num_workers], &item))
+            break;
+    }
+    if (i == pool->num_workers) {
+        __atomic_sub_fetch(&pool->queued, 1, __ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&pool->inline_runs, 1, __ATOMIC_RELAXED);
+        run(arg);
+        sgp_work_pool_finish(pool, &item);
+        return;
+    }
+
+    if (__atomic_load_n(&pool->sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&pool->idle_lock);
+        pthread_cond_signal(&pool->work_cond);
+        pthread_mutex_unlock(&pool->idle_lock);
+    }
+}
+
+void sgp_work_pool_wait(sgp_work_pool* pool, sgp_work_group* group) {
+    if (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) == 0)
+        return;
+    pthread_mutex_lock(&pool->idle_lock);
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) != 0)
+        pthread_cond_wait(&pool->done_cond, &pool->idle_lock);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+void sgp_work_pool_destroy(sgp_work_pool* pool) {
+    sgp_work_pool_stop(pool, pool->num_workers);
+}
+
+void sgp_work_pool_get_stats(sgp_work_pool* pool, sgp_work_pool_stats* stats) {
+    uint16_t i;
+
+    stats->executed = 0;
+    stats->stolen = 0;
+    stats->inline_runs = __atomic_load_n(&pool->inline_runs, __ATOMIC_RELAXED);
+    for (i = 0; i < pool->num_workers; ++i) {
+        sgp_work_pool_worker* worker = &pool->workers[i];
+
+        stats->executed +=
+            __atomic_load_n(&worker->executed, __ATOMIC_RELAXED);
+        stats->stolen += __atomic_load_n(&worker->stolen, __ATOMIC_RELAXED);
+    }
+}
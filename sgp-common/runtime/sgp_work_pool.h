@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_WORK_POOL_H
+#define SGP_WORK_POOL_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pool of worker threads for the processing of the measurements, e.g. the
+ * VOC algorithm, humidity conversions and the encoding of the results, which
+ * does not need the I2C bus and runs on any CPU.
+ *
+ * Each worker has its own queue. Tasks are submitted to the queue of a worker
+ * chosen by a hint, e.g. the bus index, so tasks of the same bus tend to run
+ * on the same CPU. Idle workers steal tasks from the queues of the others, so
+ * the load is balanced when some buses produce more work than others.
+ */
+
+#define SGP_WORK_POOL_MAX_WORKERS 64
+#define SGP_WORK_POOL_QUEUE_SIZE 256
+
+/**
+ * struct sgp_work_group - tasks which are waited for together
+ *
+ * @pending:    Submitted tasks which did not finish yet
+ */
+typedef struct {
+    uint32_t pending;
+} sgp_work_group;
+
+/**
+ * struct sgp_work_pool_stats - counters of a work pool
+ *
+ * @executed:    Tasks run by the workers
+ * @stolen:      Tasks a worker took from the queue of another worker
+ * @inline_runs: Tasks run by the submitting thread because all queues were
+ *               full
+ */
+typedef struct {
+    uint64_t executed;
+    uint64_t stolen;
+    uint64_t inline_runs;
+} sgp_work_pool_stats;
+
+typedef struct {
+    void (*run)(void* arg);
+    void* arg;
+    sgp_work_group* group;
+} sgp_work_item;
+
+typedef struct {
+    struct sgp_work_pool* pool;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    /* tasks from head to tail, the owner takes from the tail */
+    sgp_work_item items[SGP_WORK_POOL_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+    uint64_t executed;
+    uint64_t stolen;
+} sgp_work_pool_worker;
+
+/**
+ * struct sgp_work_pool - work-stealing pool of worker threads
+ *
+ * @workers:     The workers and their queues
+ * @num_workers: Number of workers
+ * @idle_lock:   Protects the waiting for work and for groups
+ * @work_cond:   Signalled when a task is queued while workers sleep
+ * @done_cond:   Broadcast when the last task of a group finished
+ * @queued:      Tasks in all queues
+ * @sleepers:    Workers waiting for @work_cond
+ * @inline_runs: See struct sgp_work_pool_stats
+ * @stopping:    Set by sgp_work_pool_destroy()
+ */
+typedef struct sgp_work_pool {
+    sgp_work_pool_worker workers[SGP_WORK_POOL_MAX_WORKERS];
+    uint16_t num_workers;
+    pthread_mutex_t idle_lock;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    uint32_t queued;
+    uint32_t sleepers;
+    uint64_t inline_runs;
+    bool stopping;
+} sgp_work_pool;
+
+/**
+ * sgp_work_group_init() - initialize a group without pending tasks
+ *
+ * @group: The group
+ */
+void sgp_work_group_init(sgp_work_group* group);
+
+/**
+ * sgp_work_pool_init() - start the worker threads of a pool
+ *
+ * @pool:        The pool
+ * @num_workers: Number of workers, 0 for one per online CPU
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if a thread could not be started
+ */
+int16_t sgp_work_pool_init(sgp_work_pool* pool, uint16_t num_workers);
+
+/**
+ * sgp_work_pool_submit() - run a task on a worker
+ *
+ * Thread-safe. If all queues are full, the task runs in the calling thread
+ * before the function returns.
+ *
+ * @pool:  The pool
+ * @group: Group of the task to wait for it with sgp_work_pool_wait(), NULL
+ *         for none
+ * @run:   The task
+ * @arg:   Argument of @run
+ * @hint:  Selects the queue of the task, e.g. the bus index
+ */
+void sgp_work_pool_submit(sgp_work_pool* pool, sgp_work_group* group,
+                          void (*run)(void* arg), void* arg, uint16_t hint);
+
+/**
+ * sgp_work_pool_wait() - wait until all tasks of a group finished
+ *
+ * @pool:  The pool
+ * @group: The group
+ */
+void sgp_work_pool_wait(sgp_work_pool* pool, sgp_work_group* group);
+
+/**
+ * sgp_work_pool_destroy() - run the queued tasks and stop the workers
+ *
+ * No tasks may be submitted afterwards. The counters stay readable.
+ *
+ * @pool:  The pool
+ */
+void sgp_work_pool_destroy(sgp_work_pool* pool);
+
+/**
+ * sgp_work_pool_get_stats() - read the counters of a pool
+ *
+ * @pool:  The pool
+ * @stats: Output for the sums of the counters of all workers
+ */
+void sgp_work_pool_get_stats(sgp_work_pool* pool, sgp_work_pool_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_WORK_POOL_H */
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_clock.h"
+#include "sensirion_i2c.h"
+
+static uint64_t sgp_default_clock_now_us(sgp_clock* clock) {
+    return *(uint64_t*)clock->user_data;
+}
+
+static void sgp_default_clock_sleep_usec(sgp_clock* clock,
+                                         uint32_t useconds) {
+    sensirion_sleep_usec(useconds);
+    *(uint64_t*)clock->user_data += useconds;
+}
+
+static uint64_t sgp_default_clock_slept_us;
+static sgp_clock sgp_default_clock = {sgp_default_clock_now_us,
+                                      sgp_default_clock_sleep_usec,
+                                      &sgp_default_clock_slept_us};
+static sgp_clock* sgp_current_clock = &sgp_default_clock;
+
+void sgp_clock_set(sgp_clock* clock) {
+    sgp_current_clock = clock ? clock : &sgp_default_clock;
+}
+
+sgp_clock* sgp_clock_get(void) {
+    return sgp_current_clock;
+}
+
+bool sgp_clock_is_set(void) {
+    return sgp_current_clock != &sgp_default_clock;
+}
+
+uint64_t sgp_clock_now_us(void) {
+    return sgp_current_clock->now_us(sgp_current_clock);
+}
+
+void sgp_clock_sleep_usec(uint32_t useconds) {
+    sgp_current_clock->sleep_usec(sgp_current_clock, useconds);
+}
+
+static uint64_t sgp_virtual_clock_now_us(sgp_clock* clock) {
+    return ((sgp_virtual_clock*)clock->user_data)->time_us;
+}
+
+static void sgp_virtual_clock_sleep_usec(sgp_clock* clock, uint32_t useconds) {
+    ((sgp_virtual_clock*)clock->user_data)->time_us += useconds;
+}
+
+void sgp_virtual_clock_init(sgp_virtual_clock* virtual_clock,
+                            uint64_t start_us) {
+    virtual_clock->clock.now_us = sgp_virtual_clock_now_us;
+    virtual_clock->clock.sleep_usec = sgp_virtual_clock_sleep_usec;
+    virtual_clock->clock.user_data = virtual_clock;
+    virtual_clock->time_us = start_us;
+}
+
+void sgp_virtual_clock_advance_us(sgp_virtual_clock* virtual_clock,
+                                  uint64_t useconds) {
+    virtual_clock->time_us += useconds;
+}
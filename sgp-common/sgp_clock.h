@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_CLOCK_H
+#define SGP_CLOCK_H
+#include "sensirion_arch_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * struct sgp_clock - time source and sleep function used by the drivers
+ *
+ * The drivers wait for their commands with sgp_clock_sleep_usec(), which
+ * sleeps with the installed clock. By default, this is
+ * sensirion_sleep_usec(). A virtual clock (sgp_virtual_clock) only advances
+ * its time when sleeping, so that long simulations run as fast as the CPU
+ * allows.
+ *
+ * @now_us:     Returns the current time of the clock in microseconds
+ * @sleep_usec: Sleeps for the given number of microseconds
+ * @user_data:  Optional data for the functions
+ */
+typedef struct sgp_clock {
+    uint64_t (*now_us)(struct sgp_clock* clock);
+    void (*sleep_usec)(struct sgp_clock* clock, uint32_t useconds);
+    void* user_data;
+} sgp_clock;
+
+/**
+ * struct sgp_virtual_clock - clock whose time only advances when sleeping
+ *
+ * @clock:   The clock to install with sgp_clock_set()
+ * @time_us: The current time in microseconds
+ */
+typedef struct {
+    sgp_clock clock;
+    uint64_t time_us;
+} sgp_virtual_clock;
+
+/**
+ * sgp_clock_set() - install the clock used by the drivers
+ *
+ * @clock:  The clock, NULL for the default clock
+ */
+void sgp_clock_set(sgp_clock* clock);
+
+/**
+ * sgp_clock_get() - get the installed clock
+ *
+ * Return:  The installed clock, the default clock if none was installed
+ */
+sgp_clock* sgp_clock_get(void);
+
+/**
+ * sgp_clock_is_set() - check if a clock was installed
+ *
+ * Return:  true if a clock was installed with sgp_clock_set(), false if the
+ *          default clock is used
+ */
+bool sgp_clock_is_set(void);
+
+/**
+ * sgp_clock_now_us() - current time of the installed clock
+ *
+ * The default clock has no time source of its own and returns the total time
+ * slept with sgp_clock_sleep_usec(). Install a clock reading a hardware timer
+ * if the time between the sleeps matters.
+ *
+ * Return:  The current time in microseconds
+ */
+uint64_t sgp_clock_now_us(void);
+
+/**
+ * sgp_clock_sleep_usec() - sleep with the installed clock
+ *
+ * @useconds:   Time to sleep in microseconds
+ */
+void sgp_clock_sleep_usec(uint32_t useconds);
+
+/**
+ * sgp_virtual_clock_init() - initialize a virtual clock
+ *
+ * Install the clock with sgp_clock_set(&virtual_clock->clock).
+ *
+ * @virtual_clock:  The virtual clock
+ * @start_us:       Start time in microseconds
+ */
+void sgp_virtual_clock_init(sgp_virtual_clock* virtual_clock,
+                            uint64_t start_us);
+
+/**
+ * sgp_virtual_clock_advance_us() - advance the time of a virtual clock
+ *
+ * @virtual_clock:  The virtual clock
+ * @useconds:       Time to advance in microseconds
+ */
+void sgp_virtual_clock_advance_us(sgp_virtual_clock* virtual_clock,
+                                  uint64_t useconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_CLOCK_H */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "sgp_humidity_compensation.h"
+
+void sgp_humidity_compensation_init(sgp_humidity_compensation* hc) {
+    hc->threshold = SGP_AH_THRESHOLD_DEFAULT;
+    hc->interval = SGP_AH_INTERVAL_DEFAULT;
+    hc->measurements_since_update = 0;
+    hc->last_update = 0;
+    hc->valid = false;
+    hc->writes = 0;
+    hc->skipped_writes = 0;
+}
+
+void sgp_humidity_compensation_configure(sgp_humidity_compensation* hc,
+                                         uint32_t threshold,
+                                         uint16_t interval) {
+    hc->threshold = threshold;
+    hc->interval = interval;
+}
+
+void sgp_humidity_compensation_reset(sgp_humidity_compensation* hc) {
+    hc->valid = false;
+}
+
+bool sgp_humidity_compensation_needs_update(sgp_humidity_compensation* hc,
+                                            uint32_t absolute_humidity) {
+    uint32_t change;
+
+    change = absolute_humidity > hc->last_update
+                 ? absolute_humidity - hc->last_update
+                 : hc->last_update - absolute_humidity;
+    ++hc->measurements_since_update;
+    if (hc->valid && change < hc->threshold &&
+        (hc->interval == 0 || hc->measurements_since_update < hc->interval)) {
+        ++hc->skipped_writes;
+        return false;
+    }
+    return true;
+}
+
+void sgp_humidity_compensation_updated(sgp_humidity_compensation* hc,
+                                       uint32_t absolute_humidity) {
+    hc->last_update = absolute_humidity;
+    hc->measurements_since_update = 0;
+    hc->valid = true;
+    ++hc->writes;
+}
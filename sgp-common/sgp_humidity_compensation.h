@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef SGP_HUMIDITY_COMPENSATION_H
+#define SGP_HUMIDITY_COMPENSATION_H
+#include "sensirion_arch_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Default humidity compensation policy: the absolute humidity is sent to the
+ * sensor when it changed by 100 mg/m^3 (about 0.5 %RH at 25 degree Celsius)
+ * or after 60 measurements (one minute at 1Hz) at the latest.
+ */
+#define SGP_AH_THRESHOLD_DEFAULT 100
+#define SGP_AH_INTERVAL_DEFAULT 60
+
+/**
+ * struct sgp_humidity_compensation - decides when the measured humidity is
+ * sent to an SGP
+ *
+ * Sending the absolute humidity with every measurement costs an I2C transfer
+ * and the 10ms wait of the set absolute humidity command. The humidity is
+ * only sent when it changed by at least @threshold since it was last sent, or
+ * when it was last sent @interval measurements ago. Initialize it with
+ * sgp_humidity_compensation_init(); the members are managed by the functions.
+ *
+ * @threshold:                 Change of the absolute humidity in [mg/m^3]
+ *                             which is sent, 0 to send every measurement
+ * @interval:                  Maximum number of measurements between updates,
+ *                             0 to only update on changes beyond @threshold
+ * @measurements_since_update: Measurements since the humidity was last sent
+ * @last_update:               Absolute humidity which was last sent
+ * @valid:                     Whether the sensor has @last_update
+ * @writes:                    Number of absolute humidity values sent
+ * @skipped_writes:            Number of measurements which did not send it
+ */
+typedef struct {
+    uint32_t threshold;
+    uint16_t interval;
+    uint16_t measurements_since_update;
+    uint32_t last_update;
+    bool valid;
+    uint32_t writes;
+    uint32_t skipped_writes;
+} sgp_humidity_compensation;
+
+/**
+ * sgp_humidity_compensation_init() - initialize with the default policy
+ *
+ * @hc:     The humidity compensation to initialize
+ */
+void sgp_humidity_compensation_init(sgp_humidity_compensation* hc);
+
+/**
+ * sgp_humidity_compensation_configure() - set the threshold and interval
+ *
+ * @hc:         The humidity compensation
+ * @threshold:  Change of the absolute humidity in [mg/m^3] which is sent to
+ *              the sensor, 0 to send it with every measurement
+ * @interval:   Maximum number of measurements between updates, 0 to only
+ *              update on changes beyond @threshold
+ */
+void sgp_humidity_compensation_configure(sgp_humidity_compensation* hc,
+                                         uint32_t threshold, uint16_t interval);
+
+/**
+ * sgp_humidity_compensation_reset() - send the humidity with the next
+ * measurement
+ *
+ * Call it when the sensor was (re-)initialized and lost its humidity.
+ *
+ * @hc:     The humidity compensation
+ */
+void sgp_humidity_compensation_reset(sgp_humidity_compensation* hc);
+
+/**
+ * sgp_humidity_compensation_needs_update() - count a measurement and check
+ * if its humidity must be sent
+ *
+ * If it returns true, send the humidity and report it with
+ * sgp_humidity_compensation_updated(). Otherwise, the skipped write is
+ * counted.
+ *
+ * @hc:                 The humidity compensation
+ * @absolute_humidity:  Measured absolute humidity in [mg/m^3]
+ *
+ * Return:  true if the humidity must be sent to the sensor
+ */
+bool sgp_humidity_compensation_needs_update(sgp_humidity_compensation* hc,
+                                            uint32_t absolute_humidity);
+
+/**
+ * sgp_humidity_compensation_updated() - report the humidity sent to the sensor
+ *
+ * @hc:                 The humidity compensation
+ * @absolute_humidity:  Absolute humidity in [mg/m^3] which was sent
+ */
+void sgp_humidity_compensation_updated(sgp_humidity_compensation* hc,
+                                       uint32_t absolute_humidity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_HUMIDITY_COMPENSATION_H */
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_i2c_bus.h"
+
+#if defined(__AVR__)
+/* no threads and no 32-bit atomics, e.g. on the Arduino Uno */
+#ifndef SGP_I2C_BUS_LOCK_FETCH_ADD
+#define SGP_I2C_BUS_LOCK_FETCH_ADD(word) ((*(word))++)
+#endif
+#ifndef SGP_I2C_BUS_LOCK_LOAD_ACQUIRE
+#define SGP_I2C_BUS_LOCK_LOAD_ACQUIRE(word) (*(word))
+#endif
+#ifndef SGP_I2C_BUS_LOCK_STORE_RELEASE
+#define SGP_I2C_BUS_LOCK_STORE_RELEASE(word, value) (*(word) = (value))
+#endif
+#endif
+
+#ifndef SGP_I2C_BUS_LOCK_FETCH_ADD
+#define SGP_I2C_BUS_LOCK_FETCH_ADD(word) \
+    __atomic_fetch_add(word, 1, __ATOMIC_RELAXED)
+#endif
+#ifndef SGP_I2C_BUS_LOCK_LOAD_ACQUIRE
+#define SGP_I2C_BUS_LOCK_LOAD_ACQUIRE(word) \
+    __atomic_load_n(word, __ATOMIC_ACQUIRE)
+#endif
+#ifndef SGP_I2C_BUS_LOCK_STORE_RELEASE
+#define SGP_I2C_BUS_LOCK_STORE_RELEASE(word, value) \
+    __atomic_store_n(word, value, __ATOMIC_RELEASE)
+#endif
+
+/* its address identifies the calling thread as owner of a lock without @self */
+static SGP_THREAD_LOCAL uint8_t sgp_i2c_bus_thread;
+
+static void (*sgp_i2c_bus_flush)(void);
+
+int16_t sgp_i2c_bus_select(sgp_i2c_bus* bus) {
+    int16_t ret;
+
+    if (!bus)
+        return STATUS_OK;
+
+    if (bus->select)
+        return bus->select(bus);
+
+    ret = sensirion_i2c_select_bus(bus->bus_idx);
+    /* platforms with a single bus do not need to implement bus selection */
+    if (ret == NOT_IMPLEMENTED_ERROR && bus->bus_idx == 0)
+        return STATUS_OK;
+    return ret;
+}
+
+void sgp_i2c_bus_set_flush(void (*flush)(void)) {
+    sgp_i2c_bus_flush = flush;
+}
+
+void sgp_i2c_bus_lock_init(sgp_i2c_bus_lock* lock, void (*wait)(void),
+                           const void* (*self)(void)) {
+    lock->next_ticket = 0;
+    lock->now_serving = 0;
+    lock->owner = NULL;
+    lock->depth = 0;
+    lock->wait = wait;
+    lock->self = self;
+    lock->clock = NULL;
+    lock->hold_start_us = 0;
+    lock->stats.acquisitions = 0;
+    lock->stats.contentions = 0;
+    lock->stats.wait_us = 0;
+    lock->stats.max_wait_us = 0;
+    lock->stats.hold_us = 0;
+    lock->stats.max_hold_us = 0;
+}
+
+void sgp_i2c_bus_lock_set_clock(sgp_i2c_bus_lock* lock, sgp_clock* clock) {
+    lock->clock = clock;
+}
+
+static const void* sgp_i2c_bus_lock_self(const sgp_i2c_bus_lock* lock) {
+    if (lock->self)
+        return lock->self();
+    return &sgp_i2c_bus_thread;
+}
+
+/**
+ * sgp_i2c_bus_lock_take() - take the lock without statistics
+ *
+ * Return:  true if the lock was held by another thread
+ */
+static bool sgp_i2c_bus_lock_take(sgp_i2c_bus_lock* lock) {
+    uint32_t ticket = SGP_I2C_BUS_LOCK_FETCH_ADD(&lock->next_ticket);
+    bool contended = false;
+
+    while (SGP_I2C_BUS_LOCK_LOAD_ACQUIRE(&lock->now_serving) != ticket) {
+        contended = true;
+        if (lock->wait)
+            lock->wait();
+    }
+    SGP_I2C_BUS_LOCK_STORE_RELEASE(&lock->owner,
+                                   sgp_i2c_bus_lock_self(lock));
+    return contended;
+}
+
+static void sgp_i2c_bus_lock_give(sgp_i2c_bus_lock* lock) {
+    SGP_I2C_BUS_LOCK_STORE_RELEASE(&lock->owner, (const void*)NULL);
+    SGP_I2C_BUS_LOCK_STORE_RELEASE(&lock->now_serving, lock->now_serving + 1);
+}
+
+static bool sgp_i2c_bus_lock_owned(sgp_i2c_bus_lock* lock) {
+    /* only the owner itself can have stored its identity */
+    return SGP_I2C_BUS_LOCK_LOAD_ACQUIRE(&lock->owner) ==
+           sgp_i2c_bus_lock_self(lock);
+}
+
+void sgp_i2c_bus_lock_acquire(sgp_i2c_bus_lock* lock) {
+    sgp_clock* clock;
+    uint64_t start_us = 0;
+    uint64_t now_us;
+    uint64_t wait_us;
+
+    if (!lock)
+        return;
+
+    if (sgp_i2c_bus_lock_owned(lock)) {
+        ++lock->depth;
+        return;
+    }
+
+    /* set before the threads are started, so it can be read without lock */
+    clock = lock->clock;
+    if (clock)
+        start_us = clock->now_us(clock);
+    if (sgp_i2c_bus_lock_take(lock)) {
+        ++lock->stats.contentions;
+        if (clock) {
+            now_us = clock->now_us(clock);
+            wait_us = now_us - start_us;
+            lock->stats.wait_us += wait_us;
+            if (wait_us > lock->stats.max_wait_us)
+                lock->stats.max_wait_us = (uint32_t)wait_us;
+            start_us = now_us;
+        }
+    }
+    ++lock->stats.acquisitions;
+    lock->hold_start_us = start_us;
+    lock->depth = 1;
+}
+
+int16_t sgp_i2c_bus_lock_release(sgp_i2c_bus_lock* lock) {
+    uint64_t hold_us;
+
+    if (!lock)
+        return STATUS_OK;
+
+    /* a free lock or one of another thread has no depth to decrement */
+    if (!sgp_i2c_bus_lock_owned(lock))
+        return STATUS_FAIL;
+
+    if (--lock->depth > 0)
+        return STATUS_OK;
+
+    /* the queued transfers are for the channel selected by this thread */
+    if (sgp_i2c_bus_flush)
+        sgp_i2c_bus_flush();
+    if (lock->clock) {
+        hold_us = lock->clock->now_us(lock->clock) - lock->hold_start_us;
+        lock->stats.hold_us += hold_us;
+        if (hold_us > lock->stats.max_hold_us)
+            lock->stats.max_hold_us = (uint32_t)hold_us;
+    }
+    sgp_i2c_bus_lock_give(lock);
+    return STATUS_OK;
+}
+
+void sgp_i2c_bus_lock_get_stats(sgp_i2c_bus_lock* lock,
+                                sgp_i2c_bus_lock_stats* stats, bool reset) {
+    bool owned = sgp_i2c_bus_lock_owned(lock);
+
+    if (!owned)
+        sgp_i2c_bus_lock_take(lock);
+    *stats = lock->stats;
+    if (reset) {
+        lock->stats.acquisitions = 0;
+        lock->stats.contentions = 0;
+        lock->stats.wait_us = 0;
+        lock->stats.max_wait_us = 0;
+        lock->stats.hold_us = 0;
+        lock->stats.max_hold_us = 0;
+    }
+    if (!owned)
+        sgp_i2c_bus_lock_give(lock);
+}
+
+int16_t sgp_i2c_bus_acquire(sgp_i2c_bus* bus) {
+    int16_t ret;
+
+    if (!bus)
+        return STATUS_OK;
+
+    sgp_i2c_bus_lock_acquire(bus->lock);
+    ret = sgp_i2c_bus_select(bus);
+    if (ret != STATUS_OK)
+        sgp_i2c_bus_lock_release(bus->lock);
+    return ret;
+}
+
+int16_t sgp_i2c_bus_release(sgp_i2c_bus* bus) {
+    if (!bus)
+        return STATUS_OK;
+
+    return sgp_i2c_bus_lock_release(bus->lock);
+}
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_I2C_BUS_H
+#define SGP_I2C_BUS_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_clock.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Storage class of per-thread state: the bus selection of the hosted I2C
+ * implementations, so that one thread per bus can run the drivers in
+ * parallel, and the default owner of a bus lock. Single-threaded builds, such
+ * as the AVR, define SGP_NO_THREADS to do without. On other toolchains without
+ * thread-local storage, define SGP_THREAD_LOCAL to their storage class.
+ */
+#ifndef SGP_THREAD_LOCAL
+#if defined(SGP_NO_THREADS) || defined(__AVR__)
+#define SGP_THREAD_LOCAL
+#elif defined(__cplusplus) && __cplusplus >= 201103L
+#define SGP_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SGP_THREAD_LOCAL _Thread_local
+#elif defined(__GNUC__)
+#define SGP_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define SGP_THREAD_LOCAL __declspec(thread)
+#else
+#error "No thread-local storage: define SGP_THREAD_LOCAL or SGP_NO_THREADS"
+#endif
+#endif
+
+/**
+ * struct sgp_i2c_bus_lock_stats - contention statistics of a bus lock
+ *
+ * The times are only measured with the clock set by
+ * sgp_i2c_bus_lock_set_clock(), otherwise they stay 0.
+ *
+ * @acquisitions: Number of times the lock was taken, without nested ones
+ * @contentions:  Number of acquisitions which waited for another thread
+ * @wait_us:      Total time spent waiting for the lock
+ * @max_wait_us:  Longest wait for the lock
+ * @hold_us:      Total time the lock was held
+ * @max_hold_us:  Longest time the lock was held
+ */
+typedef struct {
+    uint32_t acquisitions;
+    uint32_t contentions;
+    uint64_t wait_us;
+    uint32_t max_wait_us;
+    uint64_t hold_us;
+    uint32_t max_hold_us;
+} sgp_i2c_bus_lock_stats;
+
+/**
+ * struct sgp_i2c_bus_lock - ownership of a physical I2C bus shared by threads
+ *
+ * A FIFO ticket lock, so threads get the bus in the order they asked for it.
+ * The drivers take the lock of the bus of a device for the selection of the
+ * bus (including the channel of a multiplexer) together with each command or
+ * read, and release it while the sensor is measuring. The thread holding the
+ * lock may take it again, e.g. to keep the bus for a command and the read of
+ * its result, or to call a driver without device handle, such as the SHTC1
+ * or SVM30 driver, between sgp_i2c_bus_acquire() and sgp_i2c_bus_release().
+ *
+ * The lock word is updated with the __atomic builtins of GCC and Clang, or
+ * with plain accesses on the AVR. Other compilers need
+ * SGP_I2C_BUS_LOCK_FETCH_ADD(), SGP_I2C_BUS_LOCK_LOAD_ACQUIRE() and
+ * SGP_I2C_BUS_LOCK_STORE_RELEASE() defined in sgp_i2c_bus.c. The owner is
+ * recognized by the address of SGP_THREAD_LOCAL storage, or by @self if the
+ * thread-local storage is not switched with the threads, e.g. on an RTOS.
+ *
+ * @next_ticket:   Ticket of the next thread asking for the lock
+ * @now_serving:   Ticket of the thread holding the lock
+ * @owner:         Thread holding the lock, NULL if free
+ * @depth:         Number of nested acquisitions by @owner
+ * @wait:          Called while another thread holds the lock, NULL to spin
+ * @self:          Returns the identity of the calling thread, NULL to use the
+ *                 address of SGP_THREAD_LOCAL storage
+ * @clock:         Clock measuring the wait and hold times, NULL to not
+ *                 measure them
+ * @hold_start_us: Time of the outermost acquisition by @owner
+ * @stats:         See struct sgp_i2c_bus_lock_stats
+ */
+typedef struct sgp_i2c_bus_lock {
+    uint32_t next_ticket;
+    uint32_t now_serving;
+    const void* owner;
+    uint16_t depth;
+    void (*wait)(void);
+    const void* (*self)(void);
+    sgp_clock* clock;
+    uint64_t hold_start_us;
+    sgp_i2c_bus_lock_stats stats;
+} sgp_i2c_bus_lock;
+
+/**
+ * struct sgp_i2c_bus - I2C bus a sensor is connected to
+ *
+ * The device handles of the drivers refer to a bus, which is selected before
+ * each I2C transfer to the device. Sensors with the same I2C address need to
+ * be connected to different buses, or behind different channels of an I2C
+ * multiplexer.
+ *
+ * @bus_idx:    Index of the bus passed to sensirion_i2c_select_bus()
+ * @select:     Optional function to select the bus instead of
+ *              sensirion_i2c_select_bus(), e.g. to switch the channel of an
+ *              I2C multiplexer. NULL to use sensirion_i2c_select_bus().
+ * @user_data:  Optional data for @select
+ * @lock:       Optional lock of the physical bus if several threads use it,
+ *              NULL if the bus is only used by one thread
+ */
+typedef struct sgp_i2c_bus {
+    uint8_t bus_idx;
+    int16_t (*select)(struct sgp_i2c_bus* bus);
+    void* user_data;
+    sgp_i2c_bus_lock* lock;
+} sgp_i2c_bus;
+
+/**
+ * sgp_i2c_bus_select() - select the bus for the following I2C transfers
+ *
+ * Platforms with a single bus do not need to implement
+ * sensirion_i2c_select_bus() to use bus index 0.
+ *
+ * @bus:    The bus to select, NULL to keep the currently selected bus
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp_i2c_bus_select(sgp_i2c_bus* bus);
+
+/**
+ * sgp_i2c_bus_set_flush() - set the function sending queued I2C transfers
+ *
+ * For I2C implementations which queue writes instead of sending them
+ * immediately, such as the Linux implementation with batching. The function
+ * is called by the thread releasing a bus lock, before another thread can
+ * take the bus, so that the queued transfers are sent to the channel selected
+ * by the releasing thread. Errors of these transfers are for the
+ * implementation to report.
+ *
+ * @flush:  Function sending the queued transfers of the calling thread, NULL
+ *          if transfers are sent immediately (the default)
+ */
+void sgp_i2c_bus_set_flush(void (*flush)(void));
+
+/**
+ * sgp_i2c_bus_lock_init() - initialize a free bus lock
+ *
+ * Call before the threads sharing the bus are started, and set the lock of
+ * each sgp_i2c_bus of the physical bus, before sgp_i2c_mux_init_bus() for the
+ * channels of a multiplexer on it.
+ *
+ * @lock:   The lock
+ * @wait:   Function to give the CPU to other threads while the lock is taken,
+ *          e.g. sched_yield() or an RTOS delay. NULL to spin, which is only
+ *          suitable if all threads using the bus run on different CPUs.
+ * @self:   Function returning a distinct, non-NULL identity of each calling
+ *          thread, e.g. the task handle of an RTOS whose tasks share the
+ *          thread-local storage. NULL to use the address of SGP_THREAD_LOCAL
+ *          storage, which needs thread-local storage switched with the
+ *          threads, or a single thread.
+ */
+void sgp_i2c_bus_lock_init(sgp_i2c_bus_lock* lock, void (*wait)(void),
+                           const void* (*self)(void));
+
+/**
+ * sgp_i2c_bus_lock_set_clock() - measure the wait and hold times of a lock
+ *
+ * The clock is read by all threads taking the lock and must be monotonic and
+ * thread-safe, e.g. sgp_runtime_get_system_clock(). The default clock is not,
+ * it only counts the time slept. Call before the threads sharing the bus are
+ * started.
+ *
+ * @lock:   The lock
+ * @clock:  The clock, NULL to not measure the times (the default)
+ */
+void sgp_i2c_bus_lock_set_clock(sgp_i2c_bus_lock* lock, sgp_clock* clock);
+
+/**
+ * sgp_i2c_bus_lock_acquire() - take a bus lock, waiting for other threads
+ *
+ * @lock:   The lock, NULL to do nothing
+ */
+void sgp_i2c_bus_lock_acquire(sgp_i2c_bus_lock* lock);
+
+/**
+ * sgp_i2c_bus_lock_release() - give back a bus lock
+ *
+ * The queued transfers are sent with the function set by
+ * sgp_i2c_bus_set_flush() before the outermost acquisition is given back.
+ *
+ * @lock:   The lock taken by the calling thread, NULL to do nothing
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the calling thread does not
+ *          hold the lock
+ */
+int16_t sgp_i2c_bus_lock_release(sgp_i2c_bus_lock* lock);
+
+/**
+ * sgp_i2c_bus_lock_get_stats() - read the contention statistics of a lock
+ *
+ * @lock:   The lock
+ * @stats:  Output for the statistics
+ * @reset:  Reset the statistics after reading them
+ */
+void sgp_i2c_bus_lock_get_stats(sgp_i2c_bus_lock* lock,
+                                sgp_i2c_bus_lock_stats* stats, bool reset);
+
+/**
+ * sgp_i2c_bus_acquire() - take the lock of a bus and select it
+ *
+ * The transfers to the bus until sgp_i2c_bus_release() are not interleaved
+ * with those of other threads. Do not wait for a measurement while holding the
+ * bus, the read of the result acquires it again.
+ *
+ * @bus:    The bus, NULL to keep the currently selected bus without lock
+ *
+ * Return:  STATUS_OK on success, an error code otherwise. The lock is not
+ *          held if the selection failed.
+ */
+int16_t sgp_i2c_bus_acquire(sgp_i2c_bus* bus);
+
+/**
+ * sgp_i2c_bus_release() - give back a bus taken with sgp_i2c_bus_acquire()
+ *
+ * @bus:    The bus, NULL to do nothing
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if the calling thread does not
+ *          hold the bus
+ */
+int16_t sgp_i2c_bus_release(sgp_i2c_bus* bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_I2C_BUS_H */
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_i2c_mux.h"
+
+static int16_t sgp_i2c_mux_write_channels(sgp_i2c_mux* mux,
+                                          uint8_t channel_mask) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_select(mux->parent);
+    if (ret != STATUS_OK)
+        return ret;
+
+    ++mux->channel_switches;
+    return sensirion_i2c_write(mux->i2c_address, &channel_mask, 1);
+}
+
+static int16_t sgp_i2c_mux_select(sgp_i2c_bus* bus) {
+    sgp_i2c_mux* mux = (sgp_i2c_mux*)bus->user_data;
+    int16_t ret;
+
+    if (bus->bus_idx >= SGP_I2C_MUX_NUM_CHANNELS)
+        return STATUS_FAIL;
+
+    if (mux->active_channel == bus->bus_idx)
+        return sgp_i2c_bus_select(mux->parent);
+
+    ret = sgp_i2c_mux_write_channels(mux, (uint8_t)(1 << bus->bus_idx));
+    if (ret != STATUS_OK) {
+        /* the state of the control register is unknown after an error */
+        mux->active_channel = SGP_I2C_MUX_NO_CHANNEL;
+        return ret;
+    }
+    mux->active_channel = bus->bus_idx;
+    return STATUS_OK;
+}
+
+void sgp_i2c_mux_init(sgp_i2c_mux* mux, sgp_i2c_bus* parent,
+                      uint8_t i2c_address) {
+    mux->parent = parent;
+    mux->i2c_address = i2c_address;
+    mux->active_channel = SGP_I2C_MUX_NO_CHANNEL;
+    mux->channel_switches = 0;
+}
+
+int16_t sgp_i2c_mux_init_bus(sgp_i2c_mux* mux, sgp_i2c_bus* bus,
+                             uint8_t channel) {
+    if (channel >= SGP_I2C_MUX_NUM_CHANNELS)
+        return STATUS_FAIL;
+
+    bus->bus_idx = channel;
+    bus->select = sgp_i2c_mux_select;
+    bus->user_data = mux;
+    /* the channels share the lock of the physical bus */
+    bus->lock = mux->parent ? mux->parent->lock : NULL;
+    return STATUS_OK;
+}
+
+void sgp_i2c_mux_invalidate(sgp_i2c_mux* mux) {
+    mux->active_channel = SGP_I2C_MUX_NO_CHANNEL;
+}
+
+int16_t sgp_i2c_mux_disable(sgp_i2c_mux* mux) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_acquire(mux->parent);
+    if (ret != STATUS_OK)
+        return ret;
+
+    /* the channel is unknown until the write succeeded, and none afterwards */
+    mux->active_channel = SGP_I2C_MUX_NO_CHANNEL;
+    ret = sgp_i2c_mux_write_channels(mux, 0);
+    sgp_i2c_bus_release(mux->parent);
+    return ret;
+}
+
+static sgp_i2c_mux* sgp_i2c_mux_of(sgp_i2c_bus* bus) {
+    if (!bus || bus->select != sgp_i2c_mux_select)
+        return NULL;
+    return (sgp_i2c_mux*)bus->user_data;
+}
+
+/**
+ * sgp_i2c_mux_schedule_key() - position of a bus in a polling round
+ *
+ * Buses without multiplexer have key 0. The channels of a multiplexer follow
+ * in blocks of SGP_I2C_MUX_NUM_CHANNELS keys, ordered by the first appearance
+ * of the multiplexer in @buses, and rotated to start with its selected
+ * channel.
+ */
+static uint32_t sgp_i2c_mux_schedule_key(sgp_i2c_bus* const* buses,
+                                         uint16_t idx) {
+    sgp_i2c_mux* mux = sgp_i2c_mux_of(buses[idx]);
+    uint16_t first;
+    uint8_t channel;
+
+    if (!mux)
+        return 0;
+
+    first = 0;
+    while (sgp_i2c_mux_of(buses[first]) != mux)
+        ++first;
+
+    channel = buses[idx]->bus_idx;
+    if (mux->active_channel < SGP_I2C_MUX_NUM_CHANNELS)
+        channel = (channel + SGP_I2C_MUX_NUM_CHANNELS - mux->active_channel) %
+                  SGP_I2C_MUX_NUM_CHANNELS;
+
+    return 1 + (uint32_t)first * SGP_I2C_MUX_NUM_CHANNELS + channel;
+}
+
+uint16_t sgp_i2c_mux_schedule(sgp_i2c_bus* const* buses, uint16_t num_buses,
+                              uint32_t* keys, uint16_t* order) {
+    sgp_i2c_mux* mux = NULL;
+    uint8_t channel = SGP_I2C_MUX_NO_CHANNEL;
+    uint16_t switches = 0;
+    uint16_t i;
+    uint16_t j;
+
+    for (i = 0; i < num_buses; ++i)
+        keys[i] = sgp_i2c_mux_schedule_key(buses, i);
+
+    /* stable insertion sort, polling rounds are short */
+    for (i = 0; i < num_buses; ++i) {
+        uint32_t key = keys[i];
+
+        j = i;
+        while (j > 0 && keys[order[j - 1]] > key) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = i;
+    }
+
+    for (i = 0; i < num_buses; ++i) {
+        sgp_i2c_bus* bus = buses[order[i]];
+
+        if (sgp_i2c_mux_of(bus) != mux) {
+            mux = sgp_i2c_mux_of(bus);
+            if (mux)
+                channel = mux->active_channel;
+        }
+        if (mux && bus->bus_idx != channel) {
+            channel = bus->bus_idx;
+            ++switches;
+        }
+    }
+    return switches;
+}
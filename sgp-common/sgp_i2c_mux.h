@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_I2C_MUX_H
+#define SGP_I2C_MUX_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_i2c_bus.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SGP_I2C_MUX_NUM_CHANNELS 8
+#define SGP_I2C_MUX_NO_CHANNEL 0xFF
+
+/**
+ * struct sgp_i2c_mux - I2C multiplexer with one control register, such as the
+ * TCA9548A
+ *
+ * Sensors with a fixed I2C address, such as the SGP30 and SGPC3, are connected
+ * to the channels of a multiplexer to use several of them on one bus. Each
+ * channel is represented by a sgp_i2c_bus, initialized with
+ * sgp_i2c_mux_init_bus(), which is passed to the device handles.
+ *
+ * The channel last selected is cached, so the control register is only
+ * written when a transfer goes to a device on a different channel. Several
+ * multiplexers on the same parent bus must not enable channels with devices at
+ * the same address; use sgp_i2c_mux_disable() before switching to another
+ * multiplexer in that case.
+ *
+ * @parent:           Bus the multiplexer is connected to, NULL for the
+ *                    currently selected bus. May be the channel of another
+ *                    multiplexer.
+ * @i2c_address:      I2C address of the multiplexer
+ * @active_channel:   Channel last selected, SGP_I2C_MUX_NO_CHANNEL if unknown
+ * @channel_switches: Number of writes to the control register
+ */
+typedef struct {
+    sgp_i2c_bus* parent;
+    uint8_t i2c_address;
+    uint8_t active_channel;
+    uint32_t channel_switches;
+} sgp_i2c_mux;
+
+/**
+ * sgp_i2c_mux_init() - initialize a multiplexer
+ *
+ * The selected channel is unknown after initialization, so the control
+ * register is written for the first transfer.
+ *
+ * @mux:         The multiplexer to initialize
+ * @parent:      Bus the multiplexer is connected to, NULL for the currently
+ *               selected bus
+ * @i2c_address: I2C address of the multiplexer, 0x70 to 0x77 for the TCA9548A
+ */
+void sgp_i2c_mux_init(sgp_i2c_mux* mux, sgp_i2c_bus* parent,
+                      uint8_t i2c_address);
+
+/**
+ * sgp_i2c_mux_init_bus() - initialize the bus of a multiplexer channel
+ *
+ * Selecting the bus switches the multiplexer to the channel unless it is
+ * already selected. The bus gets the lock of the parent bus, so the channel
+ * switch and the transfer to the device are not interleaved with the transfers
+ * of other threads to the same multiplexer.
+ *
+ * @mux:     The multiplexer
+ * @bus:     The bus to initialize
+ * @channel: Channel of the multiplexer, 0 to SGP_I2C_MUX_NUM_CHANNELS - 1
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if @channel is out of range
+ */
+int16_t sgp_i2c_mux_init_bus(sgp_i2c_mux* mux, sgp_i2c_bus* bus,
+                             uint8_t channel);
+
+/**
+ * sgp_i2c_mux_invalidate() - forget the cached channel
+ *
+ * Must be called when the control register may have changed without the
+ * driver, e.g. after a reset of the multiplexer or a general call reset.
+ *
+ * @mux: The multiplexer
+ */
+void sgp_i2c_mux_invalidate(sgp_i2c_mux* mux);
+
+/**
+ * sgp_i2c_mux_disable() - disable all channels of a multiplexer
+ *
+ * @mux: The multiplexer
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp_i2c_mux_disable(sgp_i2c_mux* mux);
+
+/**
+ * sgp_i2c_mux_schedule() - order a polling round to minimize channel switches
+ *
+ * Devices which are not behind a multiplexer are polled first. The devices of
+ * each multiplexer follow grouped by channel, starting with the selected
+ * channel, so each channel is selected at most once per round. The order of
+ * devices on the same channel is kept.
+ *
+ * The order only depends on the buses and the selected channels, so it can be
+ * computed once and reused as long as each round ends on the same channels.
+ *
+ * @buses:     Buses of the devices to poll, e.g. the bus of each device handle
+ * @num_buses: Number of buses
+ * @keys:      Scratch array of length @num_buses for the sort keys
+ * @order:     Output array of length @num_buses for the indices into @buses in
+ *             the order in which to poll the devices
+ *
+ * Return:  Number of channel switches needed for a round in this order
+ */
+uint16_t sgp_i2c_mux_schedule(sgp_i2c_bus* const* buses, uint16_t num_buses,
+                              uint32_t* keys, uint16_t* order);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_I2C_MUX_H */
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_periodic.h"
+#include "sgp_clock.h"
+
+int16_t sgp_periodic_init(sgp_periodic* periodic, uint32_t period_us) {
+    if (period_us == 0)
+        return STATUS_FAIL;
+
+    periodic->period_us = period_us;
+    periodic->deadline_us = sgp_clock_now_us();
+    sgp_periodic_get_stats(periodic, NULL, true);
+    return STATUS_OK;
+}
+
+uint32_t sgp_periodic_wait(sgp_periodic* periodic) {
+    sgp_periodic_stats* stats = &periodic->stats;
+    uint64_t now_us = sgp_clock_now_us();
+    uint64_t jitter_us;
+    uint32_t missed = 0;
+
+    periodic->deadline_us += periodic->period_us;
+    if (now_us < periodic->deadline_us) {
+        sgp_clock_sleep_usec((uint32_t)(periodic->deadline_us - now_us));
+        now_us = sgp_clock_now_us();
+    } else if (now_us > periodic->deadline_us) {
+        ++stats->overruns;
+        missed =
+            (uint32_t)((now_us - periodic->deadline_us) / periodic->period_us);
+        periodic->deadline_us += (uint64_t)missed * periodic->period_us;
+        stats->missed_ticks += missed;
+    }
+
+    /* a clock may also wake up early */
+    jitter_us = now_us > periodic->deadline_us
+                    ? now_us - periodic->deadline_us
+                    : periodic->deadline_us - now_us;
+    if (jitter_us > UINT32_MAX)
+        jitter_us = UINT32_MAX;
+    ++stats->ticks;
+    stats->last_jitter_us = (uint32_t)jitter_us;
+    if (stats->last_jitter_us > stats->max_jitter_us)
+        stats->max_jitter_us = stats->last_jitter_us;
+    stats->total_jitter_us += jitter_us;
+    return missed;
+}
+
+void sgp_periodic_get_stats(sgp_periodic* periodic, sgp_periodic_stats* stats,
+                            bool reset) {
+    if (stats)
+        *stats = periodic->stats;
+    if (reset) {
+        periodic->stats.ticks = 0;
+        periodic->stats.overruns = 0;
+        periodic->stats.missed_ticks = 0;
+        periodic->stats.last_jitter_us = 0;
+        periodic->stats.max_jitter_us = 0;
+        periodic->stats.total_jitter_us = 0;
+    }
+}
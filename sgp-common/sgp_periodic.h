@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_PERIODIC_H
+#define SGP_PERIODIC_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * struct sgp_periodic_stats - timing of the ticks of a periodic scheduler
+ *
+ * The jitter of a tick is the time between its deadline and its start.
+ *
+ * @ticks:           Ticks started by sgp_periodic_wait()
+ * @overruns:        Ticks which started late because the previous one took
+ *                   longer than the period
+ * @missed_ticks:    Deadlines skipped after overruns of more than one period
+ * @last_jitter_us:  Jitter of the last tick in microseconds
+ * @max_jitter_us:   Maximum jitter in microseconds
+ * @total_jitter_us: Sum of the jitter of all ticks, divide by @ticks for the
+ *                   mean
+ */
+typedef struct {
+    uint32_t ticks;
+    uint32_t overruns;
+    uint32_t missed_ticks;
+    uint32_t last_jitter_us;
+    uint32_t max_jitter_us;
+    uint64_t total_jitter_us;
+} sgp_periodic_stats;
+
+/**
+ * struct sgp_periodic - periodic scheduler with absolute deadlines
+ *
+ * The deadline of tick n is the start time plus n periods, independent of
+ * how long the work in each tick takes, so the measurement time and late
+ * wake-ups do not accumulate to a drift of the measurement interval.
+ *
+ * @period_us:   Period in microseconds
+ * @deadline_us: Deadline of the current tick on the sgp_clock
+ * @stats:       Timing statistics, see sgp_periodic_get_stats()
+ */
+typedef struct {
+    uint32_t period_us;
+    uint64_t deadline_us;
+    sgp_periodic_stats stats;
+} sgp_periodic;
+
+/**
+ * sgp_periodic_init() - initialize a periodic scheduler
+ *
+ * The first tick starts now, with the time of the installed sgp_clock. The
+ * default clock only advances while sleeping, so the time spent on I2C
+ * transfers is not compensated. Install a clock reading a hardware timer
+ * with sgp_clock_set() for exact periods.
+ *
+ * @periodic:   The scheduler
+ * @period_us:  Period in microseconds, e.g. 1000000 for the SGP30 and SGP40
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if @period_us is 0
+ */
+int16_t sgp_periodic_init(sgp_periodic* periodic, uint32_t period_us);
+
+/**
+ * sgp_periodic_wait() - wait for the start of the next tick
+ *
+ * Call at the end of each tick. Sleeps until the next deadline with
+ * sgp_clock_sleep_usec(). If the tick took longer than the period, the next
+ * tick starts immediately, and deadlines which already passed completely are
+ * skipped instead of catching up with a burst of ticks.
+ *
+ * @periodic:   The scheduler
+ *
+ * Return:      The number of skipped deadlines, 0 if the tick was on time
+ */
+uint32_t sgp_periodic_wait(sgp_periodic* periodic);
+
+/**
+ * sgp_periodic_get_stats() - read the timing statistics of a scheduler
+ *
+ * @periodic:   The scheduler
+ * @stats:      Output for the statistics since the last reset
+ * @reset:      true to reset the statistics, e.g. to get them per hour
+ */
+void sgp_periodic_get_stats(sgp_periodic* periodic, sgp_periodic_stats* stats,
+                            bool reset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_PERIODIC_H */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_record_ring.h"
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#include <string.h>
+
+#ifndef SGP_RECORD_RING_LOAD_ACQUIRE
+#define SGP_RECORD_RING_LOAD_ACQUIRE(index) \
+    __atomic_load_n(index, __ATOMIC_ACQUIRE)
+#endif
+#ifndef SGP_RECORD_RING_STORE_RELEASE
+#define SGP_RECORD_RING_STORE_RELEASE(index, value) \
+    __atomic_store_n(index, value, __ATOMIC_RELEASE)
+#endif
+#ifndef SGP_RECORD_RING_LOAD_RELAXED
+#define SGP_RECORD_RING_LOAD_RELAXED(counter) \
+    __atomic_load_n(counter, __ATOMIC_RELAXED)
+#endif
+
+void sgp_record_init(sgp_record* record, uint16_t device_id,
+                     uint64_t timestamp_us) {
+    memset(record, 0, sizeof(*record));
+    record->timestamp_us = timestamp_us;
+    record->device_id = device_id;
+    record->error = STATUS_OK;
+}
+
+int16_t sgp_record_ring_init(sgp_record_ring* ring, sgp_record* records,
+                             uint32_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        capacity > 0x80000000u)
+        return STATUS_FAIL;
+
+    ring->records = records;
+    ring->mask = capacity - 1;
+    ring->head = 0;
+    ring->tail_cache = 0;
+    ring->pushed = 0;
+    ring->overflows = 0;
+    ring->tail = 0;
+    ring->head_cache = 0;
+    ring->popped = 0;
+    return STATUS_OK;
+}
+
+bool sgp_record_ring_push(sgp_record_ring* ring, const sgp_record* record) {
+    uint32_t head = ring->head;
+
+    if (head - ring->tail_cache > ring->mask) {
+        ring->tail_cache = SGP_RECORD_RING_LOAD_ACQUIRE(&ring->tail);
+        if (head - ring->tail_cache > ring->mask) {
+            SGP_RECORD_RING_STORE_RELEASE(&ring->overflows,
+                                          ring->overflows + 1);
+            return false;
+        }
+    }
+
+    ring->records[head & ring->mask] = *record;
+    /* publishes the record to the consumer */
+    SGP_RECORD_RING_STORE_RELEASE(&ring->head, head + 1);
+    SGP_RECORD_RING_STORE_RELEASE(&ring->pushed, ring->pushed + 1);
+    return true;
+}
+
+uint32_t sgp_record_ring_pop_batch(sgp_record_ring* ring, sgp_record* records,
+                                   uint32_t max) {
+    uint32_t tail = ring->tail;
+    uint32_t available = ring->head_cache - tail;
+    uint32_t count;
+    uint32_t first;
+
+    if (available < max) {
+        ring->head_cache = SGP_RECORD_RING_LOAD_ACQUIRE(&ring->head);
+        available = ring->head_cache - tail;
+    }
+    count = available < max ? available : max;
+    if (count == 0)
+        return 0;
+
+    /* copy in up to two parts, before and after the wrap-around */
+    first = ring->mask + 1 - (tail & ring->mask);
+    if (first > count)
+        first = count;
+    memcpy(records, &ring->records[tail & ring->mask],
+           first * sizeof(*records));
+    memcpy(&records[first], ring->records, (count - first) * sizeof(*records));
+
+    /* releases the slots to the producer */
+    SGP_RECORD_RING_STORE_RELEASE(&ring->tail, tail + count);
+    SGP_RECORD_RING_STORE_RELEASE(&ring->popped, ring->popped + count);
+    return count;
+}
+
+void sgp_record_ring_get_stats(sgp_record_ring* ring,
+                               sgp_record_ring_stats* stats) {
+    stats->pushed = SGP_RECORD_RING_LOAD_RELAXED(&ring->pushed);
+    stats->popped = SGP_RECORD_RING_LOAD_RELAXED(&ring->popped);
+    stats->overflows = SGP_RECORD_RING_LOAD_RELAXED(&ring->overflows);
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_RECORD_RING_H
+#define SGP_RECORD_RING_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Single-producer/single-consumer ring of measurement records, e.g. between
+ * the thread or interrupt polling a bus and the thread processing the results.
+ * Neither side takes a lock or waits for the other: a full ring drops the new
+ * record and counts it, so the acquisition never blocks on a slow consumer.
+ * The records are stored in an array provided by the caller, so no memory is
+ * allocated.
+ *
+ * The indices are synchronized with the __atomic builtins of GCC and Clang.
+ * Other compilers need SGP_RECORD_RING_LOAD_ACQUIRE() and
+ * SGP_RECORD_RING_STORE_RELEASE() defined with their atomics or barriers.
+ */
+
+/*
+ * The indices written by the producer and the consumer are separated by
+ * padding of this size, so the two sides do not write to the same cache line.
+ * Define it as 1 on microcontrollers without a data cache to save the RAM.
+ */
+#ifndef SGP_RECORD_RING_CACHE_LINE_SIZE
+#define SGP_RECORD_RING_CACHE_LINE_SIZE 64
+#endif
+
+/* Values set in a record, see sgp_record.fields */
+#define SGP_RECORD_SRAW (1 << 0)
+#define SGP_RECORD_TVOC (1 << 1)
+#define SGP_RECORD_CO2_EQ (1 << 2)
+#define SGP_RECORD_ETHANOL (1 << 3)
+#define SGP_RECORD_H2 (1 << 4)
+#define SGP_RECORD_RHT (1 << 5)
+
+/**
+ * struct sgp_record - measurement of one device, 32 bytes
+ *
+ * @timestamp_us:   Time of the measurement, e.g. sgp_clock_now_us()
+ * @device_id:      Id of the device, assigned by the application
+ * @error:          Return value of the measurement, STATUS_OK on success
+ * @fields:         Valid values, SGP_RECORD_SRAW | SGP_RECORD_RHT etc.
+ * @sraw:           Raw VOC signal of an SGP40
+ * @tvoc_ppb:       TVOC of an SGP30, SGPC3 or SVM30 in ppb
+ * @co2_eq_ppm:     CO2eq of an SGP30 or SVM30 in ppm
+ * @ethanol_signal: Ethanol raw signal of an SGP30, SGPC3 or SVM30
+ * @h2_signal:      H2 raw signal of an SGP30 or SVM30
+ * @temperature:    Temperature in milli degree celsius
+ * @humidity:       Relative humidity in milli percent
+ */
+typedef struct {
+    uint64_t timestamp_us;
+    uint16_t device_id;
+    int16_t error;
+    uint16_t fields;
+    uint16_t sraw;
+    uint16_t tvoc_ppb;
+    uint16_t co2_eq_ppm;
+    uint16_t ethanol_signal;
+    uint16_t h2_signal;
+    int32_t temperature;
+    int32_t humidity;
+} sgp_record;
+
+/**
+ * struct sgp_record_ring_stats - counters of a ring
+ *
+ * @pushed:    Records stored by the producer
+ * @popped:    Records taken by the consumer
+ * @overflows: Records dropped because the ring was full
+ */
+typedef struct {
+    uint32_t pushed;
+    uint32_t popped;
+    uint32_t overflows;
+} sgp_record_ring_stats;
+
+/**
+ * struct sgp_record_ring - lock-free single-producer/single-consumer ring
+ *
+ * The indices run freely and wrap around at 2^32. Each side keeps a copy of
+ * the index of the other side and only reads the shared one when its copy
+ * says the ring is full or empty.
+ *
+ * @records:     Storage of the records
+ * @mask:        Capacity - 1, the capacity is a power of two
+ * @head:        Index of the next record to push, written by the producer
+ * @tail_cache:  Last read value of @tail, used by the producer
+ * @pushed:      See struct sgp_record_ring_stats
+ * @overflows:   See struct sgp_record_ring_stats
+ * @tail:        Index of the next record to pop, written by the consumer
+ * @head_cache:  Last read value of @head, used by the consumer
+ * @popped:      See struct sgp_record_ring_stats
+ */
+typedef struct {
+    sgp_record* records;
+    uint32_t mask;
+    uint8_t pad_shared[SGP_RECORD_RING_CACHE_LINE_SIZE];
+    uint32_t head;
+    uint32_t tail_cache;
+    uint32_t pushed;
+    uint32_t overflows;
+    uint8_t pad_producer[SGP_RECORD_RING_CACHE_LINE_SIZE];
+    uint32_t tail;
+    uint32_t head_cache;
+    uint32_t popped;
+    uint8_t pad_consumer[SGP_RECORD_RING_CACHE_LINE_SIZE];
+} sgp_record_ring;
+
+/**
+ * sgp_record_init() - initialize a record without values
+ *
+ * @record:       The record
+ * @device_id:    Id of the device
+ * @timestamp_us: Time of the measurement
+ */
+void sgp_record_init(sgp_record* record, uint16_t device_id,
+                     uint64_t timestamp_us);
+
+/**
+ * sgp_record_ring_init() - initialize an empty ring
+ *
+ * Call before the producer and the consumer start.
+ *
+ * @ring:     The ring
+ * @records:  Storage for @capacity records
+ * @capacity: Number of records, a power of two
+ *
+ * Return:  STATUS_OK on success, STATUS_FAIL if @capacity is no power of two
+ */
+int16_t sgp_record_ring_init(sgp_record_ring* ring, sgp_record* records,
+                             uint32_t capacity);
+
+/**
+ * sgp_record_ring_push() - store a record, called by the producer only
+ *
+ * Never blocks. If the ring is full, the record is dropped and counted as
+ * overflow.
+ *
+ * @ring:   The ring
+ * @record: The record to copy into the ring
+ *
+ * Return:  true if the record was stored, false if the ring was full
+ */
+bool sgp_record_ring_push(sgp_record_ring* ring, const sgp_record* record);
+
+/**
+ * sgp_record_ring_pop_batch() - take the oldest records, called by the
+ *                               consumer only
+ *
+ * Never blocks.
+ *
+ * @ring:    The ring
+ * @records: Output for the records, oldest first
+ * @max:     Maximum number of records to take
+ *
+ * Return:  The number of records taken, 0 if the ring was empty
+ */
+uint32_t sgp_record_ring_pop_batch(sgp_record_ring* ring, sgp_record* records,
+                                   uint32_t max);
+
+/**
+ * sgp_record_ring_get_stats() - read the counters of a ring
+ *
+ * May be called from any thread; the counters of the other side may be
+ * slightly behind.
+ *
+ * @ring:   The ring
+ * @stats:  Output for the counters
+ */
+void sgp_record_ring_get_stats(sgp_record_ring* ring,
+                               sgp_record_ring_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_RECORD_RING_H */
@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sgp_timer_wheel.h"
+#include "sgp_clock.h"
+
+#define SGP_TIMER_WHEEL_SLOT_MASK (SGP_TIMER_WHEEL_SLOTS - 1)
+#define SGP_TIMER_WHEEL_LEVEL_SHIFT(level) (SGP_TIMER_WHEEL_SLOT_BITS * (level))
+
+static void sgp_timer_wheel_insert(sgp_timer_wheel* wheel, sgp_timer* timer) {
+    uint64_t expires = timer->expires_tick;
+    uint64_t delta = expires - wheel->now_tick;
+    uint8_t level = 0;
+    uint8_t slot;
+
+    if (delta > SGP_TIMER_WHEEL_MAX_TICKS) {
+        delta = SGP_TIMER_WHEEL_MAX_TICKS;
+        expires = wheel->now_tick + delta;
+    }
+    while (level < SGP_TIMER_WHEEL_LEVELS - 1 &&
+           (delta >> SGP_TIMER_WHEEL_LEVEL_SHIFT(level + 1)) != 0)
+        ++level;
+    slot = (uint8_t)((expires >> SGP_TIMER_WHEEL_LEVEL_SHIFT(level)) &
+                     SGP_TIMER_WHEEL_SLOT_MASK);
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->next = wheel->slots[level][slot];
+    if (timer->next)
+        timer->next->pprev = &timer->next;
+    timer->pprev = &wheel->slots[level][slot];
+    wheel->slots[level][slot] = timer;
+    wheel->occupied[level] |= 1ull << slot;
+}
+
+/* Detach the list of timers of a slot */
+static sgp_timer* sgp_timer_wheel_take_slot(sgp_timer_wheel* wheel,
+                                            uint8_t level, uint8_t slot) {
+    sgp_timer* first = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    wheel->occupied[level] &= ~(1ull << slot);
+    return first;
+}
+
+static void sgp_timer_wheel_cascade(sgp_timer_wheel* wheel) {
+    uint64_t tick = wheel->now_tick;
+    sgp_timer* timer;
+    sgp_timer* next;
+    uint8_t level;
+
+    /* from the top, so timers can move down several levels at once */
+    for (level = SGP_TIMER_WHEEL_LEVELS - 1; level > 0; --level) {
+        uint64_t turn_mask = (1ull << SGP_TIMER_WHEEL_LEVEL_SHIFT(level)) - 1;
+        if ((tick & turn_mask) != 0)
+            continue;
+        timer = sgp_timer_wheel_take_slot(
+            wheel, level,
+            (uint8_t)((tick >> SGP_TIMER_WHEEL_LEVEL_SHIFT(level)) &
+                      SGP_TIMER_WHEEL_SLOT_MASK));
+        for (; timer; timer = next) {
+            next = timer->next;
+            sgp_timer_wheel_insert(wheel, timer);
+            ++wheel->stats.cascaded;
+        }
+    }
+}
+
+/* The next tick after now_tick which has to be processed */
+static uint64_t sgp_timer_wheel_next_tick(const sgp_timer_wheel* wheel) {
+    uint64_t next = UINT64_MAX;
+    uint64_t occupied = wheel->occupied[0];
+    uint8_t level;
+    uint8_t distance;
+
+    for (level = 1; level < SGP_TIMER_WHEEL_LEVELS; ++level) {
+        if (wheel->occupied[level]) {
+            /* the next turn of level 0 may move timers down */
+            next = (wheel->now_tick | SGP_TIMER_WHEEL_SLOT_MASK) + 1;
+            break;
+        }
+    }
+    if (occupied) {
+        /* level 0 holds the timers of the next SGP_TIMER_WHEEL_SLOTS - 1
+         * ticks */
+        for (distance = 1; distance < SGP_TIMER_WHEEL_SLOTS; ++distance) {
+            uint8_t slot = (uint8_t)((wheel->now_tick + distance) &
+                                     SGP_TIMER_WHEEL_SLOT_MASK);
+            if (occupied & (1ull << slot))
+                break;
+        }
+        if (wheel->now_tick + distance < next)
+            next = wheel->now_tick + distance;
+    }
+    return next;
+}
+
+static void sgp_timer_wheel_process_tick(sgp_timer_wheel* wheel) {
+    sgp_timer* timer;
+    sgp_timer* next;
+
+    if ((wheel->now_tick & SGP_TIMER_WHEEL_SLOT_MASK) == 0)
+        sgp_timer_wheel_cascade(wheel);
+
+    timer = sgp_timer_wheel_take_slot(
+        wheel, 0, (uint8_t)(wheel->now_tick & SGP_TIMER_WHEEL_SLOT_MASK));
+    for (; timer; timer = next) {
+        next = timer->next;
+        timer->next = NULL;
+        timer->pprev = NULL;
+        ++wheel->stats.fired;
+        timer->callback(wheel, timer);
+    }
+}
+
+void sgp_timer_wheel_init(sgp_timer_wheel* wheel, uint32_t tick_us) {
+    uint8_t level;
+    uint8_t slot;
+
+    wheel->tick_us = tick_us;
+    wheel->start_us = sgp_clock_now_us();
+    wheel->now_tick = 0;
+    for (level = 0; level < SGP_TIMER_WHEEL_LEVELS; ++level) {
+        wheel->occupied[level] = 0;
+        for (slot = 0; slot < SGP_TIMER_WHEEL_SLOTS; ++slot)
+            wheel->slots[level][slot] = NULL;
+    }
+    sgp_timer_wheel_get_stats(wheel, NULL, true);
+}
+
+void sgp_timer_init(sgp_timer* timer,
+                    void (*callback)(sgp_timer_wheel* wheel, sgp_timer* timer),
+                    void* user_data) {
+    timer->callback = callback;
+    timer->user_data = user_data;
+    timer->expires_tick = 0;
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->level = 0;
+    timer->slot = 0;
+}
+
+void sgp_timer_wheel_add(sgp_timer_wheel* wheel, sgp_timer* timer,
+                         uint64_t expires_us) {
+    uint64_t tick = 0;
+
+    sgp_timer_wheel_cancel(wheel, timer);
+    if (expires_us > wheel->start_us) {
+        /* round up to never expire early */
+        tick = (expires_us - wheel->start_us + wheel->tick_us - 1) /
+               wheel->tick_us;
+    }
+    timer->expires_tick =
+        tick > wheel->now_tick ? tick : wheel->now_tick + 1;
+    sgp_timer_wheel_insert(wheel, timer);
+}
+
+void sgp_timer_wheel_cancel(sgp_timer_wheel* wheel, sgp_timer* timer) {
+    if (!timer->pprev)
+        return;
+    *timer->pprev = timer->next;
+    if (timer->next)
+        timer->next->pprev = timer->pprev;
+    if (!wheel->slots[timer->level][timer->slot])
+        wheel->occupied[timer->level] &= ~(1ull << timer->slot);
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+bool sgp_timer_pending(const sgp_timer* timer) {
+    return timer->pprev != NULL;
+}
+
+uint64_t sgp_timer_wheel_next_us(const sgp_timer_wheel* wheel) {
+    uint64_t tick = sgp_timer_wheel_next_tick(wheel);
+
+    if (tick == UINT64_MAX)
+        return UINT64_MAX;
+    return wheel->start_us + tick * wheel->tick_us;
+}
+
+void sgp_timer_wheel_advance(sgp_timer_wheel* wheel) {
+    uint64_t now_us = sgp_clock_now_us();
+    uint64_t target;
+    uint64_t next;
+
+    if (now_us < wheel->start_us)
+        return;
+    target = (now_us - wheel->start_us) / wheel->tick_us;
+    while (wheel->now_tick < target) {
+        next = sgp_timer_wheel_next_tick(wheel);
+        wheel->now_tick = next < target ? next : target;
+        sgp_timer_wheel_process_tick(wheel);
+    }
+}
+
+void sgp_timer_wheel_run(sgp_timer_wheel* wheel, uint64_t until_us) {
+    uint64_t now_us;
+    uint64_t next_us;
+    uint64_t sleep_us;
+
+    for (;;) {
+        sgp_timer_wheel_advance(wheel);
+        now_us = sgp_clock_now_us();
+        if (now_us >= until_us)
+            return;
+        next_us = sgp_timer_wheel_next_us(wheel);
+        if (next_us > until_us)
+            next_us = until_us;
+        /* callbacks which took long leave ticks to process */
+        if (next_us <= now_us)
+            continue;
+        sleep_us = next_us - now_us;
+        if (sleep_us > UINT32_MAX)
+            sleep_us = UINT32_MAX;
+        sgp_clock_sleep_usec((uint32_t)sleep_us);
+    }
+}
+
+void sgp_timer_wheel_get_stats(sgp_timer_wheel* wheel,
+                               sgp_timer_wheel_stats* stats, bool reset) {
+    if (stats)
+        *stats = wheel->stats;
+    if (reset) {
+        wheel->stats.fired = 0;
+        wheel->stats.cascaded = 0;
+        wheel->stats.missed_deadlines = 0;
+        wheel->stats.max_lateness_us = 0;
+    }
+}
+
+static void sgp_timer_job_issue(sgp_timer_wheel* wheel, sgp_timer_job* job) {
+    uint64_t now_us = sgp_clock_now_us();
+    uint64_t lateness_us;
+    uint32_t duration_us = 0;
+    uint32_t missed;
+
+    if (now_us >= job->deadline_us + job->period_us) {
+        missed = (uint32_t)((now_us - job->deadline_us) / job->period_us);
+        job->deadline_us += (uint64_t)missed * job->period_us;
+        job->stats.missed_deadlines += missed;
+        wheel->stats.missed_deadlines += missed;
+    }
+    lateness_us = now_us > job->deadline_us ? now_us - job->deadline_us : 0;
+    if (lateness_us > job->stats.max_lateness_us)
+        job->stats.max_lateness_us = (uint32_t)lateness_us;
+    if (lateness_us > wheel->stats.max_lateness_us)
+        wheel->stats.max_lateness_us = (uint32_t)lateness_us;
+    job->deadline_us += job->period_us;
+
+    if (job->issue(job, &duration_us) != STATUS_OK) {
+        ++job->stats.errors;
+        sgp_timer_wheel_add(wheel, &job->timer, job->deadline_us);
+        return;
+    }
+    ++job->stats.issued;
+    job->collecting = true;
+    /* the command runs from the end of the write */
+    sgp_timer_wheel_add(wheel, &job->timer, sgp_clock_now_us() + duration_us);
+}
+
+static void sgp_timer_job_fire(sgp_timer_wheel* wheel, sgp_timer* timer) {
+    sgp_timer_job* job = (sgp_timer_job*)timer->user_data;
+
+    if (!job->collecting) {
+        sgp_timer_job_issue(wheel, job);
+        return;
+    }
+    job->collecting = false;
+    if (job->collect(job) == STATUS_OK) {
+        ++job->stats.collected;
+    } else {
+        ++job->stats.errors;
+    }
+    sgp_timer_wheel_add(wheel, &job->timer, job->deadline_us);
+}
+
+void sgp_timer_job_init(sgp_timer_job* job, uint32_t period_us,
+                        int16_t (*issue)(sgp_timer_job* job,
+                                         uint32_t* duration_us),
+                        int16_t (*collect)(sgp_timer_job* job), void* device) {
+    sgp_timer_init(&job->timer, sgp_timer_job_fire, job);
+    job->period_us = period_us;
+    job->deadline_us = 0;
+    job->collecting = false;
+    job->issue = issue;
+    job->collect = collect;
+    job->device = device;
+    job->stats.issued = 0;
+    job->stats.collected = 0;
+    job->stats.errors = 0;
+    job->stats.missed_deadlines = 0;
+    job->stats.max_lateness_us = 0;
+}
+
+void sgp_timer_job_start(sgp_timer_wheel* wheel, sgp_timer_job* job,
+                         uint64_t first_deadline_us) {
+    job->deadline_us = first_deadline_us;
+    job->collecting = false;
+    sgp_timer_wheel_add(wheel, &job->timer, first_deadline_us);
+}
+
+void sgp_timer_job_stop(sgp_timer_wheel* wheel, sgp_timer_job* job) {
+    sgp_timer_wheel_cancel(wheel, &job->timer);
+    job->collecting = false;
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2021, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGP_TIMER_WHEEL_H
+#define SGP_TIMER_WHEEL_H
+#include "sensirion_arch_config.h"
+#include "sensirion_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SGP_TIMER_WHEEL_LEVELS 4
+#define SGP_TIMER_WHEEL_SLOT_BITS 6
+#define SGP_TIMER_WHEEL_SLOTS (1 << SGP_TIMER_WHEEL_SLOT_BITS)
+/* Timers further ahead wait in the last level until they are in range */
+#define SGP_TIMER_WHEEL_MAX_TICKS                                              \
+    ((1ull << (SGP_TIMER_WHEEL_SLOT_BITS * SGP_TIMER_WHEEL_LEVELS)) - 1)
+
+struct sgp_timer_wheel;
+
+/**
+ * struct sgp_timer - timer on a timer wheel
+ *
+ * Initialize with sgp_timer_init(). The other members are managed by the
+ * timer wheel.
+ *
+ * @callback:     Called when the timer expires. It may add the timer again.
+ * @user_data:    Optional data for @callback
+ * @expires_tick: Tick at which the timer expires
+ * @next:         Next timer in the same slot
+ * @pprev:        Link to this timer in the slot, NULL if not pending
+ * @level:        Level of the slot
+ * @slot:         Index of the slot in its level
+ */
+typedef struct sgp_timer {
+    void (*callback)(struct sgp_timer_wheel* wheel, struct sgp_timer* timer);
+    void* user_data;
+    uint64_t expires_tick;
+    struct sgp_timer* next;
+    struct sgp_timer** pprev;
+    uint8_t level;
+    uint8_t slot;
+} sgp_timer;
+
+/**
+ * struct sgp_timer_wheel_stats - counters of a timer wheel
+ *
+ * @fired:            Expired timers whose callback was called
+ * @cascaded:         Timers moved to a lower level of the wheel
+ * @missed_deadlines: Deadlines of jobs which passed before the job could
+ *                    issue its command, see struct sgp_timer_job
+ * @max_lateness_us:  Maximum time between the deadline of a job and the
+ *                    issue of its command in microseconds
+ */
+typedef struct {
+    uint32_t fired;
+    uint32_t cascaded;
+    uint32_t missed_deadlines;
+    uint32_t max_lateness_us;
+} sgp_timer_wheel_stats;
+
+/**
+ * struct sgp_timer_wheel - hierarchical timer wheel
+ *
+ * Level 0 has one slot per tick, each higher level one slot per full turn of
+ * the level below. A timer is added to the slot of its expiry tick on the
+ * lowest level which reaches that far, and moved down a level each time the
+ * level below completes a turn. Adding and cancelling a timer is O(1),
+ * independent of the number of timers, and the occupancy bitmaps let the
+ * wheel skip empty ticks. Times are taken from the sgp_clock.
+ *
+ * @tick_us:   Length of a tick in microseconds
+ * @start_us:  Time of tick 0
+ * @now_tick:  Last processed tick
+ * @occupied:  Bitmap of the non-empty slots of each level
+ * @slots:     Lists of the timers in each slot
+ * @stats:     Counters, see sgp_timer_wheel_get_stats()
+ */
+typedef struct sgp_timer_wheel {
+    uint32_t tick_us;
+    uint64_t start_us;
+    uint64_t now_tick;
+    uint64_t occupied[SGP_TIMER_WHEEL_LEVELS];
+    sgp_timer* slots[SGP_TIMER_WHEEL_LEVELS][SGP_TIMER_WHEEL_SLOTS];
+    sgp_timer_wheel_stats stats;
+} sgp_timer_wheel;
+
+/**
+ * struct sgp_timer_job_stats - counters of a job
+ *
+ * @issued:           Commands issued
+ * @collected:        Results collected successfully
+ * @errors:           Failed issue or collect callbacks
+ * @missed_deadlines: Deadlines skipped because the job was more than a period
+ *                    late
+ * @max_lateness_us:  Maximum time between a deadline and the issue of the
+ *                    command in microseconds
+ */
+typedef struct {
+    uint32_t issued;
+    uint32_t collected;
+    uint32_t errors;
+    uint32_t missed_deadlines;
+    uint32_t max_lateness_us;
+} sgp_timer_job_stats;
+
+/**
+ * struct sgp_timer_job - periodic measurement of a sensor on a timer wheel
+ *
+ * A job splits a driver command into its two phases: @issue sends the
+ * command at each deadline, e.g. with sgp30_dev_measure_iaq(), and @collect
+ * reads the result once the command finished, e.g. with sgp30_dev_read_iaq().
+ * The deadlines are absolute (start + n periods) like with sgp_periodic. If a
+ * job is more than a period late, the deadlines which passed are skipped and
+ * counted as missed.
+ *
+ * @timer:       Timer of the job
+ * @period_us:   Period in microseconds. May be changed by the callbacks, e.g.
+ *               after switching the power mode of an SGPC3, and applies from
+ *               the next deadline.
+ * @deadline_us: Deadline of the next issue
+ * @collecting:  Whether the command was issued and the result is pending
+ * @issue:       Sends the command to the sensor and returns its execution
+ *               time in @duration_us
+ * @collect:     Reads the result of the command
+ * @device:      Device handle for the callbacks
+ * @stats:       Counters of the job
+ */
+typedef struct sgp_timer_job {
+    sgp_timer timer;
+    uint32_t period_us;
+    uint64_t deadline_us;
+    bool collecting;
+    int16_t (*issue)(struct sgp_timer_job* job, uint32_t* duration_us);
+    int16_t (*collect)(struct sgp_timer_job* job);
+    void* device;
+    sgp_timer_job_stats stats;
+} sgp_timer_job;
+
+/**
+ * sgp_timer_wheel_init() - initialize a timer wheel
+ *
+ * Tick 0 is the current time of the sgp_clock. Timers expire at the first
+ * tick at or after their expiry time, so the tick should be short compared
+ * to the command durations, e.g. 1000us.
+ *
+ * @wheel:      The timer wheel
+ * @tick_us:    Length of a tick in microseconds
+ */
+void sgp_timer_wheel_init(sgp_timer_wheel* wheel, uint32_t tick_us);
+
+/**
+ * sgp_timer_init() - initialize a timer
+ *
+ * @timer:      The timer
+ * @callback:   Called when the timer expires
+ * @user_data:  Optional data for the callback
+ */
+void sgp_timer_init(sgp_timer* timer,
+                    void (*callback)(sgp_timer_wheel* wheel, sgp_timer* timer),
+                    void* user_data);
+
+/**
+ * sgp_timer_wheel_add() - add or move a timer
+ *
+ * Timers with an expiry time in the past expire at the next tick.
+ *
+ * @wheel:      The timer wheel
+ * @timer:      The timer, which is moved if it is already pending
+ * @expires_us: Expiry time on the sgp_clock in microseconds
+ */
+void sgp_timer_wheel_add(sgp_timer_wheel* wheel, sgp_timer* timer,
+                         uint64_t expires_us);
+
+/**
+ * sgp_timer_wheel_cancel() - remove a pending timer
+ *
+ * @wheel:      The timer wheel
+ * @timer:      The timer, nothing happens if it is not pending
+ */
+void sgp_timer_wheel_cancel(sgp_timer_wheel* wheel, sgp_timer* timer);
+
+/**
+ * sgp_timer_pending() - check if a timer is on a timer wheel
+ *
+ * @timer:      The timer
+ *
+ * Return:      true if the timer is pending
+ */
+bool sgp_timer_pending(const sgp_timer* timer);
+
+/**
+ * sgp_timer_wheel_next_us() - time of the next tick with work
+ *
+ * This is the next tick with an expiring timer, or the next tick at which
+ * timers move down a level. An event loop can sleep until then and call
+ * sgp_timer_wheel_advance().
+ *
+ * @wheel:      The timer wheel
+ *
+ * Return:      The time on the sgp_clock in microseconds, UINT64_MAX if no
+ *              timer is pending
+ */
+uint64_t sgp_timer_wheel_next_us(const sgp_timer_wheel* wheel);
+
+/**
+ * sgp_timer_wheel_advance() - fire the timers which expired
+ *
+ * Processes all ticks up to the current time of the sgp_clock without
+ * sleeping.
+ *
+ * @wheel:      The timer wheel
+ */
+void sgp_timer_wheel_advance(sgp_timer_wheel* wheel);
+
+/**
+ * sgp_timer_wheel_run() - fire timers until a given time
+ *
+ * Sleeps with sgp_clock_sleep_usec() between the ticks with work.
+ *
+ * @wheel:      The timer wheel
+ * @until_us:   Time on the sgp_clock at which to return
+ */
+void sgp_timer_wheel_run(sgp_timer_wheel* wheel, uint64_t until_us);
+
+/**
+ * sgp_timer_wheel_get_stats() - read the counters of a timer wheel
+ *
+ * @wheel:      The timer wheel
+ * @stats:      Output for the counters since the last reset
+ * @reset:      true to reset the counters
+ */
+void sgp_timer_wheel_get_stats(sgp_timer_wheel* wheel,
+                               sgp_timer_wheel_stats* stats, bool reset);
+
+/**
+ * sgp_timer_job_init() - initialize a periodic job
+ *
+ * @job:        The job
+ * @period_us:  Period in microseconds
+ * @issue:      Sends the command, see struct sgp_timer_job
+ * @collect:    Reads the result, see struct sgp_timer_job
+ * @device:     Device handle for the callbacks
+ */
+void sgp_timer_job_init(sgp_timer_job* job, uint32_t period_us,
+                        int16_t (*issue)(sgp_timer_job* job,
+                                         uint32_t* duration_us),
+                        int16_t (*collect)(sgp_timer_job* job), void* device);
+
+/**
+ * sgp_timer_job_start() - start a job on a timer wheel
+ *
+ * Spread the first deadlines of many jobs over the period to spread the
+ * load on the buses.
+ *
+ * @wheel:             The timer wheel
+ * @job:               The job
+ * @first_deadline_us: Time of the first issue on the sgp_clock
+ */
+void sgp_timer_job_start(sgp_timer_wheel* wheel, sgp_timer_job* job,
+                         uint64_t first_deadline_us);
+
+/**
+ * sgp_timer_job_stop() - stop a job
+ *
+ * A pending result is not collected.
+ *
+ * @wheel:      The timer wheel
+ * @job:        The job
+ */
+void sgp_timer_job_stop(sgp_timer_wheel* wheel, sgp_timer_job* job);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SGP_TIMER_WHEEL_H */
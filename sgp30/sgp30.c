@@ -36,63 +36,110 @@
 #include "sgp_git_version.h"
 
 #define SGP30_PRODUCT_TYPE 0
-static const uint8_t SGP30_I2C_ADDRESS = 0x58;
 
 /* command and constants for reading the serial ID */
 #define SGP30_CMD_GET_SERIAL_ID 0x3682
-#define SGP30_CMD_GET_SERIAL_ID_DURATION_US 500
 #define SGP30_CMD_GET_SERIAL_ID_WORDS 3
 
 /* command and constants for reading the featureset version */
 #define SGP30_CMD_GET_FEATURESET 0x202f
-#define SGP30_CMD_GET_FEATURESET_DURATION_US 10000
 #define SGP30_CMD_GET_FEATURESET_WORDS 1
 
 /* command and constants for on-chip self-test */
 #define SGP30_CMD_MEASURE_TEST 0x2032
-#define SGP30_CMD_MEASURE_TEST_DURATION_US 220000
 #define SGP30_CMD_MEASURE_TEST_WORDS 1
 #define SGP30_CMD_MEASURE_TEST_OK 0xd400
 
 /* command and constants for IAQ init */
 #define SGP30_CMD_IAQ_INIT 0x2003
-#define SGP30_CMD_IAQ_INIT_DURATION_US 10000
 
 /* command and constants for IAQ measure */
 #define SGP30_CMD_IAQ_MEASURE 0x2008
-#define SGP30_CMD_IAQ_MEASURE_DURATION_US 12000
 #define SGP30_CMD_IAQ_MEASURE_WORDS 2
 
 /* command and constants for getting IAQ baseline */
 #define SGP30_CMD_GET_IAQ_BASELINE 0x2015
-#define SGP30_CMD_GET_IAQ_BASELINE_DURATION_US 10000
 #define SGP30_CMD_GET_IAQ_BASELINE_WORDS 2
 
 /* command and constants for setting IAQ baseline */
 #define SGP30_CMD_SET_IAQ_BASELINE 0x201e
-#define SGP30_CMD_SET_IAQ_BASELINE_DURATION_US 10000
 
 /* command and constants for raw measure */
 #define SGP30_CMD_RAW_MEASURE 0x2050
-#define SGP30_CMD_RAW_MEASURE_DURATION_US 25000
 #define SGP30_CMD_RAW_MEASURE_WORDS 2
 
 /* command and constants for setting absolute humidity */
 #define SGP30_CMD_SET_ABSOLUTE_HUMIDITY 0x2061
-#define SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US 10000
 
 /* command and constants for getting TVOC inceptive baseline */
 #define SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE 0x20b3
-#define SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US 10000
 #define SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_WORDS 1
 
 /* command and constants for setting TVOC baseline */
 #define SGP30_CMD_SET_TVOC_BASELINE 0x2077
-#define SGP30_CMD_SET_TVOC_BASELINE_DURATION_US 10000
+
+/* device used by the functions without device handle */
+static sgp30_device sgp30_default_device = {NULL, SGP30_I2C_ADDRESS};
+
+static int16_t sgp30_write_cmd(sgp30_device* dev, uint16_t command,
+                               uint32_t duration_us) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    dev->command_duration_us = duration_us;
+    ret = sensirion_i2c_write_cmd(dev->i2c_address, command);
+    if (ret == STATUS_OK)
+        dev->ready_at_us = sgp_clock_now_us() + duration_us;
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
+
+static int16_t sgp30_write_cmd_with_args(sgp30_device* dev, uint16_t command,
+                                         const uint16_t* data_words,
+                                         uint16_t num_words,
+                                         uint32_t duration_us) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    dev->command_duration_us = duration_us;
+    ret = sensirion_i2c_write_cmd_with_args(dev->i2c_address, command,
+                                            data_words, num_words);
+    if (ret == STATUS_OK)
+        dev->ready_at_us = sgp_clock_now_us() + duration_us;
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
+
+static int16_t sgp30_read_words(sgp30_device* dev, uint16_t* data_words,
+                                uint16_t num_words) {
+    int16_t ret;
+
+    /* the default clock only counts the time slept by the drivers */
+    if (sgp_clock_is_set() && sgp_clock_now_us() < dev->ready_at_us)
+        return SGP30_ERR_NOT_READY;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    ret = sensirion_i2c_read_words(dev->i2c_address, data_words, num_words);
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
 
 /**
  * sgp30_check_featureset() - Check if the connected sensor has a certain FS
  *
+ * The feature set is only read from the sensor if it is not cached yet, i.e.
+ * if sgp30_dev_probe() was not called.
+ *
+ * @dev:       The device to check
  * @needed_fs: The featureset that is required
  *
  * Return: STATUS_OK if the sensor has the required FS,
@@ -101,34 +148,65 @@ static const uint8_t SGP30_I2C_ADDRESS = 0x58;
  *                                           have the required FS,
  *         an error code otherwise
  */
-static int16_t sgp30_check_featureset(uint16_t needed_fs) {
+static int16_t sgp30_check_featureset(sgp30_device* dev, uint16_t needed_fs) {
     int16_t ret;
-    uint16_t fs_version;
-    uint8_t product_type;
 
-    ret = sgp30_get_feature_set_version(&fs_version, &product_type);
-    if (ret != STATUS_OK)
-        return ret;
+    if (!dev->capabilities_valid) {
+        ret = sgp30_dev_get_feature_set_version(dev, &dev->feature_set_version,
+                                                &dev->product_type);
+        if (ret != STATUS_OK)
+            return ret;
+        dev->capabilities_valid = true;
+    }
 
-    if (product_type != SGP30_PRODUCT_TYPE)
+    if (dev->product_type != SGP30_PRODUCT_TYPE)
         return SGP30_ERR_INVALID_PRODUCT_TYPE;
 
-    if (fs_version < needed_fs)
+    if (dev->feature_set_version < needed_fs)
         return SGP30_ERR_UNSUPPORTED_FEATURE_SET;
 
     return STATUS_OK;
 }
 
-int16_t sgp30_measure_test(uint16_t* test_result) {
+void sgp30_dev_init(sgp30_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address) {
+    dev->bus = bus;
+    dev->i2c_address = i2c_address;
+    dev->capabilities_valid = false;
+    dev->feature_set_version = 0;
+    dev->product_type = 0;
+    dev->serial_id_valid = false;
+    dev->serial_id = 0;
+    dev->command_duration_us = 0;
+    dev->ready_at_us = 0;
+}
+
+int16_t sgp30_dev_measure_test(sgp30_device* dev, uint16_t* test_result) {
+    int16_t ret;
+
+    *test_result = 0;
+
+    ret = sgp30_dev_measure_test_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_MEASURE_TEST_DURATION_US);
+
+    return sgp30_dev_measure_test_read(dev, test_result);
+}
+
+int16_t sgp30_dev_measure_test_start(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_MEASURE_TEST,
+                           SGP30_CMD_MEASURE_TEST_DURATION_US);
+}
+
+int16_t sgp30_dev_measure_test_read(sgp30_device* dev, uint16_t* test_result) {
     uint16_t measure_test_word_buf[SGP30_CMD_MEASURE_TEST_WORDS];
     int16_t ret;
 
     *test_result = 0;
 
-    ret = sensirion_i2c_delayed_read_cmd(
-        SGP30_I2C_ADDRESS, SGP30_CMD_MEASURE_TEST,
-        SGP30_CMD_MEASURE_TEST_DURATION_US, measure_test_word_buf,
-        SENSIRION_NUM_WORDS(measure_test_word_buf));
+    ret = sgp30_read_words(dev, measure_test_word_buf,
+                           SENSIRION_NUM_WORDS(measure_test_word_buf));
     if (ret != STATUS_OK)
         return ret;
 
@@ -139,16 +217,17 @@ int16_t sgp30_measure_test(uint16_t* test_result) {
     return STATUS_FAIL;
 }
 
-int16_t sgp30_measure_iaq() {
-    return sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, SGP30_CMD_IAQ_MEASURE);
+int16_t sgp30_dev_measure_iaq(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_IAQ_MEASURE,
+                           SGP30_CMD_IAQ_MEASURE_DURATION_US);
 }
 
-int16_t sgp30_read_iaq(uint16_t* tvoc_ppb, uint16_t* co2_eq_ppm) {
+int16_t sgp30_dev_read_iaq(sgp30_device* dev, uint16_t* tvoc_ppb,
+                           uint16_t* co2_eq_ppm) {
     int16_t ret;
     uint16_t words[SGP30_CMD_IAQ_MEASURE_WORDS];
 
-    ret = sensirion_i2c_read_words(SGP30_I2C_ADDRESS, words,
-                                   SGP30_CMD_IAQ_MEASURE_WORDS);
+    ret = sgp30_read_words(dev, words, SGP30_CMD_IAQ_MEASURE_WORDS);
 
     *tvoc_ppb = words[1];
     *co2_eq_ppm = words[0];
@@ -156,70 +235,75 @@ int16_t sgp30_read_iaq(uint16_t* tvoc_ppb, uint16_t* co2_eq_ppm) {
     return ret;
 }
 
-int16_t sgp30_measure_iaq_blocking_read(uint16_t* tvoc_ppb,
-                                        uint16_t* co2_eq_ppm) {
+int16_t sgp30_dev_measure_iaq_blocking_read(sgp30_device* dev,
+                                            uint16_t* tvoc_ppb,
+                                            uint16_t* co2_eq_ppm) {
     int16_t ret;
 
-    ret = sgp30_measure_iaq();
+    ret = sgp30_dev_measure_iaq(dev);
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGP30_CMD_IAQ_MEASURE_DURATION_US);
+    sgp_clock_sleep_usec(SGP30_CMD_IAQ_MEASURE_DURATION_US);
 
-    return sgp30_read_iaq(tvoc_ppb, co2_eq_ppm);
+    return sgp30_dev_read_iaq(dev, tvoc_ppb, co2_eq_ppm);
 }
 
-int16_t sgp30_measure_tvoc() {
-    return sgp30_measure_iaq();
+int16_t sgp30_dev_measure_tvoc(sgp30_device* dev) {
+    return sgp30_dev_measure_iaq(dev);
 }
 
-int16_t sgp30_read_tvoc(uint16_t* tvoc_ppb) {
+int16_t sgp30_dev_read_tvoc(sgp30_device* dev, uint16_t* tvoc_ppb) {
     uint16_t co2_eq_ppm;
-    return sgp30_read_iaq(tvoc_ppb, &co2_eq_ppm);
+    return sgp30_dev_read_iaq(dev, tvoc_ppb, &co2_eq_ppm);
 }
 
-int16_t sgp30_measure_tvoc_blocking_read(uint16_t* tvoc_ppb) {
+int16_t sgp30_dev_measure_tvoc_blocking_read(sgp30_device* dev,
+                                             uint16_t* tvoc_ppb) {
     uint16_t co2_eq_ppm;
-    return sgp30_measure_iaq_blocking_read(tvoc_ppb, &co2_eq_ppm);
+    return sgp30_dev_measure_iaq_blocking_read(dev, tvoc_ppb, &co2_eq_ppm);
 }
 
-int16_t sgp30_measure_co2_eq() {
-    return sgp30_measure_iaq();
+int16_t sgp30_dev_measure_co2_eq(sgp30_device* dev) {
+    return sgp30_dev_measure_iaq(dev);
 }
 
-int16_t sgp30_read_co2_eq(uint16_t* co2_eq_ppm) {
+int16_t sgp30_dev_read_co2_eq(sgp30_device* dev, uint16_t* co2_eq_ppm) {
     uint16_t tvoc_ppb;
-    return sgp30_read_iaq(&tvoc_ppb, co2_eq_ppm);
+    return sgp30_dev_read_iaq(dev, &tvoc_ppb, co2_eq_ppm);
 }
 
-int16_t sgp30_measure_co2_eq_blocking_read(uint16_t* co2_eq_ppm) {
+int16_t sgp30_dev_measure_co2_eq_blocking_read(sgp30_device* dev,
+                                               uint16_t* co2_eq_ppm) {
     uint16_t tvoc_ppb;
-    return sgp30_measure_iaq_blocking_read(&tvoc_ppb, co2_eq_ppm);
+    return sgp30_dev_measure_iaq_blocking_read(dev, &tvoc_ppb, co2_eq_ppm);
 }
 
-int16_t sgp30_measure_raw_blocking_read(uint16_t* ethanol_raw_signal,
-                                        uint16_t* h2_raw_signal) {
+int16_t sgp30_dev_measure_raw_blocking_read(sgp30_device* dev,
+                                            uint16_t* ethanol_raw_signal,
+                                            uint16_t* h2_raw_signal) {
     int16_t ret;
 
-    ret = sgp30_measure_raw();
+    ret = sgp30_dev_measure_raw(dev);
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGP30_CMD_RAW_MEASURE_DURATION_US);
+    sgp_clock_sleep_usec(SGP30_CMD_RAW_MEASURE_DURATION_US);
 
-    return sgp30_read_raw(ethanol_raw_signal, h2_raw_signal);
+    return sgp30_dev_read_raw(dev, ethanol_raw_signal, h2_raw_signal);
 }
 
-int16_t sgp30_measure_raw() {
-    return sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, SGP30_CMD_RAW_MEASURE);
+int16_t sgp30_dev_measure_raw(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_RAW_MEASURE,
+                           SGP30_CMD_RAW_MEASURE_DURATION_US);
 }
 
-int16_t sgp30_read_raw(uint16_t* ethanol_raw_signal, uint16_t* h2_raw_signal) {
+int16_t sgp30_dev_read_raw(sgp30_device* dev, uint16_t* ethanol_raw_signal,
+                           uint16_t* h2_raw_signal) {
     int16_t ret;
     uint16_t words[SGP30_CMD_RAW_MEASURE_WORDS];
 
-    ret = sensirion_i2c_read_words(SGP30_I2C_ADDRESS, words,
-                                   SGP30_CMD_RAW_MEASURE_WORDS);
+    ret = sgp30_read_words(dev, words, SGP30_CMD_RAW_MEASURE_WORDS);
 
     *ethanol_raw_signal = words[1];
     *h2_raw_signal = words[0];
@@ -227,20 +311,29 @@ int16_t sgp30_read_raw(uint16_t* ethanol_raw_signal, uint16_t* h2_raw_signal) {
     return ret;
 }
 
-int16_t sgp30_get_iaq_baseline(uint32_t* baseline) {
+int16_t sgp30_dev_get_iaq_baseline(sgp30_device* dev, uint32_t* baseline) {
     int16_t ret;
-    uint16_t words[SGP30_CMD_GET_IAQ_BASELINE_WORDS];
 
-    ret =
-        sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, SGP30_CMD_GET_IAQ_BASELINE);
+    ret = sgp30_dev_get_iaq_baseline_start(dev);
 
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGP30_CMD_GET_IAQ_BASELINE_DURATION_US);
+    sgp_clock_sleep_usec(SGP30_CMD_GET_IAQ_BASELINE_DURATION_US);
 
-    ret = sensirion_i2c_read_words(SGP30_I2C_ADDRESS, words,
-                                   SGP30_CMD_GET_IAQ_BASELINE_WORDS);
+    return sgp30_dev_get_iaq_baseline_read(dev, baseline);
+}
+
+int16_t sgp30_dev_get_iaq_baseline_start(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_GET_IAQ_BASELINE,
+                           SGP30_CMD_GET_IAQ_BASELINE_DURATION_US);
+}
+
+int16_t sgp30_dev_get_iaq_baseline_read(sgp30_device* dev, uint32_t* baseline) {
+    int16_t ret;
+    uint16_t words[SGP30_CMD_GET_IAQ_BASELINE_WORDS];
+
+    ret = sgp30_read_words(dev, words, SGP30_CMD_GET_IAQ_BASELINE_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
@@ -252,48 +345,82 @@ int16_t sgp30_get_iaq_baseline(uint32_t* baseline) {
     return STATUS_FAIL;
 }
 
-int16_t sgp30_set_iaq_baseline(uint32_t baseline) {
+int16_t sgp30_dev_set_iaq_baseline(sgp30_device* dev, uint32_t baseline) {
     int16_t ret;
+
+    ret = sgp30_dev_set_iaq_baseline_start(dev, baseline);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_SET_IAQ_BASELINE_DURATION_US);
+
+    return STATUS_OK;
+}
+
+int16_t sgp30_dev_set_iaq_baseline_start(sgp30_device* dev, uint32_t baseline) {
     uint16_t words[2] = {(uint16_t)((baseline & 0xffff0000) >> 16),
                          (uint16_t)(baseline & 0x0000ffff)};
 
     if (!baseline)
         return STATUS_FAIL;
 
-    ret = sensirion_i2c_write_cmd_with_args(SGP30_I2C_ADDRESS,
-                                            SGP30_CMD_SET_IAQ_BASELINE, words,
-                                            SENSIRION_NUM_WORDS(words));
+    return sgp30_write_cmd_with_args(dev, SGP30_CMD_SET_IAQ_BASELINE, words,
+                                     SENSIRION_NUM_WORDS(words),
+                                     SGP30_CMD_SET_IAQ_BASELINE_DURATION_US);
+}
 
-    sensirion_sleep_usec(SGP30_CMD_SET_IAQ_BASELINE_DURATION_US);
+int16_t sgp30_dev_get_tvoc_inceptive_baseline(
+    sgp30_device* dev, uint16_t* tvoc_inceptive_baseline) {
+    int16_t ret;
 
-    return ret;
+    ret = sgp30_dev_get_tvoc_inceptive_baseline_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US);
+
+    return sgp30_dev_get_tvoc_inceptive_baseline_read(dev,
+                                                      tvoc_inceptive_baseline);
 }
 
-int16_t sgp30_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline) {
+int16_t sgp30_dev_get_tvoc_inceptive_baseline_start(sgp30_device* dev) {
     int16_t ret;
 
-    ret = sgp30_check_featureset(0x21);
+    ret = sgp30_check_featureset(dev, 0x21);
 
     if (ret != STATUS_OK)
         return ret;
 
-    ret = sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS,
-                                  SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE);
+    return sgp30_write_cmd(dev, SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE,
+                           SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US);
+}
+
+int16_t sgp30_dev_get_tvoc_inceptive_baseline_read(
+    sgp30_device* dev, uint16_t* tvoc_inceptive_baseline) {
+    return sgp30_read_words(dev, tvoc_inceptive_baseline,
+                            SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_WORDS);
+}
+
+int16_t sgp30_dev_set_tvoc_baseline(sgp30_device* dev, uint16_t tvoc_baseline) {
+    int16_t ret;
+
+    ret = sgp30_dev_set_tvoc_baseline_start(dev, tvoc_baseline);
 
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US);
+    sgp_clock_sleep_usec(SGP30_CMD_SET_TVOC_BASELINE_DURATION_US);
 
-    return sensirion_i2c_read_words(
-        SGP30_I2C_ADDRESS, tvoc_inceptive_baseline,
-        SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_WORDS);
+    return STATUS_OK;
 }
 
-int16_t sgp30_set_tvoc_baseline(uint16_t tvoc_baseline) {
+int16_t sgp30_dev_set_tvoc_baseline_start(sgp30_device* dev,
+                                          uint16_t tvoc_baseline) {
     int16_t ret;
 
-    ret = sgp30_check_featureset(0x21);
+    ret = sgp30_check_featureset(dev, 0x21);
 
     if (ret != STATUS_OK)
         return ret;
@@ -301,17 +428,28 @@ int16_t sgp30_set_tvoc_baseline(uint16_t tvoc_baseline) {
     if (!tvoc_baseline)
         return STATUS_FAIL;
 
-    ret = sensirion_i2c_write_cmd_with_args(
-        SGP30_I2C_ADDRESS, SGP30_CMD_SET_TVOC_BASELINE, &tvoc_baseline,
-        SENSIRION_NUM_WORDS(tvoc_baseline));
+    return sgp30_write_cmd_with_args(dev, SGP30_CMD_SET_TVOC_BASELINE,
+                                     &tvoc_baseline,
+                                     SENSIRION_NUM_WORDS(tvoc_baseline),
+                                     SGP30_CMD_SET_TVOC_BASELINE_DURATION_US);
+}
+
+int16_t sgp30_dev_set_absolute_humidity(sgp30_device* dev,
+                                        uint32_t absolute_humidity) {
+    int16_t ret;
 
-    sensirion_sleep_usec(SGP30_CMD_SET_TVOC_BASELINE_DURATION_US);
+    ret = sgp30_dev_set_absolute_humidity_start(dev, absolute_humidity);
 
-    return ret;
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
+
+    return STATUS_OK;
 }
 
-int16_t sgp30_set_absolute_humidity(uint32_t absolute_humidity) {
-    int16_t ret;
+int16_t sgp30_dev_set_absolute_humidity_start(sgp30_device* dev,
+                                              uint32_t absolute_humidity) {
     uint16_t ah_scaled;
 
     if (absolute_humidity > 256000)
@@ -320,13 +458,10 @@ int16_t sgp30_set_absolute_humidity(uint32_t absolute_humidity) {
     /* ah_scaled = (absolute_humidity / 1000) * 256 */
     ah_scaled = (uint16_t)((absolute_humidity * 16777) >> 16);
 
-    ret = sensirion_i2c_write_cmd_with_args(
-        SGP30_I2C_ADDRESS, SGP30_CMD_SET_ABSOLUTE_HUMIDITY, &ah_scaled,
-        SENSIRION_NUM_WORDS(ah_scaled));
-
-    sensirion_sleep_usec(SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
-
-    return ret;
+    return sgp30_write_cmd_with_args(
+        dev, SGP30_CMD_SET_ABSOLUTE_HUMIDITY, &ah_scaled,
+        SENSIRION_NUM_WORDS(ah_scaled),
+        SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
 }
 
 const char* sgp30_get_driver_version() {
@@ -337,15 +472,34 @@ uint8_t sgp30_get_configured_address() {
     return SGP30_I2C_ADDRESS;
 }
 
-int16_t sgp30_get_feature_set_version(uint16_t* feature_set_version,
-                                      uint8_t* product_type) {
+int16_t sgp30_dev_get_feature_set_version(sgp30_device* dev,
+                                          uint16_t* feature_set_version,
+                                          uint8_t* product_type) {
+    int16_t ret;
+
+    ret = sgp30_dev_get_feature_set_version_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_GET_FEATURESET_DURATION_US);
+
+    return sgp30_dev_get_feature_set_version_read(dev, feature_set_version,
+                                                  product_type);
+}
+
+int16_t sgp30_dev_get_feature_set_version_start(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_GET_FEATURESET,
+                           SGP30_CMD_GET_FEATURESET_DURATION_US);
+}
+
+int16_t sgp30_dev_get_feature_set_version_read(sgp30_device* dev,
+                                               uint16_t* feature_set_version,
+                                               uint8_t* product_type) {
     int16_t ret;
     uint16_t words[SGP30_CMD_GET_FEATURESET_WORDS];
 
-    ret = sensirion_i2c_delayed_read_cmd(SGP30_I2C_ADDRESS,
-                                         SGP30_CMD_GET_FEATURESET,
-                                         SGP30_CMD_GET_FEATURESET_DURATION_US,
-                                         words, SGP30_CMD_GET_FEATURESET_WORDS);
+    ret = sgp30_read_words(dev, words, SGP30_CMD_GET_FEATURESET_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
@@ -356,36 +510,236 @@ int16_t sgp30_get_feature_set_version(uint16_t* feature_set_version,
     return STATUS_OK;
 }
 
-int16_t sgp30_get_serial_id(uint64_t* serial_id) {
+int16_t sgp30_dev_get_serial_id(sgp30_device* dev, uint64_t* serial_id) {
+    int16_t ret;
+
+    if (dev->serial_id_valid) {
+        *serial_id = dev->serial_id;
+        return STATUS_OK;
+    }
+
+    ret = sgp30_dev_get_serial_id_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGP30_CMD_GET_SERIAL_ID_DURATION_US);
+
+    return sgp30_dev_get_serial_id_read(dev, serial_id);
+}
+
+int16_t sgp30_dev_get_serial_id_start(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_GET_SERIAL_ID,
+                           SGP30_CMD_GET_SERIAL_ID_DURATION_US);
+}
+
+int16_t sgp30_dev_get_serial_id_read(sgp30_device* dev, uint64_t* serial_id) {
     int16_t ret;
     uint16_t words[SGP30_CMD_GET_SERIAL_ID_WORDS];
 
-    ret = sensirion_i2c_delayed_read_cmd(SGP30_I2C_ADDRESS,
-                                         SGP30_CMD_GET_SERIAL_ID,
-                                         SGP30_CMD_GET_SERIAL_ID_DURATION_US,
-                                         words, SGP30_CMD_GET_SERIAL_ID_WORDS);
+    ret = sgp30_read_words(dev, words, SGP30_CMD_GET_SERIAL_ID_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
 
     *serial_id = (((uint64_t)words[0]) << 32) | (((uint64_t)words[1]) << 16) |
                  (((uint64_t)words[2]) << 0);
+    dev->serial_id = *serial_id;
+    dev->serial_id_valid = true;
 
     return STATUS_OK;
 }
 
-int16_t sgp30_iaq_init() {
-    int16_t ret =
-        sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, SGP30_CMD_IAQ_INIT);
-    sensirion_sleep_usec(SGP30_CMD_IAQ_INIT_DURATION_US);
-    return ret;
+int16_t sgp30_dev_iaq_init(sgp30_device* dev) {
+    int16_t ret = sgp30_dev_iaq_init_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    sgp_clock_sleep_usec(SGP30_CMD_IAQ_INIT_DURATION_US);
+    return STATUS_OK;
 }
 
-int16_t sgp30_probe() {
-    int16_t ret = sgp30_check_featureset(0x20);
+int16_t sgp30_dev_iaq_init_start(sgp30_device* dev) {
+    return sgp30_write_cmd(dev, SGP30_CMD_IAQ_INIT,
+                           SGP30_CMD_IAQ_INIT_DURATION_US);
+}
+
+int16_t sgp30_dev_probe(sgp30_device* dev) {
+    int16_t ret;
+
+    /* (re-)read the capabilities of the connected sensor */
+    dev->capabilities_valid = false;
+    dev->serial_id_valid = false;
+    ret = sgp30_check_featureset(dev, 0x20);
 
     if (ret != STATUS_OK)
         return ret;
 
-    return sgp30_iaq_init();
+    return sgp30_dev_iaq_init(dev);
+}
+
+/*
+ * Functions operating on the default device on the currently selected bus
+ */
+
+int16_t sgp30_probe(void) {
+    return sgp30_dev_probe(&sgp30_default_device);
+}
+
+int16_t sgp30_iaq_init(void) {
+    return sgp30_dev_iaq_init(&sgp30_default_device);
+}
+
+int16_t sgp30_iaq_init_start(void) {
+    return sgp30_dev_iaq_init_start(&sgp30_default_device);
+}
+
+int16_t sgp30_get_feature_set_version(uint16_t* feature_set_version,
+                                      uint8_t* product_type) {
+    return sgp30_dev_get_feature_set_version(&sgp30_default_device,
+                                             feature_set_version, product_type);
+}
+
+int16_t sgp30_get_feature_set_version_start(void) {
+    return sgp30_dev_get_feature_set_version_start(&sgp30_default_device);
+}
+
+int16_t sgp30_get_feature_set_version_read(uint16_t* feature_set_version,
+                                           uint8_t* product_type) {
+    return sgp30_dev_get_feature_set_version_read(&sgp30_default_device,
+                                                  feature_set_version,
+                                                  product_type);
+}
+
+int16_t sgp30_get_serial_id(uint64_t* serial_id) {
+    return sgp30_dev_get_serial_id(&sgp30_default_device, serial_id);
+}
+
+int16_t sgp30_get_serial_id_start(void) {
+    return sgp30_dev_get_serial_id_start(&sgp30_default_device);
+}
+
+int16_t sgp30_get_serial_id_read(uint64_t* serial_id) {
+    return sgp30_dev_get_serial_id_read(&sgp30_default_device, serial_id);
+}
+
+int16_t sgp30_get_iaq_baseline(uint32_t* baseline) {
+    return sgp30_dev_get_iaq_baseline(&sgp30_default_device, baseline);
+}
+
+int16_t sgp30_get_iaq_baseline_start(void) {
+    return sgp30_dev_get_iaq_baseline_start(&sgp30_default_device);
+}
+
+int16_t sgp30_get_iaq_baseline_read(uint32_t* baseline) {
+    return sgp30_dev_get_iaq_baseline_read(&sgp30_default_device, baseline);
+}
+
+int16_t sgp30_set_iaq_baseline(uint32_t baseline) {
+    return sgp30_dev_set_iaq_baseline(&sgp30_default_device, baseline);
+}
+
+int16_t sgp30_set_iaq_baseline_start(uint32_t baseline) {
+    return sgp30_dev_set_iaq_baseline_start(&sgp30_default_device, baseline);
+}
+
+int16_t sgp30_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline) {
+    return sgp30_dev_get_tvoc_inceptive_baseline(&sgp30_default_device,
+                                                 tvoc_inceptive_baseline);
+}
+
+int16_t sgp30_get_tvoc_inceptive_baseline_start(void) {
+    return sgp30_dev_get_tvoc_inceptive_baseline_start(&sgp30_default_device);
+}
+
+int16_t
+sgp30_get_tvoc_inceptive_baseline_read(uint16_t* tvoc_inceptive_baseline) {
+    return sgp30_dev_get_tvoc_inceptive_baseline_read(&sgp30_default_device,
+                                                      tvoc_inceptive_baseline);
+}
+
+int16_t sgp30_set_tvoc_baseline(uint16_t tvoc_baseline) {
+    return sgp30_dev_set_tvoc_baseline(&sgp30_default_device, tvoc_baseline);
+}
+
+int16_t sgp30_set_tvoc_baseline_start(uint16_t tvoc_baseline) {
+    return sgp30_dev_set_tvoc_baseline_start(&sgp30_default_device,
+                                             tvoc_baseline);
+}
+
+int16_t sgp30_measure_iaq_blocking_read(uint16_t* tvoc_ppb,
+                                        uint16_t* co2_eq_ppm) {
+    return sgp30_dev_measure_iaq_blocking_read(&sgp30_default_device, tvoc_ppb,
+                                               co2_eq_ppm);
+}
+
+int16_t sgp30_measure_iaq(void) {
+    return sgp30_dev_measure_iaq(&sgp30_default_device);
+}
+
+int16_t sgp30_read_iaq(uint16_t* tvoc_ppb, uint16_t* co2_eq_ppm) {
+    return sgp30_dev_read_iaq(&sgp30_default_device, tvoc_ppb, co2_eq_ppm);
+}
+
+int16_t sgp30_measure_tvoc_blocking_read(uint16_t* tvoc_ppb) {
+    return sgp30_dev_measure_tvoc_blocking_read(&sgp30_default_device,
+                                                tvoc_ppb);
+}
+
+int16_t sgp30_measure_tvoc(void) {
+    return sgp30_dev_measure_tvoc(&sgp30_default_device);
+}
+
+int16_t sgp30_read_tvoc(uint16_t* tvoc_ppb) {
+    return sgp30_dev_read_tvoc(&sgp30_default_device, tvoc_ppb);
+}
+
+int16_t sgp30_measure_co2_eq_blocking_read(uint16_t* co2_eq_ppm) {
+    return sgp30_dev_measure_co2_eq_blocking_read(&sgp30_default_device,
+                                                  co2_eq_ppm);
+}
+
+int16_t sgp30_measure_co2_eq(void) {
+    return sgp30_dev_measure_co2_eq(&sgp30_default_device);
+}
+
+int16_t sgp30_read_co2_eq(uint16_t* co2_eq_ppm) {
+    return sgp30_dev_read_co2_eq(&sgp30_default_device, co2_eq_ppm);
+}
+
+int16_t sgp30_measure_raw_blocking_read(uint16_t* ethanol_raw_signal,
+                                        uint16_t* h2_raw_signal) {
+    return sgp30_dev_measure_raw_blocking_read(&sgp30_default_device,
+                                               ethanol_raw_signal,
+                                               h2_raw_signal);
+}
+
+int16_t sgp30_measure_raw(void) {
+    return sgp30_dev_measure_raw(&sgp30_default_device);
+}
+
+int16_t sgp30_read_raw(uint16_t* ethanol_raw_signal, uint16_t* h2_raw_signal) {
+    return sgp30_dev_read_raw(&sgp30_default_device, ethanol_raw_signal,
+                              h2_raw_signal);
+}
+
+int16_t sgp30_measure_test(uint16_t* test_result) {
+    return sgp30_dev_measure_test(&sgp30_default_device, test_result);
+}
+
+int16_t sgp30_measure_test_start(void) {
+    return sgp30_dev_measure_test_start(&sgp30_default_device);
+}
+
+int16_t sgp30_measure_test_read(uint16_t* test_result) {
+    return sgp30_dev_measure_test_read(&sgp30_default_device, test_result);
+}
+
+int16_t sgp30_set_absolute_humidity(uint32_t absolute_humidity) {
+    return sgp30_dev_set_absolute_humidity(&sgp30_default_device,
+                                           absolute_humidity);
+}
+
+int16_t sgp30_set_absolute_humidity_start(uint32_t absolute_humidity) {
+    return sgp30_dev_set_absolute_humidity_start(&sgp30_default_device,
+                                                 absolute_humidity);
 }
@@ -34,17 +34,93 @@
 #include "sensirion_arch_config.h"
 #include "sensirion_common.h"
 #include "sensirion_i2c.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_bus.h"
 
 #define SGP30_ERR_UNSUPPORTED_FEATURE_SET (-10)
 #define SGP30_ERR_INVALID_PRODUCT_TYPE (-12)
+#define SGP30_ERR_NOT_READY (-14)
+
+#define SGP30_I2C_ADDRESS 0x58
+
+/*
+ * Maximum execution times of the commands. Each blocking function waits for
+ * this time, while its *_start() or asynchronous measure counterpart returns
+ * immediately: the command is ready at the time it was started plus its
+ * duration, which the device handle records as ready_at_us. Until then, the
+ * sensor does not acknowledge any I2C transfer, so reading the result earlier
+ * fails and can simply be retried. If a clock is installed with
+ * sgp_clock_set(), the read functions check the time themselves and return
+ * SGP30_ERR_NOT_READY without accessing the bus.
+ */
+#define SGP30_CMD_GET_SERIAL_ID_DURATION_US 500
+#define SGP30_CMD_GET_FEATURESET_DURATION_US 10000
+#define SGP30_CMD_MEASURE_TEST_DURATION_US 220000
+#define SGP30_CMD_IAQ_INIT_DURATION_US 10000
+#define SGP30_CMD_IAQ_MEASURE_DURATION_US 12000
+#define SGP30_CMD_GET_IAQ_BASELINE_DURATION_US 10000
+#define SGP30_CMD_SET_IAQ_BASELINE_DURATION_US 10000
+#define SGP30_CMD_RAW_MEASURE_DURATION_US 25000
+#define SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US 10000
+#define SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US 10000
+#define SGP30_CMD_SET_TVOC_BASELINE_DURATION_US 10000
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * struct sgp30_device - handle of one SGP30 sensor
+ *
+ * A handle holds the bus and I2C address of a sensor and the data the driver
+ * caches about it, so several sensors can be used in one program. Initialize
+ * it with sgp30_dev_init(); the members are managed by the driver.
+ *
+ * @bus:                 Bus the sensor is connected to, NULL for the
+ *                       currently selected bus
+ * @i2c_address:         I2C address of the sensor
+ * @capabilities_valid:  Whether the feature set and product type are cached
+ * @feature_set_version: Feature set version, cached by sgp30_dev_probe()
+ * @product_type:        Product type, cached by sgp30_dev_probe()
+ * @serial_id_valid:     Whether the serial id is cached
+ * @serial_id:           Serial id, cached by sgp30_dev_get_serial_id()
+ * @command_duration_us: Execution time of the last command sent to the
+ *                       sensor. Its result can be read once this time has
+ *                       passed since the command was sent.
+ * @ready_at_us:         Time of sgp_clock_now_us() at which the result of the
+ *                       last command sent to the sensor can be read
+ */
+typedef struct {
+    sgp_i2c_bus* bus;
+    uint8_t i2c_address;
+    bool capabilities_valid;
+    uint16_t feature_set_version;
+    uint8_t product_type;
+    bool serial_id_valid;
+    uint64_t serial_id;
+    uint32_t command_duration_us;
+    uint64_t ready_at_us;
+} sgp30_device;
+
+/**
+ * sgp30_dev_init() - initialize the handle of a sensor
+ *
+ * The functions without device handle use a default device at
+ * SGP30_I2C_ADDRESS on the currently selected bus.
+ *
+ * @dev:            The handle to initialize
+ * @bus:            Bus the sensor is connected to, NULL for the currently
+ *                  selected bus
+ * @i2c_address:    I2C address of the sensor, usually SGP30_I2C_ADDRESS
+ */
+void sgp30_dev_init(sgp30_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address);
+
 /**
  * sgp30_probe() - check if SGP sensor is available and initialize it
  *
+ * The feature set and product type of the sensor are read and cached here,
+ * so the commands which depend on them do not need to read them again.
+ *
  * This call aleady initializes the IAQ baselines (sgp30_iaq_init())
  *
  * Return:  STATUS_OK on success,
@@ -62,6 +138,15 @@ int16_t sgp30_probe(void);
  */
 int16_t sgp30_iaq_init(void);
 
+/**
+ * sgp30_iaq_init_start() - start sgp30_iaq_init() without waiting
+ *
+ * No other command must be sent for SGP30_CMD_IAQ_INIT_DURATION_US.
+ *
+ * Return:  STATUS_OK on success.
+ */
+int16_t sgp30_iaq_init_start(void);
+
 /**
  * sgp30_get_driver_version() - Return the driver version
  * Return:  Driver version string
@@ -87,6 +172,29 @@ uint8_t sgp30_get_configured_address(void);
 int16_t sgp30_get_feature_set_version(uint16_t* feature_set_version,
                                       uint8_t* product_type);
 
+/**
+ * sgp30_get_feature_set_version_start() - start reading the feature set
+ * version without waiting
+ *
+ * Use sgp30_get_feature_set_version_read() to get the result after
+ * SGP30_CMD_GET_FEATURESET_DURATION_US.
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgp30_get_feature_set_version_start(void);
+
+/**
+ * sgp30_get_feature_set_version_read() - read the result of
+ * sgp30_get_feature_set_version_start()
+ *
+ * @feature_set_version:    The feature set version
+ * @product_type:           The product type: 0 for sgp30, 1: sgpc3
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgp30_get_feature_set_version_read(uint16_t* feature_set_version,
+                                           uint8_t* product_type);
+
 /**
  * sgp30_get_serial_id() - Retrieve the sensor's serial id
  *
@@ -96,6 +204,25 @@ int16_t sgp30_get_feature_set_version(uint16_t* feature_set_version,
  */
 int16_t sgp30_get_serial_id(uint64_t* serial_id);
 
+/**
+ * sgp30_get_serial_id_start() - start reading the serial id without waiting
+ *
+ * Use sgp30_get_serial_id_read() to get the result after
+ * SGP30_CMD_GET_SERIAL_ID_DURATION_US.
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgp30_get_serial_id_start(void);
+
+/**
+ * sgp30_get_serial_id_read() - read the result of sgp30_get_serial_id_start()
+ *
+ * @serial_id:    Output variable for the serial id
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgp30_get_serial_id_read(uint64_t* serial_id);
+
 /**
  * sgp30_get_iaq_baseline() - read out the baseline from the chip
  *
@@ -115,6 +242,27 @@ int16_t sgp30_get_serial_id(uint64_t* serial_id);
  */
 int16_t sgp30_get_iaq_baseline(uint32_t* baseline);
 
+/**
+ * sgp30_get_iaq_baseline_start() - start reading the baseline without waiting
+ *
+ * Use sgp30_get_iaq_baseline_read() to get the result after
+ * SGP30_CMD_GET_IAQ_BASELINE_DURATION_US.
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_get_iaq_baseline_start(void);
+
+/**
+ * sgp30_get_iaq_baseline_read() - read the result of
+ * sgp30_get_iaq_baseline_start()
+ *
+ * @baseline:   Pointer to raw uint32_t where to store the baseline, see
+ *              sgp30_get_iaq_baseline()
+ *
+ * Return:      STATUS_OK on success, else STATUS_FAIL
+ */
+int16_t sgp30_get_iaq_baseline_read(uint32_t* baseline);
+
 /**
  * sgp30_set_iaq_baseline() - set the on-chip baseline
  * @baseline:   A raw uint32_t baseline
@@ -127,6 +275,18 @@ int16_t sgp30_get_iaq_baseline(uint32_t* baseline);
  */
 int16_t sgp30_set_iaq_baseline(uint32_t baseline);
 
+/**
+ * sgp30_set_iaq_baseline_start() - start sgp30_set_iaq_baseline() without
+ * waiting
+ *
+ * No other command must be sent for SGP30_CMD_SET_IAQ_BASELINE_DURATION_US.
+ *
+ * @baseline:   A raw uint32_t baseline, see sgp30_set_iaq_baseline()
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_set_iaq_baseline_start(uint32_t baseline);
+
 /**
  * sgp30_get_tvoc_inceptive_baseline() - read the chip's tVOC inceptive baseline
  *
@@ -144,6 +304,30 @@ int16_t sgp30_set_iaq_baseline(uint32_t baseline);
  */
 int16_t sgp30_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline);
 
+/**
+ * sgp30_get_tvoc_inceptive_baseline_start() - start reading the tVOC
+ * inceptive baseline without waiting
+ *
+ * Use sgp30_get_tvoc_inceptive_baseline_read() to get the result after
+ * SGP30_CMD_GET_TVOC_INCEPTIVE_BASELINE_DURATION_US.
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_get_tvoc_inceptive_baseline_start(void);
+
+/**
+ * sgp30_get_tvoc_inceptive_baseline_read() - read the result of
+ * sgp30_get_tvoc_inceptive_baseline_start()
+ *
+ * @tvoc_inceptive_baseline:
+ *              Pointer to raw uint16_t where to store the inceptive baseline,
+ *              see sgp30_get_tvoc_inceptive_baseline()
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t
+sgp30_get_tvoc_inceptive_baseline_read(uint16_t* tvoc_inceptive_baseline);
+
 /**
  * sgp30_set_tvoc_baseline() - set the on-chip tVOC baseline
  * @baseline:   A raw uint16_t tVOC baseline
@@ -155,6 +339,18 @@ int16_t sgp30_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline);
  */
 int16_t sgp30_set_tvoc_baseline(uint16_t tvoc_baseline);
 
+/**
+ * sgp30_set_tvoc_baseline_start() - start sgp30_set_tvoc_baseline() without
+ * waiting
+ *
+ * No other command must be sent for SGP30_CMD_SET_TVOC_BASELINE_DURATION_US.
+ *
+ * @baseline:   A raw uint16_t tVOC baseline, see sgp30_set_tvoc_baseline()
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_set_tvoc_baseline_start(uint16_t tvoc_baseline);
+
 /**
  * sgp30_measure_iaq_blocking_read() - Measure IAQ concentrations tVOC, CO2-Eq.
  *
@@ -299,6 +495,26 @@ int16_t sgp30_read_raw(uint16_t* ethanol_raw_signal, uint16_t* h2_raw_signal);
  */
 int16_t sgp30_measure_test(uint16_t* test_result);
 
+/**
+ * sgp30_measure_test_start() - Start the on-chip self-test without waiting
+ *
+ * Use sgp30_measure_test_read() to get the result after
+ * SGP30_CMD_MEASURE_TEST_DURATION_US.
+ *
+ * Return: STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_measure_test_start(void);
+
+/**
+ * sgp30_measure_test_read() - Read the result of sgp30_measure_test_start()
+ *
+ * @test_result:    Allocated buffer to store the chip's error code, see
+ *                  sgp30_measure_test()
+ *
+ * Return: STATUS_OK on a successful self-test, an error code otherwise
+ */
+int16_t sgp30_measure_test_read(uint16_t* test_result);
+
 /**
  * sgp30_set_absolute_humidity() - set the absolute humidity for compensation
  *
@@ -312,6 +528,92 @@ int16_t sgp30_measure_test(uint16_t* test_result);
  */
 int16_t sgp30_set_absolute_humidity(uint32_t absolute_humidity);
 
+/**
+ * sgp30_set_absolute_humidity_start() - start sgp30_set_absolute_humidity()
+ * without waiting
+ *
+ * No other command must be sent for
+ * SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US.
+ *
+ * @absolute_humidity:      absolute humidity in mg/m^3
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp30_set_absolute_humidity_start(uint32_t absolute_humidity);
+
+/*
+ * Variants of the functions above operating on the sensor of the given handle
+ * instead of the default device. Their arguments and return values are the
+ * same, e.g. sgp30_dev_probe(&dev) works like sgp30_probe().
+ */
+
+int16_t sgp30_dev_probe(sgp30_device* dev);
+
+int16_t sgp30_dev_iaq_init(sgp30_device* dev);
+int16_t sgp30_dev_iaq_init_start(sgp30_device* dev);
+
+int16_t sgp30_dev_get_feature_set_version(sgp30_device* dev,
+                                          uint16_t* feature_set_version,
+                                          uint8_t* product_type);
+int16_t sgp30_dev_get_feature_set_version_start(sgp30_device* dev);
+int16_t sgp30_dev_get_feature_set_version_read(sgp30_device* dev,
+                                               uint16_t* feature_set_version,
+                                               uint8_t* product_type);
+
+int16_t sgp30_dev_get_serial_id(sgp30_device* dev, uint64_t* serial_id);
+int16_t sgp30_dev_get_serial_id_start(sgp30_device* dev);
+int16_t sgp30_dev_get_serial_id_read(sgp30_device* dev, uint64_t* serial_id);
+
+int16_t sgp30_dev_get_iaq_baseline(sgp30_device* dev, uint32_t* baseline);
+int16_t sgp30_dev_get_iaq_baseline_start(sgp30_device* dev);
+int16_t sgp30_dev_get_iaq_baseline_read(sgp30_device* dev, uint32_t* baseline);
+
+int16_t sgp30_dev_set_iaq_baseline(sgp30_device* dev, uint32_t baseline);
+int16_t sgp30_dev_set_iaq_baseline_start(sgp30_device* dev, uint32_t baseline);
+
+int16_t sgp30_dev_get_tvoc_inceptive_baseline(
+    sgp30_device* dev, uint16_t* tvoc_inceptive_baseline);
+int16_t sgp30_dev_get_tvoc_inceptive_baseline_start(sgp30_device* dev);
+int16_t sgp30_dev_get_tvoc_inceptive_baseline_read(
+    sgp30_device* dev, uint16_t* tvoc_inceptive_baseline);
+
+int16_t sgp30_dev_set_tvoc_baseline(sgp30_device* dev, uint16_t tvoc_baseline);
+int16_t sgp30_dev_set_tvoc_baseline_start(sgp30_device* dev,
+                                          uint16_t tvoc_baseline);
+
+int16_t sgp30_dev_measure_iaq_blocking_read(sgp30_device* dev,
+                                            uint16_t* tvoc_ppb,
+                                            uint16_t* co2_eq_ppm);
+int16_t sgp30_dev_measure_iaq(sgp30_device* dev);
+int16_t sgp30_dev_read_iaq(sgp30_device* dev, uint16_t* tvoc_ppb,
+                           uint16_t* co2_eq_ppm);
+
+int16_t sgp30_dev_measure_tvoc_blocking_read(sgp30_device* dev,
+                                             uint16_t* tvoc_ppb);
+int16_t sgp30_dev_measure_tvoc(sgp30_device* dev);
+int16_t sgp30_dev_read_tvoc(sgp30_device* dev, uint16_t* tvoc_ppb);
+
+int16_t sgp30_dev_measure_co2_eq_blocking_read(sgp30_device* dev,
+                                               uint16_t* co2_eq_ppm);
+int16_t sgp30_dev_measure_co2_eq(sgp30_device* dev);
+int16_t sgp30_dev_read_co2_eq(sgp30_device* dev, uint16_t* co2_eq_ppm);
+
+int16_t sgp30_dev_measure_raw_blocking_read(sgp30_device* dev,
+                                            uint16_t* ethanol_raw_signal,
+                                            uint16_t* h2_raw_signal);
+int16_t sgp30_dev_measure_raw(sgp30_device* dev);
+int16_t sgp30_dev_read_raw(sgp30_device* dev, uint16_t* ethanol_raw_signal,
+                           uint16_t* h2_raw_signal);
+
+int16_t sgp30_dev_measure_test(sgp30_device* dev, uint16_t* test_result);
+int16_t sgp30_dev_measure_test_start(sgp30_device* dev);
+int16_t sgp30_dev_measure_test_read(sgp30_device* dev, uint16_t* test_result);
+
+int16_t sgp30_dev_set_absolute_humidity(sgp30_device* dev,
+                                        uint32_t absolute_humidity);
+int16_t sgp30_dev_set_absolute_humidity_start(sgp30_device* dev,
+                                              uint32_t absolute_humidity);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,15 +30,14 @@
  */
 
 #include "sgp30.h"
+#include "sgp_periodic.h"
 
 #include <inttypes.h>  // PRIu64
 #include <stdio.h>     // printf
-#include <unistd.h>    // sleep
 
-/* TO USE CONSOLE OUTPUT (printf) AND WAIT (sleep) YOU MAY NEED TO ADAPT THE
+/* TO USE CONSOLE OUTPUT (printf) YOU MAY NEED TO ADAPT THE
  * INCLUDES ABOVE OR DEFINE THEM ACCORDING TO YOUR PLATFORM.
  * #define printf(...)
- * #define sleep(...)
  */
 
 int main(void) {
@@ -47,6 +46,7 @@ int main(void) {
     uint16_t tvoc_ppb, co2_eq_ppm;
     uint32_t iaq_baseline;
     uint16_t ethanol_raw_signal, h2_raw_signal;
+    sgp_periodic periodic;
 
     const char* driver_version = sgp30_get_driver_version();
     if (driver_version) {
@@ -73,7 +73,7 @@ int main(void) {
                 "Your sensor needs at least feature set version 1.0 (0x20)\n");
 
         printf("SGP sensor probing failed\n");
-        sensirion_sleep_usec(1000000);
+        sgp_clock_sleep_usec(1000000);
     }
 
     printf("SGP sensor probing successful\n");
@@ -121,7 +121,14 @@ int main(void) {
      * err = sgp30_set_iaq_baseline(iaq_baseline);
      */
 
-    /* Run periodic IAQ measurements at defined intervals */
+    /* Run periodic IAQ measurements at defined intervals.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 1000000);
     while (1) {
         /*
          * IMPLEMENT: get absolute humidity to enable humidity compensation
@@ -146,9 +153,12 @@ int main(void) {
         }
 
         /* The IAQ measurement must be triggered exactly once per second (SGP30)
-         * to get accurate values.
+         * to get accurate values. The scheduler compensates for the time the
+         * measurement takes.
          */
-        sleep(1);  // SGP30
+        if (sgp_periodic_wait(&periodic)) {
+            printf("IAQ measurement missed\n");
+        }
     }
     return 0;
 }
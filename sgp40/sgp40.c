@@ -32,13 +32,10 @@
 #include "sgp40.h"
 #include "sgp_git_version.h"
 
-static const uint8_t SGP40_I2C_ADDRESS = 0x59;
-
 #define SGP40_CMD_MEASURE_RAW_WORDS 1
 #define SGP40_CMD_MEASURE_RAW 0x260f
 
 /* command and constants for reading the serial ID */
-#define SGP40_CMD_GET_SERIAL_ID_DURATION_US 500
 #define SGP40_CMD_GET_SERIAL_ID_WORDS 3
 #define SGP40_CMD_GET_SERIAL_ID 0x3682
 
@@ -47,14 +44,44 @@ static const uint8_t SGP40_I2C_ADDRESS = 0x59;
 #define SGP40_CMD_GET_FEATURESET_WORDS 1
 #define SGP40_CMD_GET_FEATURESET 0x202f
 
-int16_t sgp40_measure_raw_blocking_read(uint16_t* sraw) {
+/* device used by the functions without device handle */
+static sgp40_device sgp40_default_device = {NULL, SGP40_I2C_ADDRESS};
+
+static int16_t sgp40_acquire_bus(sgp40_device* dev, uint32_t duration_us) {
+    dev->command_duration_us = duration_us;
+    return sgp_i2c_bus_acquire(dev->bus);
+}
+
+static int16_t sgp40_release_bus_after_cmd(sgp40_device* dev, int16_t ret) {
+    if (ret == STATUS_OK)
+        dev->ready_at_us = sgp_clock_now_us() + dev->command_duration_us;
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
+
+static int16_t sgp40_check_ready(const sgp40_device* dev) {
+    /* the default clock only counts the time slept by the drivers */
+    if (sgp_clock_is_set() && sgp_clock_now_us() < dev->ready_at_us)
+        return SGP40_ERR_NOT_READY;
+    return STATUS_OK;
+}
+
+void sgp40_dev_init(sgp40_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address) {
+    dev->bus = bus;
+    dev->i2c_address = i2c_address;
+    dev->serial_id_valid = false;
+    dev->command_duration_us = 0;
+    dev->ready_at_us = 0;
+}
+
+int16_t sgp40_dev_measure_raw_blocking_read(sgp40_device* dev, uint16_t* sraw) {
     int16_t ret;
 
-    ret = sgp40_measure_raw();
+    ret = sgp40_dev_measure_raw(dev);
     if (ret != STATUS_OK)
         return ret;
-    sensirion_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
-    return sgp40_read_raw(sraw);
+    sgp_clock_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
+    return sgp40_dev_read_raw(dev, sraw);
 }
 
 void sgp40_convert_rht(int32_t humidity, int32_t temperature,
@@ -82,34 +109,58 @@ void sgp40_convert_rht(int32_t humidity, int32_t temperature,
     *temperature_sensor_format = (uint16_t)(((temperature + 45000) * 3) >> 3);
 }
 
-int16_t sgp40_measure_raw_with_rht(int32_t humidity, int32_t temperature) {
+int16_t sgp40_dev_measure_raw_with_rht(sgp40_device* dev, int32_t humidity,
+                                       int32_t temperature) {
+    int16_t ret;
     uint16_t args[2];
+
     sgp40_convert_rht(humidity, temperature, &args[0], &args[1]);
-    return sensirion_i2c_write_cmd_with_args(
-        SGP40_I2C_ADDRESS, SGP40_CMD_MEASURE_RAW, args, ARRAY_SIZE(args));
+    ret = sgp40_acquire_bus(dev, SGP40_CMD_MEASURE_RAW_DURATION_US);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sensirion_i2c_write_cmd_with_args(
+        dev->i2c_address, SGP40_CMD_MEASURE_RAW, args, ARRAY_SIZE(args));
+    return sgp40_release_bus_after_cmd(dev, ret);
 }
 
-int16_t sgp40_measure_raw_with_rht_blocking_read(int32_t humidity,
-                                                 int32_t temperature,
-                                                 uint16_t* sraw) {
+int16_t sgp40_dev_measure_raw_with_rht_blocking_read(sgp40_device* dev,
+                                                     int32_t humidity,
+                                                     int32_t temperature,
+                                                     uint16_t* sraw) {
     int16_t error;
-    error = sgp40_measure_raw_with_rht(humidity, temperature);
+    error = sgp40_dev_measure_raw_with_rht(dev, humidity, temperature);
     if (error) {
         return error;
     }
-    sensirion_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
-    return sgp40_read_raw(sraw);
+    sgp_clock_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
+    return sgp40_dev_read_raw(dev, sraw);
 }
 
-int16_t sgp40_measure_raw(void) {
+int16_t sgp40_dev_measure_raw(sgp40_device* dev) {
+    int16_t ret;
     uint16_t args[2] = {SGP40_DEFAULT_HUMIDITY, SGP40_DEFAULT_TEMPERATURE};
-    return sensirion_i2c_write_cmd_with_args(
-        SGP40_I2C_ADDRESS, SGP40_CMD_MEASURE_RAW, args, ARRAY_SIZE(args));
+
+    ret = sgp40_acquire_bus(dev, SGP40_CMD_MEASURE_RAW_DURATION_US);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sensirion_i2c_write_cmd_with_args(
+        dev->i2c_address, SGP40_CMD_MEASURE_RAW, args, ARRAY_SIZE(args));
+    return sgp40_release_bus_after_cmd(dev, ret);
 }
 
-int16_t sgp40_read_raw(uint16_t* sraw) {
-    return sensirion_i2c_read_words(SGP40_I2C_ADDRESS, sraw,
-                                    SENSIRION_NUM_WORDS(*sraw));
+int16_t sgp40_dev_read_raw(sgp40_device* dev, uint16_t* sraw) {
+    int16_t ret;
+
+    ret = sgp40_check_ready(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sensirion_i2c_read_words(dev->i2c_address, sraw,
+                                   SENSIRION_NUM_WORDS(*sraw));
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
 }
 
 const char* sgp40_get_driver_version(void) {
@@ -120,19 +171,104 @@ uint8_t sgp40_get_configured_address(void) {
     return SGP40_I2C_ADDRESS;
 }
 
-int16_t sgp40_get_serial_id(uint8_t* serial_id) {
+int16_t sgp40_dev_get_serial_id(sgp40_device* dev, uint8_t* serial_id) {
     int16_t ret;
+    uint8_t i;
 
-    ret = sensirion_i2c_write_cmd(SGP40_I2C_ADDRESS, SGP40_CMD_GET_SERIAL_ID);
+    if (dev->serial_id_valid) {
+        for (i = 0; i < SGP40_SERIAL_ID_NUM_BYTES; ++i)
+            serial_id[i] = dev->serial_id[i];
+        return STATUS_OK;
+    }
+
+    ret = sgp40_dev_get_serial_id_start(dev);
     if (ret != STATUS_OK)
         return ret;
-    sensirion_sleep_usec(SGP40_CMD_GET_SERIAL_ID_DURATION_US);
-    return sensirion_i2c_read_words_as_bytes(SGP40_I2C_ADDRESS, serial_id,
-                                             SGP40_CMD_GET_SERIAL_ID_WORDS);
+    sgp_clock_sleep_usec(SGP40_CMD_GET_SERIAL_ID_DURATION_US);
+    return sgp40_dev_get_serial_id_read(dev, serial_id);
 }
 
-int16_t sgp40_probe(void) {
+int16_t sgp40_dev_get_serial_id_start(sgp40_device* dev) {
+    int16_t ret;
+
+    ret = sgp40_acquire_bus(dev, SGP40_CMD_GET_SERIAL_ID_DURATION_US);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sensirion_i2c_write_cmd(dev->i2c_address, SGP40_CMD_GET_SERIAL_ID);
+    return sgp40_release_bus_after_cmd(dev, ret);
+}
+
+int16_t sgp40_dev_get_serial_id_read(sgp40_device* dev, uint8_t* serial_id) {
+    int16_t ret;
+    uint8_t i;
+
+    ret = sgp40_check_ready(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+    ret = sensirion_i2c_read_words_as_bytes(dev->i2c_address, serial_id,
+                                            SGP40_CMD_GET_SERIAL_ID_WORDS);
+    sgp_i2c_bus_release(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    for (i = 0; i < SGP40_SERIAL_ID_NUM_BYTES; ++i)
+        dev->serial_id[i] = serial_id[i];
+    dev->serial_id_valid = true;
+    return STATUS_OK;
+}
+
+int16_t sgp40_dev_probe(sgp40_device* dev) {
     uint8_t serial[SGP40_SERIAL_ID_NUM_BYTES];
 
-    return sgp40_get_serial_id(serial);
+    /* read the serial id of the connected sensor again */
+    dev->serial_id_valid = false;
+    return sgp40_dev_get_serial_id(dev, serial);
+}
+
+/*
+ * Functions operating on the default device on the currently selected bus
+ */
+
+int16_t sgp40_probe(void) {
+    return sgp40_dev_probe(&sgp40_default_device);
+}
+
+int16_t sgp40_get_serial_id(uint8_t* serial_id) {
+    return sgp40_dev_get_serial_id(&sgp40_default_device, serial_id);
+}
+
+int16_t sgp40_get_serial_id_start(void) {
+    return sgp40_dev_get_serial_id_start(&sgp40_default_device);
+}
+
+int16_t sgp40_get_serial_id_read(uint8_t* serial_id) {
+    return sgp40_dev_get_serial_id_read(&sgp40_default_device, serial_id);
+}
+
+int16_t sgp40_measure_raw_blocking_read(uint16_t* sraw) {
+    return sgp40_dev_measure_raw_blocking_read(&sgp40_default_device, sraw);
+}
+
+int16_t sgp40_measure_raw_with_rht(int32_t humidity, int32_t temperature) {
+    return sgp40_dev_measure_raw_with_rht(&sgp40_default_device, humidity,
+                                          temperature);
+}
+
+int16_t
+sgp40_measure_raw_with_rht_blocking_read(int32_t humidity, int32_t temperature,
+                                         uint16_t* sraw) {
+    return sgp40_dev_measure_raw_with_rht_blocking_read(&sgp40_default_device,
+                                                        humidity, temperature,
+                                                        sraw);
+}
+
+int16_t sgp40_measure_raw(void) {
+    return sgp40_dev_measure_raw(&sgp40_default_device);
+}
+
+int16_t sgp40_read_raw(uint16_t* sraw) {
+    return sgp40_dev_read_raw(&sgp40_default_device, sraw);
 }
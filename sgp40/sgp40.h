@@ -34,15 +34,71 @@
 #include "sensirion_arch_config.h"
 #include "sensirion_common.h"
 #include "sensirion_i2c.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_bus.h"
+
+#define SGP40_ERR_NOT_READY (-14)
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Maximum execution times of the commands. Each blocking function waits for
+ * this time, while its *_start() or asynchronous measure counterpart returns
+ * immediately: the command is ready at the time it was started plus its
+ * duration, which the device handle records as ready_at_us. Until then, the
+ * sensor does not acknowledge any I2C transfer, so reading the result earlier
+ * fails and can simply be retried. If a clock is installed with
+ * sgp_clock_set(), the read functions check the time themselves and return
+ * SGP40_ERR_NOT_READY without accessing the bus.
+ */
 #define SGP40_CMD_MEASURE_RAW_DURATION_US 100000
+#define SGP40_CMD_GET_SERIAL_ID_DURATION_US 500
 #define SGP40_DEFAULT_HUMIDITY 0x8000
 #define SGP40_DEFAULT_TEMPERATURE 0x6666
 #define SGP40_SERIAL_ID_NUM_BYTES 6
+#define SGP40_I2C_ADDRESS 0x59
+
+/**
+ * struct sgp40_device - handle of one SGP40 sensor
+ *
+ * A handle holds the bus and I2C address of a sensor and the data the driver
+ * caches about it, so several sensors can be used in one program. Initialize
+ * it with sgp40_dev_init(); the members are managed by the driver.
+ *
+ * @bus:                 Bus the sensor is connected to, NULL for the
+ *                       currently selected bus
+ * @i2c_address:         I2C address of the sensor
+ * @serial_id_valid:     Whether the serial id is cached
+ * @serial_id:           Serial id, cached by sgp40_dev_get_serial_id()
+ * @command_duration_us: Execution time of the last command sent to the
+ *                       sensor. Its result can be read once this time has
+ *                       passed since the command was sent.
+ * @ready_at_us:         Time of sgp_clock_now_us() at which the result of the
+ *                       last command sent to the sensor can be read
+ */
+typedef struct {
+    sgp_i2c_bus* bus;
+    uint8_t i2c_address;
+    bool serial_id_valid;
+    uint8_t serial_id[SGP40_SERIAL_ID_NUM_BYTES];
+    uint32_t command_duration_us;
+    uint64_t ready_at_us;
+} sgp40_device;
+
+/**
+ * sgp40_dev_init() - initialize the handle of a sensor
+ *
+ * The functions without device handle use a default device at
+ * SGP40_I2C_ADDRESS on the currently selected bus.
+ *
+ * @dev:            The handle to initialize
+ * @bus:            Bus the sensor is connected to, NULL for the currently
+ *                  selected bus
+ * @i2c_address:    I2C address of the sensor, usually SGP40_I2C_ADDRESS
+ */
+void sgp40_dev_init(sgp40_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address);
 
 /**
  * sgp40_probe() - check if SGP sensor is available
@@ -88,6 +144,22 @@ uint8_t sgp40_get_configured_address(void);
  */
 int16_t sgp40_get_serial_id(uint8_t* serial_id);
 
+/**
+ * sgp40_get_serial_id_start() - Start reading the serial id without waiting
+ * Use sgp40_get_serial_id_read() to get the result after
+ * SGP40_CMD_GET_SERIAL_ID_DURATION_US.
+ * @return: STATUS_OK on success, an error code otherwise
+ */
+int16_t sgp40_get_serial_id_start(void);
+
+/**
+ * sgp40_get_serial_id_read() - Read the result of sgp40_get_serial_id_start()
+ * @serial_id:  Output array for the serial id of type uint8_t
+ *              and length SGP40_SERIAL_ID_NUM_BYTES
+ * @return: STATUS_OK on success
+ */
+int16_t sgp40_get_serial_id_read(uint8_t* serial_id);
+
 /**
  * Convert humidity and temperature in the format used by the sensor.
  *
@@ -165,6 +237,26 @@ int16_t sgp40_measure_raw(void);
  */
 int16_t sgp40_read_raw(uint16_t* sraw);
 
+/*
+ * Variants of the functions above operating on the sensor of the given handle
+ * instead of the default device. Their arguments and return values are the
+ * same, e.g. sgp40_dev_probe(&dev) works like sgp40_probe().
+ */
+
+int16_t sgp40_dev_probe(sgp40_device* dev);
+int16_t sgp40_dev_get_serial_id(sgp40_device* dev, uint8_t* serial_id);
+int16_t sgp40_dev_get_serial_id_start(sgp40_device* dev);
+int16_t sgp40_dev_get_serial_id_read(sgp40_device* dev, uint8_t* serial_id);
+int16_t sgp40_dev_measure_raw_blocking_read(sgp40_device* dev, uint16_t* sraw);
+int16_t sgp40_dev_measure_raw_with_rht(sgp40_device* dev, int32_t humidity,
+                                       int32_t temperature);
+int16_t sgp40_dev_measure_raw_with_rht_blocking_read(sgp40_device* dev,
+                                                     int32_t humidity,
+                                                     int32_t temperature,
+                                                     uint16_t* sraw);
+int16_t sgp40_dev_measure_raw(sgp40_device* dev);
+int16_t sgp40_dev_read_raw(sgp40_device* dev, uint16_t* sraw);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,7 @@
  */
 
 #include "sgp40.h"
+#include "sgp_periodic.h"
 
 #include <stdio.h>  // printf
 
@@ -42,6 +43,7 @@ int main(void) {
     int16_t err;
     uint16_t sraw;
     uint16_t ix;
+    sgp_periodic periodic;
 
     const char* driver_version = sgp40_get_driver_version();
     if (driver_version) {
@@ -58,7 +60,7 @@ int main(void) {
      * a sensor. */
     while (sgp40_probe() != STATUS_OK) {
         printf("SGP sensor probing failed\n");
-        sensirion_sleep_usec(1000000);
+        sgp_clock_sleep_usec(1000000);
     }
     printf("SGP sensor probing successful\n");
 
@@ -74,7 +76,16 @@ int main(void) {
         printf("sgp40_get_serial_id failed!\n");
     }
 
-    /* Run periodic measurements at defined intervals */
+    /* Run periodic measurements at defined intervals. The scheduler starts the
+     * measurements exactly once per second, independent of how long they
+     * take.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 1000000);
     while (1) {
         err = sgp40_measure_raw_blocking_read(&sraw);
         if (err == STATUS_OK) {
@@ -83,7 +94,9 @@ int main(void) {
             printf("error reading signal\n");
         }
 
-        sensirion_sleep_usec(1000000);
+        if (sgp_periodic_wait(&periodic)) {
+            printf("measurement took longer than one second\n");
+        }
     }
 
     return 0;
@@ -53,6 +53,30 @@ static inline int32_t fix16_cast_to_int(fix16_t a) {
     return (a >= 0) ? (a >> 16) : -((-a) >> 16);
 }
 
+/*! Divides the first given positive fix16_t by the second and rounds to the
+ * nearest result like F16(), independent of FIXMATH_NO_ROUNDING. Only used to
+ * derive parameters, not in the per-sample processing. */
+static fix16_t fix16_div_rounded(fix16_t a, fix16_t b) {
+    uint32_t divider = (uint32_t)b;
+    uint32_t quotient = (uint32_t)a / divider;
+    uint32_t remainder = (uint32_t)a % divider;
+    uint8_t i;
+
+    // Long division of the 16 fractional bits, remainder < divider < 2^31
+    for (i = 0; i < 16; ++i) {
+        quotient <<= 1;
+        remainder <<= 1;
+        if (remainder >= divider) {
+            quotient++;
+            remainder -= divider;
+        }
+    }
+    // Round half up, remainder >= divider / 2 without overflow
+    if (remainder >= divider - remainder)
+        quotient++;
+    return (fix16_t)quotient;
+}
+
 /*! Multiplies the two given fix16_t's and returns the result. */
 static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1);
 
@@ -65,6 +89,93 @@ static fix16_t fix16_sqrt(fix16_t inValue);
 /*! Returns the exponent (e^) of the given fix16_t. */
 static fix16_t fix16_exp(fix16_t inValue);
 
+#ifdef FIXMATH_USE_64BIT
+
+static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1) {
+    // Same as the 32-bit implementation below, but using a single 32x32 -> 64
+    // bit multiplication of the absolute values.
+    uint32_t absArg0 = (inArg0 >= 0) ? (uint32_t)inArg0 : -(uint32_t)inArg0;
+    uint32_t absArg1 = (inArg1 >= 0) ? (uint32_t)inArg1 : -(uint32_t)inArg1;
+    uint64_t product = (uint64_t)absArg0 * absArg1;
+
+#ifndef FIXMATH_NO_OVERFLOW
+    // The upper 17 bits should all be zero.
+    if (product >> 47)
+        return (fix16_t)FIX16_OVERFLOW;
+#endif
+
+#ifndef FIXMATH_NO_ROUNDING
+    // Adding 0x8000 (= 0.5) and then using right shift
+    // achieves proper rounding to result.
+    product += 0x8000;
+#endif
+
+    // Discard the lowest 16 bits and convert back to signed result.
+    fix16_t result = (fix16_t)(uint32_t)(product >> 16);
+    if ((inArg0 < 0) != (inArg1 < 0))
+        result = (fix16_t)(0u - (uint32_t)result);
+    return result;
+}
+
+static fix16_t fix16_div(fix16_t a, fix16_t b) {
+    // Same as the 32-bit restoring division below, but using a single 64-bit
+    // division of the absolute values.
+
+    if (b == 0)
+        return (fix16_t)FIX16_MINIMUM;
+
+    uint32_t remainder = (a >= 0) ? (uint32_t)a : -(uint32_t)a;
+    uint32_t divider = (b >= 0) ? (uint32_t)b : -(uint32_t)b;
+    uint32_t quotient;
+
+    if (remainder > ((uint64_t)divider << 15)) {
+        // The quotient does not fit into 32 bits.
+#ifndef FIXMATH_NO_OVERFLOW
+        return (fix16_t)FIX16_OVERFLOW;
+#else
+        // All quotient bits are shifted out in the restoring division, only
+        // its final rounding step may still produce a one.
+        while (divider < remainder)
+            divider <<= 1;
+        if (divider & 0x80000000) {
+            if (remainder >= divider)
+                remainder -= divider;
+            divider >>= 1;
+        }
+        quotient = 0;
+#ifndef FIXMATH_NO_ROUNDING
+        if (remainder >= divider)
+            quotient = 1;
+#endif
+#endif
+    } else {
+        uint64_t dividend = (uint64_t)remainder << 16;
+        quotient = (uint32_t)(dividend / divider);
+
+#ifndef FIXMATH_NO_ROUNDING
+        // Round half up, like the restoring division does.
+        if ((dividend % divider) * 2 >= divider)
+            quotient++;
+#endif
+    }
+
+    fix16_t result = (fix16_t)quotient;
+
+    /* Figure out the sign of result */
+    if ((a < 0) != (b < 0)) {
+#ifndef FIXMATH_NO_OVERFLOW
+        if (result == FIX16_MINIMUM)
+            return (fix16_t)FIX16_OVERFLOW;
+#endif
+
+        result = (fix16_t)(0u - (uint32_t)result);
+    }
+
+    return result;
+}
+
+#else /* FIXMATH_USE_64BIT */
+
 static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1) {
     // Each argument is divided to 16-bit parts.
     //					AB
@@ -75,8 +186,8 @@ static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1) {
     //				 AD
     //				AC
     //			 |----| 64 bit product
-    uint32_t absArg0 = (uint32_t)((inArg0 >= 0) ? inArg0 : (-inArg0));
-    uint32_t absArg1 = (uint32_t)((inArg1 >= 0) ? inArg1 : (-inArg1));
+    uint32_t absArg0 = (inArg0 >= 0) ? (uint32_t)inArg0 : -(uint32_t)inArg0;
+    uint32_t absArg1 = (inArg1 >= 0) ? (uint32_t)inArg1 : -(uint32_t)inArg1;
     uint32_t A = (absArg0 >> 16), C = (absArg1 >> 16);
     uint32_t B = (absArg0 & 0xFFFF), D = (absArg1 & 0xFFFF);
 
@@ -101,7 +212,7 @@ static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1) {
 #ifdef FIXMATH_NO_ROUNDING
     fix16_t result = (fix16_t)((product_hi << 16) | (product_lo >> 16));
     if ((inArg0 < 0) != (inArg1 < 0))
-        result = -result;
+        result = (fix16_t)(0u - (uint32_t)result);
     return result;
 #else
     // Adding 0x8000 (= 0.5) and then using right shift
@@ -115,7 +226,7 @@ static fix16_t fix16_mul(fix16_t inArg0, fix16_t inArg1) {
     // Discard the lowest 16 bits and convert back to signed result.
     fix16_t result = (fix16_t)((product_hi << 16) | (product_lo >> 16));
     if ((inArg0 < 0) != (inArg1 < 0))
-        result = -result;
+        result = (fix16_t)(0u - (uint32_t)result);
     return result;
 #endif
 }
@@ -129,8 +240,8 @@ static fix16_t fix16_div(fix16_t a, fix16_t b) {
     if (b == 0)
         return (fix16_t)FIX16_MINIMUM;
 
-    uint32_t remainder = (uint32_t)((a >= 0) ? a : (-a));
-    uint32_t divider = (uint32_t)((b >= 0) ? b : (-b));
+    uint32_t remainder = (a >= 0) ? (uint32_t)a : -(uint32_t)a;
+    uint32_t divider = (b >= 0) ? (uint32_t)b : -(uint32_t)b;
 
     uint32_t quotient = 0;
     uint32_t bit = 0x10000;
@@ -183,12 +294,14 @@ static fix16_t fix16_div(fix16_t a, fix16_t b) {
             return (fix16_t)FIX16_OVERFLOW;
 #endif
 
-        result = -result;
+        result = (fix16_t)(0u - (uint32_t)result);
     }
 
     return result;
 }
 
+#endif /* FIXMATH_USE_64BIT */
+
 static fix16_t fix16_sqrt(fix16_t x) {
     // It is assumed that x is not negative
 
@@ -246,6 +359,372 @@ static fix16_t fix16_sqrt(fix16_t x) {
     return (fix16_t)result;
 }
 
+#if defined(FIXMATH_EXP_LUT) && defined(FIXMATH_EXP_FAST)
+#error "Only one of FIXMATH_EXP_LUT and FIXMATH_EXP_FAST can be defined"
+#endif
+
+#if defined(FIXMATH_EXP_LUT)
+
+/* Results of the default fix16_exp() implementation below for x = +/- i/64,
+ * i.e. the product of its factors for the integer part and the first two
+ * octal digits of the fraction, rounded after each step like fix16_mul().
+ */
+#define FIX16_EXP_POS_TABLE_SIZE 666
+#define FIX16_EXP_NEG_TABLE_SIZE 755
+#ifndef FIXMATH_NO_ROUNDING
+static const fix16_t fix16_exp_pos_table[FIX16_EXP_POS_TABLE_SIZE] = {
+    65536, 66568, 67616, 68681, 69763, 70862, 71978, 73111, 74262, 75431, 76619,
+    77826, 79052, 80297, 81561, 82845, 84150, 85475, 86821, 88188, 89577, 90988,
+    92421, 93876, 95354, 96856, 98381, 99930, 101504, 103102, 104726, 106375,
+    108050, 109751, 111479, 113234, 115017, 116828, 118668, 120537, 122437,
+    124365, 126323, 128312, 130333, 132385, 134470, 136588, 138739, 140924,
+    143143, 145397, 147687, 150013, 152375, 154774, 157212, 159688, 162203,
+    164757, 167351, 169986, 172663, 175382, 178145, 180950, 183799, 186693,
+    189633, 192619, 195652, 198733, 201865, 205044, 208273, 211553, 214884,
+    218268, 221705, 225196, 228743, 232345, 236004, 239720, 243495, 247329,
+    251224, 255180, 259200, 263282, 267428, 271639, 275917, 280262, 284675,
+    289158, 293712, 298337, 303035, 307807, 312654, 317577, 322578, 327658,
+    332819, 338060, 343383, 348790, 354282, 359861, 365528, 371284, 377133,
+    383072, 389104, 395231, 401455, 407777, 414198, 420720, 427348, 434077,
+    440912, 447855, 454907, 462070, 469346, 476737, 484247, 491872, 499618,
+    507486, 515477, 523594, 531839, 540214, 548724, 557365, 566142, 575057,
+    584112, 593310, 602653, 612143, 621786, 631577, 641522, 651624, 661885,
+    672308, 682895, 693649, 704576, 715671, 726941, 738388, 750015, 761826,
+    773823, 786008, 798389, 810961, 823731, 836702, 849878, 863261, 876855,
+    890663, 904693, 918939, 933410, 948108, 963038, 978203, 993607, 1009253,
+    1025151, 1041294, 1057691, 1074347, 1091265, 1108449, 1125904, 1143634,
+    1161648, 1179941, 1198522, 1217395, 1236565, 1256037, 1275816, 1295906,
+    1316317, 1337045, 1358100, 1379486, 1401209, 1423274, 1445686, 1468451,
+    1491582, 1515070, 1538928, 1563162, 1587777, 1612780, 1638177, 1663973,
+    1690183, 1716798, 1743833, 1771293, 1799186, 1827518, 1856296, 1885527,
+    1915228, 1945387, 1976021, 2007138, 2038745, 2070849, 2103459, 2136582,
+    2170237, 2204412, 2239125, 2274385, 2310200, 2346579, 2383531, 2421065,
+    2459200, 2497925, 2537260, 2577214, 2617798, 2659021, 2700893, 2743424,
+    2786638, 2830519, 2875091, 2920365, 2966352, 3013063, 3060510, 3108704,
+    3157674, 3207398, 3257905, 3309207, 3361317, 3414248, 3468012, 3522623,
+    3578114, 3634459, 3691691, 3749824, 3808873, 3868852, 3929775, 3991657,
+    4054533, 4118380, 4183232, 4249106, 4316017, 4383982, 4453017, 4523139,
+    4594387, 4666735, 4740222, 4814867, 4890687, 4967701, 5045928, 5125387,
+    5206121, 5288102, 5371374, 5455957, 5541872, 5629140, 5717782, 5807820,
+    5899307, 5992204, 6086564, 6182410, 6279765, 6378653, 6479098, 6581125,
+    6684789, 6790055, 6896978, 7005585, 7115902, 7227957, 7341776, 7457387,
+    7574857, 7694139, 7815299, 7938367, 8063373, 8190348, 8319322, 8450327,
+    8583436, 8718600, 8855892, 8995346, 9136996, 9280877, 9427024, 9575472,
+    9726305, 9879466, 10035039, 10193061, 10353572, 10516610, 10682216,
+    10850430, 11021345, 11194899, 11371186, 11550249, 11732132, 11916879,
+    12104535, 12295146, 12488817, 12685479, 12885238, 13088143, 13294243,
+    13503588, 13716230, 13932220, 14151680, 14374528, 14600885, 14830806,
+    15064348, 15301567, 15542522, 15787271, 16035951, 16288470, 16544966,
+    16805501, 17070138, 17338943, 17611981, 17889318, 18171109, 18457251,
+    18747899, 19043123, 19342996, 19647592, 19956984, 20271248, 20590559,
+    20914800, 21244147, 21578680, 21918481, 22263633, 22614220, 22970328,
+    23332155, 23699568, 24072767, 24451843, 24836888, 25227996, 25625263,
+    26028786, 26438791, 26855125, 27278015, 27707564, 28143877, 28587061,
+    29037223, 29494474, 29959068, 30430836, 30910033, 31396775, 31891182,
+    32393375, 32903476, 33421609, 33948064, 34482647, 35025648, 35577199,
+    36137436, 36706495, 37284515, 37871637, 38468187, 39073948, 39689248,
+    40314237, 40949068, 41593896, 42248878, 42914174, 43590157, 44276574,
+    44973800, 45682006, 46401364, 47132050, 47874242, 48628121, 49394108,
+    50171920, 50961981, 51764483, 52579622, 53407597, 54248610, 55102867,
+    55970844, 56852221, 57747477, 58656831, 59580504, 60518722, 61471715,
+    62439714, 63423261, 64421992, 65436450, 66466882, 67513541, 68576681,
+    69656563, 70753450, 71867957, 72999667, 74149198, 75316831, 76502850,
+    77707546, 78931212, 80174147, 81437046, 82719441, 84022030, 85345131,
+    86689067, 88054166, 89440761, 90849191, 92280242, 93733385, 95209411,
+    96708680, 98231558, 99778417, 101349635, 102945595, 104567190, 106213817,
+    107886373, 109585267, 111310914, 113063735, 114844158, 116652617, 118490122,
+    120355994, 122251248, 124176347, 126131761, 128117967, 130135450, 132184702,
+    134266868, 136381178, 138528782, 140710204, 142925977, 145176642, 147462749,
+    149784855, 152144259, 154540085, 156973639, 159445514, 161956314, 164506651,
+    167097149, 169728440, 172401992, 175116818, 177874395, 180675396, 183520504,
+    186410414, 189345832, 192327474, 195357013, 198433314, 201558057, 204732006,
+    207955935, 211230632, 214556896, 217935539, 221368446, 224854350, 228395147,
+    231991701, 235644891, 239355608, 243124758, 246953261, 250843255, 254793301,
+    258805549, 262880978, 267020583, 271225375, 275496380, 279834641, 284242581,
+    288718569, 293265041, 297883106, 302573892, 307338544, 312178226, 317094118,
+    322088967, 327160925, 332312751, 337545703, 342861059, 348260116, 353744193,
+    359314628, 364974531, 370721811, 376559593, 382489303, 388512389, 394630321,
+    400844592, 407156720, 413570230, 420082749, 426697822, 433417063, 440242112,
+    447174635, 454216325, 461368901, 468636359, 476016009, 483511867, 491125762,
+    498859554, 506715130, 514694409, 522799338, 531034471, 539396708, 547890626,
+    556518298, 565281831, 574183364, 583225070, 592409156, 601740751, 611216405,
+    620841273, 630617704, 640548085, 650634841, 660880434, 671287365, 681861445,
+    692598765, 703505166, 714583311, 725835905, 737265694, 748875469, 760668064,
+    772650065, 784817040, 797175609, 809728789, 822479645, 835431290, 848586885,
+    861949642, 875527025, 889314011, 903318101, 917542715, 931991325, 946667458,
+    961574697, 976716681, 992101867, 1007724565, 1023593275, 1039711870,
+    1056084286, 1072714520, 1089606631, 1106764743, 1124198438, 1141901270,
+    1159882870, 1178147627, 1196700001, 1215544520, 1234685785, 1254128469,
+    1273883429, 1293943361, 1314319178, 1335015855, 1356038444, 1377392077,
+    1399081967, 1421113409, 1443498777, 1466229654, 1489318475, 1512770878,
+    1536592587, 1560789419, 1585367280, 1610332170, 1635698031, 1661455483,
+    1687618539, 1714193587, 1741187114, 1768605710, 1796456068, 1824744988,
+    1853488269, 1882675279, 1912321899, 1942435366, 1973023032, 2004092364,
+    2035650947, 2067706486, 2100276883, 2133350091,};
+static const fix16_t fix16_exp_neg_table[FIX16_EXP_NEG_TABLE_SIZE] = {
+    65536, 64520, 63520, 62535, 61566, 60612, 59672, 58747, 57835, 56938, 56055,
+    55186, 54330, 53488, 52659, 51843, 51039, 50248, 49469, 48702, 47947, 47204,
+    46472, 45752, 45042, 44344, 43657, 42980, 42314, 41658, 41012, 40376, 39749,
+    39133, 38526, 37929, 37341, 36762, 36192, 35631, 35078, 34534, 33999, 33472,
+    32953, 32442, 31939, 31444, 30956, 30476, 30004, 29539, 29081, 28630, 28186,
+    27749, 27318, 26894, 26477, 26067, 25663, 25265, 24873, 24487, 24109, 23735,
+    23367, 23005, 22648, 22297, 21951, 21611, 21276, 20946, 20621, 20301, 19986,
+    19676, 19371, 19071, 18776, 18485, 18198, 17916, 17638, 17365, 17096, 16831,
+    16570, 16313, 16060, 15811, 15566, 15325, 15087, 14853, 14623, 14396, 14173,
+    13953, 13737, 13524, 13314, 13108, 12905, 12705, 12508, 12314, 12123, 11935,
+    11750, 11568, 11389, 11212, 11038, 10867, 10699, 10533, 10370, 10209, 10051,
+    9895, 9742, 9591, 9442, 9296, 9152, 9010, 8869, 8732, 8597, 8464, 8333,
+    8204, 8077, 7952, 7827, 7706, 7587, 7469, 7353, 7239, 7127, 7017, 6907,
+    6800, 6695, 6591, 6489, 6388, 6289, 6192, 6095, 6001, 5908, 5816, 5726,
+    5637, 5550, 5464, 5379, 5296, 5214, 5133, 5053, 4975, 4898, 4822, 4747,
+    4673, 4601, 4530, 4460, 4391, 4323, 4256, 4189, 4124, 4060, 3997, 3935,
+    3874, 3814, 3755, 3697, 3640, 3584, 3528, 3473, 3419, 3366, 3314, 3263,
+    3212, 3162, 3113, 3065, 3017, 2970, 2924, 2880, 2835, 2791, 2748, 2705,
+    2663, 2622, 2581, 2542, 2503, 2464, 2426, 2388, 2351, 2315, 2279, 2243,
+    2208, 2174, 2140, 2107, 2074, 2042, 2010, 1979, 1948, 1918, 1888, 1859,
+    1830, 1802, 1774, 1746, 1719, 1692, 1666, 1640, 1615, 1590, 1565, 1541,
+    1517, 1493, 1470, 1447, 1425, 1403, 1381, 1360, 1339, 1318, 1298, 1278,
+    1258, 1238, 1219, 1200, 1181, 1163, 1145, 1127, 1110, 1093, 1076, 1059,
+    1043, 1027, 1011, 995, 980, 965, 950, 935, 921, 907, 893, 879, 865, 852,
+    839, 825, 812, 799, 787, 775, 763, 751, 739, 728, 717, 706, 695, 684, 673,
+    663, 653, 642, 632, 622, 612, 603, 594, 585, 576, 567, 558, 549, 540, 532,
+    524, 516, 508, 500, 492, 484, 476, 469, 462, 455, 448, 441, 434, 427, 420,
+    413, 407, 401, 395, 389, 383, 377, 371, 365, 359, 353, 348, 343, 338, 333,
+    328, 323, 318, 313, 308, 303, 298, 293, 288, 284, 280, 276, 272, 267, 263,
+    259, 255, 251, 247, 243, 239, 236, 232, 228, 224, 221, 218, 215, 212, 208,
+    205, 202, 199, 196, 193, 190, 187, 184, 181, 178, 175, 172, 169, 166, 163,
+    162, 159, 157, 155, 153, 151, 149, 147, 143, 141, 139, 137, 135, 133, 131,
+    129, 126, 124, 122, 120, 118, 116, 114, 112, 111, 109, 107, 105, 103, 101,
+    99, 97, 98, 96, 95, 94, 93, 92, 91, 90, 86, 85, 84, 83, 82, 81, 80, 79, 76,
+    75, 74, 73, 72, 71, 70, 69, 67, 66, 65, 64, 63, 62, 61, 60, 60, 59, 58, 57,
+    56, 55, 54, 53, 53, 52, 51, 50, 49, 48, 47, 46, 47, 46, 45, 44, 43, 42, 41,
+    40, 41, 40, 39, 38, 37, 36, 35, 34, 36, 35, 34, 33, 32, 32, 32, 32, 32, 32,
+    32, 32, 32, 32, 32, 32, 28, 28, 28, 28, 28, 28, 28, 28, 25, 25, 25, 25, 25,
+    25, 25, 25, 22, 22, 22, 22, 22, 22, 22, 22, 19, 19, 19, 19, 19, 19, 19, 19,
+    17, 17, 17, 17, 17, 17, 17, 17, 15, 15, 15, 15, 15, 15, 15, 15, 13, 13, 13,
+    13, 13, 13, 13, 13, 11, 11, 11, 11, 11, 11, 11, 11, 10, 10, 10, 10, 10, 10,
+    10, 10, 9, 9, 9, 9, 9, 9, 9, 9, 8, 8, 8, 8, 8, 8, 8, 8, 7, 7, 7, 7, 7, 7, 7,
+    7, 6, 6, 6, 6, 6, 6, 6, 6, 5, 5, 5, 5, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,};
+#else /* FIXMATH_NO_ROUNDING */
+static const fix16_t fix16_exp_pos_table[FIX16_EXP_POS_TABLE_SIZE] = {
+    65536, 66568, 67616, 68680, 69761, 70859, 71974, 73107, 74262, 75431, 76618,
+    77824, 79049, 80293, 81557, 82841, 84149, 85474, 86819, 88186, 89574, 90984,
+    92416, 93871, 95353, 96854, 98379, 99928, 101501, 103099, 104722, 106371,
+    108049, 109750, 111478, 113233, 115016, 116827, 118666, 120534, 122435,
+    124362, 126320, 128309, 130329, 132381, 134465, 136582, 138736, 140920,
+    143139, 145393, 147682, 150007, 152369, 154768, 157208, 159683, 162197,
+    164751, 167345, 169980, 172656, 175374, 178145, 180950, 183799, 186693,
+    189632, 192618, 195651, 198731, 201864, 205042, 208270, 211549, 214880,
+    218263, 221700, 225191, 228741, 232343, 236001, 239717, 243491, 247325,
+    251219, 255174, 259197, 263278, 267423, 271634, 275911, 280255, 284668,
+    289150, 293708, 298333, 303030, 307801, 312647, 317570, 322570, 327649,
+    332814, 338054, 343377, 348784, 354276, 359854, 365520, 371275, 377127,
+    383065, 389097, 395224, 401447, 407768, 414189, 420711, 427340, 434069,
+    440904, 447846, 454898, 462061, 469337, 476727, 484247, 491872, 499617,
+    507484, 515475, 523592, 531837, 540211, 548723, 557363, 566139, 575054,
+    584109, 593307, 602649, 612138, 621784, 631575, 641520, 651622, 661883,
+    672305, 682891, 693644, 704573, 715667, 726936, 738383, 750010, 761820,
+    773816, 786001, 798385, 810957, 823727, 836698, 849873, 863256, 876849,
+    890656, 904688, 918934, 933404, 948102, 963031, 978195, 993598, 1009244,
+    1025145, 1041288, 1057685, 1074340, 1091257, 1108441, 1125895, 1143624,
+    1161641, 1179933, 1198513, 1217386, 1236556, 1256028, 1275806, 1295896,
+    1316317, 1337045, 1358099, 1379485, 1401207, 1423271, 1445683, 1468448,
+    1491582, 1515070, 1538927, 1563160, 1587775, 1612777, 1638173, 1663969,
+    1690183, 1716798, 1743832, 1771292, 1799184, 1827515, 1856293, 1885524,
+    1915227, 1945386, 1976020, 2007136, 2038742, 2070846, 2103455, 2136578,
+    2170236, 2204410, 2239122, 2274381, 2310195, 2346573, 2383524, 2421057,
+    2459199, 2497924, 2537258, 2577212, 2617795, 2659017, 2700888, 2743419,
+    2786636, 2830517, 2875089, 2920363, 2966350, 3013061, 3060507, 3108701,
+    3157671, 3207395, 3257902, 3309204, 3361314, 3414244, 3468008, 3522618,
+    3578114, 3634458, 3691690, 3749823, 3808871, 3868849, 3929772, 3991654,
+    4054533, 4118380, 4183232, 4249105, 4316015, 4383979, 4453013, 4523134,
+    4594386, 4666734, 4740221, 4814865, 4890685, 4967698, 5045924, 5125382,
+    5206120, 5288101, 5371373, 5455956, 5541871, 5629139, 5717781, 5807819,
+    5899305, 5992201, 6086560, 6182405, 6279759, 6378646, 6479090, 6581116,
+    6684786, 6790051, 6896974, 7005581, 7115898, 7227952, 7341771, 7457382,
+    7574853, 7694134, 7815294, 7938361, 8063366, 8190340, 8319313, 8450317,
+    8583430, 8718593, 8855885, 8995339, 9136989, 9280869, 9427015, 9575462,
+    9726304, 9879464, 10035036, 10193058, 10353568, 10516606, 10682211,
+    10850424, 11021343, 11194896, 11371182, 11550244, 11732126, 11916872,
+    12104527, 12295137, 12488814, 12685476, 12885235, 13088139, 13294238,
+    13503583, 13716224, 13932214, 14151677, 14374524, 14600880, 14830801,
+    15064342, 15301561, 15542515, 15787264, 16035947, 16288466, 16544961,
+    16805495, 17070132, 17338936, 17611973, 17889309, 18171104, 18457245,
+    18747892, 19043116, 19342989, 19647584, 19956975, 20271238, 20590553,
+    20914793, 21244139, 21578671, 21918471, 22263622, 22614208, 22970315,
+    23332147, 23699559, 24072757, 24451832, 24836876, 25227984, 25625250,
+    26028772, 26438788, 26855121, 27278010, 27707558, 28143870, 28587053,
+    29037215, 29494466, 29959064, 30430831, 30910027, 31396769, 31891176,
+    32393368, 32903468, 33421601, 33948059, 34482641, 35025641, 35577192,
+    36137428, 36706486, 37284505, 37871626, 38468181, 39073942, 39689242,
+    40314231, 40949062, 41593889, 42248870, 42914165, 43590149, 44276566,
+    44973792, 45681997, 46401354, 47132039, 47874230, 48628108, 49394098,
+    50171910, 50961970, 51764471, 52579609, 53407583, 54248595, 55102851,
+    55970832, 56852208, 57747463, 58656816, 59580489, 60518707, 61471699,
+    62439698, 63423247, 64421977, 65436434, 66466866, 67513524, 68576664,
+    69656545, 70753431, 71867948, 72999657, 74149187, 75316819, 76502838,
+    77707533, 78931198, 80174133, 81437035, 82719429, 84022017, 85345117,
+    86689052, 88054150, 89440744, 90849173, 92280229, 93733372, 95209397,
+    96708666, 98231544, 99778403, 101349620, 102945579, 104567174, 106213800,
+    107886356, 109585250, 111310896, 113063716, 114844138, 116652596, 118490104,
+    120355975, 122251229, 124176327, 126131740, 128117945, 130135427, 132184678,
+    134266847, 136381156, 138528759, 140710181, 142925954, 145176619, 147462725,
+    149784830, 152144235, 154540060, 156973613, 159445487, 161956286, 164506623,
+    167097120, 169728410, 172401965, 175116790, 177874366, 180675366, 183520473,
+    186410382, 189345799, 192327440, 195356988, 198433288, 201558030, 204731978,
+    207955906, 211230602, 214556865, 217935507, 221368418, 224854322, 228395118,
+    231991671, 235644860, 239355576, 243124725, 246953227, 250843222, 254793267,
+    258805514, 262880942, 267020546, 271225337, 275496341, 279834601, 284242543,
+    288718530, 293265000, 297883064, 302573849, 307338500, 312178180, 317094071,
+    322088924, 327160880, 332312705, 337545656, 342861011, 348260067, 353744142,
+    359314575, 364974482, 370721760, 376559541, 382489250, 388512335, 394630266,
+    400844536, 407156663, 413570174, 420082692, 426697763, 433417002, 440242050,
+    447174572, 454216261, 461368836, 468636295, 476015943, 483511799, 491125693,
+    498859483, 506715058, 514694335, 522799262, 531034402, 539396638, 547890554,
+    556518225, 565281756, 574183287, 583224991, 592409075, 601740673, 611216325,
+    620841191, 630617620, 640548000, 650634754, 660880345, 671287274, 681861356,
+    692598674, 703505074, 714583217, 725835809, 737265596, 748875369, 760667962,
+    772649963, 784816936, 797175503, 809728681, 822479535, 835431178, 848586771,
+    861949526, 875526909, 889313892, 903317980, 917542591, 931991198, 946667328,
+    961574564, 976716546, 992101735, 1007724430, 1023593137, 1039711730,
+    1056084143, 1072714374, 1089606482, 1106764591, 1124198288, 1141901117,
+    1159882714, 1178147468, 1196699839, 1215544355, 1234685617, 1254128298,
+    1273883259, 1293943188, 1314319002, 1335015675, 1356038260, 1377391889,
+    1399081775, 1421113214, 1443498589, 1466229462, 1489318280, 1512770679,
+    1536592385, 1560789213, 1585367070, 1610331956, 1635697818, 1661455266,
+    1687618318, 1714193362, 1741186885, 1768605477, 1796455831, 1824744747,
+    1853488027, 1882675033, 1912321649, 1942435112, 1973022774, 2004092102,
+    2035650681, 2067706215, 2100276609, 2133349812,};
+static const fix16_t fix16_exp_neg_table[FIX16_EXP_NEG_TABLE_SIZE] = {
+    65536, 64520, 63519, 62534, 61564, 60609, 59669, 58743, 57835, 56938, 56055,
+    55185, 54329, 53486, 52656, 51839, 51038, 50246, 49467, 48700, 47945, 47201,
+    46469, 45748, 45040, 44341, 43653, 42976, 42309, 41653, 41007, 40371, 39747,
+    39130, 38523, 37925, 37337, 36758, 36188, 35626, 35076, 34532, 33996, 33468,
+    32949, 32438, 31935, 31439, 30954, 30474, 30001, 29535, 29077, 28626, 28182,
+    27745, 27316, 26892, 26475, 26064, 25659, 25261, 24869, 24483, 24109, 23735,
+    23367, 23004, 22647, 22295, 21949, 21608, 21276, 20946, 20621, 20301, 19986,
+    19676, 19370, 19069, 18775, 18483, 18196, 17913, 17635, 17361, 17091, 16826,
+    16568, 16311, 16058, 15809, 15563, 15321, 15083, 14849, 14621, 14394, 14170,
+    13950, 13733, 13520, 13310, 13103, 12902, 12701, 12504, 12310, 12119, 11931,
+    11746, 11563, 11385, 11208, 11034, 10862, 10693, 10527, 10363, 10202, 10047,
+    9891, 9737, 9586, 9437, 9290, 9145, 9003, 8869, 8731, 8595, 8461, 8329,
+    8199, 8071, 7945, 7826, 7704, 7584, 7466, 7350, 7236, 7123, 7012, 6906,
+    6798, 6692, 6588, 6485, 6384, 6285, 6187, 6094, 5999, 5905, 5813, 5722,
+    5633, 5545, 5459, 5377, 5293, 5210, 5129, 5049, 4970, 4892, 4816, 4745,
+    4671, 4598, 4526, 4455, 4385, 4317, 4250, 4187, 4122, 4058, 3995, 3933,
+    3872, 3811, 3751, 3694, 3636, 3579, 3523, 3468, 3414, 3361, 3308, 3262,
+    3211, 3161, 3111, 3062, 3014, 2967, 2921, 2878, 2833, 2789, 2745, 2702,
+    2660, 2618, 2577, 2539, 2499, 2460, 2421, 2383, 2346, 2309, 2273, 2240,
+    2205, 2170, 2136, 2102, 2069, 2036, 2004, 1976, 1945, 1914, 1884, 1854,
+    1825, 1796, 1768, 1743, 1715, 1688, 1661, 1635, 1609, 1584, 1559, 1538,
+    1514, 1490, 1466, 1443, 1420, 1397, 1375, 1357, 1335, 1314, 1293, 1272,
+    1252, 1232, 1212, 1200, 1181, 1162, 1143, 1125, 1107, 1089, 1072, 1058,
+    1041, 1024, 1008, 992, 976, 960, 945, 933, 918, 903, 889, 875, 861, 847,
+    833, 823, 810, 797, 784, 771, 759, 747, 735, 726, 714, 702, 691, 680, 669,
+    658, 647, 640, 630, 620, 610, 600, 590, 580, 571, 564, 555, 546, 537, 528,
+    519, 510, 502, 497, 489, 481, 473, 465, 457, 449, 442, 441, 434, 427, 420,
+    413, 406, 399, 392, 389, 382, 376, 370, 364, 358, 352, 346, 343, 337, 331,
+    325, 319, 314, 309, 304, 302, 297, 292, 287, 282, 277, 272, 267, 266, 261,
+    256, 252, 248, 244, 240, 236, 234, 230, 226, 222, 218, 214, 210, 206, 206,
+    202, 198, 194, 190, 187, 184, 181, 181, 178, 175, 172, 169, 166, 163, 160,
+    162, 159, 156, 153, 150, 147, 144, 141, 142, 139, 136, 133, 130, 127, 125,
+    123, 125, 123, 121, 119, 117, 115, 113, 111, 110, 108, 106, 104, 102, 100,
+    98, 96, 97, 95, 93, 91, 89, 87, 85, 83, 85, 83, 81, 79, 77, 75, 73, 71, 75,
+    73, 71, 69, 67, 65, 63, 62, 66, 64, 63, 62, 61, 60, 59, 58, 59, 58, 57, 56,
+    55, 54, 53, 52, 52, 51, 50, 49, 48, 47, 46, 45, 45, 44, 43, 42, 41, 40, 39,
+    38, 39, 38, 37, 36, 35, 34, 33, 32, 34, 33, 32, 31, 30, 29, 28, 27, 30, 29,
+    28, 27, 26, 25, 24, 23, 26, 25, 24, 23, 22, 21, 20, 19, 22, 21, 20, 19, 18,
+    17, 16, 15, 21, 20, 19, 18, 17, 16, 15, 14, 18, 17, 16, 15, 14, 13, 12, 11,
+    15, 14, 13, 12, 11, 10, 9, 8, 13, 12, 11, 10, 9, 8, 7, 6, 11, 10, 9, 8, 7,
+    6, 5, 4, 9, 8, 7, 6, 5, 4, 3, 2, 7, 6, 5, 4, 3, 2, 1, 0, 6, 5, 4, 3, 2, 1,
+    0, 0, 7, 6, 5, 4, 3, 2, 1, 0, 6, 5, 4, 3, 2, 1, 0, 0, 5, 4, 3, 2, 1, 0, 0,
+    0, 4, 3, 2, 1, 0, 0, 0, 0, 3, 2, 1, 0, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0,
+    1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0,};
+#endif /* FIXMATH_NO_ROUNDING */
+
+static fix16_t fix16_exp(fix16_t x) {
+    // Same result as the default implementation below, but looks up the
+    // product of the factors for the 1, 1/8 and 1/64 steps and only applies
+    // the remaining 1/512 steps
+
+    fix16_t res, step;
+    const fix16_t* table;
+    uint16_t i;
+
+    if (x >= F16(10.3972))
+        return FIX16_MAXIMUM;
+    if (x <= F16(-11.7835))
+        return 0;
+
+    if (x < 0) {
+        x = -x;
+        table = fix16_exp_neg_table;
+        step = F16(0.9980488);
+    } else {
+        table = fix16_exp_pos_table;
+        step = F16(1.0019550);
+    }
+
+    res = table[x >> 10];
+    for (i = (uint16_t)((x >> 7) & 7); i > 0; i--) {
+        res = fix16_mul(res, step);
+    }
+    return res;
+}
+
+#elif defined(FIXMATH_EXP_FAST)
+
+static fix16_t fix16_exp(fix16_t x) {
+    // Computes exp(x) = 2^k * 2^f with k = floor(x * log2(e)) and f in [0, 1)
+    // using a minimax polynomial for 2^f. The result is within 2 LSB of the
+    // correctly rounded value, independent of FIXMATH_NO_ROUNDING.
+
+    // log2(e) in Q40
+    static const int64_t log2_e = 1586259972792;
+    // Coefficients of 2^f for f in [0, 1) in Q31, constant term first
+#define NUM_EXP2_COEFFICIENTS 8
+    static const uint32_t exp2_coefficients[NUM_EXP2_COEFFICIENTS] = {
+        2147483648u, 1488522248u, 515882234u, 119196347u,
+        20645951u,   2882491u,    308205u,    46172u};
+
+    uint64_t y;
+    uint32_t res, f;
+    uint16_t i, shift;
+
+    if (x >= F16(10.3972))
+        return FIX16_MAXIMUM;
+    if (x <= F16(-11.7835))
+        return 0;
+
+    // x * log2(e) in Q56, offset by 32 to get k + 32 with an unsigned shift
+    y = (uint64_t)(x * log2_e) + ((uint64_t)32 << 56);
+    f = (uint32_t)(y >> 24);
+
+    res = exp2_coefficients[NUM_EXP2_COEFFICIENTS - 1];
+    for (i = NUM_EXP2_COEFFICIENTS - 1; i > 0; i--) {
+        res = exp2_coefficients[i - 1] +
+              (uint32_t)(((uint64_t)res * f + 0x80000000u) >> 32);
+    }
+
+    // Convert 2^f from Q31 to fix16_t and scale by 2^k, i.e. shift right by
+    // 15 - k, which is in the range 1..32
+    shift = (uint16_t)(47 - (y >> 56));
+    return (fix16_t)(((uint64_t)res + ((uint64_t)1 << (shift - 1))) >> shift);
+}
+
+#else /* FIXMATH_EXP_LUT / FIXMATH_EXP_FAST */
+
 static fix16_t fix16_exp(fix16_t x) {
     // Function to approximate exp(); optimized more for code size than speed
 
@@ -284,87 +763,145 @@ static fix16_t fix16_exp(fix16_t x) {
     return res;
 }
 
+#endif /* FIXMATH_EXP_LUT / FIXMATH_EXP_FAST */
+
+/*! Returns F16(1.) + fix16_exp(x). A saturated fix16_exp() wraps around to a
+ * negative sum as in the reference, computed unsigned as a signed overflow is
+ * undefined and gave different results depending on the fix16_div() inlined.
+ */
+static fix16_t fix16_one_plus_exp(fix16_t x) {
+    return (fix16_t)((uint32_t)F16(1.) + (uint32_t)fix16_exp(x));
+}
+
 static void VocAlgorithm__init_instances(VocAlgorithmParams* params);
+static void VocAlgorithm__init_config_instances(VocAlgorithmConfig* config);
+static void
+VocAlgorithm__init_state_instances(const VocAlgorithmConfig* config,
+                                   VocAlgorithmState* state);
+static inline fix16_t VocAlgorithm__process(const VocAlgorithmConfig* config,
+                                            VocAlgorithmState* state,
+                                            int32_t sraw);
 static void
-VocAlgorithm__mean_variance_estimator__init(VocAlgorithmParams* params);
-static void VocAlgorithm__mean_variance_estimator___init_instances(
-    VocAlgorithmParams* params);
+VocAlgorithm__mean_variance_estimator__init(VocAlgorithmState* state,
+                                            fix16_t std_initial);
 static void VocAlgorithm__mean_variance_estimator__set_parameters(
-    VocAlgorithmParams* params, fix16_t std_initial,
-    fix16_t tau_mean_variance_hours, fix16_t gating_max_duration_minutes);
+    VocAlgorithmConfig* config, fix16_t tau_mean_variance_hours,
+    fix16_t gating_max_duration_minutes);
 static void
-VocAlgorithm__mean_variance_estimator__set_states(VocAlgorithmParams* params,
+VocAlgorithm__mean_variance_estimator__set_states(VocAlgorithmState* state,
                                                   fix16_t mean, fix16_t std,
                                                   fix16_t uptime_gamma);
-static fix16_t
-VocAlgorithm__mean_variance_estimator__get_std(VocAlgorithmParams* params);
-static fix16_t
-VocAlgorithm__mean_variance_estimator__get_mean(VocAlgorithmParams* params);
+static fix16_t VocAlgorithm__mean_variance_estimator__get_std(
+    const VocAlgorithmState* state);
+static fix16_t VocAlgorithm__mean_variance_estimator__get_mean(
+    const VocAlgorithmState* state);
 static void VocAlgorithm__mean_variance_estimator___calculate_gamma(
-    VocAlgorithmParams* params, fix16_t voc_index_from_prior);
+    const VocAlgorithmConfig* config, VocAlgorithmState* state,
+    fix16_t voc_index_from_prior, fix16_t* gamma_mean_gated,
+    fix16_t* gamma_variance_gated);
 static void VocAlgorithm__mean_variance_estimator__process(
-    VocAlgorithmParams* params, fix16_t sraw, fix16_t voc_index_from_prior);
-static void VocAlgorithm__mean_variance_estimator___sigmoid__init(
-    VocAlgorithmParams* params);
-static void VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-    VocAlgorithmParams* params, fix16_t L, fix16_t X0, fix16_t K);
-static fix16_t VocAlgorithm__mean_variance_estimator___sigmoid__process(
-    VocAlgorithmParams* params, fix16_t sample);
-static void VocAlgorithm__mox_model__init(VocAlgorithmParams* params);
-static void VocAlgorithm__mox_model__set_parameters(VocAlgorithmParams* params,
+    const VocAlgorithmConfig* config, VocAlgorithmState* state, fix16_t sraw,
+    fix16_t voc_index_from_prior);
+static fix16_t
+VocAlgorithm__mean_variance_estimator___sigmoid__process(fix16_t X0, fix16_t K,
+                                                         fix16_t sample);
+static bool VocAlgorithm__mean_variance_estimator___sigmoid__is_saturated(
+    fix16_t X0, fix16_t K, fix16_t sample);
+static void VocAlgorithm__mox_model__set_parameters(VocAlgorithmState* state,
                                                     fix16_t SRAW_STD,
                                                     fix16_t SRAW_MEAN);
-static fix16_t VocAlgorithm__mox_model__process(VocAlgorithmParams* params,
-                                                fix16_t sraw);
-static void VocAlgorithm__sigmoid_scaled__init(VocAlgorithmParams* params);
+static fix16_t
+VocAlgorithm__mox_model__process(const VocAlgorithmState* state, fix16_t sraw);
 static void
-VocAlgorithm__sigmoid_scaled__set_parameters(VocAlgorithmParams* params,
+VocAlgorithm__sigmoid_scaled__set_parameters(VocAlgorithmConfig* config,
                                              fix16_t offset);
-static fix16_t VocAlgorithm__sigmoid_scaled__process(VocAlgorithmParams* params,
-                                                     fix16_t sample);
-static void VocAlgorithm__adaptive_lowpass__init(VocAlgorithmParams* params);
+static fix16_t
+VocAlgorithm__sigmoid_scaled__process(const VocAlgorithmConfig* config,
+                                      fix16_t sample);
+static void VocAlgorithm__adaptive_lowpass__init(VocAlgorithmState* state);
 static void
-VocAlgorithm__adaptive_lowpass__set_parameters(VocAlgorithmParams* params);
+VocAlgorithm__adaptive_lowpass__set_parameters(VocAlgorithmConfig* config);
 static fix16_t
-VocAlgorithm__adaptive_lowpass__process(VocAlgorithmParams* params,
+VocAlgorithm__adaptive_lowpass__process(const VocAlgorithmConfig* config,
+                                        VocAlgorithmState* state,
                                         fix16_t sample);
 
 void VocAlgorithm_init(VocAlgorithmParams* params) {
 
-    params->mVoc_Index_Offset = F16(VocAlgorithm_VOC_INDEX_OFFSET_DEFAULT);
-    params->mTau_Mean_Variance_Hours =
+    VocAlgorithm_init_with_sampling_interval(
+        params, (int32_t)VocAlgorithm_SAMPLING_INTERVAL);
+}
+int16_t VocAlgorithm_init_with_sampling_interval(VocAlgorithmParams* params,
+                                                 int32_t sampling_interval) {
+
+    if (sampling_interval < VocAlgorithm_SAMPLING_INTERVAL_MIN ||
+        sampling_interval > VocAlgorithm_SAMPLING_INTERVAL_MAX)
+        return VocAlgorithm_ERR_SAMPLING_INTERVAL;
+    params->mTimestamp_Valid = false;
+    VocAlgorithm_init_config(&params->mConfig, sampling_interval);
+    VocAlgorithm_init_state(&params->mConfig, &params->mState);
+    return 0;
+}
+
+int16_t VocAlgorithm_init_config(VocAlgorithmConfig* config,
+                                 int32_t sampling_interval) {
+
+    if (sampling_interval < VocAlgorithm_SAMPLING_INTERVAL_MIN ||
+        sampling_interval > VocAlgorithm_SAMPLING_INTERVAL_MAX)
+        return VocAlgorithm_ERR_SAMPLING_INTERVAL;
+    config->mSampling_Interval = (fix16_from_int(sampling_interval));
+    config->mVoc_Index_Offset = F16(VocAlgorithm_VOC_INDEX_OFFSET_DEFAULT);
+    config->mTau_Mean_Variance_Hours =
         F16(VocAlgorithm_TAU_MEAN_VARIANCE_HOURS);
-    params->mGating_Max_Duration_Minutes =
+    config->mGating_Max_Duration_Minutes =
         F16(VocAlgorithm_GATING_MAX_DURATION_MINUTES);
-    params->mSraw_Std_Initial = F16(VocAlgorithm_SRAW_STD_INITIAL);
-    params->mUptime = F16(0.);
-    params->mSraw = F16(0.);
-    params->mVoc_Index = 0;
-    VocAlgorithm__init_instances(params);
+    config->mSraw_Std_Initial = F16(VocAlgorithm_SRAW_STD_INITIAL);
+    VocAlgorithm__init_config_instances(config);
+    return 0;
+}
+
+void VocAlgorithm_init_state(const VocAlgorithmConfig* config,
+                             VocAlgorithmState* state) {
+
+    state->mUptime = F16(0.);
+    state->mSraw = F16(0.);
+    state->mVoc_Index = 0;
+    VocAlgorithm__init_state_instances(config, state);
 }
 
 static void VocAlgorithm__init_instances(VocAlgorithmParams* params) {
 
-    VocAlgorithm__mean_variance_estimator__init(params);
+    VocAlgorithm__init_config_instances(&params->mConfig);
+    VocAlgorithm__init_state_instances(&params->mConfig, &params->mState);
+}
+
+static void VocAlgorithm__init_config_instances(VocAlgorithmConfig* config) {
+
     VocAlgorithm__mean_variance_estimator__set_parameters(
-        params, params->mSraw_Std_Initial, params->mTau_Mean_Variance_Hours,
-        params->mGating_Max_Duration_Minutes);
-    VocAlgorithm__mox_model__init(params);
+        config, config->mTau_Mean_Variance_Hours,
+        config->mGating_Max_Duration_Minutes);
+    VocAlgorithm__sigmoid_scaled__set_parameters(config,
+                                                 config->mVoc_Index_Offset);
+    VocAlgorithm__adaptive_lowpass__set_parameters(config);
+}
+
+static void
+VocAlgorithm__init_state_instances(const VocAlgorithmConfig* config,
+                                   VocAlgorithmState* state) {
+
+    VocAlgorithm__mean_variance_estimator__init(state,
+                                                config->mSraw_Std_Initial);
     VocAlgorithm__mox_model__set_parameters(
-        params, VocAlgorithm__mean_variance_estimator__get_std(params),
-        VocAlgorithm__mean_variance_estimator__get_mean(params));
-    VocAlgorithm__sigmoid_scaled__init(params);
-    VocAlgorithm__sigmoid_scaled__set_parameters(params,
-                                                 params->mVoc_Index_Offset);
-    VocAlgorithm__adaptive_lowpass__init(params);
-    VocAlgorithm__adaptive_lowpass__set_parameters(params);
+        state, VocAlgorithm__mean_variance_estimator__get_std(state),
+        VocAlgorithm__mean_variance_estimator__get_mean(state));
+    VocAlgorithm__adaptive_lowpass__init(state);
 }
 
 void VocAlgorithm_get_states(VocAlgorithmParams* params, int32_t* state0,
                              int32_t* state1) {
 
-    *state0 = VocAlgorithm__mean_variance_estimator__get_mean(params);
-    *state1 = VocAlgorithm__mean_variance_estimator__get_std(params);
+    *state0 = VocAlgorithm__mean_variance_estimator__get_mean(&params->mState);
+    *state1 = VocAlgorithm__mean_variance_estimator__get_std(&params->mState);
     return;
 }
 
@@ -372,8 +909,9 @@ void VocAlgorithm_set_states(VocAlgorithmParams* params, int32_t state0,
                              int32_t state1) {
 
     VocAlgorithm__mean_variance_estimator__set_states(
-        params, state0, state1, F16(VocAlgorithm_PERSISTENCE_UPTIME_GAMMA));
-    params->mSraw = state0;
+        &params->mState, state0, state1,
+        F16(VocAlgorithm_PERSISTENCE_UPTIME_GAMMA));
+    params->mState.mSraw = state0;
 }
 
 void VocAlgorithm_set_tuning_parameters(VocAlgorithmParams* params,
@@ -382,20 +920,255 @@ void VocAlgorithm_set_tuning_parameters(VocAlgorithmParams* params,
                                         int32_t gating_max_duration_minutes,
                                         int32_t std_initial) {
 
-    params->mVoc_Index_Offset = (fix16_from_int(voc_index_offset));
-    params->mTau_Mean_Variance_Hours = (fix16_from_int(learning_time_hours));
-    params->mGating_Max_Duration_Minutes =
+    VocAlgorithm_set_config_tuning_parameters(
+        &params->mConfig, voc_index_offset, learning_time_hours,
+        gating_max_duration_minutes, std_initial);
+    VocAlgorithm__init_state_instances(&params->mConfig, &params->mState);
+}
+
+void VocAlgorithm_set_config_tuning_parameters(
+    VocAlgorithmConfig* config, int32_t voc_index_offset,
+    int32_t learning_time_hours, int32_t gating_max_duration_minutes,
+    int32_t std_initial) {
+
+    config->mVoc_Index_Offset = (fix16_from_int(voc_index_offset));
+    config->mTau_Mean_Variance_Hours = (fix16_from_int(learning_time_hours));
+    config->mGating_Max_Duration_Minutes =
         (fix16_from_int(gating_max_duration_minutes));
-    params->mSraw_Std_Initial = (fix16_from_int(std_initial));
-    VocAlgorithm__init_instances(params);
+    config->mSraw_Std_Initial = (fix16_from_int(std_initial));
+    VocAlgorithm__init_config_instances(config);
 }
 
+static uint8_t* VocAlgorithm__snapshot_put(uint8_t* buffer, fix16_t value) {
+
+    buffer[0] = (uint8_t)((uint32_t)value >> 24);
+    buffer[1] = (uint8_t)((uint32_t)value >> 16);
+    buffer[2] = (uint8_t)((uint32_t)value >> 8);
+    buffer[3] = (uint8_t)value;
+    return buffer + 4;
+}
+static const uint8_t* VocAlgorithm__snapshot_get(const uint8_t* buffer,
+                                                 fix16_t* value) {
+
+    *value = (fix16_t)(((uint32_t)buffer[0] << 24) |
+                       ((uint32_t)buffer[1] << 16) |
+                       ((uint32_t)buffer[2] << 8) | (uint32_t)buffer[3]);
+    return buffer + 4;
+}
+static uint16_t VocAlgorithm__snapshot_crc(const uint8_t* data,
+                                           uint16_t count) {
+
+    // CRC-16/CCITT-FALSE: polynomial 0x1021, initialization 0xFFFF
+    uint16_t crc = 0xFFFF;
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0; i < count; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (bit = 8; bit > 0; --bit) {
+            if (crc & 0x8000)
+                crc = (uint16_t)((crc << 1) ^ 0x1021);
+            else
+                crc = (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+int16_t VocAlgorithm_get_snapshot(VocAlgorithmParams* params,
+                                  uint8_t* snapshot, uint16_t size) {
+
+    const VocAlgorithmConfig* config = &params->mConfig;
+    const VocAlgorithmState* state = &params->mState;
+    uint8_t* p = snapshot;
+    uint16_t crc;
+
+    if (size < VocAlgorithm_SNAPSHOT_SIZE)
+        return VocAlgorithm_SNAPSHOT_ERR_SIZE;
+
+    *p++ = VocAlgorithm_SNAPSHOT_MAGIC_0;
+    *p++ = VocAlgorithm_SNAPSHOT_MAGIC_1;
+    *p++ = VocAlgorithm_SNAPSHOT_VERSION;
+    p = VocAlgorithm__snapshot_put(p, config->mVoc_Index_Offset);
+    p = VocAlgorithm__snapshot_put(p, config->mTau_Mean_Variance_Hours);
+    p = VocAlgorithm__snapshot_put(p, config->mGating_Max_Duration_Minutes);
+    p = VocAlgorithm__snapshot_put(p, config->mSraw_Std_Initial);
+    p = VocAlgorithm__snapshot_put(p, config->mSampling_Interval);
+    p = VocAlgorithm__snapshot_put(p, state->mUptime);
+    p = VocAlgorithm__snapshot_put(p, state->mSraw);
+    p = VocAlgorithm__snapshot_put(p, state->mVoc_Index);
+    p = VocAlgorithm__snapshot_put(p, state->m_Mean_Variance_Estimator___Mean);
+    p = VocAlgorithm__snapshot_put(
+        p, state->m_Mean_Variance_Estimator___Sraw_Offset);
+    p = VocAlgorithm__snapshot_put(p, state->m_Mean_Variance_Estimator___Std);
+    p = VocAlgorithm__snapshot_put(
+        p, state->m_Mean_Variance_Estimator___Uptime_Gamma);
+    p = VocAlgorithm__snapshot_put(
+        p, state->m_Mean_Variance_Estimator___Uptime_Gating);
+    p = VocAlgorithm__snapshot_put(
+        p, state->m_Mean_Variance_Estimator___Gating_Duration_Minutes);
+    p = VocAlgorithm__snapshot_put(p, state->m_Mox_Model__Sraw_Std);
+    p = VocAlgorithm__snapshot_put(p, state->m_Mox_Model__Sraw_Mean);
+    p = VocAlgorithm__snapshot_put(p, state->m_Adaptive_Lowpass___X1);
+    p = VocAlgorithm__snapshot_put(p, state->m_Adaptive_Lowpass___X2);
+    p = VocAlgorithm__snapshot_put(p, state->m_Adaptive_Lowpass___X3);
+    *p++ = (uint8_t)((state->m_Mean_Variance_Estimator___Initialized ? 0x01
+                                                                      : 0) |
+                     (state->m_Adaptive_Lowpass___Initialized ? 0x02 : 0));
+    crc = VocAlgorithm__snapshot_crc(snapshot, (uint16_t)(p - snapshot));
+    *p++ = (uint8_t)(crc >> 8);
+    *p = (uint8_t)crc;
+    return 0;
+}
+int16_t VocAlgorithm_set_snapshot(VocAlgorithmParams* params,
+                                  const uint8_t* snapshot, uint16_t size) {
+
+    VocAlgorithmConfig* config = &params->mConfig;
+    VocAlgorithmState* state = &params->mState;
+    const uint8_t* p = snapshot;
+    uint16_t crc;
+    uint8_t flags;
+
+    if (size < VocAlgorithm_SNAPSHOT_SIZE)
+        return VocAlgorithm_SNAPSHOT_ERR_SIZE;
+    if (snapshot[0] != VocAlgorithm_SNAPSHOT_MAGIC_0 ||
+        snapshot[1] != VocAlgorithm_SNAPSHOT_MAGIC_1 ||
+        snapshot[2] != VocAlgorithm_SNAPSHOT_VERSION)
+        return VocAlgorithm_SNAPSHOT_ERR_FORMAT;
+    crc = VocAlgorithm__snapshot_crc(snapshot, VocAlgorithm_SNAPSHOT_SIZE - 2);
+    if (snapshot[VocAlgorithm_SNAPSHOT_SIZE - 2] != (uint8_t)(crc >> 8) ||
+        snapshot[VocAlgorithm_SNAPSHOT_SIZE - 1] != (uint8_t)crc)
+        return VocAlgorithm_SNAPSHOT_ERR_CRC;
+
+    // Derive everything that depends on the tuning parameters only, then
+    // restore the states on top of it
+    p += 3;
+    p = VocAlgorithm__snapshot_get(p, &config->mVoc_Index_Offset);
+    p = VocAlgorithm__snapshot_get(p, &config->mTau_Mean_Variance_Hours);
+    p = VocAlgorithm__snapshot_get(p, &config->mGating_Max_Duration_Minutes);
+    p = VocAlgorithm__snapshot_get(p, &config->mSraw_Std_Initial);
+    p = VocAlgorithm__snapshot_get(p, &config->mSampling_Interval);
+    params->mTimestamp_Valid = false;
+    VocAlgorithm__init_instances(params);
+
+    p = VocAlgorithm__snapshot_get(p, &state->mUptime);
+    p = VocAlgorithm__snapshot_get(p, &state->mSraw);
+    p = VocAlgorithm__snapshot_get(p, &state->mVoc_Index);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Mean_Variance_Estimator___Mean);
+    p = VocAlgorithm__snapshot_get(
+        p, &state->m_Mean_Variance_Estimator___Sraw_Offset);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Mean_Variance_Estimator___Std);
+    p = VocAlgorithm__snapshot_get(
+        p, &state->m_Mean_Variance_Estimator___Uptime_Gamma);
+    p = VocAlgorithm__snapshot_get(
+        p, &state->m_Mean_Variance_Estimator___Uptime_Gating);
+    p = VocAlgorithm__snapshot_get(
+        p, &state->m_Mean_Variance_Estimator___Gating_Duration_Minutes);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Mox_Model__Sraw_Std);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Mox_Model__Sraw_Mean);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Adaptive_Lowpass___X1);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Adaptive_Lowpass___X2);
+    p = VocAlgorithm__snapshot_get(p, &state->m_Adaptive_Lowpass___X3);
+    flags = *p;
+    state->m_Mean_Variance_Estimator___Initialized = (flags & 0x01) != 0;
+    state->m_Adaptive_Lowpass___Initialized = (flags & 0x02) != 0;
+    return 0;
+}
 void VocAlgorithm_process(VocAlgorithmParams* params, int32_t sraw,
                           int32_t* voc_index) {
 
-    if ((params->mUptime <= F16(VocAlgorithm_INITIAL_BLACKOUT))) {
-        params->mUptime =
-            (params->mUptime + F16(VocAlgorithm_SAMPLING_INTERVAL));
+    *voc_index = (fix16_cast_to_int(
+        (VocAlgorithm__process(&params->mConfig, &params->mState, sraw) +
+         F16(0.5))));
+    return;
+}
+
+void VocAlgorithm_process_state(const VocAlgorithmConfig* config,
+                                VocAlgorithmState* state, int32_t sraw,
+                                int32_t* voc_index) {
+
+    *voc_index = (fix16_cast_to_int(
+        (VocAlgorithm__process(config, state, sraw) + F16(0.5))));
+}
+
+void VocAlgorithm_process_with_timestamp(VocAlgorithmParams* params,
+                                         int32_t sraw, uint32_t timestamp_ms,
+                                         int32_t* voc_index) {
+
+    uint32_t interval_ms =
+        (uint32_t)fix16_cast_to_int(params->mConfig.mSampling_Interval) * 1000;
+    uint32_t elapsed_ms;
+    uint32_t intervals;
+    fix16_t result;
+
+    if (!params->mTimestamp_Valid) {
+        params->mTimestamp_Valid = true;
+        params->mTimestamp_Ms = timestamp_ms;
+        params->mTimestamp_Remainder_Ms = 0;
+        VocAlgorithm_process(params, sraw, voc_index);
+        return;
+    }
+
+    // Unsigned arithmetic handles the wrap-around of the timestamp
+    elapsed_ms = timestamp_ms - params->mTimestamp_Ms;
+    params->mTimestamp_Ms = timestamp_ms;
+    if (elapsed_ms > (uint32_t)(VocAlgorithm_MAX_GAP_SECONDS * 1000)) {
+        // The states are outdated, restart with the initial blackout like
+        // after VocAlgorithm_init(), but keep the tuning parameters
+        VocAlgorithm_init_state(&params->mConfig, &params->mState);
+        params->mTimestamp_Remainder_Ms = 0;
+        VocAlgorithm_process(params, sraw, voc_index);
+        return;
+    }
+
+    elapsed_ms += params->mTimestamp_Remainder_Ms;
+    intervals = elapsed_ms / interval_ms;
+    params->mTimestamp_Remainder_Ms = elapsed_ms % interval_ms;
+
+    // Missed intervals are filled with the current sample
+    result = params->mState.mVoc_Index;
+    while (intervals > 0) {
+        result = VocAlgorithm__process(&params->mConfig, &params->mState, sraw);
+        intervals--;
+    }
+    *voc_index = (fix16_cast_to_int((result + F16(0.5))));
+}
+
+void VocAlgorithm_process_batch(VocAlgorithmParams* params,
+                                const uint16_t* sraw, int32_t* voc_index,
+                                uint32_t count) {
+
+    // Work on a local copy, so the compiler does not have to assume that the
+    // stores to voc_index alias the states and can keep them in registers.
+    const VocAlgorithmConfig config = params->mConfig;
+    VocAlgorithmState state = params->mState;
+    uint32_t i;
+
+    for (i = 0; i < count; ++i) {
+        voc_index[i] = (fix16_cast_to_int(
+            (VocAlgorithm__process(&config, &state, sraw[i]) + F16(0.5))));
+    }
+    params->mState = state;
+}
+
+void VocAlgorithm_process_states(const VocAlgorithmConfig* config,
+                                 VocAlgorithmState* states,
+                                 const uint16_t* sraw, int32_t* voc_index,
+                                 uint32_t count) {
+
+    uint32_t i;
+
+    for (i = 0; i < count; ++i) {
+        voc_index[i] = (fix16_cast_to_int(
+            (VocAlgorithm__process(config, &states[i], sraw[i]) + F16(0.5))));
+    }
+}
+
+static inline fix16_t VocAlgorithm__process(const VocAlgorithmConfig* config,
+                                            VocAlgorithmState* state,
+                                            int32_t sraw) {
+
+    if ((state->mUptime <= F16(VocAlgorithm_INITIAL_BLACKOUT))) {
+        state->mUptime = (state->mUptime + config->mSampling_Interval);
     } else {
         if (((sraw > 0) && (sraw < 65000))) {
             if ((sraw < 20001)) {
@@ -403,320 +1176,329 @@ void VocAlgorithm_process(VocAlgorithmParams* params, int32_t sraw,
             } else if ((sraw > 52767)) {
                 sraw = 52767;
             }
-            params->mSraw = (fix16_from_int((sraw - 20000)));
+            state->mSraw = (fix16_from_int((sraw - 20000)));
         }
-        params->mVoc_Index =
-            VocAlgorithm__mox_model__process(params, params->mSraw);
-        params->mVoc_Index =
-            VocAlgorithm__sigmoid_scaled__process(params, params->mVoc_Index);
-        params->mVoc_Index =
-            VocAlgorithm__adaptive_lowpass__process(params, params->mVoc_Index);
-        if ((params->mVoc_Index < F16(0.5))) {
-            params->mVoc_Index = F16(0.5);
+        state->mVoc_Index =
+            VocAlgorithm__mox_model__process(state, state->mSraw);
+        state->mVoc_Index =
+            VocAlgorithm__sigmoid_scaled__process(config, state->mVoc_Index);
+        state->mVoc_Index = VocAlgorithm__adaptive_lowpass__process(
+            config, state, state->mVoc_Index);
+        if ((state->mVoc_Index < F16(0.5))) {
+            state->mVoc_Index = F16(0.5);
         }
-        if ((params->mSraw > F16(0.))) {
+        if ((state->mSraw > F16(0.))) {
             VocAlgorithm__mean_variance_estimator__process(
-                params, params->mSraw, params->mVoc_Index);
+                config, state, state->mSraw, state->mVoc_Index);
             VocAlgorithm__mox_model__set_parameters(
-                params, VocAlgorithm__mean_variance_estimator__get_std(params),
-                VocAlgorithm__mean_variance_estimator__get_mean(params));
+                state, VocAlgorithm__mean_variance_estimator__get_std(state),
+                VocAlgorithm__mean_variance_estimator__get_mean(state));
         }
     }
-    *voc_index = (fix16_cast_to_int((params->mVoc_Index + F16(0.5))));
-    return;
+    return state->mVoc_Index;
 }
 
 static void
-VocAlgorithm__mean_variance_estimator__init(VocAlgorithmParams* params) {
-
-    VocAlgorithm__mean_variance_estimator__set_parameters(params, F16(0.),
-                                                          F16(0.), F16(0.));
-    VocAlgorithm__mean_variance_estimator___init_instances(params);
-}
-
-static void VocAlgorithm__mean_variance_estimator___init_instances(
-    VocAlgorithmParams* params) {
-
-    VocAlgorithm__mean_variance_estimator___sigmoid__init(params);
+VocAlgorithm__mean_variance_estimator__init(VocAlgorithmState* state,
+                                            fix16_t std_initial) {
+
+    state->m_Mean_Variance_Estimator___Initialized = false;
+    state->m_Mean_Variance_Estimator___Mean = F16(0.);
+    state->m_Mean_Variance_Estimator___Sraw_Offset = F16(0.);
+    state->m_Mean_Variance_Estimator___Std = std_initial;
+    state->m_Mean_Variance_Estimator___Uptime_Gamma = F16(0.);
+    state->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
+    state->m_Mean_Variance_Estimator___Uptime_Gamma_Saturated = false;
+    state->m_Mean_Variance_Estimator___Uptime_Gating_Saturated = false;
+    state->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
 }
 
 static void VocAlgorithm__mean_variance_estimator__set_parameters(
-    VocAlgorithmParams* params, fix16_t std_initial,
-    fix16_t tau_mean_variance_hours, fix16_t gating_max_duration_minutes) {
+    VocAlgorithmConfig* config, fix16_t tau_mean_variance_hours,
+    fix16_t gating_max_duration_minutes) {
 
-    params->m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes =
+    config->m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes =
         gating_max_duration_minutes;
-    params->m_Mean_Variance_Estimator___Initialized = false;
-    params->m_Mean_Variance_Estimator___Mean = F16(0.);
-    params->m_Mean_Variance_Estimator___Sraw_Offset = F16(0.);
-    params->m_Mean_Variance_Estimator___Std = std_initial;
-    params->m_Mean_Variance_Estimator___Gamma =
-        (fix16_div(F16((VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING *
-                        (VocAlgorithm_SAMPLING_INTERVAL / 3600.))),
-                   (tau_mean_variance_hours +
-                    F16((VocAlgorithm_SAMPLING_INTERVAL / 3600.)))));
-    params->m_Mean_Variance_Estimator___Gamma_Initial_Mean =
-        F16(((VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING *
-              VocAlgorithm_SAMPLING_INTERVAL) /
-             (VocAlgorithm_TAU_INITIAL_MEAN + VocAlgorithm_SAMPLING_INTERVAL)));
-    params->m_Mean_Variance_Estimator___Gamma_Initial_Variance = F16(
-        ((VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING *
-          VocAlgorithm_SAMPLING_INTERVAL) /
-         (VocAlgorithm_TAU_INITIAL_VARIANCE + VocAlgorithm_SAMPLING_INTERVAL)));
-    params->m_Mean_Variance_Estimator__Gamma_Mean = F16(0.);
-    params->m_Mean_Variance_Estimator__Gamma_Variance = F16(0.);
-    params->m_Mean_Variance_Estimator___Uptime_Gamma = F16(0.);
-    params->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
-    params->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
+    config->m_Mean_Variance_Estimator__Sampling_Interval_Minutes =
+        fix16_div_rounded(config->mSampling_Interval, F16(60.));
+    config->m_Mean_Variance_Estimator___Gamma = (fix16_div(
+        fix16_div_rounded(
+            fix16_mul(F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING),
+                      config->mSampling_Interval),
+            F16(3600.)),
+        (tau_mean_variance_hours +
+         fix16_div_rounded(config->mSampling_Interval, F16(3600.)))));
+    config->m_Mean_Variance_Estimator___Gamma_Initial_Mean = fix16_div_rounded(
+        fix16_mul(F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING),
+                  config->mSampling_Interval),
+        (F16(VocAlgorithm_TAU_INITIAL_MEAN) + config->mSampling_Interval));
+    config->m_Mean_Variance_Estimator___Gamma_Initial_Variance =
+        fix16_div_rounded(
+            fix16_mul(F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING),
+                      config->mSampling_Interval),
+            (F16(VocAlgorithm_TAU_INITIAL_VARIANCE) +
+             config->mSampling_Interval));
 }
 
 static void
-VocAlgorithm__mean_variance_estimator__set_states(VocAlgorithmParams* params,
+VocAlgorithm__mean_variance_estimator__set_states(VocAlgorithmState* state,
                                                   fix16_t mean, fix16_t std,
                                                   fix16_t uptime_gamma) {
 
-    params->m_Mean_Variance_Estimator___Mean = mean;
-    params->m_Mean_Variance_Estimator___Std = std;
-    params->m_Mean_Variance_Estimator___Uptime_Gamma = uptime_gamma;
-    params->m_Mean_Variance_Estimator___Initialized = true;
+    state->m_Mean_Variance_Estimator___Mean = mean;
+    state->m_Mean_Variance_Estimator___Std = std;
+    state->m_Mean_Variance_Estimator___Uptime_Gamma = uptime_gamma;
+    state->m_Mean_Variance_Estimator___Uptime_Gamma_Saturated = false;
+    state->m_Mean_Variance_Estimator___Initialized = true;
 }
 
-static fix16_t
-VocAlgorithm__mean_variance_estimator__get_std(VocAlgorithmParams* params) {
+static fix16_t VocAlgorithm__mean_variance_estimator__get_std(
+    const VocAlgorithmState* state) {
 
-    return params->m_Mean_Variance_Estimator___Std;
+    return state->m_Mean_Variance_Estimator___Std;
 }
 
-static fix16_t
-VocAlgorithm__mean_variance_estimator__get_mean(VocAlgorithmParams* params) {
+static fix16_t VocAlgorithm__mean_variance_estimator__get_mean(
+    const VocAlgorithmState* state) {
 
-    return (params->m_Mean_Variance_Estimator___Mean +
-            params->m_Mean_Variance_Estimator___Sraw_Offset);
+    return (state->m_Mean_Variance_Estimator___Mean +
+            state->m_Mean_Variance_Estimator___Sraw_Offset);
 }
 
 static void VocAlgorithm__mean_variance_estimator___calculate_gamma(
-    VocAlgorithmParams* params, fix16_t voc_index_from_prior) {
+    const VocAlgorithmConfig* config, VocAlgorithmState* state,
+    fix16_t voc_index_from_prior, fix16_t* gamma_mean_gated,
+    fix16_t* gamma_variance_gated) {
 
     fix16_t uptime_limit;
     fix16_t sigmoid_gamma_mean;
     fix16_t gamma_mean;
     fix16_t gating_threshold_mean;
     fix16_t sigmoid_gating_mean;
+    fix16_t sigmoid_uptime_gating_mean;
     fix16_t sigmoid_gamma_variance;
     fix16_t gamma_variance;
     fix16_t gating_threshold_variance;
     fix16_t sigmoid_gating_variance;
-
-    uptime_limit = F16((VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__FIX16_MAX -
-                        VocAlgorithm_SAMPLING_INTERVAL));
-    if ((params->m_Mean_Variance_Estimator___Uptime_Gamma < uptime_limit)) {
-        params->m_Mean_Variance_Estimator___Uptime_Gamma =
-            (params->m_Mean_Variance_Estimator___Uptime_Gamma +
-             F16(VocAlgorithm_SAMPLING_INTERVAL));
-    }
-    if ((params->m_Mean_Variance_Estimator___Uptime_Gating < uptime_limit)) {
-        params->m_Mean_Variance_Estimator___Uptime_Gating =
-            (params->m_Mean_Variance_Estimator___Uptime_Gating +
-             F16(VocAlgorithm_SAMPLING_INTERVAL));
-    }
-    VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-        params, F16(1.), F16(VocAlgorithm_INIT_DURATION_MEAN),
-        F16(VocAlgorithm_INIT_TRANSITION_MEAN));
-    sigmoid_gamma_mean =
-        VocAlgorithm__mean_variance_estimator___sigmoid__process(
-            params, params->m_Mean_Variance_Estimator___Uptime_Gamma);
+    fix16_t sigmoid_uptime_gating_variance;
+
+    uptime_limit = (F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__FIX16_MAX) -
+                    config->mSampling_Interval);
+    if ((state->m_Mean_Variance_Estimator___Uptime_Gamma < uptime_limit)) {
+        state->m_Mean_Variance_Estimator___Uptime_Gamma =
+            (state->m_Mean_Variance_Estimator___Uptime_Gamma +
+             config->mSampling_Interval);
+    }
+    if ((state->m_Mean_Variance_Estimator___Uptime_Gating < uptime_limit)) {
+        state->m_Mean_Variance_Estimator___Uptime_Gating =
+            (state->m_Mean_Variance_Estimator___Uptime_Gating +
+             config->mSampling_Interval);
+    }
+    // The sigmoids of the uptimes decrease monotonically to zero. Once the one
+    // with the later transition (variance) saturated, both of them return
+    // zero until the uptime is reset, so they do not need to be evaluated.
+    sigmoid_gamma_mean = F16(0.);
+    sigmoid_gamma_variance = F16(0.);
+    sigmoid_uptime_gating_mean = F16(0.);
+    sigmoid_uptime_gating_variance = F16(0.);
+    if (!state->m_Mean_Variance_Estimator___Uptime_Gamma_Saturated) {
+        sigmoid_gamma_mean =
+            VocAlgorithm__mean_variance_estimator___sigmoid__process(
+                F16(VocAlgorithm_INIT_DURATION_MEAN),
+                F16(VocAlgorithm_INIT_TRANSITION_MEAN),
+                state->m_Mean_Variance_Estimator___Uptime_Gamma);
+        sigmoid_gamma_variance =
+            VocAlgorithm__mean_variance_estimator___sigmoid__process(
+                F16(VocAlgorithm_INIT_DURATION_VARIANCE),
+                F16(VocAlgorithm_INIT_TRANSITION_VARIANCE),
+                state->m_Mean_Variance_Estimator___Uptime_Gamma);
+        state->m_Mean_Variance_Estimator___Uptime_Gamma_Saturated =
+            VocAlgorithm__mean_variance_estimator___sigmoid__is_saturated(
+                F16(VocAlgorithm_INIT_DURATION_VARIANCE),
+                F16(VocAlgorithm_INIT_TRANSITION_VARIANCE),
+                state->m_Mean_Variance_Estimator___Uptime_Gamma);
+    }
+    if (!state->m_Mean_Variance_Estimator___Uptime_Gating_Saturated) {
+        sigmoid_uptime_gating_mean =
+            VocAlgorithm__mean_variance_estimator___sigmoid__process(
+                F16(VocAlgorithm_INIT_DURATION_MEAN),
+                F16(VocAlgorithm_INIT_TRANSITION_MEAN),
+                state->m_Mean_Variance_Estimator___Uptime_Gating);
+        sigmoid_uptime_gating_variance =
+            VocAlgorithm__mean_variance_estimator___sigmoid__process(
+                F16(VocAlgorithm_INIT_DURATION_VARIANCE),
+                F16(VocAlgorithm_INIT_TRANSITION_VARIANCE),
+                state->m_Mean_Variance_Estimator___Uptime_Gating);
+        state->m_Mean_Variance_Estimator___Uptime_Gating_Saturated =
+            VocAlgorithm__mean_variance_estimator___sigmoid__is_saturated(
+                F16(VocAlgorithm_INIT_DURATION_VARIANCE),
+                F16(VocAlgorithm_INIT_TRANSITION_VARIANCE),
+                state->m_Mean_Variance_Estimator___Uptime_Gating);
+    }
     gamma_mean =
-        (params->m_Mean_Variance_Estimator___Gamma +
-         (fix16_mul((params->m_Mean_Variance_Estimator___Gamma_Initial_Mean -
-                     params->m_Mean_Variance_Estimator___Gamma),
+        (config->m_Mean_Variance_Estimator___Gamma +
+         (fix16_mul((config->m_Mean_Variance_Estimator___Gamma_Initial_Mean -
+                     config->m_Mean_Variance_Estimator___Gamma),
                     sigmoid_gamma_mean)));
     gating_threshold_mean =
         (F16(VocAlgorithm_GATING_THRESHOLD) +
-         (fix16_mul(
-             F16((VocAlgorithm_GATING_THRESHOLD_INITIAL -
-                  VocAlgorithm_GATING_THRESHOLD)),
-             VocAlgorithm__mean_variance_estimator___sigmoid__process(
-                 params, params->m_Mean_Variance_Estimator___Uptime_Gating))));
-    VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-        params, F16(1.), gating_threshold_mean,
-        F16(VocAlgorithm_GATING_THRESHOLD_TRANSITION));
+         (fix16_mul(F16((VocAlgorithm_GATING_THRESHOLD_INITIAL -
+                         VocAlgorithm_GATING_THRESHOLD)),
+                    sigmoid_uptime_gating_mean)));
     sigmoid_gating_mean =
         VocAlgorithm__mean_variance_estimator___sigmoid__process(
-            params, voc_index_from_prior);
-    params->m_Mean_Variance_Estimator__Gamma_Mean =
-        (fix16_mul(sigmoid_gating_mean, gamma_mean));
-    VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-        params, F16(1.), F16(VocAlgorithm_INIT_DURATION_VARIANCE),
-        F16(VocAlgorithm_INIT_TRANSITION_VARIANCE));
-    sigmoid_gamma_variance =
-        VocAlgorithm__mean_variance_estimator___sigmoid__process(
-            params, params->m_Mean_Variance_Estimator___Uptime_Gamma);
+            gating_threshold_mean,
+            F16(VocAlgorithm_GATING_THRESHOLD_TRANSITION),
+            voc_index_from_prior);
+    *gamma_mean_gated = (fix16_mul(sigmoid_gating_mean, gamma_mean));
     gamma_variance =
-        (params->m_Mean_Variance_Estimator___Gamma +
+        (config->m_Mean_Variance_Estimator___Gamma +
          (fix16_mul(
-             (params->m_Mean_Variance_Estimator___Gamma_Initial_Variance -
-              params->m_Mean_Variance_Estimator___Gamma),
+             (config->m_Mean_Variance_Estimator___Gamma_Initial_Variance -
+              config->m_Mean_Variance_Estimator___Gamma),
              (sigmoid_gamma_variance - sigmoid_gamma_mean))));
     gating_threshold_variance =
         (F16(VocAlgorithm_GATING_THRESHOLD) +
-         (fix16_mul(
-             F16((VocAlgorithm_GATING_THRESHOLD_INITIAL -
-                  VocAlgorithm_GATING_THRESHOLD)),
-             VocAlgorithm__mean_variance_estimator___sigmoid__process(
-                 params, params->m_Mean_Variance_Estimator___Uptime_Gating))));
-    VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-        params, F16(1.), gating_threshold_variance,
-        F16(VocAlgorithm_GATING_THRESHOLD_TRANSITION));
+         (fix16_mul(F16((VocAlgorithm_GATING_THRESHOLD_INITIAL -
+                         VocAlgorithm_GATING_THRESHOLD)),
+                    sigmoid_uptime_gating_variance)));
     sigmoid_gating_variance =
         VocAlgorithm__mean_variance_estimator___sigmoid__process(
-            params, voc_index_from_prior);
-    params->m_Mean_Variance_Estimator__Gamma_Variance =
+            gating_threshold_variance,
+            F16(VocAlgorithm_GATING_THRESHOLD_TRANSITION),
+            voc_index_from_prior);
+    *gamma_variance_gated =
         (fix16_mul(sigmoid_gating_variance, gamma_variance));
-    params->m_Mean_Variance_Estimator___Gating_Duration_Minutes =
-        (params->m_Mean_Variance_Estimator___Gating_Duration_Minutes +
-         (fix16_mul(F16((VocAlgorithm_SAMPLING_INTERVAL / 60.)),
-                    ((fix16_mul((F16(1.) - sigmoid_gating_mean),
-                                F16((1. + VocAlgorithm_GATING_MAX_RATIO)))) -
-                     F16(VocAlgorithm_GATING_MAX_RATIO)))));
-    if ((params->m_Mean_Variance_Estimator___Gating_Duration_Minutes <
+    state->m_Mean_Variance_Estimator___Gating_Duration_Minutes =
+        (state->m_Mean_Variance_Estimator___Gating_Duration_Minutes +
+         (fix16_mul(
+             config->m_Mean_Variance_Estimator__Sampling_Interval_Minutes,
+             ((fix16_mul((F16(1.) - sigmoid_gating_mean),
+                         F16((1. + VocAlgorithm_GATING_MAX_RATIO)))) -
+              F16(VocAlgorithm_GATING_MAX_RATIO)))));
+    if ((state->m_Mean_Variance_Estimator___Gating_Duration_Minutes <
          F16(0.))) {
-        params->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
+        state->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
     }
-    if ((params->m_Mean_Variance_Estimator___Gating_Duration_Minutes >
-         params->m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes)) {
-        params->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
+    if ((state->m_Mean_Variance_Estimator___Gating_Duration_Minutes >
+         config->m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes)) {
+        state->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
+        state->m_Mean_Variance_Estimator___Uptime_Gating_Saturated = false;
     }
 }
 
 static void VocAlgorithm__mean_variance_estimator__process(
-    VocAlgorithmParams* params, fix16_t sraw, fix16_t voc_index_from_prior) {
+    const VocAlgorithmConfig* config, VocAlgorithmState* state, fix16_t sraw,
+    fix16_t voc_index_from_prior) {
 
     fix16_t delta_sgp;
     fix16_t c;
     fix16_t additional_scaling;
+    fix16_t gamma_mean;
+    fix16_t gamma_variance;
 
-    if (!params->m_Mean_Variance_Estimator___Initialized) {
-        params->m_Mean_Variance_Estimator___Initialized = true;
-        params->m_Mean_Variance_Estimator___Sraw_Offset = sraw;
-        params->m_Mean_Variance_Estimator___Mean = F16(0.);
+    if (!state->m_Mean_Variance_Estimator___Initialized) {
+        state->m_Mean_Variance_Estimator___Initialized = true;
+        state->m_Mean_Variance_Estimator___Sraw_Offset = sraw;
+        state->m_Mean_Variance_Estimator___Mean = F16(0.);
     } else {
-        if (((params->m_Mean_Variance_Estimator___Mean >= F16(100.)) ||
-             (params->m_Mean_Variance_Estimator___Mean <= F16(-100.)))) {
-            params->m_Mean_Variance_Estimator___Sraw_Offset =
-                (params->m_Mean_Variance_Estimator___Sraw_Offset +
-                 params->m_Mean_Variance_Estimator___Mean);
-            params->m_Mean_Variance_Estimator___Mean = F16(0.);
+        if (((state->m_Mean_Variance_Estimator___Mean >= F16(100.)) ||
+             (state->m_Mean_Variance_Estimator___Mean <= F16(-100.)))) {
+            state->m_Mean_Variance_Estimator___Sraw_Offset =
+                (state->m_Mean_Variance_Estimator___Sraw_Offset +
+                 state->m_Mean_Variance_Estimator___Mean);
+            state->m_Mean_Variance_Estimator___Mean = F16(0.);
         }
-        sraw = (sraw - params->m_Mean_Variance_Estimator___Sraw_Offset);
+        sraw = (sraw - state->m_Mean_Variance_Estimator___Sraw_Offset);
         VocAlgorithm__mean_variance_estimator___calculate_gamma(
-            params, voc_index_from_prior);
+            config, state, voc_index_from_prior, &gamma_mean, &gamma_variance);
         delta_sgp = (fix16_div(
-            (sraw - params->m_Mean_Variance_Estimator___Mean),
+            (sraw - state->m_Mean_Variance_Estimator___Mean),
             F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING)));
         if ((delta_sgp < F16(0.))) {
-            c = (params->m_Mean_Variance_Estimator___Std - delta_sgp);
+            c = (state->m_Mean_Variance_Estimator___Std - delta_sgp);
         } else {
-            c = (params->m_Mean_Variance_Estimator___Std + delta_sgp);
+            c = (state->m_Mean_Variance_Estimator___Std + delta_sgp);
         }
         additional_scaling = F16(1.);
         if ((c > F16(1440.))) {
             additional_scaling = F16(4.);
         }
-        params->m_Mean_Variance_Estimator___Std = (fix16_mul(
+        state->m_Mean_Variance_Estimator___Std = (fix16_mul(
             fix16_sqrt((fix16_mul(
                 additional_scaling,
                 (F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING) -
-                 params->m_Mean_Variance_Estimator__Gamma_Variance)))),
+                 gamma_variance)))),
             fix16_sqrt((
                 (fix16_mul(
-                    params->m_Mean_Variance_Estimator___Std,
+                    state->m_Mean_Variance_Estimator___Std,
                     (fix16_div(
-                        params->m_Mean_Variance_Estimator___Std,
+                        state->m_Mean_Variance_Estimator___Std,
                         (fix16_mul(
                             F16(VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING),
                             additional_scaling)))))) +
-                (fix16_mul(
-                    (fix16_div(
-                        (fix16_mul(
-                            params->m_Mean_Variance_Estimator__Gamma_Variance,
-                            delta_sgp)),
-                        additional_scaling)),
-                    delta_sgp))))));
-        params->m_Mean_Variance_Estimator___Mean =
-            (params->m_Mean_Variance_Estimator___Mean +
-             (fix16_mul(params->m_Mean_Variance_Estimator__Gamma_Mean,
-                        delta_sgp)));
+                (fix16_mul((fix16_div((fix16_mul(gamma_variance, delta_sgp)),
+                                      additional_scaling)),
+                           delta_sgp))))));
+        state->m_Mean_Variance_Estimator___Mean =
+            (state->m_Mean_Variance_Estimator___Mean +
+             (fix16_mul(gamma_mean, delta_sgp)));
     }
 }
 
-static void VocAlgorithm__mean_variance_estimator___sigmoid__init(
-    VocAlgorithmParams* params) {
-
-    VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-        params, F16(0.), F16(0.), F16(0.));
-}
-
-static void VocAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
-    VocAlgorithmParams* params, fix16_t L, fix16_t X0, fix16_t K) {
-
-    params->m_Mean_Variance_Estimator___Sigmoid__L = L;
-    params->m_Mean_Variance_Estimator___Sigmoid__K = K;
-    params->m_Mean_Variance_Estimator___Sigmoid__X0 = X0;
-}
-
-static fix16_t VocAlgorithm__mean_variance_estimator___sigmoid__process(
-    VocAlgorithmParams* params, fix16_t sample) {
+static fix16_t
+VocAlgorithm__mean_variance_estimator___sigmoid__process(fix16_t X0, fix16_t K,
+                                                         fix16_t sample) {
 
+    // All sigmoids of the estimator have an amplitude L of 1
     fix16_t x;
 
-    x = (fix16_mul(params->m_Mean_Variance_Estimator___Sigmoid__K,
-                   (sample - params->m_Mean_Variance_Estimator___Sigmoid__X0)));
+    x = (fix16_mul(K, (sample - X0)));
     if ((x < F16(-50.))) {
-        return params->m_Mean_Variance_Estimator___Sigmoid__L;
+        return F16(1.);
     } else if ((x > F16(50.))) {
         return F16(0.);
     } else {
-        return (fix16_div(params->m_Mean_Variance_Estimator___Sigmoid__L,
-                          (F16(1.) + fix16_exp(x))));
+        return (fix16_div(F16(1.), fix16_one_plus_exp(x)));
     }
 }
+static bool VocAlgorithm__mean_variance_estimator___sigmoid__is_saturated(
+    fix16_t X0, fix16_t K, fix16_t sample) {
 
-static void VocAlgorithm__mox_model__init(VocAlgorithmParams* params) {
+    // True if process() returns zero for this and all larger samples
+    fix16_t x;
 
-    VocAlgorithm__mox_model__set_parameters(params, F16(1.), F16(0.));
+    x = (fix16_mul(K, (sample - X0)));
+    return (x > F16(50.));
 }
 
-static void VocAlgorithm__mox_model__set_parameters(VocAlgorithmParams* params,
+static void VocAlgorithm__mox_model__set_parameters(VocAlgorithmState* state,
                                                     fix16_t SRAW_STD,
                                                     fix16_t SRAW_MEAN) {
 
-    params->m_Mox_Model__Sraw_Std = SRAW_STD;
-    params->m_Mox_Model__Sraw_Mean = SRAW_MEAN;
+    state->m_Mox_Model__Sraw_Std = SRAW_STD;
+    state->m_Mox_Model__Sraw_Mean = SRAW_MEAN;
 }
 
-static fix16_t VocAlgorithm__mox_model__process(VocAlgorithmParams* params,
-                                                fix16_t sraw) {
+static fix16_t
+VocAlgorithm__mox_model__process(const VocAlgorithmState* state, fix16_t sraw) {
 
-    return (fix16_mul((fix16_div((sraw - params->m_Mox_Model__Sraw_Mean),
-                                 (-(params->m_Mox_Model__Sraw_Std +
+    return (fix16_mul((fix16_div((sraw - state->m_Mox_Model__Sraw_Mean),
+                                 (-(state->m_Mox_Model__Sraw_Std +
                                     F16(VocAlgorithm_SRAW_STD_BONUS))))),
                       F16(VocAlgorithm_VOC_INDEX_GAIN)));
 }
 
-static void VocAlgorithm__sigmoid_scaled__init(VocAlgorithmParams* params) {
-
-    VocAlgorithm__sigmoid_scaled__set_parameters(params, F16(0.));
-}
-
 static void
-VocAlgorithm__sigmoid_scaled__set_parameters(VocAlgorithmParams* params,
+VocAlgorithm__sigmoid_scaled__set_parameters(VocAlgorithmConfig* config,
                                              fix16_t offset) {
 
-    params->m_Sigmoid_Scaled__Offset = offset;
+    config->m_Sigmoid_Scaled__Offset = offset;
 }
 
-static fix16_t VocAlgorithm__sigmoid_scaled__process(VocAlgorithmParams* params,
-                                                     fix16_t sample) {
+static fix16_t
+VocAlgorithm__sigmoid_scaled__process(const VocAlgorithmConfig* config,
+                                      fix16_t sample) {
 
     fix16_t x;
     fix16_t shift;
@@ -731,40 +1513,40 @@ static fix16_t VocAlgorithm__sigmoid_scaled__process(VocAlgorithmParams* params,
         if ((sample >= F16(0.))) {
             shift = (fix16_div(
                 (F16(VocAlgorithm_SIGMOID_L) -
-                 (fix16_mul(F16(5.), params->m_Sigmoid_Scaled__Offset))),
+                 (fix16_mul(F16(5.), config->m_Sigmoid_Scaled__Offset))),
                 F16(4.)));
             return ((fix16_div((F16(VocAlgorithm_SIGMOID_L) + shift),
-                               (F16(1.) + fix16_exp(x)))) -
+                               fix16_one_plus_exp(x))) -
                     shift);
         } else {
             return (fix16_mul(
-                (fix16_div(params->m_Sigmoid_Scaled__Offset,
+                (fix16_div(config->m_Sigmoid_Scaled__Offset,
                            F16(VocAlgorithm_VOC_INDEX_OFFSET_DEFAULT))),
                 (fix16_div(F16(VocAlgorithm_SIGMOID_L),
-                           (F16(1.) + fix16_exp(x))))));
+                           fix16_one_plus_exp(x)))));
         }
     }
 }
 
-static void VocAlgorithm__adaptive_lowpass__init(VocAlgorithmParams* params) {
+static void VocAlgorithm__adaptive_lowpass__init(VocAlgorithmState* state) {
 
-    VocAlgorithm__adaptive_lowpass__set_parameters(params);
+    state->m_Adaptive_Lowpass___Initialized = false;
 }
 
 static void
-VocAlgorithm__adaptive_lowpass__set_parameters(VocAlgorithmParams* params) {
-
-    params->m_Adaptive_Lowpass__A1 =
-        F16((VocAlgorithm_SAMPLING_INTERVAL /
-             (VocAlgorithm_LP_TAU_FAST + VocAlgorithm_SAMPLING_INTERVAL)));
-    params->m_Adaptive_Lowpass__A2 =
-        F16((VocAlgorithm_SAMPLING_INTERVAL /
-             (VocAlgorithm_LP_TAU_SLOW + VocAlgorithm_SAMPLING_INTERVAL)));
-    params->m_Adaptive_Lowpass___Initialized = false;
+VocAlgorithm__adaptive_lowpass__set_parameters(VocAlgorithmConfig* config) {
+
+    config->m_Adaptive_Lowpass__A1 = fix16_div_rounded(
+        config->mSampling_Interval,
+        (F16(VocAlgorithm_LP_TAU_FAST) + config->mSampling_Interval));
+    config->m_Adaptive_Lowpass__A2 = fix16_div_rounded(
+        config->mSampling_Interval,
+        (F16(VocAlgorithm_LP_TAU_SLOW) + config->mSampling_Interval));
 }
 
 static fix16_t
-VocAlgorithm__adaptive_lowpass__process(VocAlgorithmParams* params,
+VocAlgorithm__adaptive_lowpass__process(const VocAlgorithmConfig* config,
+                                        VocAlgorithmState* state,
                                         fix16_t sample) {
 
     fix16_t abs_delta;
@@ -772,22 +1554,22 @@ VocAlgorithm__adaptive_lowpass__process(VocAlgorithmParams* params,
     fix16_t tau_a;
     fix16_t a3;
 
-    if (!params->m_Adaptive_Lowpass___Initialized) {
-        params->m_Adaptive_Lowpass___X1 = sample;
-        params->m_Adaptive_Lowpass___X2 = sample;
-        params->m_Adaptive_Lowpass___X3 = sample;
-        params->m_Adaptive_Lowpass___Initialized = true;
-    }
-    params->m_Adaptive_Lowpass___X1 =
-        ((fix16_mul((F16(1.) - params->m_Adaptive_Lowpass__A1),
-                    params->m_Adaptive_Lowpass___X1)) +
-         (fix16_mul(params->m_Adaptive_Lowpass__A1, sample)));
-    params->m_Adaptive_Lowpass___X2 =
-        ((fix16_mul((F16(1.) - params->m_Adaptive_Lowpass__A2),
-                    params->m_Adaptive_Lowpass___X2)) +
-         (fix16_mul(params->m_Adaptive_Lowpass__A2, sample)));
+    if (!state->m_Adaptive_Lowpass___Initialized) {
+        state->m_Adaptive_Lowpass___X1 = sample;
+        state->m_Adaptive_Lowpass___X2 = sample;
+        state->m_Adaptive_Lowpass___X3 = sample;
+        state->m_Adaptive_Lowpass___Initialized = true;
+    }
+    state->m_Adaptive_Lowpass___X1 =
+        ((fix16_mul((F16(1.) - config->m_Adaptive_Lowpass__A1),
+                    state->m_Adaptive_Lowpass___X1)) +
+         (fix16_mul(config->m_Adaptive_Lowpass__A1, sample)));
+    state->m_Adaptive_Lowpass___X2 =
+        ((fix16_mul((F16(1.) - config->m_Adaptive_Lowpass__A2),
+                    state->m_Adaptive_Lowpass___X2)) +
+         (fix16_mul(config->m_Adaptive_Lowpass__A2, sample)));
     abs_delta =
-        (params->m_Adaptive_Lowpass___X1 - params->m_Adaptive_Lowpass___X2);
+        (state->m_Adaptive_Lowpass___X1 - state->m_Adaptive_Lowpass___X2);
     if ((abs_delta < F16(0.))) {
         abs_delta = (-abs_delta);
     }
@@ -796,10 +1578,10 @@ VocAlgorithm__adaptive_lowpass__process(VocAlgorithmParams* params,
         ((fix16_mul(F16((VocAlgorithm_LP_TAU_SLOW - VocAlgorithm_LP_TAU_FAST)),
                     F1)) +
          F16(VocAlgorithm_LP_TAU_FAST));
-    a3 = (fix16_div(F16(VocAlgorithm_SAMPLING_INTERVAL),
-                    (F16(VocAlgorithm_SAMPLING_INTERVAL) + tau_a)));
-    params->m_Adaptive_Lowpass___X3 =
-        ((fix16_mul((F16(1.) - a3), params->m_Adaptive_Lowpass___X3)) +
+    a3 = (fix16_div(config->mSampling_Interval,
+                    (config->mSampling_Interval + tau_a)));
+    state->m_Adaptive_Lowpass___X3 =
+        ((fix16_mul((F16(1.) - a3), state->m_Adaptive_Lowpass___X3)) +
          (fix16_mul(a3, sample)));
-    return params->m_Adaptive_Lowpass___X3;
+    return state->m_Adaptive_Lowpass___X3;
 }
@@ -36,6 +36,16 @@
 
 /* The fixed point arithmetic parts of this code were originally created by
  * https://github.com/PetteriAimonen/libfixmath
+ *
+ * Define FIXMATH_USE_64BIT on targets with a fast 64-bit multiply and divide
+ * (e.g. 32/64-bit application processors) to use 64-bit intermediates in
+ * fix16_mul() and fix16_div(). The results are bit-identical to the default
+ * 32-bit implementation, also with FIXMATH_NO_ROUNDING and FIXMATH_NO_OVERFLOW.
+ *
+ * The implementation of fix16_exp() can be selected by defining at most one of
+ * - FIXMATH_EXP_LUT: table lookup, bit-identical results, ~5.6kB more flash
+ * - FIXMATH_EXP_FAST: polynomial approximation, at most 2 LSB away from the
+ *   correctly rounded exp(), which slightly changes the VOC index output
  */
 
 typedef int32_t fix16_t;
@@ -49,6 +59,8 @@ typedef int32_t fix16_t;
 #endif
 
 #define VocAlgorithm_SAMPLING_INTERVAL (1.)
+#define VocAlgorithm_SAMPLING_INTERVAL_MIN 1
+#define VocAlgorithm_SAMPLING_INTERVAL_MAX 10
 #define VocAlgorithm_INITIAL_BLACKOUT (45.)
 #define VocAlgorithm_VOC_INDEX_GAIN (230.)
 #define VocAlgorithm_SRAW_STD_INITIAL (50.)
@@ -75,43 +87,72 @@ typedef int32_t fix16_t;
 #define VocAlgorithm_PERSISTENCE_UPTIME_GAMMA ((3. * 3600.))
 #define VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING (64.)
 #define VocAlgorithm_MEAN_VARIANCE_ESTIMATOR__FIX16_MAX (32767.)
+#define VocAlgorithm_MAX_GAP_SECONDS (600.)
+
+#define VocAlgorithm_SNAPSHOT_MAGIC_0 0x56 /* 'V' */
+#define VocAlgorithm_SNAPSHOT_MAGIC_1 0x41 /* 'A' */
+#define VocAlgorithm_SNAPSHOT_VERSION 1
+/* magic, version, 19 big-endian 32-bit values, flags, CRC-16 */
+#define VocAlgorithm_SNAPSHOT_SIZE (2 + 1 + 19 * 4 + 1 + 2)
+#define VocAlgorithm_SNAPSHOT_ERR_SIZE (-1)
+#define VocAlgorithm_SNAPSHOT_ERR_FORMAT (-2)
+#define VocAlgorithm_SNAPSHOT_ERR_CRC (-3)
+#define VocAlgorithm_ERR_SAMPLING_INTERVAL (-4)
 
 /**
- * Struct to hold all the states of the VOC algorithm.
+ * Struct to hold the tuning parameters of the VOC algorithm and the constants
+ * derived from them. It does not change while processing, so it can be shared
+ * by all sensors with the same sampling interval and tuning parameters.
  */
 typedef struct {
     fix16_t mVoc_Index_Offset;
     fix16_t mTau_Mean_Variance_Hours;
     fix16_t mGating_Max_Duration_Minutes;
     fix16_t mSraw_Std_Initial;
+    fix16_t mSampling_Interval;
+    fix16_t m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes;
+    fix16_t m_Mean_Variance_Estimator__Sampling_Interval_Minutes;
+    fix16_t m_Mean_Variance_Estimator___Gamma;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Mean;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Variance;
+    fix16_t m_Sigmoid_Scaled__Offset;
+    fix16_t m_Adaptive_Lowpass__A1;
+    fix16_t m_Adaptive_Lowpass__A2;
+} VocAlgorithmConfig;
+
+/**
+ * Struct to hold the mutable states of the VOC algorithm for one sensor.
+ */
+typedef struct {
     fix16_t mUptime;
     fix16_t mSraw;
     fix16_t mVoc_Index;
-    fix16_t m_Mean_Variance_Estimator__Gating_Max_Duration_Minutes;
-    bool m_Mean_Variance_Estimator___Initialized;
     fix16_t m_Mean_Variance_Estimator___Mean;
     fix16_t m_Mean_Variance_Estimator___Sraw_Offset;
     fix16_t m_Mean_Variance_Estimator___Std;
-    fix16_t m_Mean_Variance_Estimator___Gamma;
-    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Mean;
-    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Variance;
-    fix16_t m_Mean_Variance_Estimator__Gamma_Mean;
-    fix16_t m_Mean_Variance_Estimator__Gamma_Variance;
     fix16_t m_Mean_Variance_Estimator___Uptime_Gamma;
     fix16_t m_Mean_Variance_Estimator___Uptime_Gating;
     fix16_t m_Mean_Variance_Estimator___Gating_Duration_Minutes;
-    fix16_t m_Mean_Variance_Estimator___Sigmoid__L;
-    fix16_t m_Mean_Variance_Estimator___Sigmoid__K;
-    fix16_t m_Mean_Variance_Estimator___Sigmoid__X0;
     fix16_t m_Mox_Model__Sraw_Std;
     fix16_t m_Mox_Model__Sraw_Mean;
-    fix16_t m_Sigmoid_Scaled__Offset;
-    fix16_t m_Adaptive_Lowpass__A1;
-    fix16_t m_Adaptive_Lowpass__A2;
-    bool m_Adaptive_Lowpass___Initialized;
     fix16_t m_Adaptive_Lowpass___X1;
     fix16_t m_Adaptive_Lowpass___X2;
     fix16_t m_Adaptive_Lowpass___X3;
+    bool m_Mean_Variance_Estimator___Initialized;
+    bool m_Mean_Variance_Estimator___Uptime_Gamma_Saturated;
+    bool m_Mean_Variance_Estimator___Uptime_Gating_Saturated;
+    bool m_Adaptive_Lowpass___Initialized;
+} VocAlgorithmState;
+
+/**
+ * Struct to hold all the states of the VOC algorithm.
+ */
+typedef struct {
+    VocAlgorithmConfig mConfig;
+    VocAlgorithmState mState;
+    bool mTimestamp_Valid;
+    uint32_t mTimestamp_Ms;
+    uint32_t mTimestamp_Remainder_Ms;
 } VocAlgorithmParams;
 
 /**
@@ -121,6 +162,21 @@ typedef struct {
  */
 void VocAlgorithm_init(VocAlgorithmParams* params);
 
+/**
+ * Initialize the VOC algorithm parameters for a sampling interval other than
+ * the default of VocAlgorithm_SAMPLING_INTERVAL seconds. All time constants of
+ * the algorithm are adapted, so VocAlgorithm_process() must be called exactly
+ * once per sampling interval. Call this instead of VocAlgorithm_init().
+ * @param params            Pointer to the VocAlgorithmParams struct
+ * @param sampling_interval Time between two samples.
+ *                          Range 1..10 [seconds], default 1 [second]
+ * @return                  0 on success, VocAlgorithm_ERR_SAMPLING_INTERVAL
+ *                          if sampling_interval is outside of 1..10, the
+ *                          params are not changed then
+ */
+int16_t VocAlgorithm_init_with_sampling_interval(VocAlgorithmParams* params,
+                                                 int32_t sampling_interval);
+
 /**
  * Get current algorithm states. Retrieved values can be used in
  * VocAlgorithm_set_states() to resume operation after a short interruption,
@@ -146,6 +202,37 @@ void VocAlgorithm_get_states(VocAlgorithmParams* params, int32_t* state0,
 void VocAlgorithm_set_states(VocAlgorithmParams* params, int32_t state0,
                              int32_t state1);
 
+/**
+ * Serialize the complete algorithm state, including the tuning parameters, to
+ * a byte buffer of VocAlgorithm_SNAPSHOT_SIZE bytes. The format is versioned,
+ * independent of the platform endianness and protected by a CRC-16. Unlike
+ * VocAlgorithm_get_states(), restoring it with VocAlgorithm_set_snapshot()
+ * continues exactly where the algorithm left off, without blackout period.
+ * @param params    Pointer to the VocAlgorithmParams struct
+ * @param snapshot  Buffer to write the snapshot to
+ * @param size      Size of the buffer, at least VocAlgorithm_SNAPSHOT_SIZE
+ * @return          0 on success, VocAlgorithm_SNAPSHOT_ERR_SIZE if the buffer
+ *                  is too small
+ */
+int16_t VocAlgorithm_get_snapshot(VocAlgorithmParams* params,
+                                  uint8_t* snapshot, uint16_t size);
+
+/**
+ * Restore the complete algorithm state from a snapshot previously created by
+ * VocAlgorithm_get_snapshot(). No prior call of VocAlgorithm_init() or
+ * VocAlgorithm_set_tuning_parameters() is needed. If the snapshot is
+ * rejected, the algorithm state is left unchanged.
+ * @param params    Pointer to the VocAlgorithmParams struct
+ * @param snapshot  Snapshot to be restored
+ * @param size      Size of the snapshot, at least VocAlgorithm_SNAPSHOT_SIZE
+ * @return          0 on success, VocAlgorithm_SNAPSHOT_ERR_SIZE if the
+ *                  snapshot is too short, VocAlgorithm_SNAPSHOT_ERR_FORMAT if
+ *                  it has an unknown format or version and
+ *                  VocAlgorithm_SNAPSHOT_ERR_CRC if it is corrupted
+ */
+int16_t VocAlgorithm_set_snapshot(VocAlgorithmParams* params,
+                                  const uint8_t* snapshot, uint16_t size);
+
 /**
  * Set parameters to customize the VOC algorithm. Call this once after
  * VocAlgorithm_init(), if desired. Otherwise, the default values will be used.
@@ -184,4 +271,116 @@ void VocAlgorithm_set_tuning_parameters(VocAlgorithmParams* params,
 void VocAlgorithm_process(VocAlgorithmParams* params, int32_t sraw,
                           int32_t* voc_index);
 
+/**
+ * Calculate the VOC index value from a raw sensor value taken at the given
+ * time, for acquisition loops that cannot guarantee exactly one sample per
+ * sampling interval. The algorithm is advanced by the number of sampling
+ * intervals elapsed since the previous call, with the remaining time carried
+ * over to the next call:
+ * - no full interval elapsed: the sample is dropped and the previous VOC index
+ *   is returned
+ * - one or more intervals elapsed: the algorithm is advanced once per interval
+ *   using this sample, i.e. missed samples are replaced by this one
+ * - more than VocAlgorithm_MAX_GAP_SECONDS elapsed: the algorithm is restarted
+ *   with the initial blackout period, keeping the tuning parameters
+ * Do not mix with calls to VocAlgorithm_process() on the same instance.
+ *
+ * @param params       Pointer to the VocAlgorithmParams struct
+ * @param sraw         Raw value from the SGP40 sensor
+ * @param timestamp_ms Monotonic time of the measurement in milliseconds, may
+ *                     wrap around
+ * @param voc_index    Calculated VOC index value from the raw sensor value.
+ *                     Zero during initial blackout period and 1..500
+ *                     afterwards
+ */
+void VocAlgorithm_process_with_timestamp(VocAlgorithmParams* params,
+                                         int32_t sraw, uint32_t timestamp_ms,
+                                         int32_t* voc_index);
+
+/**
+ * Calculate the VOC index values for a series of consecutive raw sensor
+ * values. The result is identical to calling VocAlgorithm_process() once per
+ * sample, but avoids the per-sample call overhead when replaying logged data.
+ *
+ * @param params    Pointer to the VocAlgorithmParams struct
+ * @param sraw      Array of raw values from the SGP40 sensor, one per
+ *                  sampling interval
+ * @param voc_index Output array for the calculated VOC index values. Must hold
+ *                  at least count elements.
+ * @param count     Number of samples to process
+ */
+void VocAlgorithm_process_batch(VocAlgorithmParams* params,
+                                const uint16_t* sraw, int32_t* voc_index,
+                                uint32_t count);
+
+/**
+ * Initialize a configuration shared by several sensors with the same sampling
+ * interval and the default tuning parameters. Together with one
+ * VocAlgorithmState per sensor, this needs considerably less memory than one
+ * VocAlgorithmParams per sensor.
+ * @param config            Pointer to the VocAlgorithmConfig struct
+ * @param sampling_interval Time between two samples.
+ *                          Range 1..10 [seconds], default 1 [second]
+ * @return                  0 on success, VocAlgorithm_ERR_SAMPLING_INTERVAL
+ *                          if sampling_interval is outside of 1..10, the
+ *                          config is not changed then
+ */
+int16_t VocAlgorithm_init_config(VocAlgorithmConfig* config,
+                                 int32_t sampling_interval);
+
+/**
+ * Set parameters to customize a shared configuration, see
+ * VocAlgorithm_set_tuning_parameters() for the description and range of the
+ * parameters. The states of all sensors using this configuration have to be
+ * initialized again with VocAlgorithm_init_state() afterwards.
+ * @param config                      Pointer to the VocAlgorithmConfig struct
+ * @param voc_index_offset            VOC index representing typical (average)
+ *                                    conditions
+ * @param learning_time_hours         Time constant of long-term estimator
+ * @param gating_max_duration_minutes Maximum duration of gating
+ * @param std_initial                 Initial estimate for standard deviation
+ */
+void VocAlgorithm_set_config_tuning_parameters(
+    VocAlgorithmConfig* config, int32_t voc_index_offset,
+    int32_t learning_time_hours, int32_t gating_max_duration_minutes,
+    int32_t std_initial);
+
+/**
+ * Initialize the states of one sensor. Call this once at the beginning or
+ * whenever the sensor stopped measurements.
+ * @param config    Pointer to the shared VocAlgorithmConfig struct
+ * @param state     Pointer to the VocAlgorithmState struct of the sensor
+ */
+void VocAlgorithm_init_state(const VocAlgorithmConfig* config,
+                             VocAlgorithmState* state);
+
+/**
+ * Calculate the VOC index value of one sensor from the raw sensor value, like
+ * VocAlgorithm_process().
+ * @param config    Pointer to the shared VocAlgorithmConfig struct
+ * @param state     Pointer to the VocAlgorithmState struct of the sensor
+ * @param sraw      Raw value from the SGP40 sensor
+ * @param voc_index Calculated VOC index value from the raw sensor value. Zero
+ *                  during initial blackout period and 1..500 afterwards
+ */
+void VocAlgorithm_process_state(const VocAlgorithmConfig* config,
+                                VocAlgorithmState* state, int32_t sraw,
+                                int32_t* voc_index);
+
+/**
+ * Calculate the VOC index values of several sensors sharing one configuration
+ * for one sampling interval. The result is identical to calling
+ * VocAlgorithm_process_state() once for each state.
+ * @param config    Pointer to the shared VocAlgorithmConfig struct
+ * @param states    Array of count VocAlgorithmState structs, one per sensor
+ * @param sraw      Array of count raw values, sraw[i] belongs to states[i]
+ * @param voc_index Output array for the calculated VOC index values. Must hold
+ *                  at least count elements.
+ * @param count     Number of sensors to process
+ */
+void VocAlgorithm_process_states(const VocAlgorithmConfig* config,
+                                 VocAlgorithmState* states,
+                                 const uint16_t* sraw, int32_t* voc_index,
+                                 uint32_t count);
+
 #endif /* VOCALGORITHM_H_ */
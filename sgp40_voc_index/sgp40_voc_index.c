@@ -39,39 +39,113 @@
 extern "C" {
 #endif
 
-static VocAlgorithmParams voc_algorithm_params;
+/* used by the functions without context, on the currently selected bus */
+static sensirion_voc_index_ctx default_ctx;
 
 int16_t sensirion_init_sensors() {
+    sensirion_i2c_init();
+    return sensirion_init_sensors_ctx(&default_ctx, 0);
+}
+
+int16_t sensirion_measure_voc_index(int32_t* voc_index) {
+    return sensirion_measure_voc_index_with_rh_t(voc_index, NULL, NULL);
+}
+
+int16_t sensirion_measure_voc_index_with_rh_t(int32_t* voc_index,
+                                              int32_t* relative_humidity,
+                                              int32_t* temperature) {
+    return sensirion_measure_voc_index_with_rh_t_ctx(
+        &default_ctx, voc_index, relative_humidity, temperature);
+}
+
+void sensirion_set_pipelined_mode(bool enable) {
+    sensirion_set_pipelined_mode_ctx(&default_ctx, enable);
+}
+
+/* the functions without context keep the currently selected bus */
+static sgp_i2c_bus* sensirion_ctx_bus(sensirion_voc_index_ctx* ctx) {
+    return ctx == &default_ctx ? NULL : &ctx->bus;
+}
+
+int16_t sensirion_init_sensors_ctx(sensirion_voc_index_ctx* ctx,
+                                   uint8_t bus_idx) {
+    sgp_i2c_bus bus = {bus_idx, NULL, NULL, NULL};
+
+    return sensirion_init_sensors_bus_ctx(ctx, &bus);
+}
+
+int16_t sensirion_init_sensors_bus_ctx(sensirion_voc_index_ctx* ctx,
+                                       const sgp_i2c_bus* bus) {
+    sgp_i2c_bus* ctx_bus = sensirion_ctx_bus(ctx);
     int16_t ret;
 
-    sensirion_i2c_init();
+    ctx->bus = *bus;
+    ctx->pipelined = false;
+    ctx->rht_valid = false;
+    if (sgp_i2c_bus_acquire(ctx_bus))
+        return SENSIRION_SELECT_BUS_FAILED;
 
     ret = shtc1_probe();
-    if (ret)
+    if (ret) {
+        sgp_i2c_bus_release(ctx_bus);
         return SENSIRION_SHT_PROBE_FAILED;
+    }
 
     ret = sgp40_probe();
+    sgp_i2c_bus_release(ctx_bus);
     if (ret)
         return SENSIRION_SGP_PROBE_FAILED;
 
-    VocAlgorithm_init(&voc_algorithm_params);
+    VocAlgorithm_init(&ctx->voc_algorithm_params);
     return 0;
 }
 
-int16_t sensirion_measure_voc_index(int32_t* voc_index) {
-    return sensirion_measure_voc_index_with_rh_t(voc_index, NULL, NULL);
+int16_t sensirion_measure_voc_index_ctx(sensirion_voc_index_ctx* ctx,
+                                        int32_t* voc_index) {
+    return sensirion_measure_voc_index_with_rh_t_ctx(ctx, voc_index, NULL,
+                                                     NULL);
 }
 
-int16_t sensirion_measure_voc_index_with_rh_t(int32_t* voc_index,
-                                              int32_t* relative_humidity,
-                                              int32_t* temperature) {
+int16_t sensirion_measure_voc_index_with_rh_t_ctx(sensirion_voc_index_ctx* ctx,
+                                                  int32_t* voc_index,
+                                                  int32_t* relative_humidity,
+                                                  int32_t* temperature) {
+    sgp_i2c_bus* ctx_bus = sensirion_ctx_bus(ctx);
     int32_t int_temperature, int_humidity;
     int16_t ret;
     uint16_t sraw;
+    bool pipelined = ctx->pipelined && ctx->rht_valid;
 
-    ret = shtc1_measure_blocking_read(&int_temperature, &int_humidity);
-    if (ret)
+    if (sgp_i2c_bus_acquire(ctx_bus))
+        return SENSIRION_SELECT_BUS_FAILED;
+    ret = shtc1_measure();
+    if (ret) {
+        sgp_i2c_bus_release(ctx_bus);
+        return SENSIRION_GET_RHT_SIGNAL_FAILED;
+    }
+    if (pipelined) {
+        /* compensate with the previous values while the SHTC1 converts */
+        ret = sgp40_measure_raw_with_rht(ctx->relative_humidity,
+                                         ctx->temperature);
+        if (ret) {
+            sgp_i2c_bus_release(ctx_bus);
+            return SENSIRION_GET_SGP_SIGNAL_FAILED;
+        }
+    }
+    /* other threads may use the bus while the sensors measure */
+    sgp_i2c_bus_release(ctx_bus);
+    sgp_clock_sleep_usec(SHTC1_MEASUREMENT_DURATION_USEC);
+    if (sgp_i2c_bus_acquire(ctx_bus))
+        return SENSIRION_SELECT_BUS_FAILED;
+    ret = shtc1_read(&int_temperature, &int_humidity);
+    if (ret) {
+        sgp_i2c_bus_release(ctx_bus);
+        ctx->rht_valid = false;
         return SENSIRION_GET_RHT_SIGNAL_FAILED;
+    }
+    ctx->relative_humidity = int_humidity;
+    ctx->temperature = int_temperature;
+    ctx->rht_valid = true;
 
     if (temperature) {
         *temperature = int_temperature;
@@ -80,16 +154,33 @@ int16_t sensirion_measure_voc_index_with_rh_t(int32_t* voc_index,
         *relative_humidity = int_humidity;
     }
 
-    ret = sgp40_measure_raw_with_rht_blocking_read(int_humidity,
-                                                   int_temperature, &sraw);
-    if (ret) {
-        return SENSIRION_GET_SGP_SIGNAL_FAILED;
+    if (pipelined) {
+        sgp_i2c_bus_release(ctx_bus);
+        sgp_clock_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US -
+                             SHTC1_MEASUREMENT_DURATION_USEC);
+    } else {
+        ret = sgp40_measure_raw_with_rht(int_humidity, int_temperature);
+        sgp_i2c_bus_release(ctx_bus);
+        if (ret)
+            return SENSIRION_GET_SGP_SIGNAL_FAILED;
+        sgp_clock_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
     }
+    if (sgp_i2c_bus_acquire(ctx_bus))
+        return SENSIRION_SELECT_BUS_FAILED;
+    ret = sgp40_read_raw(&sraw);
+    sgp_i2c_bus_release(ctx_bus);
+    if (ret)
+        return SENSIRION_GET_SGP_SIGNAL_FAILED;
 
-    VocAlgorithm_process(&voc_algorithm_params, sraw, voc_index);
+    VocAlgorithm_process(&ctx->voc_algorithm_params, sraw, voc_index);
     return 0;
 }
 
+void sensirion_set_pipelined_mode_ctx(sensirion_voc_index_ctx* ctx,
+                                      bool enable) {
+    ctx->pipelined = enable;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -34,6 +34,9 @@
 #include "sensirion_arch_config.h"
 #include "sensirion_common.h"
 #include "sensirion_i2c.h"
+#include "sensirion_voc_algorithm.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_bus.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +49,25 @@ extern "C" {
 #define SENSIRION_GET_SGP_SIGNAL_FAILED (-22)
 #define SENSIRION_SET_RHT_SIGNAL_FAILED (-23)
 
+#define SENSIRION_SELECT_BUS_FAILED (-31)
+
+/**
+ * Context of one SGP40 and SHTC1 pair. Each context owns its VOC algorithm
+ * state and the I2C bus the sensors are connected to, so several pairs can be
+ * driven independently. Both sensors have fixed I2C addresses, so each pair
+ * needs its own bus or channel of an I2C multiplexer, see struct sgp_i2c_bus.
+ * Other devices on the bus may be driven by other threads if the bus has a
+ * lock.
+ */
+typedef struct {
+    sgp_i2c_bus bus;
+    bool pipelined;
+    bool rht_valid;
+    int32_t relative_humidity;
+    int32_t temperature;
+    VocAlgorithmParams voc_algorithm_params;
+} sensirion_voc_index_ctx;
+
 /**
  * Initialize the SGP40, SHT and VOC algorithm.
  *
@@ -86,6 +108,114 @@ int16_t sensirion_measure_voc_index_with_rh_t(int32_t* voc_index,
                                               int32_t* relative_humidity,
                                               int32_t* temperature);
 
+/**
+ * Enable or disable the pipelined measurement mode (disabled by default).
+ *
+ * By default, each measurement waits for the SHTC1 conversion before starting
+ * the SGP40 measurement with the fresh humidity and temperature, so a
+ * measurement takes the sum of both durations. In pipelined mode, the SGP40
+ * measurement is started together with the SHTC1 conversion, compensated with
+ * the humidity and temperature of the previous measurement, so a measurement
+ * only takes as long as the SGP40 measurement. The returned humidity and
+ * temperature are still the freshly measured ones.
+ *
+ * The first measurement after enabling the mode, and any measurement after a
+ * failed humidity reading, runs sequentially. Only use the pipelined mode
+ * when measuring periodically, as the compensation lags behind by one period.
+ *
+ * @param enable    true to enable the pipelined mode, false to disable it
+ */
+void sensirion_set_pipelined_mode(bool enable);
+
+/**
+ * Initialize the SGP40, SHT and VOC algorithm of one sensor pair.
+ *
+ * Unlike sensirion_init_sensors(), this does not initialize the I2C
+ * implementation. Call sensirion_i2c_init() once before initializing the
+ * contexts.
+ *
+ * The context functions do not share any state, so different contexts can be
+ * used from different threads, provided that the platform's
+ * sensirion_i2c_select_bus() selects the bus for the calling thread only or
+ * the calls are serialized. The same context must not be used concurrently.
+ *
+ * @param ctx       Pointer to the context to initialize
+ * @param bus_idx   Index of the I2C bus the sensors are connected to, passed
+ *                  to sensirion_i2c_select_bus(). Use 0 on platforms with a
+ *                  single bus.
+ * @return          STATUS_OK on success, an error code otherwise
+ */
+int16_t sensirion_init_sensors_ctx(sensirion_voc_index_ctx* ctx,
+                                   uint8_t bus_idx);
+
+/**
+ * Initialize a context like sensirion_init_sensors_ctx() for the sensors on
+ * a given bus, e.g. a channel of an I2C multiplexer initialized with
+ * sgp_i2c_mux_init_bus(), or a bus shared with other threads.
+ *
+ * The bus is acquired with sgp_i2c_bus_acquire(), which takes its lock and
+ * selects it, for the commands and reads of the sensors, but not while
+ * waiting for their measurements.
+ *
+ * @param ctx       Pointer to the context to initialize
+ * @param bus       The bus the sensors are connected to. It is copied to the
+ *                  context, a multiplexer and lock it refers to must stay
+ *                  valid.
+ * @return          STATUS_OK on success, an error code otherwise
+ */
+int16_t sensirion_init_sensors_bus_ctx(sensirion_voc_index_ctx* ctx,
+                                       const sgp_i2c_bus* bus);
+
+/**
+ * Measure the humidity-compensated VOC Index of one sensor pair.
+ *
+ * This command works like sensirion_measure_voc_index() but uses the sensors
+ * and VOC algorithm state of the given context.
+ *
+ * @param ctx       Pointer to the context initialized with
+ *                  sensirion_init_sensors_ctx()
+ * @param voc_index Pointer to buffer for measured voc_index. Range 0..500.
+ * @return          STATUS_OK on success, an error code otherwise
+ */
+int16_t sensirion_measure_voc_index_ctx(sensirion_voc_index_ctx* ctx,
+                                        int32_t* voc_index);
+
+/**
+ * Measure the humidity-compensated VOC Index and ambient temperature and
+ * relative humidity of one sensor pair.
+ *
+ * This command works like sensirion_measure_voc_index_with_rh_t() but uses
+ * the sensors and VOC algorithm state of the given context. The bus is
+ * selected again after each wait for a measurement, so other contexts may use
+ * the I2C implementation in the meantime.
+ *
+ * @param ctx               Pointer to the context initialized with
+ *                          sensirion_init_sensors_ctx()
+ * @param voc_index         Pointer to buffer for measured VOC index. Range
+ *                          0..500.
+ * @param relative_humidity Pointer to buffer for relative humidity in milli %RH
+ * @param temperature       Pointer to buffer for measured temperature in milli
+ *                          degree Celsius.
+ * @return                  STATUS_OK on success, an error code otherwise
+ */
+int16_t sensirion_measure_voc_index_with_rh_t_ctx(sensirion_voc_index_ctx* ctx,
+                                                  int32_t* voc_index,
+                                                  int32_t* relative_humidity,
+                                                  int32_t* temperature);
+
+/**
+ * Enable or disable the pipelined measurement mode of one sensor pair.
+ *
+ * This command works like sensirion_set_pipelined_mode() but only affects
+ * the given context.
+ *
+ * @param ctx       Pointer to the context initialized with
+ *                  sensirion_init_sensors_ctx()
+ * @param enable    true to enable the pipelined mode, false to disable it
+ */
+void sensirion_set_pipelined_mode_ctx(sensirion_voc_index_ctx* ctx,
+                                      bool enable);
+
 #ifdef __cplusplus
 }
 #endif
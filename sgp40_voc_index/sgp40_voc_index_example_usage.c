@@ -30,6 +30,7 @@
  */
 
 #include "sgp40_voc_index.h"
+#include "sgp_periodic.h"
 
 #include <stdio.h>  // printf
 
@@ -43,15 +44,23 @@ int main(void) {
     int32_t temperature_celsius;
     int32_t relative_humidity_percent;
     int16_t err;
+    sgp_periodic periodic;
 
     /* Initialize I2C bus, SHT, SGP and VOC Engine */
     while ((err = sensirion_init_sensors())) {
         printf("initialization failed: %d\n", err);
-        sensirion_sleep_usec(1000000); /* wait one second */
+        sgp_clock_sleep_usec(1000000); /* wait one second */
     }
     printf("initialization successful\n");
 
-    /* Run one measurement per second */
+    /* Run one measurement per second, as expected by the VOC algorithm.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 1000000);
     while (1) {
         err = sensirion_measure_voc_index_with_rh_t(
             &voc_index, &relative_humidity_percent, &temperature_celsius);
@@ -64,7 +73,9 @@ int main(void) {
             printf("error reading signal: %d\n", err);
         }
 
-        sensirion_sleep_usec(1000000); /* wait one second */
+        if (sgp_periodic_wait(&periodic)) {
+            printf("measurement took longer than one second\n");
+        }
     }
 
     return 0;
@@ -36,76 +36,120 @@
 #include "sgp_git_version.h"
 
 #define SGPC3_PRODUCT_TYPE 1
-static const uint8_t SGPC3_I2C_ADDRESS = 0x58;
 
 /* command and constants for reading the serial ID */
 #define SGPC3_CMD_GET_SERIAL_ID 0x3682
-#define SGPC3_CMD_GET_SERIAL_ID_DURATION_US 500
 #define SGPC3_CMD_GET_SERIAL_ID_WORDS 3
 
 /* command and constants for reading the featureset version */
 #define SGPC3_CMD_GET_FEATURESET 0x202f
-#define SGPC3_CMD_GET_FEATURESET_DURATION_US 1000
 #define SGPC3_CMD_GET_FEATURESET_WORDS 1
 
 /* command and constants for on-chip self-test */
 #define SGPC3_CMD_MEASURE_TEST 0x2032
-#define SGPC3_CMD_MEASURE_TEST_DURATION_US 220000
 #define SGPC3_CMD_MEASURE_TEST_WORDS 1
 #define SGPC3_CMD_MEASURE_TEST_OK 0xd400
 
 /* command and constants for IAQ init 0 */
 #define SGPC3_CMD_IAQ_INIT_0 0x2089
-#define SGPC3_CMD_IAQ_INIT_0_DURATION_US 10000
 
 /* command and constants for IAQ init 64 */
 #define SGPC3_CMD_IAQ_INIT_64 0x2003
-#define SGPC3_CMD_IAQ_INIT_64_DURATION_US 10000
 
 /* command and constants for IAQ init continuous */
 #define SGPC3_CMD_IAQ_INIT_CON 0x20ae
-#define SGPC3_CMD_IAQ_INIT_CON_DURATION_US 10000
 
 /* command and constants for IAQ measure */
 #define SGPC3_CMD_IAQ_MEASURE 0x2008
-#define SGPC3_CMD_IAQ_MEASURE_DURATION_US 50000
 #define SGPC3_CMD_IAQ_MEASURE_WORDS 1
 
 /* command and constants for getting IAQ baseline */
 #define SGPC3_CMD_GET_IAQ_BASELINE 0x2015
-#define SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US 10000
 #define SGPC3_CMD_GET_IAQ_BASELINE_WORDS 1
 
 /* command and constants for setting IAQ baseline */
 #define SGPC3_CMD_SET_IAQ_BASELINE 0x201e
-#define SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US 10000
 
 /* command and constants for getting IAQ inceptive baseline */
 #define SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE 0x20b3
-#define SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US 10000
 #define SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_WORDS 1
 
 /* command and constants for raw measure */
 #define SGPC3_CMD_RAW_MEASURE 0x204d
-#define SGPC3_CMD_RAW_MEASURE_DURATION_US 50000
 #define SGPC3_CMD_RAW_MEASURE_WORDS 1
 
 /* command and constants for IAQ raw measure */
 #define SGPC3_CMD_IAQ_RAW_MEASURE 0x2046
-#define SGPC3_CMD_IAQ_RAW_MEASURE_DURATION_US 50000
 #define SGPC3_CMD_IAQ_RAW_MEASURE_WORDS 2
 
 /* command and constants for setting absolute humidity */
 #define SGPC3_CMD_SET_ABSOLUTE_HUMIDITY 0x2061
-#define SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US 10000
 
 /* command and constants for setting power mode */
 #define SGPC3_CMD_SET_POWER_MODE 0x209f
-#define SGPC3_CMD_SET_POWER_MODE_DURATION_US 10000
+
+/* device used by the functions without device handle */
+static sgpc3_device sgpc3_default_device = {NULL, SGPC3_I2C_ADDRESS};
+
+static int16_t sgpc3_write_cmd(sgpc3_device* dev, uint16_t command,
+                               uint32_t duration_us) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    dev->command_duration_us = duration_us;
+    ret = sensirion_i2c_write_cmd(dev->i2c_address, command);
+    if (ret == STATUS_OK)
+        dev->ready_at_us = sgp_clock_now_us() + duration_us;
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
+
+static int16_t sgpc3_write_cmd_with_args(sgpc3_device* dev, uint16_t command,
+                                         const uint16_t* data_words,
+                                         uint16_t num_words,
+                                         uint32_t duration_us) {
+    int16_t ret;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    dev->command_duration_us = duration_us;
+    ret = sensirion_i2c_write_cmd_with_args(dev->i2c_address, command,
+                                            data_words, num_words);
+    if (ret == STATUS_OK)
+        dev->ready_at_us = sgp_clock_now_us() + duration_us;
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
+
+static int16_t sgpc3_read_words(sgpc3_device* dev, uint16_t* data_words,
+                                uint16_t num_words) {
+    int16_t ret;
+
+    /* the default clock only counts the time slept by the drivers */
+    if (sgp_clock_is_set() && sgp_clock_now_us() < dev->ready_at_us)
+        return SGPC3_ERR_NOT_READY;
+
+    ret = sgp_i2c_bus_acquire(dev->bus);
+    if (ret != STATUS_OK)
+        return ret;
+
+    ret = sensirion_i2c_read_words(dev->i2c_address, data_words, num_words);
+    sgp_i2c_bus_release(dev->bus);
+    return ret;
+}
 
 /**
  * sgpc3_check_featureset() - Check if the connected sensor has a certain FS
  *
+ * The feature set is only read from the sensor if it is not cached yet, i.e.
+ * if sgpc3_dev_probe() was not called.
+ *
+ * @dev:       The device to check
  * @needed_fs: The featureset that is required
  *
  * Return: STATUS_OK if the sensor has the required FS,
@@ -114,34 +158,65 @@ static const uint8_t SGPC3_I2C_ADDRESS = 0x58;
  *                                           have the required FS,
  *         an error code otherwise
  */
-static int16_t sgpc3_check_featureset(uint16_t needed_fs) {
+static int16_t sgpc3_check_featureset(sgpc3_device* dev, uint16_t needed_fs) {
     int16_t ret;
-    uint16_t fs_version;
-    uint8_t product_type;
 
-    ret = sgpc3_get_feature_set_version(&fs_version, &product_type);
-    if (ret != STATUS_OK)
-        return ret;
+    if (!dev->capabilities_valid) {
+        ret = sgpc3_dev_get_feature_set_version(dev, &dev->feature_set_version,
+                                                &dev->product_type);
+        if (ret != STATUS_OK)
+            return ret;
+        dev->capabilities_valid = true;
+    }
 
-    if (product_type != SGPC3_PRODUCT_TYPE)
+    if (dev->product_type != SGPC3_PRODUCT_TYPE)
         return SGPC3_ERR_INVALID_PRODUCT_TYPE;
 
-    if (fs_version < needed_fs)
+    if (dev->feature_set_version < needed_fs)
         return SGPC3_ERR_UNSUPPORTED_FEATURE_SET;
 
     return STATUS_OK;
 }
 
-int16_t sgpc3_measure_test(uint16_t* test_result) {
+void sgpc3_dev_init(sgpc3_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address) {
+    dev->bus = bus;
+    dev->i2c_address = i2c_address;
+    dev->capabilities_valid = false;
+    dev->feature_set_version = 0;
+    dev->product_type = 0;
+    dev->serial_id_valid = false;
+    dev->serial_id = 0;
+    dev->command_duration_us = 0;
+    dev->ready_at_us = 0;
+}
+
+int16_t sgpc3_dev_measure_test(sgpc3_device* dev, uint16_t* test_result) {
+    int16_t ret;
+
+    *test_result = 0;
+
+    ret = sgpc3_dev_measure_test_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_MEASURE_TEST_DURATION_US);
+
+    return sgpc3_dev_measure_test_read(dev, test_result);
+}
+
+int16_t sgpc3_dev_measure_test_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_MEASURE_TEST,
+                           SGPC3_CMD_MEASURE_TEST_DURATION_US);
+}
+
+int16_t sgpc3_dev_measure_test_read(sgpc3_device* dev, uint16_t* test_result) {
     uint16_t measure_test_word_buf[SGPC3_CMD_MEASURE_TEST_WORDS];
     int16_t ret;
 
     *test_result = 0;
 
-    ret = sensirion_i2c_delayed_read_cmd(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_MEASURE_TEST,
-        SGPC3_CMD_MEASURE_TEST_DURATION_US, measure_test_word_buf,
-        SENSIRION_NUM_WORDS(measure_test_word_buf));
+    ret = sgpc3_read_words(dev, measure_test_word_buf,
+                           SENSIRION_NUM_WORDS(measure_test_word_buf));
     if (ret != STATUS_OK)
         return ret;
 
@@ -152,87 +227,88 @@ int16_t sgpc3_measure_test(uint16_t* test_result) {
     return STATUS_FAIL;
 }
 
-int16_t sgpc3_measure_tvoc() {
-    return sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS, SGPC3_CMD_IAQ_MEASURE);
+int16_t sgpc3_dev_measure_tvoc(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_IAQ_MEASURE,
+                           SGPC3_CMD_IAQ_MEASURE_DURATION_US);
 }
 
-int16_t sgpc3_read_tvoc(uint16_t* tvoc_ppb) {
+int16_t sgpc3_dev_read_tvoc(sgpc3_device* dev, uint16_t* tvoc_ppb) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_IAQ_MEASURE_WORDS];
 
-    ret = sensirion_i2c_read_words(SGPC3_I2C_ADDRESS, words,
-                                   SGPC3_CMD_IAQ_MEASURE_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_IAQ_MEASURE_WORDS);
 
     *tvoc_ppb = words[0];
 
     return ret;
 }
 
-int16_t sgpc3_measure_tvoc_blocking_read(uint16_t* tvoc_ppb) {
+int16_t sgpc3_dev_measure_tvoc_blocking_read(sgpc3_device* dev,
+                                             uint16_t* tvoc_ppb) {
     int16_t ret;
 
-    ret = sgpc3_measure_tvoc();
+    ret = sgpc3_dev_measure_tvoc(dev);
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGPC3_CMD_IAQ_MEASURE_DURATION_US);
+    sgp_clock_sleep_usec(SGPC3_CMD_IAQ_MEASURE_DURATION_US);
 
-    return sgpc3_read_tvoc(tvoc_ppb);
+    return sgpc3_dev_read_tvoc(dev, tvoc_ppb);
 }
 
-int16_t sgpc3_measure_raw_blocking_read(uint16_t* ethanol_raw_signal) {
+int16_t sgpc3_dev_measure_raw_blocking_read(sgpc3_device* dev,
+                                            uint16_t* ethanol_raw_signal) {
     int16_t ret;
 
-    ret = sgpc3_measure_raw();
+    ret = sgpc3_dev_measure_raw(dev);
     if (ret != STATUS_OK)
         return STATUS_FAIL;
 
-    sensirion_sleep_usec(SGPC3_CMD_RAW_MEASURE_DURATION_US);
+    sgp_clock_sleep_usec(SGPC3_CMD_RAW_MEASURE_DURATION_US);
 
-    return sgpc3_read_raw(ethanol_raw_signal);
+    return sgpc3_dev_read_raw(dev, ethanol_raw_signal);
 }
 
-int16_t sgpc3_measure_raw(void) {
-    return sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS, SGPC3_CMD_RAW_MEASURE);
+int16_t sgpc3_dev_measure_raw(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_RAW_MEASURE,
+                           SGPC3_CMD_RAW_MEASURE_DURATION_US);
 }
 
-int16_t sgpc3_read_raw(uint16_t* ethanol_raw_signal) {
+int16_t sgpc3_dev_read_raw(sgpc3_device* dev, uint16_t* ethanol_raw_signal) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_RAW_MEASURE_WORDS];
 
-    ret = sensirion_i2c_read_words(SGPC3_I2C_ADDRESS, words,
-                                   SGPC3_CMD_RAW_MEASURE_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_RAW_MEASURE_WORDS);
 
     *ethanol_raw_signal = words[0];
 
     return ret;
 }
 
-int16_t sgpc3_measure_tvoc_and_raw_blocking_read(uint16_t* tvoc_ppb,
-                                                 uint16_t* ethanol_raw_signal) {
+int16_t sgpc3_dev_measure_tvoc_and_raw_blocking_read(
+    sgpc3_device* dev, uint16_t* tvoc_ppb, uint16_t* ethanol_raw_signal) {
     int16_t ret;
 
-    ret = sgpc3_measure_tvoc_and_raw();
+    ret = sgpc3_dev_measure_tvoc_and_raw(dev);
     if (ret != STATUS_OK)
         return ret;
 
-    sensirion_sleep_usec(SGPC3_CMD_IAQ_RAW_MEASURE_DURATION_US);
+    sgp_clock_sleep_usec(SGPC3_CMD_IAQ_RAW_MEASURE_DURATION_US);
 
-    return sgpc3_read_tvoc_and_raw(tvoc_ppb, ethanol_raw_signal);
+    return sgpc3_dev_read_tvoc_and_raw(dev, tvoc_ppb, ethanol_raw_signal);
 }
 
-int16_t sgpc3_measure_tvoc_and_raw() {
-    return sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS,
-                                   SGPC3_CMD_IAQ_RAW_MEASURE);
+int16_t sgpc3_dev_measure_tvoc_and_raw(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_IAQ_RAW_MEASURE,
+                           SGPC3_CMD_IAQ_RAW_MEASURE_DURATION_US);
 }
 
-int16_t sgpc3_read_tvoc_and_raw(uint16_t* tvoc_ppb,
-                                uint16_t* ethanol_raw_signal) {
+int16_t sgpc3_dev_read_tvoc_and_raw(sgpc3_device* dev, uint16_t* tvoc_ppb,
+                                    uint16_t* ethanol_raw_signal) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_IAQ_RAW_MEASURE_WORDS];
 
-    ret = sensirion_i2c_read_words(SGPC3_I2C_ADDRESS, words,
-                                   SGPC3_CMD_IAQ_RAW_MEASURE_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_IAQ_RAW_MEASURE_WORDS);
 
     *tvoc_ppb = words[1];
     *ethanol_raw_signal = words[0];
@@ -240,14 +316,30 @@ int16_t sgpc3_read_tvoc_and_raw(uint16_t* tvoc_ppb,
     return ret;
 }
 
-int16_t sgpc3_get_tvoc_baseline(uint16_t* baseline) {
+int16_t sgpc3_dev_get_tvoc_baseline(sgpc3_device* dev, uint16_t* baseline) {
+    int16_t ret;
+
+    ret = sgpc3_dev_get_tvoc_baseline_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US);
+
+    return sgpc3_dev_get_tvoc_baseline_read(dev, baseline);
+}
+
+int16_t sgpc3_dev_get_tvoc_baseline_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_GET_IAQ_BASELINE,
+                           SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US);
+}
+
+int16_t sgpc3_dev_get_tvoc_baseline_read(sgpc3_device* dev,
+                                         uint16_t* baseline) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_GET_IAQ_BASELINE_WORDS];
 
-    ret = sensirion_i2c_delayed_read_cmd(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_GET_IAQ_BASELINE,
-        SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US, words,
-        SGPC3_CMD_GET_IAQ_BASELINE_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_GET_IAQ_BASELINE_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
@@ -259,40 +351,82 @@ int16_t sgpc3_get_tvoc_baseline(uint16_t* baseline) {
     return STATUS_FAIL;
 }
 
-int16_t sgpc3_set_tvoc_baseline(uint16_t baseline) {
+int16_t sgpc3_dev_set_tvoc_baseline(sgpc3_device* dev, uint16_t baseline) {
     int16_t ret;
 
+    ret = sgpc3_dev_set_tvoc_baseline_start(dev, baseline);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US);
+
+    return STATUS_OK;
+}
+
+int16_t sgpc3_dev_set_tvoc_baseline_start(sgpc3_device* dev,
+                                          uint16_t baseline) {
     if (!baseline)
         return STATUS_FAIL;
 
-    ret = sensirion_i2c_write_cmd_with_args(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_SET_IAQ_BASELINE, &baseline,
-        SENSIRION_NUM_WORDS(baseline));
+    return sgpc3_write_cmd_with_args(dev, SGPC3_CMD_SET_IAQ_BASELINE, &baseline,
+                                     SENSIRION_NUM_WORDS(baseline),
+                                     SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US);
+}
+
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline(
+    sgpc3_device* dev, uint16_t* tvoc_inceptive_baseline) {
+    int16_t ret;
 
-    sensirion_sleep_usec(SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US);
+    ret = sgpc3_dev_get_tvoc_inceptive_baseline_start(dev);
 
-    return ret;
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US);
+
+    return sgpc3_dev_get_tvoc_inceptive_baseline_read(dev,
+                                                      tvoc_inceptive_baseline);
 }
 
-int16_t sgpc3_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline) {
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline_start(sgpc3_device* dev) {
     int16_t ret;
 
-    ret = sgpc3_check_featureset(5);
+    ret = sgpc3_check_featureset(dev, 5);
 
     if (ret != STATUS_OK)
         return ret;
 
-    return sensirion_i2c_delayed_read_cmd(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE,
-        SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US,
-        tvoc_inceptive_baseline, SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_WORDS);
+    return sgpc3_write_cmd(dev, SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE,
+                           SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US);
 }
 
-int16_t sgpc3_set_absolute_humidity(uint32_t absolute_humidity) {
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline_read(
+    sgpc3_device* dev, uint16_t* tvoc_inceptive_baseline) {
+    return sgpc3_read_words(dev, tvoc_inceptive_baseline,
+                            SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_WORDS);
+}
+
+int16_t sgpc3_dev_set_absolute_humidity(sgpc3_device* dev,
+                                        uint32_t absolute_humidity) {
+    int16_t ret;
+
+    ret = sgpc3_dev_set_absolute_humidity_start(dev, absolute_humidity);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
+
+    return STATUS_OK;
+}
+
+int16_t sgpc3_dev_set_absolute_humidity_start(sgpc3_device* dev,
+                                              uint32_t absolute_humidity) {
     int16_t ret;
     uint16_t ah_scaled;
 
-    ret = sgpc3_check_featureset(6);
+    ret = sgpc3_check_featureset(dev, 6);
 
     if (ret != STATUS_OK)
         return ret;
@@ -303,30 +437,36 @@ int16_t sgpc3_set_absolute_humidity(uint32_t absolute_humidity) {
     /* ah_scaled = (absolute_humidity / 1000) * 256 */
     ah_scaled = (uint16_t)((absolute_humidity * 16777) >> 16);
 
-    ret = sensirion_i2c_write_cmd_with_args(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_SET_ABSOLUTE_HUMIDITY, &ah_scaled,
-        SENSIRION_NUM_WORDS(ah_scaled));
-
-    sensirion_sleep_usec(SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
-
-    return ret;
+    return sgpc3_write_cmd_with_args(
+        dev, SGPC3_CMD_SET_ABSOLUTE_HUMIDITY, &ah_scaled,
+        SENSIRION_NUM_WORDS(ah_scaled),
+        SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
 }
 
-int16_t sgpc3_set_power_mode(uint16_t power_mode) {
+int16_t sgpc3_dev_set_power_mode(sgpc3_device* dev, uint16_t power_mode) {
     int16_t ret;
 
-    ret = sgpc3_check_featureset(6);
+    ret = sgpc3_dev_set_power_mode_start(dev, power_mode);
 
     if (ret != STATUS_OK)
         return ret;
 
-    ret = sensirion_i2c_write_cmd_with_args(
-        SGPC3_I2C_ADDRESS, SGPC3_CMD_SET_POWER_MODE, &power_mode,
-        SENSIRION_NUM_WORDS(power_mode));
+    sgp_clock_sleep_usec(SGPC3_CMD_SET_POWER_MODE_DURATION_US);
 
-    sensirion_sleep_usec(SGPC3_CMD_SET_POWER_MODE_DURATION_US);
+    return STATUS_OK;
+}
 
-    return ret;
+int16_t sgpc3_dev_set_power_mode_start(sgpc3_device* dev, uint16_t power_mode) {
+    int16_t ret;
+
+    ret = sgpc3_check_featureset(dev, 6);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    return sgpc3_write_cmd_with_args(dev, SGPC3_CMD_SET_POWER_MODE, &power_mode,
+                                     SENSIRION_NUM_WORDS(power_mode),
+                                     SGPC3_CMD_SET_POWER_MODE_DURATION_US);
 }
 
 const char* sgpc3_get_driver_version() {
@@ -337,15 +477,34 @@ uint8_t sgpc3_get_configured_address() {
     return SGPC3_I2C_ADDRESS;
 }
 
-int16_t sgpc3_get_feature_set_version(uint16_t* feature_set_version,
-                                      uint8_t* product_type) {
+int16_t sgpc3_dev_get_feature_set_version(sgpc3_device* dev,
+                                          uint16_t* feature_set_version,
+                                          uint8_t* product_type) {
+    int16_t ret;
+
+    ret = sgpc3_dev_get_feature_set_version_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_GET_FEATURESET_DURATION_US);
+
+    return sgpc3_dev_get_feature_set_version_read(dev, feature_set_version,
+                                                  product_type);
+}
+
+int16_t sgpc3_dev_get_feature_set_version_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_GET_FEATURESET,
+                           SGPC3_CMD_GET_FEATURESET_DURATION_US);
+}
+
+int16_t sgpc3_dev_get_feature_set_version_read(sgpc3_device* dev,
+                                               uint16_t* feature_set_version,
+                                               uint8_t* product_type) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_GET_FEATURESET_WORDS];
 
-    ret = sensirion_i2c_delayed_read_cmd(SGPC3_I2C_ADDRESS,
-                                         SGPC3_CMD_GET_FEATURESET,
-                                         SGPC3_CMD_GET_FEATURESET_DURATION_US,
-                                         words, SGPC3_CMD_GET_FEATURESET_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_GET_FEATURESET_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
@@ -356,57 +515,270 @@ int16_t sgpc3_get_feature_set_version(uint16_t* feature_set_version,
     return STATUS_OK;
 }
 
-int16_t sgpc3_get_serial_id(uint64_t* serial_id) {
+int16_t sgpc3_dev_get_serial_id(sgpc3_device* dev, uint64_t* serial_id) {
+    int16_t ret;
+
+    if (dev->serial_id_valid) {
+        *serial_id = dev->serial_id;
+        return STATUS_OK;
+    }
+
+    ret = sgpc3_dev_get_serial_id_start(dev);
+
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_clock_sleep_usec(SGPC3_CMD_GET_SERIAL_ID_DURATION_US);
+
+    return sgpc3_dev_get_serial_id_read(dev, serial_id);
+}
+
+int16_t sgpc3_dev_get_serial_id_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_GET_SERIAL_ID,
+                           SGPC3_CMD_GET_SERIAL_ID_DURATION_US);
+}
+
+int16_t sgpc3_dev_get_serial_id_read(sgpc3_device* dev, uint64_t* serial_id) {
     int16_t ret;
     uint16_t words[SGPC3_CMD_GET_SERIAL_ID_WORDS];
 
-    ret = sensirion_i2c_delayed_read_cmd(SGPC3_I2C_ADDRESS,
-                                         SGPC3_CMD_GET_SERIAL_ID,
-                                         SGPC3_CMD_GET_SERIAL_ID_DURATION_US,
-                                         words, SGPC3_CMD_GET_SERIAL_ID_WORDS);
+    ret = sgpc3_read_words(dev, words, SGPC3_CMD_GET_SERIAL_ID_WORDS);
 
     if (ret != STATUS_OK)
         return ret;
 
     *serial_id = (((uint64_t)words[0]) << 32) | (((uint64_t)words[1]) << 16) |
                  (((uint64_t)words[2]) << 0);
+    dev->serial_id = *serial_id;
+    dev->serial_id_valid = true;
+
+    return STATUS_OK;
+}
 
+int16_t sgpc3_dev_tvoc_init_preheat(sgpc3_device* dev) {
+    int16_t ret = sgpc3_dev_tvoc_init_preheat_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    sgp_clock_sleep_usec(SGPC3_CMD_IAQ_INIT_CON_DURATION_US);
     return STATUS_OK;
 }
 
-int16_t sgpc3_tvoc_init_preheat() {
+int16_t sgpc3_dev_tvoc_init_preheat_start(sgpc3_device* dev) {
     int16_t ret;
 
-    ret = sgpc3_check_featureset(6);
+    ret = sgpc3_check_featureset(dev, 6);
 
     if (ret != STATUS_OK)
         return ret;
 
-    ret = sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS, SGPC3_CMD_IAQ_INIT_CON);
-    sensirion_sleep_usec(SGPC3_CMD_IAQ_INIT_CON_DURATION_US);
-    return ret;
+    return sgpc3_write_cmd(dev, SGPC3_CMD_IAQ_INIT_CON,
+                           SGPC3_CMD_IAQ_INIT_CON_DURATION_US);
 }
 
-int16_t sgpc3_tvoc_init_no_preheat() {
-    int16_t ret;
-    ret = sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS, SGPC3_CMD_IAQ_INIT_0);
-    sensirion_sleep_usec(SGPC3_CMD_IAQ_INIT_0_DURATION_US);
-    return ret;
+int16_t sgpc3_dev_tvoc_init_no_preheat(sgpc3_device* dev) {
+    int16_t ret = sgpc3_dev_tvoc_init_no_preheat_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    sgp_clock_sleep_usec(SGPC3_CMD_IAQ_INIT_0_DURATION_US);
+    return STATUS_OK;
 }
 
-int16_t sgpc3_tvoc_init_64s_fs5() {
-    int16_t ret;
-    ret = sensirion_i2c_write_cmd(SGPC3_I2C_ADDRESS, SGPC3_CMD_IAQ_INIT_64);
-    sensirion_sleep_usec(SGPC3_CMD_IAQ_INIT_64_DURATION_US);
-    return ret;
+int16_t sgpc3_dev_tvoc_init_no_preheat_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_IAQ_INIT_0,
+                           SGPC3_CMD_IAQ_INIT_0_DURATION_US);
+}
+
+int16_t sgpc3_dev_tvoc_init_64s_fs5(sgpc3_device* dev) {
+    int16_t ret = sgpc3_dev_tvoc_init_64s_fs5_start(dev);
+    if (ret != STATUS_OK)
+        return ret;
+    sgp_clock_sleep_usec(SGPC3_CMD_IAQ_INIT_64_DURATION_US);
+    return STATUS_OK;
 }
 
-int16_t sgpc3_probe() {
+int16_t sgpc3_dev_tvoc_init_64s_fs5_start(sgpc3_device* dev) {
+    return sgpc3_write_cmd(dev, SGPC3_CMD_IAQ_INIT_64,
+                           SGPC3_CMD_IAQ_INIT_64_DURATION_US);
+}
+
+int16_t sgpc3_dev_probe(sgpc3_device* dev) {
     int16_t ret;
 
-    ret = sgpc3_check_featureset(4);
+    /* (re-)read the capabilities of the connected sensor */
+    dev->capabilities_valid = false;
+    dev->serial_id_valid = false;
+    ret = sgpc3_check_featureset(dev, 4);
     if (ret != STATUS_OK)
         return ret;
 
-    return sgpc3_tvoc_init_no_preheat();
+    return sgpc3_dev_tvoc_init_no_preheat(dev);
+}
+
+/*
+ * Functions operating on the default device on the currently selected bus
+ */
+
+int16_t sgpc3_probe(void) {
+    return sgpc3_dev_probe(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_preheat(void) {
+    return sgpc3_dev_tvoc_init_preheat(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_preheat_start(void) {
+    return sgpc3_dev_tvoc_init_preheat_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_no_preheat(void) {
+    return sgpc3_dev_tvoc_init_no_preheat(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_no_preheat_start(void) {
+    return sgpc3_dev_tvoc_init_no_preheat_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_64s_fs5(void) {
+    return sgpc3_dev_tvoc_init_64s_fs5(&sgpc3_default_device);
+}
+
+int16_t sgpc3_tvoc_init_64s_fs5_start(void) {
+    return sgpc3_dev_tvoc_init_64s_fs5_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_get_feature_set_version(uint16_t* feature_set_version,
+                                      uint8_t* product_type) {
+    return sgpc3_dev_get_feature_set_version(&sgpc3_default_device,
+                                             feature_set_version, product_type);
+}
+
+int16_t sgpc3_get_feature_set_version_start(void) {
+    return sgpc3_dev_get_feature_set_version_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_get_feature_set_version_read(uint16_t* feature_set_version,
+                                           uint8_t* product_type) {
+    return sgpc3_dev_get_feature_set_version_read(&sgpc3_default_device,
+                                                  feature_set_version,
+                                                  product_type);
+}
+
+int16_t sgpc3_get_serial_id(uint64_t* serial_id) {
+    return sgpc3_dev_get_serial_id(&sgpc3_default_device, serial_id);
+}
+
+int16_t sgpc3_get_serial_id_start(void) {
+    return sgpc3_dev_get_serial_id_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_get_serial_id_read(uint64_t* serial_id) {
+    return sgpc3_dev_get_serial_id_read(&sgpc3_default_device, serial_id);
+}
+
+int16_t sgpc3_get_tvoc_baseline(uint16_t* baseline) {
+    return sgpc3_dev_get_tvoc_baseline(&sgpc3_default_device, baseline);
+}
+
+int16_t sgpc3_get_tvoc_baseline_start(void) {
+    return sgpc3_dev_get_tvoc_baseline_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_get_tvoc_baseline_read(uint16_t* baseline) {
+    return sgpc3_dev_get_tvoc_baseline_read(&sgpc3_default_device, baseline);
+}
+
+int16_t sgpc3_set_tvoc_baseline(uint16_t baseline) {
+    return sgpc3_dev_set_tvoc_baseline(&sgpc3_default_device, baseline);
+}
+
+int16_t sgpc3_set_tvoc_baseline_start(uint16_t baseline) {
+    return sgpc3_dev_set_tvoc_baseline_start(&sgpc3_default_device, baseline);
+}
+
+int16_t sgpc3_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline) {
+    return sgpc3_dev_get_tvoc_inceptive_baseline(&sgpc3_default_device,
+                                                 tvoc_inceptive_baseline);
+}
+
+int16_t sgpc3_get_tvoc_inceptive_baseline_start(void) {
+    return sgpc3_dev_get_tvoc_inceptive_baseline_start(&sgpc3_default_device);
+}
+
+int16_t
+sgpc3_get_tvoc_inceptive_baseline_read(uint16_t* tvoc_inceptive_baseline) {
+    return sgpc3_dev_get_tvoc_inceptive_baseline_read(&sgpc3_default_device,
+                                                      tvoc_inceptive_baseline);
+}
+
+int16_t sgpc3_measure_tvoc_blocking_read(uint16_t* tvoc_ppb) {
+    return sgpc3_dev_measure_tvoc_blocking_read(&sgpc3_default_device,
+                                                tvoc_ppb);
+}
+
+int16_t sgpc3_measure_tvoc(void) {
+    return sgpc3_dev_measure_tvoc(&sgpc3_default_device);
+}
+
+int16_t sgpc3_read_tvoc(uint16_t* tvoc_ppb) {
+    return sgpc3_dev_read_tvoc(&sgpc3_default_device, tvoc_ppb);
+}
+
+int16_t sgpc3_measure_raw_blocking_read(uint16_t* ethanol_raw_signal) {
+    return sgpc3_dev_measure_raw_blocking_read(&sgpc3_default_device,
+                                               ethanol_raw_signal);
+}
+
+int16_t sgpc3_measure_raw(void) {
+    return sgpc3_dev_measure_raw(&sgpc3_default_device);
+}
+
+int16_t sgpc3_read_raw(uint16_t* ethanol_raw_signal) {
+    return sgpc3_dev_read_raw(&sgpc3_default_device, ethanol_raw_signal);
+}
+
+int16_t sgpc3_measure_tvoc_and_raw_blocking_read(uint16_t* tvoc_ppb,
+                                                 uint16_t* ethanol_raw_signal) {
+    return sgpc3_dev_measure_tvoc_and_raw_blocking_read(&sgpc3_default_device,
+                                                        tvoc_ppb,
+                                                        ethanol_raw_signal);
+}
+
+int16_t sgpc3_measure_tvoc_and_raw(void) {
+    return sgpc3_dev_measure_tvoc_and_raw(&sgpc3_default_device);
+}
+
+int16_t sgpc3_read_tvoc_and_raw(uint16_t* tvoc_ppb,
+                                uint16_t* ethanol_raw_signal) {
+    return sgpc3_dev_read_tvoc_and_raw(&sgpc3_default_device, tvoc_ppb,
+                                       ethanol_raw_signal);
+}
+
+int16_t sgpc3_set_power_mode(uint16_t power_mode) {
+    return sgpc3_dev_set_power_mode(&sgpc3_default_device, power_mode);
+}
+
+int16_t sgpc3_set_power_mode_start(uint16_t power_mode) {
+    return sgpc3_dev_set_power_mode_start(&sgpc3_default_device, power_mode);
+}
+
+int16_t sgpc3_set_absolute_humidity(uint32_t absolute_humidity) {
+    return sgpc3_dev_set_absolute_humidity(&sgpc3_default_device,
+                                           absolute_humidity);
+}
+
+int16_t sgpc3_set_absolute_humidity_start(uint32_t absolute_humidity) {
+    return sgpc3_dev_set_absolute_humidity_start(&sgpc3_default_device,
+                                                 absolute_humidity);
+}
+
+int16_t sgpc3_measure_test(uint16_t* test_result) {
+    return sgpc3_dev_measure_test(&sgpc3_default_device, test_result);
+}
+
+int16_t sgpc3_measure_test_start(void) {
+    return sgpc3_dev_measure_test_start(&sgpc3_default_device);
+}
+
+int16_t sgpc3_measure_test_read(uint16_t* test_result) {
+    return sgpc3_dev_measure_test_read(&sgpc3_default_device, test_result);
 }
@@ -34,17 +34,96 @@
 #include "sensirion_arch_config.h"
 #include "sensirion_common.h"
 #include "sensirion_i2c.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_bus.h"
 
 #define SGPC3_ERR_UNSUPPORTED_FEATURE_SET (-11)
 #define SGPC3_ERR_INVALID_PRODUCT_TYPE (-13)
+#define SGPC3_ERR_NOT_READY (-14)
+
+#define SGPC3_I2C_ADDRESS 0x58
+
+/*
+ * Maximum execution times of the commands. Each blocking function waits for
+ * this time, while its *_start() or asynchronous measure counterpart returns
+ * immediately: the command is ready at the time it was started plus its
+ * duration, which the device handle records as ready_at_us. Until then, the
+ * sensor does not acknowledge any I2C transfer, so reading the result earlier
+ * fails and can simply be retried. If a clock is installed with
+ * sgp_clock_set(), the read functions check the time themselves and return
+ * SGPC3_ERR_NOT_READY without accessing the bus.
+ */
+#define SGPC3_CMD_GET_SERIAL_ID_DURATION_US 500
+#define SGPC3_CMD_GET_FEATURESET_DURATION_US 1000
+#define SGPC3_CMD_MEASURE_TEST_DURATION_US 220000
+#define SGPC3_CMD_IAQ_INIT_0_DURATION_US 10000
+#define SGPC3_CMD_IAQ_INIT_64_DURATION_US 10000
+#define SGPC3_CMD_IAQ_INIT_CON_DURATION_US 10000
+#define SGPC3_CMD_IAQ_MEASURE_DURATION_US 50000
+#define SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US 10000
+#define SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US 10000
+#define SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US 10000
+#define SGPC3_CMD_RAW_MEASURE_DURATION_US 50000
+#define SGPC3_CMD_IAQ_RAW_MEASURE_DURATION_US 50000
+#define SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US 10000
+#define SGPC3_CMD_SET_POWER_MODE_DURATION_US 10000
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * struct sgpc3_device - handle of one SGPC3 sensor
+ *
+ * A handle holds the bus and I2C address of a sensor and the data the driver
+ * caches about it, so several sensors can be used in one program. Initialize
+ * it with sgpc3_dev_init(); the members are managed by the driver.
+ *
+ * @bus:                 Bus the sensor is connected to, NULL for the
+ *                       currently selected bus
+ * @i2c_address:         I2C address of the sensor
+ * @capabilities_valid:  Whether the feature set and product type are cached
+ * @feature_set_version: Feature set version, cached by sgpc3_dev_probe()
+ * @product_type:        Product type, cached by sgpc3_dev_probe()
+ * @serial_id_valid:     Whether the serial id is cached
+ * @serial_id:           Serial id, cached by sgpc3_dev_get_serial_id()
+ * @command_duration_us: Execution time of the last command sent to the
+ *                       sensor. Its result can be read once this time has
+ *                       passed since the command was sent.
+ * @ready_at_us:         Time of sgp_clock_now_us() at which the result of the
+ *                       last command sent to the sensor can be read
+ */
+typedef struct {
+    sgp_i2c_bus* bus;
+    uint8_t i2c_address;
+    bool capabilities_valid;
+    uint16_t feature_set_version;
+    uint8_t product_type;
+    bool serial_id_valid;
+    uint64_t serial_id;
+    uint32_t command_duration_us;
+    uint64_t ready_at_us;
+} sgpc3_device;
+
+/**
+ * sgpc3_dev_init() - initialize the handle of a sensor
+ *
+ * The functions without device handle use a default device at
+ * SGPC3_I2C_ADDRESS on the currently selected bus.
+ *
+ * @dev:            The handle to initialize
+ * @bus:            Bus the sensor is connected to, NULL for the currently
+ *                  selected bus
+ * @i2c_address:    I2C address of the sensor, usually SGPC3_I2C_ADDRESS
+ */
+void sgpc3_dev_init(sgpc3_device* dev, sgp_i2c_bus* bus, uint8_t i2c_address);
+
 /**
  * sgpc3_probe() - check if SGP sensor is available and initialize it
  *
+ * The feature set and product type of the sensor are read and cached here,
+ * so the commands which depend on them do not need to read them again.
+ *
  * This call aleady initializes the TVOC baselines
  * (sgpc3_tvoc_init_no_preheat())
  *
@@ -65,6 +144,16 @@ int16_t sgpc3_probe(void);
  */
 int16_t sgpc3_tvoc_init_preheat(void);
 
+/**
+ * sgpc3_tvoc_init_preheat_start() - start sgpc3_tvoc_init_preheat()
+ * without waiting
+ *
+ * No other command must be sent for SGPC3_CMD_IAQ_INIT_CON_DURATION_US.
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_tvoc_init_preheat_start(void);
+
 /**
  * sgpc3_tvoc_init_no_preheat() - reset the SGP's internal TVOC baselines
  * without accelerated startup time
@@ -73,6 +162,16 @@ int16_t sgpc3_tvoc_init_preheat(void);
  */
 int16_t sgpc3_tvoc_init_no_preheat(void);
 
+/**
+ * sgpc3_tvoc_init_no_preheat_start() - start sgpc3_tvoc_init_no_preheat()
+ * without waiting
+ *
+ * No other command must be sent for SGPC3_CMD_IAQ_INIT_0_DURATION_US.
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_tvoc_init_no_preheat_start(void);
+
 /**
  * sgpc3_tvoc_init_64s_fs5() - reset the SGP's internal TVOC baselines using
  * accelerated startup time of 64s.
@@ -85,6 +184,16 @@ int16_t sgpc3_tvoc_init_no_preheat(void);
  */
 int16_t sgpc3_tvoc_init_64s_fs5(void);
 
+/**
+ * sgpc3_tvoc_init_64s_fs5_start() - start sgpc3_tvoc_init_64s_fs5()
+ * without waiting
+ *
+ * No other command must be sent for SGPC3_CMD_IAQ_INIT_64_DURATION_US.
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_tvoc_init_64s_fs5_start(void);
+
 /**
  * sgpc3_get_driver_version() - Return the driver version
  * Return:  Driver version string
@@ -110,6 +219,29 @@ uint8_t sgpc3_get_configured_address(void);
 int16_t sgpc3_get_feature_set_version(uint16_t* feature_set_version,
                                       uint8_t* product_type);
 
+/**
+ * sgpc3_get_feature_set_version_start() - start reading the feature set
+ * version without waiting
+ *
+ * Use sgpc3_get_feature_set_version_read() to get the result after
+ * SGPC3_CMD_GET_FEATURESET_DURATION_US.
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgpc3_get_feature_set_version_start(void);
+
+/**
+ * sgpc3_get_feature_set_version_read() - read the result of
+ * sgpc3_get_feature_set_version_start()
+ *
+ * @feature_set_version:    The feature set version
+ * @product_type:           The product type: 0 for sgp30, 1: sgpc3
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgpc3_get_feature_set_version_read(uint16_t* feature_set_version,
+                                           uint8_t* product_type);
+
 /**
  * sgpc3_get_serial_id() - Retrieve the sensor's serial id
  *
@@ -119,6 +251,25 @@ int16_t sgpc3_get_feature_set_version(uint16_t* feature_set_version,
  */
 int16_t sgpc3_get_serial_id(uint64_t* serial_id);
 
+/**
+ * sgpc3_get_serial_id_start() - start reading the serial id without waiting
+ *
+ * Use sgpc3_get_serial_id_read() to get the result after
+ * SGPC3_CMD_GET_SERIAL_ID_DURATION_US.
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgpc3_get_serial_id_start(void);
+
+/**
+ * sgpc3_get_serial_id_read() - read the result of sgpc3_get_serial_id_start()
+ *
+ * @serial_id:    Output variable for the serial id
+ *
+ * Return:  STATUS_OK on success
+ */
+int16_t sgpc3_get_serial_id_read(uint64_t* serial_id);
+
 /**
  * sgpc3_get_tvoc_baseline() - read out the baseline from the chip
  *
@@ -138,6 +289,28 @@ int16_t sgpc3_get_serial_id(uint64_t* serial_id);
  */
 int16_t sgpc3_get_tvoc_baseline(uint16_t* baseline);
 
+/**
+ * sgpc3_get_tvoc_baseline_start() - start reading the baseline without
+ * waiting
+ *
+ * Use sgpc3_get_tvoc_baseline_read() to get the result after
+ * SGPC3_CMD_GET_IAQ_BASELINE_DURATION_US.
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_get_tvoc_baseline_start(void);
+
+/**
+ * sgpc3_get_tvoc_baseline_read() - read the result of
+ * sgpc3_get_tvoc_baseline_start()
+ *
+ * @baseline:   Pointer to raw uint16_t where to store the baseline, see
+ *              sgpc3_get_tvoc_baseline()
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_get_tvoc_baseline_read(uint16_t* baseline);
+
 /**
  * sgpc3_set_tvoc_baseline() - set the on-chip baseline
  * @baseline:   A raw uint16_t baseline
@@ -150,6 +323,18 @@ int16_t sgpc3_get_tvoc_baseline(uint16_t* baseline);
  */
 int16_t sgpc3_set_tvoc_baseline(uint16_t baseline);
 
+/**
+ * sgpc3_set_tvoc_baseline_start() - start sgpc3_set_tvoc_baseline()
+ * without waiting
+ *
+ * No other command must be sent for SGPC3_CMD_SET_IAQ_BASELINE_DURATION_US.
+ *
+ * @baseline:   A raw uint16_t baseline, see sgpc3_set_tvoc_baseline()
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_set_tvoc_baseline_start(uint16_t baseline);
+
 /**
  * sgpc3_get_tvoc_inceptive_baseline() - read the chip's tVOC inceptive baseline
  *
@@ -169,6 +354,30 @@ int16_t sgpc3_set_tvoc_baseline(uint16_t baseline);
  */
 int16_t sgpc3_get_tvoc_inceptive_baseline(uint16_t* tvoc_inceptive_baseline);
 
+/**
+ * sgpc3_get_tvoc_inceptive_baseline_start() - start reading the tVOC
+ * inceptive baseline without waiting
+ *
+ * Use sgpc3_get_tvoc_inceptive_baseline_read() to get the result after
+ * SGPC3_CMD_GET_IAQ_INCEPTIVE_BASELINE_DURATION_US.
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_get_tvoc_inceptive_baseline_start(void);
+
+/**
+ * sgpc3_get_tvoc_inceptive_baseline_read() - read the result of
+ * sgpc3_get_tvoc_inceptive_baseline_start()
+ *
+ * @tvoc_inceptive_baseline:
+ *              Pointer to raw uint16_t where to store the inceptive baseline,
+ *              see sgpc3_get_tvoc_inceptive_baseline()
+ *
+ * Return:      STATUS_OK on success, an error code otherwise
+ */
+int16_t
+sgpc3_get_tvoc_inceptive_baseline_read(uint16_t* tvoc_inceptive_baseline);
+
 /**
  * sgpc3_measure_tvoc_blocking_read() - Measure tVOC concentration
  *
@@ -286,6 +495,17 @@ int16_t sgpc3_read_tvoc_and_raw(uint16_t* tvoc_ppb,
  */
 int16_t sgpc3_set_power_mode(uint16_t power_mode);
 
+/**
+ * sgpc3_set_power_mode_start() - start sgpc3_set_power_mode() without waiting
+ *
+ * No other command must be sent for SGPC3_CMD_SET_POWER_MODE_DURATION_US.
+ *
+ * @power_mode: Power mode, see sgpc3_set_power_mode()
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_set_power_mode_start(uint16_t power_mode);
+
 /**
  * sgpc3_set_absolute_humidity() - set the absolute humidity for compensation
  *
@@ -299,6 +519,19 @@ int16_t sgpc3_set_power_mode(uint16_t power_mode);
  */
 int16_t sgpc3_set_absolute_humidity(uint32_t absolute_humidity);
 
+/**
+ * sgpc3_set_absolute_humidity_start() - start sgpc3_set_absolute_humidity()
+ * without waiting
+ *
+ * No other command must be sent for
+ * SGPC3_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US.
+ *
+ * @absolute_humidity:      absolute humidity in mg/m^3
+ *
+ * Return:  STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_set_absolute_humidity_start(uint32_t absolute_humidity);
+
 /**
  * sgpc3_measure_test() - Run the on-chip self-test
  *
@@ -313,6 +546,96 @@ int16_t sgpc3_set_absolute_humidity(uint32_t absolute_humidity);
  */
 int16_t sgpc3_measure_test(uint16_t* test_result);
 
+/**
+ * sgpc3_measure_test_start() - Start the on-chip self-test without waiting
+ *
+ * Use sgpc3_measure_test_read() to get the result after
+ * SGPC3_CMD_MEASURE_TEST_DURATION_US.
+ *
+ * Return: STATUS_OK on success, an error code otherwise
+ */
+int16_t sgpc3_measure_test_start(void);
+
+/**
+ * sgpc3_measure_test_read() - Read the result of sgpc3_measure_test_start()
+ *
+ * @test_result:    Allocated buffer to store the chip's error code, see
+ *                  sgpc3_measure_test()
+ *
+ * Return: STATUS_OK on a successful self-test, an error code otherwise
+ */
+int16_t sgpc3_measure_test_read(uint16_t* test_result);
+
+/*
+ * Variants of the functions above operating on the sensor of the given handle
+ * instead of the default device. Their arguments and return values are the
+ * same, e.g. sgpc3_dev_probe(&dev) works like sgpc3_probe().
+ */
+
+int16_t sgpc3_dev_probe(sgpc3_device* dev);
+
+int16_t sgpc3_dev_tvoc_init_preheat(sgpc3_device* dev);
+int16_t sgpc3_dev_tvoc_init_preheat_start(sgpc3_device* dev);
+
+int16_t sgpc3_dev_tvoc_init_no_preheat(sgpc3_device* dev);
+int16_t sgpc3_dev_tvoc_init_no_preheat_start(sgpc3_device* dev);
+
+int16_t sgpc3_dev_tvoc_init_64s_fs5(sgpc3_device* dev);
+int16_t sgpc3_dev_tvoc_init_64s_fs5_start(sgpc3_device* dev);
+
+int16_t sgpc3_dev_get_feature_set_version(sgpc3_device* dev,
+                                          uint16_t* feature_set_version,
+                                          uint8_t* product_type);
+int16_t sgpc3_dev_get_feature_set_version_start(sgpc3_device* dev);
+int16_t sgpc3_dev_get_feature_set_version_read(sgpc3_device* dev,
+                                               uint16_t* feature_set_version,
+                                               uint8_t* product_type);
+
+int16_t sgpc3_dev_get_serial_id(sgpc3_device* dev, uint64_t* serial_id);
+int16_t sgpc3_dev_get_serial_id_start(sgpc3_device* dev);
+int16_t sgpc3_dev_get_serial_id_read(sgpc3_device* dev, uint64_t* serial_id);
+
+int16_t sgpc3_dev_get_tvoc_baseline(sgpc3_device* dev, uint16_t* baseline);
+int16_t sgpc3_dev_get_tvoc_baseline_start(sgpc3_device* dev);
+int16_t sgpc3_dev_get_tvoc_baseline_read(sgpc3_device* dev, uint16_t* baseline);
+
+int16_t sgpc3_dev_set_tvoc_baseline(sgpc3_device* dev, uint16_t baseline);
+int16_t sgpc3_dev_set_tvoc_baseline_start(sgpc3_device* dev, uint16_t baseline);
+
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline(
+    sgpc3_device* dev, uint16_t* tvoc_inceptive_baseline);
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline_start(sgpc3_device* dev);
+int16_t sgpc3_dev_get_tvoc_inceptive_baseline_read(
+    sgpc3_device* dev, uint16_t* tvoc_inceptive_baseline);
+
+int16_t sgpc3_dev_measure_tvoc_blocking_read(sgpc3_device* dev,
+                                             uint16_t* tvoc_ppb);
+int16_t sgpc3_dev_measure_tvoc(sgpc3_device* dev);
+int16_t sgpc3_dev_read_tvoc(sgpc3_device* dev, uint16_t* tvoc_ppb);
+
+int16_t sgpc3_dev_measure_raw_blocking_read(sgpc3_device* dev,
+                                            uint16_t* ethanol_raw_signal);
+int16_t sgpc3_dev_measure_raw(sgpc3_device* dev);
+int16_t sgpc3_dev_read_raw(sgpc3_device* dev, uint16_t* ethanol_raw_signal);
+
+int16_t sgpc3_dev_measure_tvoc_and_raw_blocking_read(
+    sgpc3_device* dev, uint16_t* tvoc_ppb, uint16_t* ethanol_raw_signal);
+int16_t sgpc3_dev_measure_tvoc_and_raw(sgpc3_device* dev);
+int16_t sgpc3_dev_read_tvoc_and_raw(sgpc3_device* dev, uint16_t* tvoc_ppb,
+                                    uint16_t* ethanol_raw_signal);
+
+int16_t sgpc3_dev_set_power_mode(sgpc3_device* dev, uint16_t power_mode);
+int16_t sgpc3_dev_set_power_mode_start(sgpc3_device* dev, uint16_t power_mode);
+
+int16_t sgpc3_dev_set_absolute_humidity(sgpc3_device* dev,
+                                        uint32_t absolute_humidity);
+int16_t sgpc3_dev_set_absolute_humidity_start(sgpc3_device* dev,
+                                              uint32_t absolute_humidity);
+
+int16_t sgpc3_dev_measure_test(sgpc3_device* dev, uint16_t* test_result);
+int16_t sgpc3_dev_measure_test_start(sgpc3_device* dev);
+int16_t sgpc3_dev_measure_test_read(sgpc3_device* dev, uint16_t* test_result);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sgp_periodic.h"
 #include "sgpc3.h"
 
 #include <inttypes.h>  // PRIu64
@@ -47,6 +48,7 @@ int main(void) {
     uint16_t tvoc_ppb;
     uint16_t tvoc_baseline;
     uint16_t ethanol_raw_signal;
+    sgp_periodic periodic;
 
     const char* driver_version = sgpc3_get_driver_version();
     if (driver_version) {
@@ -123,7 +125,14 @@ int main(void) {
      * err = sgpc3_set_tvoc_baseline(tvoc_baseline);
      */
 
-    /* Run periodic tVOC measurements at defined intervals */
+    /* Run periodic tVOC measurements at defined intervals.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 2000000);
     while (1) {
         err = sgpc3_measure_tvoc_and_raw_blocking_read(&tvoc_ppb,
                                                        &ethanol_raw_signal);
@@ -144,8 +153,11 @@ int main(void) {
 
         /* The tVOC measurement must be triggered exactly once every two seconds
          * to get accurate values and to respect the duty cycle/power budget.
+         * The scheduler compensates for the time the measurement takes.
          */
-        sleep(2);
+        if (sgp_periodic_wait(&periodic)) {
+            printf("tVOC measurement missed\n");
+        }
     }
     return 0;
 }
@@ -29,9 +29,11 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sgpc3_with_shtc1.h"
 #include "sensirion_common.h"
 #include "sensirion_humidity_conversion.h"
 #include "sgp_git_version.h"
+#include "sgp_humidity_compensation.h"
 #include "sgpc3.h"
 #include "shtc1.h"
 
@@ -39,52 +41,66 @@ const char* sgpc3_with_shtc1_get_driver_version() {
     return SGP_DRV_VERSION_STR;
 }
 
-int16_t sgpc3_with_shtc1_measure_iaq_blocking_read(uint16_t* tvoc_ppb,
-                                                   int32_t* temperature,
-                                                   int32_t* humidity) {
+/* see sgpc3_with_shtc1_set_humidity_compensation() */
+static sgp_humidity_compensation sgpc3_ah = {SGP_AH_THRESHOLD_DEFAULT,
+                                             SGP_AH_INTERVAL_DEFAULT};
+
+/**
+ * sgpc3_with_shtc1_measure_humidity() - Measure temperature and humidity and
+ * update the humidity compensation of the SGPC3 if required
+ *
+ * @temperature:    Temperature in [degree Celsius] multiplied by 1000
+ * @humidity:       Relative humidity in [%RH (0..100)] multiplied by 1000
+ *
+ * Return:          STATUS_OK on success, an error code otherwise
+ */
+static int16_t sgpc3_with_shtc1_measure_humidity(int32_t* temperature,
+                                                 int32_t* humidity) {
     uint32_t absolute_humidity;
-    uint16_t sgp_feature_set;
-    uint8_t sgp_product_type;
     int16_t err;
 
     err = shtc1_measure_blocking_read(temperature, humidity);
     if (err != STATUS_OK)
         return err;
 
-    sgpc3_get_feature_set_version(&sgp_feature_set, &sgp_product_type);
     absolute_humidity =
         sensirion_calc_absolute_humidity(*temperature, *humidity);
-    sgpc3_set_absolute_humidity(absolute_humidity);
-
-    err = sgpc3_measure_tvoc_blocking_read(tvoc_ppb);
-    if (err != STATUS_OK)
-        return err;
+    if (!sgp_humidity_compensation_needs_update(&sgpc3_ah, absolute_humidity))
+        return STATUS_OK;
 
+    /* sensors without humidity compensation just measure uncompensated */
+    if (sgpc3_set_absolute_humidity(absolute_humidity) == STATUS_OK)
+        sgp_humidity_compensation_updated(&sgpc3_ah, absolute_humidity);
     return STATUS_OK;
 }
 
-int16_t sgpc3_with_shtc1_measure_raw_blocking_read(uint16_t* ethanol_raw_signal,
+void sgpc3_with_shtc1_set_humidity_compensation(uint32_t threshold,
+                                                uint16_t interval) {
+    sgp_humidity_compensation_configure(&sgpc3_ah, threshold, interval);
+}
+
+int16_t sgpc3_with_shtc1_measure_iaq_blocking_read(uint16_t* tvoc_ppb,
                                                    int32_t* temperature,
                                                    int32_t* humidity) {
-    uint32_t absolute_humidity;
-    uint16_t sgp_feature_set;
-    uint8_t sgp_product_type;
     int16_t err;
 
-    err = shtc1_measure_blocking_read(temperature, humidity);
+    err = sgpc3_with_shtc1_measure_humidity(temperature, humidity);
     if (err != STATUS_OK)
         return err;
 
-    sgpc3_get_feature_set_version(&sgp_feature_set, &sgp_product_type);
-    absolute_humidity =
-        sensirion_calc_absolute_humidity(*temperature, *humidity);
-    sgpc3_set_absolute_humidity(absolute_humidity);
+    return sgpc3_measure_tvoc_blocking_read(tvoc_ppb);
+}
 
-    err = sgpc3_measure_raw_blocking_read(ethanol_raw_signal);
+int16_t sgpc3_with_shtc1_measure_raw_blocking_read(uint16_t* ethanol_raw_signal,
+                                                   int32_t* temperature,
+                                                   int32_t* humidity) {
+    int16_t err;
+
+    err = sgpc3_with_shtc1_measure_humidity(temperature, humidity);
     if (err != STATUS_OK)
         return err;
 
-    return STATUS_OK;
+    return sgpc3_measure_raw_blocking_read(ethanol_raw_signal);
 }
 
 int16_t sgpc3_with_shtc1_probe() {
@@ -94,5 +110,8 @@ int16_t sgpc3_with_shtc1_probe() {
     if (err != STATUS_OK)
         return err;
 
+    /* the SGPC3 needs the humidity again after its initialization */
+    sgp_humidity_compensation_reset(&sgpc3_ah);
+
     return sgpc3_probe();
 }
@@ -56,6 +56,23 @@ const char* sgpc3_with_shtc1_get_driver_version();
  */
 int16_t sgpc3_with_shtc1_probe(void);
 
+/**
+ * sgpc3_with_shtc1_set_humidity_compensation() - configure when the measured
+ * humidity is sent to the SGPC3
+ *
+ * Each measurement measures the humidity, but only sends it to the SGPC3 as
+ * described at struct sgp_humidity_compensation, by default with
+ * SGP_AH_THRESHOLD_DEFAULT and SGP_AH_INTERVAL_DEFAULT. The first measurement
+ * after sgpc3_with_shtc1_probe() always sends the humidity.
+ *
+ * @threshold:  Change of the absolute humidity in [mg/m^3] which is sent to
+ *              the sensor, 0 to send it with every measurement
+ * @interval:   Maximum number of measurements between updates, 0 to only
+ *              update on changes beyond @threshold
+ */
+void sgpc3_with_shtc1_set_humidity_compensation(uint32_t threshold,
+                                                uint16_t interval);
+
 /**
  * sgpc3_with_shtc1_measure_iaq_blocking_read() - Measure tVOC concentration
  *
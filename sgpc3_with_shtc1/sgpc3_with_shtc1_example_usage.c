@@ -29,6 +29,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sgp_periodic.h"
 #include "sgpc3_with_shtc1.h"
 
 #include <stdio.h>  // printf
@@ -44,6 +45,7 @@ int main(void) {
     uint16_t tvoc_ppb;
     uint16_t tvoc_baseline;
     int32_t temperature, humidity;
+    sgp_periodic periodic;
 
     /* Initialize I2C bus */
     sensirion_i2c_init();
@@ -52,7 +54,7 @@ int main(void) {
      * a sensor. */
     while (sgpc3_with_shtc1_probe() != STATUS_OK) {
         printf("Failed to detect SGPC3 and/or SHTC1\n");
-        sensirion_sleep_usec(1000000);  // wait 1s before trying again
+        sgp_clock_sleep_usec(1000000);  // wait 1s before trying again
     }
     printf("SGPC3 and SHTC1 sensors detected\n");
 
@@ -68,7 +70,14 @@ int main(void) {
      * err = sgpc3_set_tvoc_baseline(tvoc_baseline);
      */
 
-    /* Run periodic IAQ measurements at defined intervals */
+    /* Run periodic IAQ measurements at defined intervals.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 2000000);
     while (1) {
         err = sgpc3_with_shtc1_measure_iaq_blocking_read(
             &tvoc_ppb, &temperature, &humidity);
@@ -90,9 +99,12 @@ int main(void) {
         }
 
         /* The tVOC measurement must be triggered exactly once every two seconds
-         * (SGPC3) to get accurate values.
+         * (SGPC3) to get accurate values. The scheduler compensates for the
+         * time the measurement takes.
          */
-        sensirion_sleep_usec(2000000);  // 2s interval for SGPC3
+        if (sgp_periodic_wait(&periodic)) {  // 2s interval for SGPC3
+            printf("tVOC measurement missed\n");
+        }
     }
     return 0;
 }
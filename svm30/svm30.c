@@ -34,8 +34,13 @@
 #include "sensirion_humidity_conversion.h"
 #include "sgp30.h"
 #include "sgp_git_version.h"
+#include "sgp_humidity_compensation.h"
 #include "shtc1.h"
 
+/* see svm_set_humidity_compensation() */
+static sgp_humidity_compensation svm_ah = {SGP_AH_THRESHOLD_DEFAULT,
+                                           SGP_AH_INTERVAL_DEFAULT};
+
 static void svm_compensate_rht(int32_t* temperature, int32_t* humidity) {
     *temperature = ((*temperature * 8225) >> 13) - 500;
     *humidity = (*humidity * 8397) >> 13;
@@ -44,6 +49,7 @@ static void svm_compensate_rht(int32_t* temperature, int32_t* humidity) {
 static int16_t svm_set_humidity(const int32_t* temperature,
                                 const int32_t* humidity) {
     uint32_t absolute_humidity;
+    int16_t ret;
 
     absolute_humidity =
         sensirion_calc_absolute_humidity(*temperature, *humidity);
@@ -51,7 +57,25 @@ static int16_t svm_set_humidity(const int32_t* temperature,
     if (absolute_humidity == 0)
         absolute_humidity = 1; /* avoid disabling humidity compensation */
 
-    return sgp30_set_absolute_humidity(absolute_humidity);
+    if (!sgp_humidity_compensation_needs_update(&svm_ah, absolute_humidity))
+        return STATUS_OK;
+
+    ret = sgp30_set_absolute_humidity(absolute_humidity);
+    if (ret != STATUS_OK)
+        return ret;
+
+    sgp_humidity_compensation_updated(&svm_ah, absolute_humidity);
+    return STATUS_OK;
+}
+
+void svm_set_humidity_compensation(uint32_t threshold, uint16_t interval) {
+    sgp_humidity_compensation_configure(&svm_ah, threshold, interval);
+}
+
+void svm_get_humidity_compensation_stats(uint32_t* writes,
+                                         uint32_t* skipped_writes) {
+    *writes = svm_ah.writes;
+    *skipped_writes = svm_ah.skipped_writes;
 }
 
 const char* svm_get_driver_version() {
@@ -106,5 +130,8 @@ int16_t svm_probe() {
     if (err != STATUS_OK)
         return err;
 
+    /* send the humidity again with the first measurement */
+    sgp_humidity_compensation_reset(&svm_ah);
+
     return sgp30_probe();
 }
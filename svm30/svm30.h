@@ -55,6 +55,34 @@ const char* svm_get_driver_version();
  */
 int16_t svm_probe(void);
 
+/**
+ * svm_set_humidity_compensation() - configure when the measured humidity is
+ * sent to the SGP30
+ *
+ * Each measurement measures the humidity, but only sends it to the SGP30 as
+ * described at struct sgp_humidity_compensation, which keeps the 1Hz IAQ
+ * measurements on time. The defaults are SGP_AH_THRESHOLD_DEFAULT and
+ * SGP_AH_INTERVAL_DEFAULT. The first measurement after svm_probe() always
+ * sends the humidity.
+ *
+ * @threshold:  Change of the absolute humidity in [mg/m^3] which is sent to
+ *              the sensor, 0 to send it with every measurement
+ * @interval:   Maximum number of measurements between updates, 0 to only
+ *              update on changes beyond @threshold
+ */
+void svm_set_humidity_compensation(uint32_t threshold, uint16_t interval);
+
+/**
+ * svm_get_humidity_compensation_stats() - get the number of humidity writes
+ *
+ * The counters are cumulative over all measurements since start-up.
+ *
+ * @writes:         Number of absolute humidity values sent to the SGP30
+ * @skipped_writes: Number of measurements which did not send the humidity
+ */
+void svm_get_humidity_compensation_stats(uint32_t* writes,
+                                         uint32_t* skipped_writes);
+
 /**
  * svm_measure_iaq_blocking_read() - Measure IAQ concentrations tVOC, CO2-Eq.
  *
@@ -29,6 +29,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "sgp_periodic.h"
 #include "svm30.h"
 
 #include <stdio.h>  // printf
@@ -44,6 +45,7 @@ int main(void) {
     uint16_t tvoc_ppb, co2_eq_ppm;
     uint32_t iaq_baseline;
     int32_t temperature, humidity;
+    sgp_periodic periodic;
 
     /* Initialize I2C */
     sensirion_i2c_init();
@@ -66,7 +68,14 @@ int main(void) {
      * err = sgp_set_iaq_baseline(iaq_baseline);
      */
 
-    /* Run periodic IAQ measurements at defined intervals */
+    /* Run periodic IAQ measurements at defined intervals.
+     * IMPLEMENT: install an sgp_clock reading a hardware timer with
+     * sgp_clock_set(), unless the I2C implementation installs one like the
+     * Linux and emulated ones. The default clock only counts the time slept,
+     * so the scheduler can neither compensate the measurement time nor
+     * detect overruns.
+     */
+    sgp_periodic_init(&periodic, 1000000);
     while (1) {
         err = svm_measure_iaq_blocking_read(&tvoc_ppb, &co2_eq_ppm,
                                             &temperature, &humidity);
@@ -89,9 +98,12 @@ int main(void) {
         }
 
         /* The IAQ measurement must be triggered exactly once per second (SGP30)
-         * to get accurate values.
+         * to get accurate values. The scheduler compensates for the time the
+         * measurement takes.
          */
-        sensirion_sleep_usec(1000000);  // SVM30 / SGP30
+        if (sgp_periodic_wait(&periodic)) {  // SVM30 / SGP30
+            printf("IAQ measurement missed\n");
+        }
     }
     return 0;
 }
@@ -0,0 +1,37 @@
+#include "sensirion_common.h"
+#include "sgp_emulator.h"
+
+/*
+ * Emulated version of the test rig the hardware tests run on:
+ *
+ * - TCA9548A at 0x71 with SGP30 FS 0x20, 0x21 and 0x22 on the channels 0 to 2,
+ *   SGPC3 FS 4, 5 and 6 on the channels 3 to 5 and an SHTC1 on channel 6
+ * - TCA9548A at 0x72 with an SGP40 and an SHTC3 on channel 0
+ */
+static void sensirion_emulated_rig_setup(void) {
+    static const uint16_t feature_sets[] = {0x0020, 0x0021, 0x0022,
+                                            0x1004, 0x1005, 0x1006};
+    uint16_t mux_id;
+    uint16_t id;
+    uint8_t ch;
+
+    sgp_emulator_reset();
+    sgp_emulator_add_device(0, SGP_EMULATOR_TCA9548A, 0x71, &mux_id);
+    for (ch = 0; ch < ARRAY_SIZE(feature_sets); ++ch) {
+        sgp_emulator_add_device_on_mux(
+            mux_id, ch, ch < 3 ? SGP_EMULATOR_SGP30 : SGP_EMULATOR_SGPC3, 0x58,
+            &id);
+        sgp_emulator_set_feature_set(id, feature_sets[ch]);
+    }
+    sgp_emulator_add_device_on_mux(mux_id, 6, SGP_EMULATOR_SHTC1, 0x70, &id);
+
+    sgp_emulator_add_device(0, SGP_EMULATOR_TCA9548A, 0x72, &mux_id);
+    sgp_emulator_add_device_on_mux(mux_id, 0, SGP_EMULATOR_SGP40, 0x59, &id);
+    sgp_emulator_add_device_on_mux(mux_id, 0, SGP_EMULATOR_SHTC1, 0x70, &id);
+}
+
+static struct sensirion_emulated_rig {
+    sensirion_emulated_rig() {
+        sensirion_emulated_rig_setup();
+    }
+} rig;
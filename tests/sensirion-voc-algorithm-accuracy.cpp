@@ -0,0 +1,158 @@
+#include "sensirion-voc-algorithm-trace.h"
+#include "sensirion_voc_algorithm.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+ * Built once per fix16_exp() implementation, e.g. with -DFIXMATH_EXP_LUT. The
+ * algorithm is included to measure the static fix16_exp().
+ */
+#include "sensirion_voc_algorithm.c"
+
+#if defined(FIXMATH_EXP_LUT)
+#define EXP_MODE "FIXMATH_EXP_LUT"
+#elif defined(FIXMATH_EXP_FAST)
+#define EXP_MODE "FIXMATH_EXP_FAST"
+#else
+#define EXP_MODE "default"
+#define EXP_MODE_IS_REFERENCE
+#endif
+
+/* One month of samples at the default sampling interval of 1s */
+#define NUM_SAMPLES (30 * 24 * 3600)
+
+/* The default build stores its VOC index as <trace name>.voc_index in the
+ * working directory for the other builds to compare against */
+static void reference_path(const char* name, char* path, size_t size) {
+    const char* base = strrchr(name, '/');
+    snprintf(path, size, "%s.voc_index", base ? base + 1 : name);
+}
+
+#ifdef EXP_MODE_IS_REFERENCE
+static bool write_reference(const char* path,
+                            const std::vector<int32_t>& voc_index) {
+    FILE* file = fopen(path, "wb");
+    bool ok;
+
+    if (!file) {
+        return false;
+    }
+    ok = fwrite(voc_index.data(), sizeof(int32_t), voc_index.size(), file) ==
+         voc_index.size();
+    return fclose(file) == 0 && ok;
+}
+#else
+static bool read_reference(const char* path, std::vector<int32_t>& voc_index) {
+    FILE* file = fopen(path, "rb");
+    bool ok;
+
+    if (!file) {
+        return false;
+    }
+    ok = fread(voc_index.data(), sizeof(int32_t), voc_index.size(), file) ==
+         voc_index.size();
+    fclose(file);
+    return ok;
+}
+
+static void compare_reference(const char* path,
+                              const std::vector<int32_t>& voc_index) {
+    std::vector<int32_t> reference(voc_index.size());
+    size_t differing = 0;
+    int32_t max_diff = 0;
+    double sum_diff = 0;
+
+    if (!read_reference(path, reference)) {
+        printf("  no reference VOC index, run the default build first\n");
+        return;
+    }
+    for (size_t i = 0; i < voc_index.size(); ++i) {
+        int32_t diff = abs(voc_index[i] - reference[i]);
+        if (diff) {
+            ++differing;
+            sum_diff += diff;
+            if (diff > max_diff) {
+                max_diff = diff;
+            }
+        }
+    }
+    printf("  VOC index compared to the default build: %zu differing "
+           "(%.4f%%), max diff %d, mean abs diff %.6f\n",
+           differing, 100. * differing / voc_index.size(), max_diff,
+           sum_diff / voc_index.size());
+}
+#endif
+
+static void report_exp_error(void) {
+    double max_error = 0;
+    for (fix16_t x = F16(-11.7835) + 1; x < F16(10.3972); ++x) {
+        double expected = floor(exp(x / 65536.) * 65536. + 0.5);
+        double error = fabs(fix16_exp(x) - expected);
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+    printf("fix16_exp() compared to the correctly rounded exp(): "
+           "max error %.0f LSB\n",
+           max_error);
+}
+
+static bool report_trace(const char* name, const std::vector<uint16_t>& sraw) {
+    std::vector<int32_t> voc_index(sraw.size());
+    VocAlgorithmParams params;
+    char path[256];
+
+    VocAlgorithm_init(&params);
+    auto start = std::chrono::steady_clock::now();
+    VocAlgorithm_process_batch(&params, sraw.data(), voc_index.data(),
+                               (uint32_t)sraw.size());
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    printf("%s: %zu samples, %.0f samples/s\n", name, sraw.size(),
+           sraw.size() / seconds);
+
+    reference_path(name, path, sizeof(path));
+#ifdef EXP_MODE_IS_REFERENCE
+    if (!write_reference(path, voc_index)) {
+        printf("error: could not write %s\n", path);
+        return false;
+    }
+    printf("  reference VOC index written to %s\n", path);
+#else
+    compare_reference(path, voc_index);
+#endif
+    return true;
+}
+
+/*
+ * Compares fix16_exp() against exp() and the resulting VOC index against the
+ * default build, which has to run first. Recorded traces with one raw value
+ * per line can be passed as arguments, otherwise one month of synthetic data
+ * is used.
+ */
+int main(int argc, char** argv) {
+    std::vector<uint16_t> sraw(NUM_SAMPLES);
+
+    printf("fix16_exp() implementation: %s\n", EXP_MODE);
+    report_exp_error();
+
+    if (argc < 2) {
+        generate_sraw(sraw);
+        return report_trace("synthetic", sraw) ? 0 : 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (!load_sraw(argv[i], sraw)) {
+            printf("error: could not read trace %s\n", argv[i]);
+            return 1;
+        }
+        if (!report_trace(argv[i], sraw)) {
+            return 1;
+        }
+    }
+    return 0;
+}
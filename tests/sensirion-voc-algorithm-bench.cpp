@@ -0,0 +1,135 @@
+#include "sensirion_voc_algorithm.h"
+#include "sensirion-voc-algorithm-trace.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+/* One month of samples at the default sampling interval of 1s */
+#define NUM_SAMPLES (30 * 24 * 3600)
+/* Sensors of a gateway, each advanced for one hour */
+#define NUM_SENSORS 500
+#define NUM_TICKS 3600
+/* Large fleet sharing one configuration, each advanced for six minutes */
+#define NUM_FLEET_SENSORS 10000
+#define NUM_FLEET_TICKS 360
+#define CACHE_LINE_SIZE 64
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+int main(void) {
+    std::vector<uint16_t> sraw(NUM_SAMPLES);
+    std::vector<int32_t> voc_index_single(NUM_SAMPLES);
+    std::vector<int32_t> voc_index_batch(NUM_SAMPLES);
+    VocAlgorithmParams params;
+
+    generate_sraw(sraw);
+
+    VocAlgorithm_init(&params);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sraw.size(); ++i) {
+        VocAlgorithm_process(&params, sraw[i], &voc_index_single[i]);
+    }
+    double single_s = seconds_since(start);
+
+    VocAlgorithm_init(&params);
+    start = std::chrono::steady_clock::now();
+    VocAlgorithm_process_batch(&params, sraw.data(), voc_index_batch.data(),
+                               NUM_SAMPLES);
+    double batch_s = seconds_since(start);
+
+    printf("VocAlgorithm_process:       %10.0f samples/s\n",
+           NUM_SAMPLES / single_s);
+    printf("VocAlgorithm_process_batch: %10.0f samples/s\n",
+           NUM_SAMPLES / batch_s);
+
+    if (voc_index_single != voc_index_batch) {
+        printf("error: batch and per-sample results differ\n");
+        return 1;
+    }
+
+    std::vector<VocAlgorithmParams> fleet(NUM_SENSORS);
+    std::vector<uint16_t> fleet_sraw(NUM_SENSORS);
+    std::vector<int32_t> fleet_voc_index(NUM_SENSORS);
+    for (size_t n = 0; n < fleet.size(); ++n) {
+        VocAlgorithm_init(&fleet[n]);
+    }
+    start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < NUM_TICKS; ++t) {
+        for (size_t n = 0; n < fleet.size(); ++n) {
+            fleet_sraw[n] = sraw[(t + 97 * n) % sraw.size()];
+        }
+        for (size_t n = 0; n < fleet.size(); ++n) {
+            VocAlgorithm_process(&fleet[n], fleet_sraw[n],
+                                 &fleet_voc_index[n]);
+        }
+    }
+    double fleet_s = seconds_since(start);
+    printf("VocAlgorithm_process:       %10.0f samples/s (%d sensors)\n",
+           (double)NUM_SENSORS * NUM_TICKS / fleet_s, NUM_SENSORS);
+
+    /*
+     * Once the instances do not fit into the cache anymore, every sampling
+     * interval has to fetch each cache line of the whole fleet again, so the
+     * number of cache lines touched per interval is the number of misses.
+     * Use e.g. `perf stat -e cache-misses` to measure them on the target.
+     */
+    std::vector<VocAlgorithmParams> large_fleet(NUM_FLEET_SENSORS);
+    std::vector<VocAlgorithmState> states(NUM_FLEET_SENSORS);
+    std::vector<uint16_t> large_sraw(NUM_FLEET_SENSORS);
+    std::vector<int32_t> voc_index_params(NUM_FLEET_SENSORS);
+    std::vector<int32_t> voc_index_states(NUM_FLEET_SENSORS);
+    VocAlgorithmConfig config;
+    double params_s = 0;
+    double states_s = 0;
+    bool identical = true;
+
+    VocAlgorithm_init_config(&config, (int32_t)VocAlgorithm_SAMPLING_INTERVAL);
+    for (size_t n = 0; n < NUM_FLEET_SENSORS; ++n) {
+        VocAlgorithm_init(&large_fleet[n]);
+        VocAlgorithm_init_state(&config, &states[n]);
+    }
+    for (size_t t = 0; t < NUM_FLEET_TICKS; ++t) {
+        for (size_t n = 0; n < NUM_FLEET_SENSORS; ++n) {
+            large_sraw[n] = sraw[(t + 97 * n) % sraw.size()];
+        }
+        start = std::chrono::steady_clock::now();
+        for (size_t n = 0; n < NUM_FLEET_SENSORS; ++n) {
+            VocAlgorithm_process(&large_fleet[n], large_sraw[n],
+                                 &voc_index_params[n]);
+        }
+        params_s += seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        VocAlgorithm_process_states(&config, states.data(), large_sraw.data(),
+                                    voc_index_states.data(),
+                                    NUM_FLEET_SENSORS);
+        states_s += seconds_since(start);
+        identical = identical && voc_index_params == voc_index_states;
+    }
+    printf("\n%d sensors, cache lines touched per sampling interval:\n",
+           NUM_FLEET_SENSORS);
+    printf("VocAlgorithmParams per sensor: %3zu bytes, %6zu lines, "
+           "%10.0f samples/s\n",
+           sizeof(VocAlgorithmParams),
+           (sizeof(VocAlgorithmParams) * NUM_FLEET_SENSORS +
+            CACHE_LINE_SIZE - 1) /
+               CACHE_LINE_SIZE,
+           (double)NUM_FLEET_SENSORS * NUM_FLEET_TICKS / params_s);
+    printf("VocAlgorithmState per sensor:  %3zu bytes, %6zu lines, "
+           "%10.0f samples/s (shared config %zu bytes)\n",
+           sizeof(VocAlgorithmState),
+           (sizeof(VocAlgorithmState) * NUM_FLEET_SENSORS +
+            sizeof(VocAlgorithmConfig) + CACHE_LINE_SIZE - 1) /
+               CACHE_LINE_SIZE,
+           (double)NUM_FLEET_SENSORS * NUM_FLEET_TICKS / states_s,
+           sizeof(VocAlgorithmConfig));
+
+    if (!identical) {
+        printf("error: shared config and per-sensor results differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "sensirion-voc-algorithm-trace.h"
+#include "sensirion_voc_algorithm.h"
+#include <math.h>
+
+/*
+ * Built once per fix16_exp() implementation, e.g. with -DFIXMATH_EXP_LUT, and
+ * compared against the reference values of the default implementation. The
+ * algorithm is included to test the static fix16_exp().
+ */
+#include "sensirion_voc_algorithm.c"
+
+/* Range of arguments that do not saturate, with some margin */
+#define EXP_ARG_MIN F16(-12.)
+#define EXP_ARG_MAX F16(11.)
+
+/* Hash of fix16_exp() over the range of the default implementation */
+#ifndef FIXMATH_NO_ROUNDING
+#define EXP_REFERENCE_HASH 0xE4C28896u
+#else
+#define EXP_REFERENCE_HASH 0x9A08F045u
+#endif
+
+#define EXP_FAST_MAX_ULP_ERROR 2
+#define EXP_FAST_MAX_VOC_INDEX_ERROR 1
+
+TEST_GROUP (Sgp40VocIndexAlgorithmExpTest) {};
+
+#ifdef FIXMATH_EXP_FAST
+TEST (Sgp40VocIndexAlgorithmExpTest, exp_is_within_max_ulp_error) {
+    for (fix16_t x = F16(-11.7835) + 1; x < F16(10.3972); ++x) {
+        fix16_t actual = fix16_exp(x);
+        double expected = floor(exp(x / 65536.) * 65536. + 0.5);
+        if (fabs(actual - expected) > EXP_FAST_MAX_ULP_ERROR) {
+            CHECK_EQUAL_TEXT((fix16_t)expected, actual,
+                             "Fast exp() exceeds its maximum error");
+        }
+    }
+}
+#else
+TEST (Sgp40VocIndexAlgorithmExpTest, exp_matches_reference) {
+    uint32_t hash = TRACE_HASH_INIT;
+
+    for (fix16_t x = EXP_ARG_MIN; x <= EXP_ARG_MAX; ++x) {
+        hash = trace_hash(hash, fix16_exp(x));
+    }
+    CHECK_EQUAL_TEXT(EXP_REFERENCE_HASH, hash,
+                     "exp() should match the default implementation");
+}
+#endif
+
+TEST (Sgp40VocIndexAlgorithmExpTest, exp_saturates_like_reference) {
+    for (fix16_t x = F16(10.3972); x <= EXP_ARG_MAX; ++x) {
+        if (fix16_exp(x) != FIX16_MAXIMUM) {
+            CHECK_EQUAL(FIX16_MAXIMUM, fix16_exp(x));
+        }
+    }
+    for (fix16_t x = EXP_ARG_MIN; x <= F16(-11.7835); ++x) {
+        if (fix16_exp(x) != 0) {
+            CHECK_EQUAL(0, fix16_exp(x));
+        }
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmExpTest, voc_index_matches_reference) {
+    std::vector<int32_t> voc_index;
+    uint32_t hash;
+
+    process_reference_trace(voc_index, &hash);
+    CHECK_EQUAL(sizeof(reference_voc_index) / sizeof(reference_voc_index[0]),
+                voc_index.size());
+    for (size_t i = 0; i < voc_index.size(); ++i) {
+#ifdef FIXMATH_EXP_FAST
+        CHECK_TRUE_TEXT(abs(voc_index[i] - reference_voc_index[i]) <=
+                            EXP_FAST_MAX_VOC_INDEX_ERROR,
+                        "VOC index with fast exp() differs too much");
+#else
+        CHECK_EQUAL(reference_voc_index[i], voc_index[i]);
+#endif
+    }
+#ifndef FIXMATH_EXP_FAST
+    CHECK_EQUAL_TEXT(REFERENCE_VOC_INDEX_HASH, hash,
+                     "VOC index should be identical to the reference");
+#endif
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
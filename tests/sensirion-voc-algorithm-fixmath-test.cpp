@@ -0,0 +1,106 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "sensirion-voc-algorithm-trace.h"
+#include "sensirion_voc_algorithm.h"
+#include <stdint.h>
+
+/*
+ * Built with and without -DFIXMATH_USE_64BIT for each combination of
+ * FIXMATH_NO_ROUNDING and FIXMATH_NO_OVERFLOW, and compared against reference
+ * values of the 32-bit fix16_mul() and fix16_div(). The algorithm is included
+ * to test these static functions.
+ */
+#include "sensirion_voc_algorithm.c"
+
+/* Hashes of the 32-bit results for all operands of check_operation() */
+#if !defined(FIXMATH_NO_ROUNDING) && !defined(FIXMATH_NO_OVERFLOW)
+#define MUL_REFERENCE_HASH 0x62686626u
+#define DIV_REFERENCE_HASH 0x51DACCDDu
+#elif !defined(FIXMATH_NO_ROUNDING)
+#define MUL_REFERENCE_HASH 0x04E5AA8Fu
+#define DIV_REFERENCE_HASH 0x4000FDA5u
+#elif !defined(FIXMATH_NO_OVERFLOW)
+#define MUL_REFERENCE_HASH 0xC07E399Cu
+#define DIV_REFERENCE_HASH 0x7E757C56u
+#else
+#define MUL_REFERENCE_HASH 0x17092EFEu
+#define DIV_REFERENCE_HASH 0xFE757C56u
+#endif
+
+#define NUM_RANDOM_OPERANDS 2000000
+
+typedef fix16_t (*fix16_operation)(fix16_t, fix16_t);
+
+/* Zero, units, rounding and overflow boundaries and the extremes */
+static const fix16_t edge_operands[] = {
+    0,          1,          2,          0x7FFF,     0x8000,
+    0x8001,     0xFFFF,     0x10000,    0x10001,    0x18000,
+    0xB504F3,   0xB504F4,   0xFFFFFF,   0x1000000,  0x7FFF0000,
+    0x7FFF8000, 0x3FFFFFFF, 0x40000000, 0x7FFFFFFE, 0x7FFFFFFF,
+    -1,         -2,         -0x7FFF,    -0x8000,    -0x8001,
+    -0xFFFF,    -0x10000,   -0x10001,   -0x18000,   -0xB504F3,
+    -0xB504F4,  -0xFFFFFF,  -0x1000000, -0x7FFF0000, -0x7FFF8000,
+    -0x3FFFFFFF, -0x40000000, -0x7FFFFFFF, INT32_MIN};
+
+static uint32_t random_state = 1;
+
+/* Random operand with a random magnitude, to also cover small operands */
+static fix16_t random_operand(void) {
+    random_state = random_state * 1664525 + 1013904223;
+    uint32_t value = random_state;
+    random_state = random_state * 1664525 + 1013904223;
+    return (fix16_t)value >> (random_state >> 27);
+}
+
+static uint32_t hash_operation(fix16_operation operation) {
+    const size_t num_edges = sizeof(edge_operands) / sizeof(edge_operands[0]);
+    uint32_t hash = TRACE_HASH_INIT;
+
+    for (size_t i = 0; i < num_edges; ++i) {
+        for (size_t j = 0; j < num_edges; ++j) {
+            fix16_t a = edge_operands[i];
+            fix16_t b = edge_operands[j];
+            hash = trace_hash(hash, operation(a, b));
+        }
+    }
+    random_state = 1;
+    for (uint32_t i = 0; i < NUM_RANDOM_OPERANDS; ++i) {
+        fix16_t a = random_operand();
+        fix16_t b = random_operand();
+        hash = trace_hash(hash, operation(a, b));
+    }
+    return hash;
+}
+
+TEST_GROUP (Sgp40VocIndexAlgorithmFixmathTest) {};
+
+TEST (Sgp40VocIndexAlgorithmFixmathTest, mul_matches_reference) {
+    CHECK_EQUAL_TEXT(MUL_REFERENCE_HASH, hash_operation(fix16_mul),
+                     "fix16_mul() should match the 32-bit implementation");
+    CHECK_EQUAL(F16(3.), fix16_mul(F16(1.5), F16(2.)));
+    CHECK_EQUAL(F16(-3.), fix16_mul(F16(-1.5), F16(2.)));
+}
+
+TEST (Sgp40VocIndexAlgorithmFixmathTest, div_matches_reference) {
+    CHECK_EQUAL_TEXT(DIV_REFERENCE_HASH, hash_operation(fix16_div),
+                     "fix16_div() should match the 32-bit implementation");
+    CHECK_EQUAL(F16(0.75), fix16_div(F16(1.5), F16(2.)));
+    CHECK_EQUAL(F16(-0.75), fix16_div(F16(-1.5), F16(2.)));
+}
+
+TEST (Sgp40VocIndexAlgorithmFixmathTest, voc_index_matches_reference) {
+    std::vector<int32_t> voc_index;
+    uint32_t hash;
+
+    process_reference_trace(voc_index, &hash);
+    CHECK_EQUAL(sizeof(reference_voc_index) / sizeof(reference_voc_index[0]),
+                voc_index.size());
+    for (size_t i = 0; i < voc_index.size(); ++i) {
+        CHECK_EQUAL(reference_voc_index[i], voc_index[i]);
+    }
+    CHECK_EQUAL_TEXT(REFERENCE_VOC_INDEX_HASH, hash,
+                     "VOC index should be identical to the reference");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
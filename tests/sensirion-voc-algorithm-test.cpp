@@ -1,5 +1,6 @@
 #include "CppUTest/CommandLineTestRunner.h"
 #include "sensirion_voc_algorithm.h"
+#include <stdlib.h>
 
 TEST_GROUP (Sgp40VocIndexAlgorithmTest) {};
 
@@ -27,6 +28,223 @@ TEST (Sgp40VocIndexAlgorithmTest, returns_average_after_blackout) {
         "VOC index should be the offset default after the the blackout period");
 }
 
+TEST (Sgp40VocIndexAlgorithmTest, batch_matches_per_sample_processing) {
+    VocAlgorithmParams single_params;
+    VocAlgorithmParams batch_params;
+    uint16_t sraw[600];
+    int32_t voc_index_batch[600];
+
+    for (int i = 0; i < 600; ++i) {
+        sraw[i] = (uint16_t)(30000 - (i % 120) * 20);
+    }
+    VocAlgorithm_init(&single_params);
+    VocAlgorithm_init(&batch_params);
+    VocAlgorithm_process_batch(&batch_params, sraw, voc_index_batch, 600);
+    for (int i = 0; i < 600; ++i) {
+        int32_t voc_index;
+        VocAlgorithm_process(&single_params, sraw[i], &voc_index);
+        CHECK_EQUAL_TEXT(voc_index, voc_index_batch[i],
+                         "Batch processing should match per-sample results");
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, shared_config_matches_single_instances) {
+    VocAlgorithmParams single_params[4];
+    VocAlgorithmConfig config;
+    VocAlgorithmState states[4];
+    uint16_t sraw[4];
+    int32_t voc_index_states[4];
+
+    VocAlgorithm_init_config(&config, 2);
+    VocAlgorithm_set_config_tuning_parameters(&config, 150, 24, 60, 80);
+    for (int n = 0; n < 4; ++n) {
+        VocAlgorithm_init_with_sampling_interval(&single_params[n], 2);
+        VocAlgorithm_set_tuning_parameters(&single_params[n], 150, 24, 60, 80);
+        VocAlgorithm_init_state(&config, &states[n]);
+    }
+    for (int i = 0; i < 600; ++i) {
+        for (int n = 0; n < 4; ++n) {
+            sraw[n] = (uint16_t)(28000 + 1000 * n - ((i * (n + 1)) % 300));
+        }
+        VocAlgorithm_process_states(&config, states, sraw, voc_index_states,
+                                    4);
+        for (int n = 0; n < 4; ++n) {
+            int32_t voc_index;
+            VocAlgorithm_process(&single_params[n], sraw[n], &voc_index);
+            CHECK_EQUAL_TEXT(voc_index, voc_index_states[n],
+                             "Shared config should match single instances");
+        }
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, sampling_interval_follows_1s_processing) {
+    VocAlgorithmParams params_1s;
+    VocAlgorithmParams params_10s;
+    int32_t voc_index_1s = 0;
+    int32_t voc_index_10s = 0;
+
+    VocAlgorithm_init(&params_1s);
+    CHECK_ZERO(VocAlgorithm_init_with_sampling_interval(&params_10s, 10));
+    for (int i = 0; i < 24 * 3600; ++i) {
+        /* baseline with a slow VOC event every two hours */
+        int32_t sraw = 30000 - ((i % 7200) > 3600 && (i % 7200) < 5400
+                                    ? ((i % 7200) - 3600) * 2
+                                    : 0);
+        VocAlgorithm_process(&params_1s, sraw, &voc_index_1s);
+        if (i % 10 != 9) {
+            continue;
+        }
+        VocAlgorithm_process(&params_10s, sraw, &voc_index_10s);
+        if (i < 50) {
+            CHECK_EQUAL_TEXT(0, voc_index_10s,
+                             "VOC index should be 0 during initial blackout");
+        } else if (i > 3600) {
+            CHECK_TEXT(abs(voc_index_1s - voc_index_10s) <= 25,
+                       "10s sampling should follow the 1s VOC index");
+        }
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, sampling_interval_out_of_range_is_rejected) {
+    VocAlgorithmParams params;
+    VocAlgorithmConfig config;
+
+    VocAlgorithm_init(&params);
+    config = params.mConfig;
+    CHECK_EQUAL(VocAlgorithm_ERR_SAMPLING_INTERVAL,
+                VocAlgorithm_init_with_sampling_interval(&params, 0));
+    CHECK_EQUAL(VocAlgorithm_ERR_SAMPLING_INTERVAL,
+                VocAlgorithm_init_config(&config, -1));
+    CHECK_EQUAL(VocAlgorithm_ERR_SAMPLING_INTERVAL,
+                VocAlgorithm_init_with_sampling_interval(&params, 11));
+    CHECK_EQUAL(VocAlgorithm_ERR_SAMPLING_INTERVAL,
+                VocAlgorithm_init_config(&config, 32768));
+    CHECK_EQUAL(F16(VocAlgorithm_SAMPLING_INTERVAL),
+                params.mConfig.mSampling_Interval);
+    CHECK_EQUAL(F16(VocAlgorithm_SAMPLING_INTERVAL), config.mSampling_Interval);
+    CHECK_ZERO(VocAlgorithm_init_config(&config, 1));
+    CHECK_ZERO(VocAlgorithm_init_config(&config, 10));
+}
+
+static int32_t snapshot_test_sraw(int i) {
+    /* baseline with a VOC event every 30 minutes */
+    return 30000 - ((i % 1800) < 300 ? (i % 1800) * 10 : 0);
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, snapshot_resumes_without_blackout) {
+    VocAlgorithmParams params;
+    VocAlgorithmParams restored;
+    uint8_t snapshot[VocAlgorithm_SNAPSHOT_SIZE];
+
+    VocAlgorithm_init(&params);
+    VocAlgorithm_set_tuning_parameters(&params, 150, 24, 60, 100);
+    for (int i = 0; i < 4 * 3600; ++i) {
+        int32_t voc_index;
+        VocAlgorithm_process(&params, snapshot_test_sraw(i), &voc_index);
+    }
+    CHECK_EQUAL(0, VocAlgorithm_get_snapshot(&params, snapshot,
+                                             sizeof(snapshot)));
+    CHECK_EQUAL(0, VocAlgorithm_set_snapshot(&restored, snapshot,
+                                             sizeof(snapshot)));
+
+    for (int i = 4 * 3600; i < 6 * 3600; ++i) {
+        int32_t expected;
+        int32_t voc_index;
+        VocAlgorithm_process(&params, snapshot_test_sraw(i), &expected);
+        VocAlgorithm_process(&restored, snapshot_test_sraw(i), &voc_index);
+        CHECK_EQUAL_TEXT(expected, voc_index,
+                         "Restored state should continue identically");
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, snapshot_rejects_invalid_data) {
+    VocAlgorithmParams params;
+    VocAlgorithmParams restored;
+    uint8_t snapshot[VocAlgorithm_SNAPSHOT_SIZE];
+    int32_t voc_index;
+
+    VocAlgorithm_init(&params);
+    for (int i = 0; i < 600; ++i) {
+        VocAlgorithm_process(&params, snapshot_test_sraw(i), &voc_index);
+    }
+    CHECK_EQUAL(VocAlgorithm_SNAPSHOT_ERR_SIZE,
+                VocAlgorithm_get_snapshot(&params, snapshot,
+                                          sizeof(snapshot) - 1));
+    CHECK_EQUAL(0, VocAlgorithm_get_snapshot(&params, snapshot,
+                                             sizeof(snapshot)));
+
+    VocAlgorithm_init(&restored);
+    CHECK_EQUAL(VocAlgorithm_SNAPSHOT_ERR_SIZE,
+                VocAlgorithm_set_snapshot(&restored, snapshot,
+                                          sizeof(snapshot) - 1));
+    snapshot[10] ^= 0x01;
+    CHECK_EQUAL(VocAlgorithm_SNAPSHOT_ERR_CRC,
+                VocAlgorithm_set_snapshot(&restored, snapshot,
+                                          sizeof(snapshot)));
+    snapshot[10] ^= 0x01;
+    snapshot[2] = VocAlgorithm_SNAPSHOT_VERSION + 1;
+    CHECK_EQUAL(VocAlgorithm_SNAPSHOT_ERR_FORMAT,
+                VocAlgorithm_set_snapshot(&restored, snapshot,
+                                          sizeof(snapshot)));
+
+    /* a rejected snapshot leaves the freshly initialized state untouched */
+    VocAlgorithm_process(&restored, snapshot_test_sraw(0), &voc_index);
+    CHECK_EQUAL_TEXT(0, voc_index, "VOC index should be 0 during blackout");
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, timestamp_processing_fills_missed_samples) {
+    VocAlgorithmParams expected_params;
+    VocAlgorithmParams params;
+    int32_t expected;
+    int32_t voc_index;
+    /* start close to the wrap-around of the millisecond timestamp */
+    uint32_t timestamp_ms = 0xFFFFFFFFu - 30 * 60 * 1000u;
+
+    VocAlgorithm_init(&expected_params);
+    VocAlgorithm_init(&params);
+    for (int i = 0; i < 3600; ++i) {
+        int32_t sraw = snapshot_test_sraw(i);
+        /* irregular timing: every 10th sample is late */
+        uint32_t jitter_ms = (i % 10 == 9) ? 700 : 0;
+        if (i % 100 == 11) {
+            /* missed sample, replaced by the next one */
+            continue;
+        }
+        if (i % 100 == 12) {
+            VocAlgorithm_process(&expected_params, sraw, &expected);
+        }
+        VocAlgorithm_process(&expected_params, sraw, &expected);
+        VocAlgorithm_process_with_timestamp(
+            &params, sraw, timestamp_ms + i * 1000u + jitter_ms, &voc_index);
+        CHECK_EQUAL_TEXT(expected, voc_index,
+                         "Should advance once per elapsed sampling interval");
+    }
+}
+
+TEST (Sgp40VocIndexAlgorithmTest, timestamp_processing_restarts_after_gap) {
+    VocAlgorithmParams params;
+    int32_t voc_index;
+    uint32_t timestamp_ms = 0;
+
+    VocAlgorithm_init(&params);
+    for (int i = 0; i < 600; ++i) {
+        VocAlgorithm_process_with_timestamp(&params, 30000, timestamp_ms,
+                                            &voc_index);
+        timestamp_ms += 1000;
+    }
+    CHECK_EQUAL(100, voc_index);
+
+    /* too early for the next sampling interval */
+    VocAlgorithm_process_with_timestamp(&params, 20000, timestamp_ms - 500,
+                                        &voc_index);
+    CHECK_EQUAL_TEXT(100, voc_index, "Early sample should be dropped");
+
+    timestamp_ms += (uint32_t)(VocAlgorithm_MAX_GAP_SECONDS * 1000) + 1;
+    VocAlgorithm_process_with_timestamp(&params, 30000, timestamp_ms,
+                                        &voc_index);
+    CHECK_EQUAL_TEXT(0, voc_index, "Long gap should restart the blackout");
+}
+
 int main(int argc, char** argv) {
     return CommandLineTestRunner::RunAllTests(argc, argv);
 }
@@ -0,0 +1,85 @@
+#ifndef SENSIRION_VOC_ALGORITHM_TRACE_H
+#define SENSIRION_VOC_ALGORITHM_TRACE_H
+
+#include "sensirion_voc_algorithm.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/*
+ * VOC index of the default fix16_exp() implementation for one day of
+ * generate_sraw() at the end of every hour, and the hash of all values. The
+ * tests and reports of the other build configurations compare against them.
+ */
+#define REFERENCE_TRACE_SAMPLES (24 * 3600)
+#define REFERENCE_TRACE_INTERVAL 3600
+#ifndef FIXMATH_NO_ROUNDING
+static const int32_t reference_voc_index[] = {
+    101, 95, 97, 94, 92, 93, 89, 88, 88, 88, 84, 84,
+    81,  81, 79, 80, 79, 81, 79, 80, 77, 77, 78, 77};
+#define REFERENCE_VOC_INDEX_HASH 0xC27C0131u
+#else
+static const int32_t reference_voc_index[] = {
+    101, 95, 97, 94, 92, 93, 89, 88, 88, 88, 84, 84,
+    80,  80, 78, 80, 78, 80, 79, 80, 76, 76, 77, 76};
+#define REFERENCE_VOC_INDEX_HASH 0x3F7E92E6u
+#endif
+
+/* Synthetic raw signal with a slow baseline drift, a VOC event every two
+ * hours and some noise, one sample per second */
+static inline void generate_sraw(std::vector<uint16_t>& sraw) {
+    uint32_t seed = 42;
+    for (size_t i = 0; i < sraw.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int32_t value = 30000 + (int32_t)((i / 600) % 2000) - 1000;
+        if (i % 7200 < 600) {
+            value -= (int32_t)(i % 7200) * 5;
+        }
+        value += (int32_t)((seed >> 16) % 200) - 100;
+        sraw[i] = (uint16_t)value;
+    }
+}
+
+/* FNV-1 like hash over 32-bit values, start with TRACE_HASH_INIT */
+#define TRACE_HASH_INIT 2166136261u
+static inline uint32_t trace_hash(uint32_t hash, int32_t value) {
+    return (hash ^ (uint32_t)value) * 16777619u;
+}
+
+/* VOC index of the reference trace, compared to reference_voc_index[] */
+static inline void process_reference_trace(std::vector<int32_t>& voc_index,
+                                           uint32_t* hash) {
+    std::vector<uint16_t> sraw(REFERENCE_TRACE_SAMPLES);
+    VocAlgorithmParams params;
+
+    generate_sraw(sraw);
+    VocAlgorithm_init(&params);
+    voc_index.clear();
+    *hash = TRACE_HASH_INIT;
+    for (size_t i = 0; i < sraw.size(); ++i) {
+        int32_t value;
+        VocAlgorithm_process(&params, sraw[i], &value);
+        *hash = trace_hash(*hash, value);
+        if (i % REFERENCE_TRACE_INTERVAL == REFERENCE_TRACE_INTERVAL - 1) {
+            voc_index.push_back(value);
+        }
+    }
+}
+
+/* Load a recorded trace with one raw value per line */
+static inline bool load_sraw(const char* path, std::vector<uint16_t>& sraw) {
+    FILE* file = fopen(path, "r");
+    unsigned value;
+
+    if (!file) {
+        return false;
+    }
+    sraw.clear();
+    while (fscanf(file, "%u", &value) == 1) {
+        sraw.push_back((uint16_t)value);
+    }
+    fclose(file);
+    return !sraw.empty();
+}
+
+#endif /* SENSIRION_VOC_ALGORITHM_TRACE_H */
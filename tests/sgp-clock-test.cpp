@@ -0,0 +1,84 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp40_voc_index.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_periodic.h"
+
+#define USEC_PER_SEC 1000000ull
+#define LEARNING_PHASE_SECONDS (3 * 3600)
+
+TEST_GROUP (SGP_Clock_Tests) {
+    void setup() {
+        sgp_emulator_reset();
+        sensirion_i2c_init();
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_clock_set(NULL);
+    }
+};
+
+TEST (SGP_Clock_Tests, virtual_clock_only_advances_when_sleeping) {
+    sgp_virtual_clock virtual_clock;
+
+    sgp_virtual_clock_init(&virtual_clock, 1000);
+    sgp_clock_set(&virtual_clock.clock);
+    CHECK_TRUE(sgp_clock_get() == &virtual_clock.clock);
+    CHECK_TRUE(sgp_clock_is_set());
+    CHECK_EQUAL(1000, sgp_clock_now_us());
+
+    sgp_clock_sleep_usec(500);
+    CHECK_EQUAL(1500, sgp_clock_now_us());
+    sgp_virtual_clock_advance_us(&virtual_clock, 30 * 24 * 3600 * USEC_PER_SEC);
+    CHECK_EQUAL(1500 + 30 * 24 * 3600 * USEC_PER_SEC, sgp_clock_now_us());
+
+    sgp_clock_set(NULL);
+    CHECK_TRUE(sgp_clock_get() != &virtual_clock.clock);
+    CHECK_FALSE(sgp_clock_is_set());
+}
+
+TEST (SGP_Clock_Tests, default_clock_sleeps_with_sensirion_sleep_usec) {
+    uint64_t emulator_us;
+    uint64_t now_us;
+
+    CHECK_TRUE_TEXT(sgp_clock_get() == sgp_emulator_get_clock(),
+                    "sensirion_i2c_init() installs the emulator clock");
+    sgp_clock_set(NULL);
+
+    emulator_us = sgp_emulator_get_time_us();
+    now_us = sgp_clock_now_us();
+    sgp_clock_sleep_usec(1234);
+    CHECK_EQUAL(emulator_us + 1234, sgp_emulator_get_time_us());
+    CHECK_EQUAL_TEXT(now_us + 1234, sgp_clock_now_us(),
+                     "default clock counts the time slept");
+}
+
+TEST (SGP_Clock_Tests, simulates_voc_learning_phase) {
+    const sgp_emulator_signal sraw = {30000, 1500, 20 * 60 * 1000, 20};
+    sgp_periodic periodic;
+    int32_t voc_index = 0;
+    int32_t max_voc_index = 0;
+
+    /* the SGP40 of the default devices */
+    CHECK_ZERO(sgp_emulator_set_signal(1, SGP_EMULATOR_SIGNAL_SRAW, &sraw));
+    CHECK_ZERO(sensirion_init_sensors());
+
+    sgp_periodic_init(&periodic, USEC_PER_SEC);
+    for (int i = 0; i < LEARNING_PHASE_SECONDS; ++i) {
+        CHECK_ZERO(sensirion_measure_voc_index(&voc_index));
+        if (voc_index > max_voc_index)
+            max_voc_index = voc_index;
+        CHECK_ZERO(sgp_periodic_wait(&periodic));
+    }
+    CHECK_TRUE(sgp_clock_now_us() >= LEARNING_PHASE_SECONDS * USEC_PER_SEC);
+    CHECK_TRUE_TEXT(voc_index > 0, "VOC index after the learning phase");
+    CHECK_TRUE_TEXT(max_voc_index > 100, "VOC events detected");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,251 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp40.h"
+#include "sgp_emulator.h"
+#include "sgp_i2c_mux.h"
+
+#define MUX_ADDRESS 0x71
+#define SHTC1_ADDRESS 0x70
+#define SHTC1_CMD_MEASURE 0x7866
+#define SHTC1_CMD_SLEEP 0xb098
+#define SHTC1_CMD_WAKE_UP 0x3517
+#define SHTC1_MEASUREMENT_DURATION_USEC 12100
+#define SGP30_IAQ_INIT_TIME_USEC 15000000
+
+TEST_GROUP (SGP_Emulator_Tests) {
+    sgp_i2c_bus bus;
+    sgp30_device sgp30;
+    uint16_t sgp30_id;
+    sgp_emulator_stats stats;
+
+    void setup() {
+        sgp_emulator_reset();
+        CHECK_ZERO(sgp_emulator_add_device(0, SGP_EMULATOR_SGP30,
+                                           SGP30_I2C_ADDRESS, &sgp30_id));
+        sensirion_i2c_init();
+        bus.bus_idx = 0;
+        bus.select = NULL;
+        bus.user_data = NULL;
+        bus.lock = NULL;
+        sgp30_dev_init(&sgp30, &bus, SGP30_I2C_ADDRESS);
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_emulator_reset();
+    }
+};
+
+TEST (SGP_Emulator_Tests, nacks_until_command_finished) {
+    uint16_t tvoc_ppb;
+    uint16_t co2_eq_ppm;
+    uint32_t count;
+
+    CHECK_ZERO(sgp30_dev_iaq_init(&sgp30));
+    sgp_emulator_get_stats(&stats, true);
+
+    CHECK_ZERO(sgp30_dev_measure_iaq(&sgp30));
+    sensirion_sleep_usec(SGP30_CMD_IAQ_MEASURE_DURATION_US - 1);
+    CHECK_EQUAL_TEXT(SGP30_ERR_NOT_READY,
+                     sgp30_dev_read_iaq(&sgp30, &tvoc_ppb, &co2_eq_ppm),
+                     "no result before the measurement duration");
+    CHECK_TRUE_TEXT(sgp30_dev_measure_iaq(&sgp30) != STATUS_OK,
+                    "no command before the measurement duration");
+
+    sensirion_sleep_usec(1);
+    CHECK_ZERO(sgp30_dev_read_iaq(&sgp30, &tvoc_ppb, &co2_eq_ppm));
+    CHECK_EQUAL_TEXT(400, co2_eq_ppm, "fixed value after iaq init");
+    CHECK_EQUAL(0, tvoc_ppb);
+    CHECK_TRUE_TEXT(sgp30_dev_read_iaq(&sgp30, &tvoc_ppb, &co2_eq_ppm) !=
+                        STATUS_OK,
+                    "result is read only once");
+
+    sgp_emulator_get_stats(&stats, false);
+    CHECK_EQUAL(2, stats.writes);
+    CHECK_EQUAL(2, stats.reads);
+    CHECK_EQUAL(2, stats.nacks);
+    CHECK_ZERO(sgp_emulator_get_command_count(sgp30_id, 0x2008, &count));
+    CHECK_EQUAL(1, count);
+    CHECK_ZERO(sgp_emulator_get_command_count(sgp30_id, 0, &count));
+    CHECK_EQUAL(2, count);
+}
+
+TEST (SGP_Emulator_Tests, rejects_invalid_commands) {
+    uint8_t cmd[] = {0x20, 0x61, 0x12, 0x34, 0x00};
+    uint16_t ah;
+
+    cmd[4] = sensirion_common_generate_crc(&cmd[2], 2);
+    cmd[4] ^= 0x01;
+    CHECK_TRUE_TEXT(sensirion_i2c_write(SGP30_I2C_ADDRESS, cmd, 5) !=
+                        STATUS_OK,
+                    "argument with wrong CRC");
+    CHECK_TRUE_TEXT(sensirion_i2c_write(SGP30_I2C_ADDRESS, cmd, 2) !=
+                        STATUS_OK,
+                    "missing argument");
+    cmd[4] ^= 0x01;
+    CHECK_ZERO(sensirion_i2c_write(SGP30_I2C_ADDRESS, cmd, 5));
+    CHECK_ZERO(sgp_emulator_get_absolute_humidity(sgp30_id, &ah));
+    CHECK_EQUAL(0x1234, ah);
+
+    sensirion_sleep_usec(SGP30_CMD_SET_ABSOLUTE_HUMIDITY_DURATION_US);
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, 0x1234) !=
+                        STATUS_OK,
+                    "unknown command");
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(0x42, 0x3682) != STATUS_OK,
+                    "unknown address");
+
+    CHECK_ZERO(sgp_emulator_set_feature_set(sgp30_id, 0x0020));
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, 0x20b3) !=
+                        STATUS_OK,
+                    "command of a newer feature set");
+}
+
+TEST (SGP_Emulator_Tests, follows_signal_models) {
+    const sgp_emulator_signal tvoc = {100, 50, 1000, 0};
+    const sgp_emulator_signal noisy = {13000, 0, 0, 10};
+    uint16_t tvoc_ppb;
+    uint16_t co2_eq_ppm;
+    uint16_t ethanol;
+    uint16_t h2;
+    uint64_t start_us;
+
+    CHECK_ZERO(sgp_emulator_set_signal(sgp30_id, SGP_EMULATOR_SIGNAL_TVOC,
+                                       &tvoc));
+    CHECK_ZERO(sgp_emulator_set_signal(sgp30_id, SGP_EMULATOR_SIGNAL_H2,
+                                       &noisy));
+    CHECK_ZERO(sgp30_dev_iaq_init(&sgp30));
+    sensirion_sleep_usec(SGP30_IAQ_INIT_TIME_USEC);
+
+    /* the measurement starts at the beginning of the period */
+    start_us = sgp_emulator_get_time_us();
+    sensirion_sleep_usec((uint32_t)(1000000 - start_us % 1000000));
+    CHECK_ZERO(sgp30_dev_measure_iaq_blocking_read(&sgp30, &tvoc_ppb,
+                                                   &co2_eq_ppm));
+    CHECK_EQUAL(50, tvoc_ppb);
+    CHECK_EQUAL(450, co2_eq_ppm);
+
+    sensirion_sleep_usec(500000 - SGP30_CMD_IAQ_MEASURE_DURATION_US);
+    CHECK_ZERO(sgp30_dev_measure_iaq_blocking_read(&sgp30, &tvoc_ppb,
+                                                   &co2_eq_ppm));
+    CHECK_EQUAL_TEXT(150, tvoc_ppb, "peak at half the period");
+
+    for (int i = 0; i < 20; ++i) {
+        CHECK_ZERO(sgp30_dev_measure_raw_blocking_read(&sgp30, &ethanol, &h2));
+        CHECK_EQUAL(17500, ethanol);
+        CHECK_TRUE(h2 >= 12990 && h2 <= 13010);
+    }
+}
+
+TEST (SGP_Emulator_Tests, converts_temperature_and_humidity) {
+    const sgp_emulator_signal temperature = {-10000, 0, 0, 0};
+    const sgp_emulator_signal humidity = {75000, 0, 0, 0};
+    uint16_t ticks[2];
+    uint16_t id;
+
+    CHECK_ZERO(sgp_emulator_add_device(0, SGP_EMULATOR_SHTC1, SHTC1_ADDRESS,
+                                       &id));
+    CHECK_ZERO(sgp_emulator_set_signal(id, SGP_EMULATOR_SIGNAL_TEMPERATURE,
+                                       &temperature));
+    CHECK_ZERO(sgp_emulator_set_signal(id, SGP_EMULATOR_SIGNAL_HUMIDITY,
+                                       &humidity));
+
+    CHECK_ZERO(sensirion_i2c_delayed_read_cmd(SHTC1_ADDRESS, SHTC1_CMD_MEASURE,
+                                              SHTC1_MEASUREMENT_DURATION_USEC,
+                                              ticks, 2));
+    CHECK_EQUAL_TEXT(13107, ticks[0], "(T + 45) * 2^16 / 175");
+    CHECK_EQUAL_TEXT(49152, ticks[1], "RH * 2^16 / 100");
+
+    CHECK_ZERO(sensirion_i2c_write_cmd(SHTC1_ADDRESS, SHTC1_CMD_SLEEP));
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SHTC1_ADDRESS, SHTC1_CMD_MEASURE) !=
+                        STATUS_OK,
+                    "no measurement while sleeping");
+    CHECK_ZERO(sensirion_i2c_write_cmd(SHTC1_ADDRESS, SHTC1_CMD_WAKE_UP));
+}
+
+TEST (SGP_Emulator_Tests, routes_through_multiplexer_channels) {
+    sgp_i2c_bus mux_bus = {1, NULL, NULL, NULL};
+    sgp_i2c_mux mux;
+    sgp_i2c_bus channels[2];
+    sgp30_device devices[2];
+    const uint8_t both_channels = 0x03;
+    uint16_t mux_id;
+    uint16_t id;
+    uint64_t serial_id;
+
+    CHECK_ZERO(sgp_emulator_add_device(1, SGP_EMULATOR_TCA9548A, MUX_ADDRESS,
+                                       &mux_id));
+    sgp_i2c_mux_init(&mux, &mux_bus, MUX_ADDRESS);
+    for (uint8_t ch = 0; ch < 2; ++ch) {
+        CHECK_ZERO(sgp_emulator_add_device_on_mux(
+            mux_id, ch, SGP_EMULATOR_SGP30, SGP30_I2C_ADDRESS, &id));
+        CHECK_ZERO(sgp_emulator_set_serial_id(id, 0x100 + ch));
+        sgp_i2c_mux_init_bus(&mux, &channels[ch], ch);
+        sgp30_dev_init(&devices[ch], &channels[ch], SGP30_I2C_ADDRESS);
+    }
+    CHECK_TRUE_TEXT(sgp_emulator_add_device_on_mux(id, 0, SGP_EMULATOR_SGP30,
+                                                   SGP30_I2C_ADDRESS,
+                                                   &id) != STATUS_OK,
+                    "not a multiplexer");
+
+    CHECK_ZERO(sensirion_i2c_select_bus(1));
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, 0x3682) !=
+                        STATUS_OK,
+                    "no channel selected");
+
+    for (uint8_t ch = 0; ch < 2; ++ch) {
+        CHECK_ZERO(sgp30_dev_get_serial_id(&devices[ch], &serial_id));
+        CHECK_EQUAL(0x100u + ch, serial_id);
+    }
+
+    /* both sensors answer with both channels enabled */
+    CHECK_ZERO(sensirion_i2c_write(MUX_ADDRESS, &both_channels, 1));
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SGP30_I2C_ADDRESS, 0x3682) !=
+                        STATUS_OK,
+                    "address conflict");
+
+    CHECK_ZERO(sgp30_dev_get_serial_id(&sgp30, &serial_id));
+}
+
+TEST (SGP_Emulator_Tests, general_call_resets_sensors) {
+    uint32_t baseline;
+
+    CHECK_ZERO(sgp30_dev_iaq_init(&sgp30));
+    CHECK_ZERO(sgp30_dev_set_iaq_baseline(&sgp30, 0x80018002));
+    CHECK_ZERO(sgp30_dev_get_iaq_baseline(&sgp30, &baseline));
+    CHECK_EQUAL(0x80018002, baseline);
+
+    CHECK_ZERO(sensirion_i2c_general_call_reset());
+    CHECK_TRUE_TEXT(sgp30_dev_get_iaq_baseline(&sgp30, &baseline) != STATUS_OK,
+                    "no baseline after the reset");
+
+    CHECK_ZERO(sensirion_i2c_select_bus(1));
+    CHECK_TRUE_TEXT(sensirion_i2c_general_call_reset() != STATUS_OK,
+                    "no device on the bus");
+    CHECK_ZERO(sensirion_i2c_select_bus(0));
+}
+
+TEST (SGP_Emulator_Tests, adds_default_devices) {
+    sgp40_device sgp40;
+    uint8_t serial_id[SGP40_SERIAL_ID_NUM_BYTES];
+    uint16_t id;
+
+    sgp_emulator_reset();
+    sensirion_i2c_init();
+    CHECK_ZERO(sgp30_dev_probe(&sgp30));
+    sgp40_dev_init(&sgp40, &bus, SGP40_I2C_ADDRESS);
+    CHECK_ZERO(sgp40_dev_probe(&sgp40));
+    CHECK_ZERO(sgp40_dev_get_serial_id(&sgp40, serial_id));
+
+    CHECK_ZERO(sgp_emulator_add_device(0, SGP_EMULATOR_SHTC1, SHTC1_ADDRESS,
+                                       &id));
+    CHECK_TRUE_TEXT(sensirion_i2c_write_cmd(SHTC1_ADDRESS, SHTC1_CMD_MEASURE) !=
+                        STATUS_OK,
+                    "address conflict with the default SHTC1");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,257 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp40_voc_index.h"
+#include "sgp_emulator.h"
+#include "sgp_i2c_bus.h"
+#include "sgp_i2c_mux.h"
+#include "shtc1.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Emulated bus 0 shared by four threads through a TCA9548A at MUX_ADDRESS: an
+ * SGP30 on each of its first two channels, and an SGP40 and SHTC1 pair
+ * measured through a VOC index context on each of the next two channels. The
+ * I2C transfers take their time in real time at BUS_CLOCK_HZ, so the threads
+ * are switched while they hold the bus.
+ */
+#define NUM_ROUNDS 50
+#define NUM_SGP30 2
+#define NUM_VOC 2
+#define MUX_ADDRESS 0x71
+#define BUS_CLOCK_HZ 400000
+
+static void wait_usec(uint32_t useconds) {
+    struct timespec duration = {0, (long)useconds * 1000};
+
+    nanosleep(&duration, NULL);
+}
+
+static void yield(void) {
+    sched_yield();
+}
+
+static uint64_t monotonic_now_us(sgp_clock* clock) {
+    struct timespec now;
+
+    (void)clock;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+/* only read by the lock, which does not sleep */
+static sgp_clock monotonic_clock = {monotonic_now_us, NULL, NULL};
+
+struct voc_thread {
+    sgp_i2c_bus channel;
+    sensirion_voc_index_ctx ctx;
+    int32_t voc_index;
+    uint32_t errors;
+};
+
+struct sgp30_thread {
+    sgp_i2c_bus channel;
+    sgp30_device sgp30;
+    uint16_t ethanol_signal;
+    uint16_t h2_signal;
+    uint32_t errors;
+};
+
+/* tasks of an RTOS which does not switch the thread-local storage */
+static uint8_t tasks[2];
+static const uint8_t* current_task;
+
+static const void* current_task_self(void) {
+    return current_task;
+}
+
+static void* release_lock(void* arg) {
+    static int16_t ret;
+
+    ret = sgp_i2c_bus_lock_release((sgp_i2c_bus_lock*)arg);
+    return &ret;
+}
+
+static void* run_voc(void* arg) {
+    voc_thread* t = (voc_thread*)arg;
+    int32_t humidity;
+    int32_t temperature;
+
+    if (sensirion_init_sensors_bus_ctx(&t->ctx, &t->channel) != STATUS_OK)
+        ++t->errors;
+    for (uint32_t round = 0; round < NUM_ROUNDS; ++round) {
+        if (sensirion_measure_voc_index_with_rh_t_ctx(
+                &t->ctx, &t->voc_index, &humidity, &temperature) != STATUS_OK)
+            ++t->errors;
+    }
+    return NULL;
+}
+
+static void* run_sgp30(void* arg) {
+    sgp30_thread* t = (sgp30_thread*)arg;
+
+    for (uint32_t round = 0; round < NUM_ROUNDS; ++round) {
+        if (sgp30_dev_measure_raw_blocking_read(&t->sgp30, &t->ethanol_signal,
+                                                &t->h2_signal) != STATUS_OK)
+            ++t->errors;
+    }
+    return NULL;
+}
+
+TEST_GROUP (SGP_I2C_Bus_Lock_Tests) {
+    sgp_i2c_bus_lock lock;
+    sgp_i2c_bus_lock_stats stats;
+
+    void setup() {
+        sgp_i2c_bus_lock_init(&lock, yield, NULL);
+    }
+};
+
+TEST (SGP_I2C_Bus_Lock_Tests, nested_acquisitions_count_once) {
+    sgp_i2c_bus bus = {0, NULL, NULL, &lock};
+
+    CHECK_ZERO(sgp_i2c_bus_acquire(&bus));
+    /* e.g. a driver called by the thread holding the bus */
+    CHECK_ZERO(sgp_i2c_bus_acquire(&bus));
+    CHECK_EQUAL(2, lock.depth);
+    sgp_i2c_bus_release(&bus);
+    CHECK_TRUE(lock.owner != NULL);
+    sgp_i2c_bus_lock_get_stats(&lock, &stats, false);
+    CHECK_EQUAL(1, stats.acquisitions);
+    CHECK_ZERO(sgp_i2c_bus_release(&bus));
+    CHECK_TRUE(lock.owner == NULL);
+
+    sgp_i2c_bus_lock_get_stats(&lock, &stats, true);
+    CHECK_EQUAL(1, stats.acquisitions);
+    CHECK_EQUAL(0, stats.contentions);
+    CHECK_EQUAL_TEXT(0, stats.hold_us, "no clock to measure the times");
+    sgp_i2c_bus_lock_get_stats(&lock, &stats, false);
+    CHECK_EQUAL(0, stats.acquisitions);
+    CHECK_EQUAL_TEXT(lock.next_ticket, lock.now_serving, "lock is free");
+}
+
+TEST (SGP_I2C_Bus_Lock_Tests, release_without_holding_the_lock_fails) {
+    sgp_i2c_bus bus = {0, NULL, NULL, &lock};
+    pthread_t thread;
+    void* ret;
+
+    CHECK_TRUE_TEXT(sgp_i2c_bus_release(&bus) != STATUS_OK, "lock is free");
+    CHECK_ZERO(sgp_i2c_bus_acquire(&bus));
+    CHECK_ZERO(pthread_create(&thread, NULL, release_lock, &lock));
+    pthread_join(thread, &ret);
+    CHECK_TRUE_TEXT(*(int16_t*)ret != STATUS_OK, "held by another thread");
+    CHECK_EQUAL(1, lock.depth);
+    CHECK_ZERO(sgp_i2c_bus_release(&bus));
+    CHECK_TRUE_TEXT(sgp_i2c_bus_release(&bus) != STATUS_OK, "released twice");
+    CHECK_EQUAL(0, lock.depth);
+    CHECK_EQUAL_TEXT(lock.next_ticket, lock.now_serving, "lock is free");
+}
+
+TEST (SGP_I2C_Bus_Lock_Tests, self_identifies_the_owner) {
+    sgp_i2c_bus bus = {0, NULL, NULL, &lock};
+
+    sgp_i2c_bus_lock_init(&lock, yield, current_task_self);
+    current_task = &tasks[0];
+    CHECK_ZERO(sgp_i2c_bus_acquire(&bus));
+    CHECK_TRUE(lock.owner == &tasks[0]);
+
+    /* same thread-local storage, but not the owner */
+    current_task = &tasks[1];
+    CHECK_TRUE_TEXT(sgp_i2c_bus_release(&bus) != STATUS_OK,
+                    "held by another task");
+    CHECK_EQUAL(1, lock.depth);
+
+    current_task = &tasks[0];
+    CHECK_ZERO(sgp_i2c_bus_release(&bus));
+    CHECK_EQUAL_TEXT(lock.next_ticket, lock.now_serving, "lock is free");
+}
+
+TEST (SGP_I2C_Bus_Lock_Tests, multiplexer_channels_share_the_lock) {
+    sgp_i2c_bus parent = {0, NULL, NULL, &lock};
+    sgp_i2c_mux mux;
+    sgp_i2c_bus channel;
+
+    sgp_i2c_mux_init(&mux, &parent, MUX_ADDRESS);
+    sgp_i2c_mux_init_bus(&mux, &channel, 1);
+    CHECK_TRUE(channel.lock == &lock);
+
+    sgp_i2c_mux_init(&mux, NULL, MUX_ADDRESS);
+    sgp_i2c_mux_init_bus(&mux, &channel, 1);
+    CHECK_TRUE(channel.lock == NULL);
+}
+
+TEST (SGP_I2C_Bus_Lock_Tests, threads_share_one_bus_without_interleaving) {
+    sgp_i2c_bus bus = {0, NULL, NULL, &lock};
+    sgp_emulator_stats emulator_stats;
+    sgp_i2c_mux mux;
+    voc_thread vocs[NUM_VOC];
+    sgp30_thread sgp30s[NUM_SGP30];
+    pthread_t threads[NUM_SGP30 + NUM_VOC];
+    uint16_t mux_id;
+    uint16_t id;
+
+    sgp_i2c_bus_lock_set_clock(&lock, &monotonic_clock);
+    sgp_emulator_reset();
+    sgp_emulator_set_transfer_time(BUS_CLOCK_HZ, wait_usec);
+    sgp_emulator_add_device(0, SGP_EMULATOR_TCA9548A, MUX_ADDRESS, &mux_id);
+    sgp_i2c_mux_init(&mux, &bus, MUX_ADDRESS);
+    for (uint8_t ch = 0; ch < NUM_SGP30; ++ch) {
+        sgp30_thread* t = &sgp30s[ch];
+
+        memset(t, 0, sizeof(*t));
+        sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SGP30,
+                                       SGP30_I2C_ADDRESS, &id);
+        sgp_i2c_mux_init_bus(&mux, &t->channel, ch);
+        sgp30_dev_init(&t->sgp30, &t->channel, SGP30_I2C_ADDRESS);
+    }
+    for (uint8_t i = 0; i < NUM_VOC; ++i) {
+        uint8_t ch = NUM_SGP30 + i;
+
+        memset(&vocs[i], 0, sizeof(vocs[i]));
+        /* the pairs have the same I2C addresses, on different channels */
+        sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SGP40, 0x59,
+                                       &id);
+        sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SHTC1, 0x70,
+                                       &id);
+        sgp_i2c_mux_init_bus(&mux, &vocs[i].channel, ch);
+    }
+    sensirion_i2c_init();
+
+    for (uint8_t ch = 0; ch < NUM_SGP30; ++ch)
+        CHECK_ZERO(
+            pthread_create(&threads[ch], NULL, run_sgp30, &sgp30s[ch]));
+    for (uint8_t i = 0; i < NUM_VOC; ++i)
+        CHECK_ZERO(pthread_create(&threads[NUM_SGP30 + i], NULL, run_voc,
+                                  &vocs[i]));
+    for (uint8_t i = 0; i < NUM_SGP30 + NUM_VOC; ++i)
+        pthread_join(threads[i], NULL);
+    sensirion_i2c_release();
+
+    CHECK_ZERO(sgp_emulator_get_bus_stats(0, &emulator_stats, false));
+    CHECK_EQUAL_TEXT(0, emulator_stats.nacks, "no transfer to another channel");
+    for (uint8_t i = 0; i < NUM_VOC; ++i)
+        CHECK_EQUAL(0, vocs[i].errors);
+    for (uint8_t ch = 0; ch < NUM_SGP30; ++ch) {
+        CHECK_EQUAL(0, sgp30s[ch].errors);
+        CHECK_TRUE(sgp30s[ch].ethanol_signal != 0);
+    }
+
+    sgp_i2c_bus_lock_get_stats(&lock, &stats, false);
+    /* probe, then SHTC1 command, SHTC1 read with SGP40 command, SGP40 read */
+    CHECK_EQUAL(NUM_VOC * (1 + 3 * NUM_ROUNDS) + NUM_SGP30 * 2 * NUM_ROUNDS,
+                stats.acquisitions);
+    CHECK_TRUE_TEXT(stats.contentions > 0, "threads switched on the bus");
+    CHECK_TRUE_TEXT(stats.max_hold_us < SHTC1_MEASUREMENT_DURATION_USEC,
+                    "measurement waits do not hold the bus");
+    CHECK_TRUE(stats.hold_us > 0);
+    CHECK_EQUAL_TEXT(lock.next_ticket, lock.now_serving, "lock is free");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
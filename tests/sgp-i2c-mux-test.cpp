@@ -0,0 +1,238 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp_i2c_mux.h"
+#include <string.h>
+
+/*
+ * Simulated TCA9548A at MUX_ADDRESS with an SGP30 on each of the channels
+ * 0 to NUM_SENSORS - 1, which answers the get serial id command.
+ */
+#define MUX_ADDRESS 0x70
+#define NUM_SENSORS 4
+#define SERIAL_ID(channel) (0x0000100020003000ull + (channel))
+
+static struct {
+    uint8_t control;
+    uint32_t control_writes;
+    uint32_t conflicts;
+    bool fail_next_control_write;
+    uint16_t pending_command[SGP_I2C_MUX_NUM_CHANNELS];
+} sim;
+
+static int8_t sim_sensor_channel(uint8_t address) {
+    int8_t channel = -1;
+
+    if (address != SGP30_I2C_ADDRESS)
+        return -1;
+    for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch) {
+        if (!(sim.control & (1 << ch)))
+            continue;
+        if (channel >= 0) {
+            /* several sensors respond at the same address */
+            ++sim.conflicts;
+            return -1;
+        }
+        channel = (int8_t)ch;
+    }
+    return channel;
+}
+
+extern "C" {
+
+int16_t sensirion_i2c_select_bus(uint8_t bus_idx) {
+    return bus_idx == 0 ? STATUS_OK : STATUS_FAIL;
+}
+
+void sensirion_i2c_init(void) {
+}
+
+void sensirion_i2c_release(void) {
+}
+
+int8_t sensirion_i2c_read(uint8_t address, uint8_t* data, uint16_t count) {
+    int8_t channel;
+    uint64_t serial_id;
+
+    if (address == MUX_ADDRESS && count == 1) {
+        data[0] = sim.control;
+        return STATUS_OK;
+    }
+    channel = sim_sensor_channel(address);
+    if (channel < 0 || sim.pending_command[channel] != 0x3682 || count != 9)
+        return STATUS_FAIL;
+
+    serial_id = SERIAL_ID(channel);
+    for (uint8_t i = 0; i < 3; ++i) {
+        data[3 * i] = (uint8_t)(serial_id >> (40 - 16 * i));
+        data[3 * i + 1] = (uint8_t)(serial_id >> (32 - 16 * i));
+        data[3 * i + 2] = sensirion_common_generate_crc(&data[3 * i], 2);
+    }
+    sim.pending_command[channel] = 0;
+    return STATUS_OK;
+}
+
+int8_t sensirion_i2c_write(uint8_t address, const uint8_t* data,
+                           uint16_t count) {
+    int8_t channel;
+
+    if (address == MUX_ADDRESS && count == 1) {
+        ++sim.control_writes;
+        if (sim.fail_next_control_write) {
+            sim.fail_next_control_write = false;
+            return STATUS_FAIL;
+        }
+        sim.control = data[0];
+        return STATUS_OK;
+    }
+    channel = sim_sensor_channel(address);
+    if (channel < 0 || count < 2)
+        return STATUS_FAIL;
+    sim.pending_command[channel] = (uint16_t)((data[0] << 8) | data[1]);
+    return STATUS_OK;
+}
+
+void sensirion_sleep_usec(uint32_t useconds) {
+    (void)useconds;
+}
+
+}  // extern "C"
+
+TEST_GROUP (SGP_I2C_Mux_Tests) {
+    sgp_i2c_mux mux;
+    sgp_i2c_bus buses[NUM_SENSORS];
+    sgp30_device devices[NUM_SENSORS];
+
+    void setup() {
+        memset(&sim, 0, sizeof(sim));
+        sgp_i2c_mux_init(&mux, NULL, MUX_ADDRESS);
+        for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch) {
+            sgp_i2c_mux_init_bus(&mux, &buses[ch], ch);
+            sgp30_dev_init(&devices[ch], &buses[ch], SGP30_I2C_ADDRESS);
+        }
+    }
+
+    void teardown() {
+        CHECK_EQUAL_TEXT(0, sim.conflicts, "address conflict on the mux");
+    }
+
+    void read_serial_id(uint8_t ch) {
+        uint64_t serial_id;
+
+        CHECK_ZERO(sgp30_dev_get_serial_id_start(&devices[ch]));
+        CHECK_ZERO(sgp30_dev_get_serial_id_read(&devices[ch], &serial_id));
+        CHECK_EQUAL(SERIAL_ID(ch), serial_id);
+    }
+};
+
+TEST (SGP_I2C_Mux_Tests, selects_channel_only_when_it_changes) {
+    for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch) {
+        read_serial_id(ch);
+        CHECK_EQUAL(1u << ch, sim.control);
+    }
+    CHECK_EQUAL_TEXT(NUM_SENSORS, sim.control_writes,
+                     "one channel switch per sensor");
+    CHECK_EQUAL(NUM_SENSORS, mux.channel_switches);
+
+    read_serial_id(NUM_SENSORS - 1);
+    read_serial_id(NUM_SENSORS - 1);
+    CHECK_EQUAL_TEXT(NUM_SENSORS, sim.control_writes,
+                     "no channel switch for the same channel");
+
+    read_serial_id(0);
+    CHECK_EQUAL(NUM_SENSORS + 1, sim.control_writes);
+}
+
+TEST (SGP_I2C_Mux_Tests, reselects_channel_after_error_and_invalidate) {
+    read_serial_id(1);
+    CHECK_EQUAL(1, sim.control_writes);
+
+    sim.fail_next_control_write = true;
+    CHECK_TRUE(sgp30_dev_get_serial_id_start(&devices[2]) != STATUS_OK);
+    CHECK_EQUAL(SGP_I2C_MUX_NO_CHANNEL, mux.active_channel);
+
+    /* the channel is unknown after the error and selected again */
+    read_serial_id(1);
+    CHECK_EQUAL(3, sim.control_writes);
+
+    sgp_i2c_mux_invalidate(&mux);
+    read_serial_id(1);
+    CHECK_EQUAL(4, sim.control_writes);
+
+    CHECK_ZERO(sgp_i2c_mux_disable(&mux));
+    CHECK_EQUAL(0, sim.control);
+    read_serial_id(1);
+    CHECK_EQUAL(6, sim.control_writes);
+}
+
+TEST (SGP_I2C_Mux_Tests, rejects_channel_out_of_range) {
+    sgp_i2c_bus bus = {0, NULL, NULL, NULL};
+    sgp30_device device;
+
+    CHECK_ZERO(sgp_i2c_mux_init_bus(&mux, &bus, SGP_I2C_MUX_NUM_CHANNELS - 1));
+    CHECK_TRUE(sgp_i2c_mux_init_bus(&mux, &bus, SGP_I2C_MUX_NUM_CHANNELS) !=
+               STATUS_OK);
+
+    /* a bus with an invalid channel set up by hand is not selected */
+    bus.bus_idx = SGP_I2C_MUX_NUM_CHANNELS;
+    sgp30_dev_init(&device, &bus, SGP30_I2C_ADDRESS);
+    CHECK_TRUE(sgp30_dev_get_serial_id_start(&device) != STATUS_OK);
+    CHECK_EQUAL(0, sim.control_writes);
+}
+
+TEST (SGP_I2C_Mux_Tests, schedule_minimizes_channel_switches) {
+    sgp_i2c_bus direct_bus = {0, NULL, NULL, NULL};
+    sgp_i2c_bus* round[] = {&buses[3], &buses[0], &buses[2], &direct_bus,
+                            &buses[3], &buses[0], &buses[1]};
+    const uint16_t expected_order[] = {3, 2, 0, 4, 1, 5, 6};
+    const uint16_t num = sizeof(round) / sizeof(round[0]);
+    uint32_t keys[sizeof(round) / sizeof(round[0])];
+    uint16_t order[sizeof(round) / sizeof(round[0])];
+    uint16_t switches;
+    uint32_t writes;
+
+    read_serial_id(2);
+    writes = sim.control_writes;
+
+    switches = sgp_i2c_mux_schedule(round, num, keys, order);
+    for (uint16_t i = 0; i < num; ++i) {
+        CHECK_EQUAL(expected_order[i], order[i]);
+    }
+    CHECK_EQUAL_TEXT(3, switches, "channels 3, 0 and 1 after channel 2");
+
+    for (uint16_t i = 0; i < num; ++i) {
+        if (round[order[i]] != &direct_bus) {
+            read_serial_id(round[order[i]]->bus_idx);
+        }
+    }
+    CHECK_EQUAL(writes + switches, sim.control_writes);
+
+    /* the next round starts on the channel the last one ended with */
+    switches = sgp_i2c_mux_schedule(round, num, keys, order);
+    CHECK_EQUAL(3, switches);
+    CHECK_EQUAL(6, order[1]);
+}
+
+TEST (SGP_I2C_Mux_Tests, schedule_groups_multiplexers) {
+    sgp_i2c_mux mux2;
+    sgp_i2c_bus buses2[2];
+    sgp_i2c_bus* round[] = {&buses[0], &buses2[1], &buses[1], &buses2[0]};
+    const uint16_t expected_order[] = {0, 2, 3, 1};
+    uint32_t keys[4];
+    uint16_t order[4];
+
+    sgp_i2c_mux_init(&mux2, NULL, MUX_ADDRESS + 1);
+    sgp_i2c_mux_init_bus(&mux2, &buses2[0], 0);
+    sgp_i2c_mux_init_bus(&mux2, &buses2[1], 1);
+
+    CHECK_EQUAL(4, sgp_i2c_mux_schedule(round, 4, keys, order));
+    for (uint16_t i = 0; i < 4; ++i) {
+        CHECK_EQUAL(expected_order[i], order[i]);
+    }
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
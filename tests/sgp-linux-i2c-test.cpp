@@ -0,0 +1,343 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp_clock.h"
+#include "sgp_i2c_mux.h"
+#include "sgp_linux_i2c.h"
+#include "sgp_periodic.h"
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <linux/i2c.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Emulated i2c-dev device with a TCA9548A at MUX_ADDRESS and an SGP30 on each
+ * of the channels 0 to NUM_SENSORS - 1, which answers the get serial id
+ * command. Like the real multiplexer, the emulated one only switches the
+ * channel with the STOP condition after the write to its control register.
+ */
+#define DEVICE_PATH "/dev/i2c-0"
+#define DEVICE_FD 7
+#define MUX_ADDRESS 0x70
+#define NUM_SENSORS 2
+#define SERIAL_ID(channel) (0x0000100020003000ull + (channel))
+
+static struct {
+    unsigned long funcs;
+    bool fd_open;
+    uint32_t opens;
+    uint32_t fail_ioctls;
+    uint64_t time_us;
+    uint8_t control;
+    uint16_t pending_command[NUM_SENSORS];
+} emu;
+
+static int8_t emu_sensor_channel(uint16_t address) {
+    if (address != SGP30_I2C_ADDRESS)
+        return -1;
+    for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch) {
+        if (emu.control == (1 << ch))
+            return (int8_t)ch;
+    }
+    return -1;
+}
+
+static bool emu_message(const struct i2c_msg* msg, bool stop) {
+    int8_t channel;
+    uint64_t serial_id;
+
+    if (msg->addr == MUX_ADDRESS) {
+        if (msg->flags & I2C_M_RD || msg->len != 1)
+            return false;
+        if (stop)
+            emu.control = msg->buf[0];
+        return true;
+    }
+    channel = emu_sensor_channel(msg->addr);
+    if (channel < 0)
+        return false;
+    if (!(msg->flags & I2C_M_RD)) {
+        if (msg->len < 2)
+            return false;
+        emu.pending_command[channel] =
+            (uint16_t)((msg->buf[0] << 8) | msg->buf[1]);
+        return true;
+    }
+    if (emu.pending_command[channel] != 0x3682 || msg->len != 9)
+        return false;
+    serial_id = SERIAL_ID(channel);
+    for (uint8_t i = 0; i < 3; ++i) {
+        msg->buf[3 * i] = (uint8_t)(serial_id >> (40 - 16 * i));
+        msg->buf[3 * i + 1] = (uint8_t)(serial_id >> (32 - 16 * i));
+        msg->buf[3 * i + 2] =
+            sensirion_common_generate_crc(&msg->buf[3 * i], 2);
+    }
+    emu.pending_command[channel] = 0;
+    return true;
+}
+
+static int emu_open(const char* path, int flags) {
+    if (strcmp(path, DEVICE_PATH) != 0 || flags != O_RDWR || emu.fd_open)
+        return -1;
+    emu.fd_open = true;
+    ++emu.opens;
+    return DEVICE_FD;
+}
+
+static int emu_ioctl(int fd, unsigned long request, void* arg) {
+    if (fd != DEVICE_FD || !emu.fd_open)
+        return -1;
+    if (request == I2C_FUNCS) {
+        *(unsigned long*)arg = emu.funcs;
+        return 0;
+    }
+    if (request != I2C_RDWR)
+        return -1;
+    if (emu.fail_ioctls) {
+        --emu.fail_ioctls;
+        return -1;
+    }
+
+    struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*)arg;
+    for (uint32_t i = 0; i < data->nmsgs; ++i) {
+        const struct i2c_msg* msg = &data->msgs[i];
+        bool last = i + 1 == data->nmsgs;
+        if (!last && !(emu.funcs & I2C_FUNC_PROTOCOL_MANGLING))
+            return -1;
+        if (!emu_message(msg, last || (msg->flags & I2C_M_STOP)))
+            return -1;
+    }
+    return (int)data->nmsgs;
+}
+
+static int emu_close(int fd) {
+    if (fd != DEVICE_FD || !emu.fd_open)
+        return -1;
+    emu.fd_open = false;
+    return 0;
+}
+
+static void emu_sleep_usec(uint32_t useconds) {
+    __atomic_add_fetch(&emu.time_us, useconds, __ATOMIC_RELAXED);
+}
+
+static uint64_t emu_now_us(void) {
+    return __atomic_load_n(&emu.time_us, __ATOMIC_RELAXED);
+}
+
+static const sgp_linux_i2c_ops emu_ops = {emu_open, emu_ioctl, emu_close,
+                                          emu_sleep_usec, emu_now_us};
+
+TEST_GROUP (SGP_Linux_I2C_Tests) {
+    sgp_i2c_mux mux;
+    sgp_i2c_bus buses[NUM_SENSORS];
+    sgp30_device devices[NUM_SENSORS];
+    sgp_linux_i2c_stats stats;
+
+    void setup() {
+        memset(&emu, 0, sizeof(emu));
+        emu.funcs = I2C_FUNC_I2C | I2C_FUNC_PROTOCOL_MANGLING;
+        sgp_linux_i2c_set_ops(&emu_ops);
+        sgp_linux_i2c_set_batching(false);
+        sensirion_i2c_init();
+        sgp_i2c_mux_init(&mux, NULL, MUX_ADDRESS);
+        for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch) {
+            sgp_i2c_mux_init_bus(&mux, &buses[ch], ch);
+            sgp30_dev_init(&devices[ch], &buses[ch], SGP30_I2C_ADDRESS);
+        }
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        CHECK_FALSE_TEXT(emu.fd_open, "device closed on release");
+        sgp_linux_i2c_get_stats(&stats, true);
+        sgp_linux_i2c_set_ops(NULL);
+    }
+
+    int16_t read_serial_id(uint8_t ch, uint64_t * serial_id) {
+        int16_t ret = sgp30_dev_get_serial_id_start(&devices[ch]);
+        if (ret != STATUS_OK)
+            return ret;
+        sensirion_sleep_usec(devices[ch].command_duration_us);
+        return sgp30_dev_get_serial_id_read(&devices[ch], serial_id);
+    }
+
+    void check_serial_id(uint8_t ch) {
+        uint64_t serial_id;
+
+        CHECK_ZERO(read_serial_id(ch, &serial_id));
+        CHECK_EQUAL(SERIAL_ID(ch), serial_id);
+    }
+};
+
+TEST (SGP_Linux_I2C_Tests, keeps_device_open_with_one_ioctl_per_transfer) {
+    check_serial_id(0);
+    sgp_linux_i2c_get_stats(&stats, true);
+    CHECK_EQUAL_TEXT(3, stats.transfers, "channel switch, command and read");
+    CHECK_EQUAL(3, stats.messages);
+    CHECK_EQUAL_TEXT(6, stats.syscalls, "open, I2C_FUNCS, 3 I2C_RDWR, sleep");
+
+    check_serial_id(0);
+    check_serial_id(0);
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL_TEXT(4, stats.transfers, "command and read");
+    CHECK_EQUAL(6, stats.syscalls);
+    CHECK_EQUAL(0, stats.errors);
+    CHECK_EQUAL_TEXT(1, emu.opens, "device kept open");
+}
+
+TEST (SGP_Linux_I2C_Tests, batching_combines_channel_switch_and_command) {
+    sgp_linux_i2c_set_batching(true);
+    check_serial_id(0);
+    sgp_linux_i2c_get_stats(&stats, true);
+    CHECK_EQUAL_TEXT(2, stats.transfers, "switch and command, then read");
+    CHECK_EQUAL(3, stats.messages);
+
+    check_serial_id(1);
+    check_serial_id(0);
+    check_serial_id(0);
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL(6, stats.transfers);
+    CHECK_EQUAL(8, stats.messages);
+    CHECK_EQUAL_TEXT(9, stats.syscalls, "6 I2C_RDWR and 3 sleeps");
+    CHECK_EQUAL(0, stats.errors);
+}
+
+TEST (SGP_Linux_I2C_Tests, releasing_bus_lock_sends_queued_writes) {
+    sgp_i2c_bus_lock lock;
+    sgp_i2c_bus parent = {0, NULL, NULL, &lock};
+    uint64_t serial_id;
+
+    sgp_i2c_bus_lock_init(&lock, NULL, NULL);
+    sgp_i2c_mux_init(&mux, &parent, MUX_ADDRESS);
+    for (uint8_t ch = 0; ch < NUM_SENSORS; ++ch)
+        sgp_i2c_mux_init_bus(&mux, &buses[ch], ch);
+    sgp_linux_i2c_set_batching(true);
+
+    /* before another thread can take the bus and its cached channel */
+    CHECK_ZERO(sgp30_dev_get_serial_id_start(&devices[1]));
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL_TEXT(1, stats.transfers, "switch and command, no sleep");
+    CHECK_EQUAL(2, stats.messages);
+    CHECK_EQUAL(1 << 1, emu.control);
+    sensirion_sleep_usec(devices[1].command_duration_us);
+    CHECK_ZERO(sgp30_dev_get_serial_id_read(&devices[1], &serial_id));
+    CHECK_EQUAL(SERIAL_ID(1), serial_id);
+
+    /* the error of a write sent on release is returned by the next read */
+    emu.fail_ioctls = 1;
+    CHECK_ZERO(sgp30_dev_get_serial_id_start(&devices[1]));
+    sensirion_sleep_usec(devices[1].command_duration_us);
+    CHECK_TRUE(sgp30_dev_get_serial_id_read(&devices[1], &serial_id) !=
+               STATUS_OK);
+    check_serial_id(1);
+}
+
+TEST (SGP_Linux_I2C_Tests, no_batching_without_protocol_mangling) {
+    emu.funcs = I2C_FUNC_I2C;
+    sgp_linux_i2c_set_batching(true);
+    check_serial_id(0);
+    check_serial_id(1);
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL(6, stats.transfers);
+    CHECK_EQUAL(6, stats.messages);
+}
+
+TEST (SGP_Linux_I2C_Tests, reports_error_of_queued_write) {
+    uint64_t serial_id;
+
+    sgp_linux_i2c_set_batching(true);
+    check_serial_id(0);
+
+    emu.fail_ioctls = 1;
+    CHECK_ZERO_TEXT(sgp30_dev_get_serial_id_start(&devices[0]),
+                    "write is queued");
+    sensirion_sleep_usec(devices[0].command_duration_us);
+    CHECK_TRUE_TEXT(sgp30_dev_get_serial_id_read(&devices[0], &serial_id) !=
+                        STATUS_OK,
+                    "failed write reported by the next transfer");
+
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL(1, stats.errors);
+    check_serial_id(0);
+}
+
+TEST (SGP_Linux_I2C_Tests, reports_missing_device) {
+    uint64_t serial_id;
+
+    CHECK_ZERO(sgp_linux_i2c_set_device(1, "/dev/i2c-missing"));
+    CHECK_TRUE(sensirion_i2c_select_bus(1) != STATUS_OK);
+    CHECK_TRUE(read_serial_id(0, &serial_id) != STATUS_OK);
+    CHECK_TRUE(sgp_linux_i2c_set_device(SGP_LINUX_I2C_MAX_BUSES, NULL) !=
+               STATUS_OK);
+
+    CHECK_ZERO(sensirion_i2c_select_bus(0));
+    check_serial_id(0);
+    CHECK_ZERO(sgp_linux_i2c_set_device(1, NULL));
+}
+
+TEST (SGP_Linux_I2C_Tests, installs_its_clock_unless_another_is_installed) {
+    sgp_virtual_clock virtual_clock;
+    sgp_periodic periodic;
+    sgp_periodic_stats periodic_stats;
+    uint64_t start_us;
+
+    CHECK_TRUE(sgp_clock_get() == sgp_linux_i2c_get_clock());
+    start_us = sgp_clock_now_us();
+    sgp_clock_sleep_usec(1000);
+    CHECK_EQUAL(start_us + 1000, sgp_clock_now_us());
+    sgp_linux_i2c_get_stats(&stats, false);
+    CHECK_EQUAL_TEXT(1, stats.syscalls, "slept with sensirion_sleep_usec()");
+
+    /* time spent outside of the sleeps is seen by the scheduler */
+    CHECK_ZERO(sgp_periodic_init(&periodic, 1000));
+    emu.time_us += 1500;
+    CHECK_EQUAL(0, sgp_periodic_wait(&periodic));
+    sgp_periodic_get_stats(&periodic, &periodic_stats, false);
+    CHECK_EQUAL(1, periodic_stats.overruns);
+    CHECK_EQUAL(500, periodic_stats.last_jitter_us);
+
+    sensirion_i2c_release();
+    CHECK_FALSE(sgp_clock_is_set());
+
+    sgp_virtual_clock_init(&virtual_clock, 0);
+    sgp_clock_set(&virtual_clock.clock);
+    sensirion_i2c_init();
+    CHECK_TRUE(sgp_clock_get() == &virtual_clock.clock);
+    sensirion_i2c_release();
+    CHECK_TRUE(sgp_clock_get() == &virtual_clock.clock);
+    sgp_clock_set(NULL);
+}
+
+TEST (SGP_Linux_I2C_Tests, counts_sleeps_of_all_threads_while_resetting) {
+    const uint32_t num_threads = 4;
+    const uint32_t num_sleeps = 100000;
+    std::vector<std::thread> threads;
+    uint32_t syscalls = 0;
+
+    sgp_linux_i2c_get_stats(&stats, true);
+    for (uint32_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([num_sleeps] {
+            for (uint32_t i = 0; i < num_sleeps; ++i)
+                sensirion_sleep_usec(0);
+        });
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        sgp_linux_i2c_get_stats(&stats, true);
+        syscalls += stats.syscalls;
+    }
+    for (auto& thread : threads)
+        thread.join();
+    sgp_linux_i2c_get_stats(&stats, true);
+    syscalls += stats.syscalls;
+    CHECK_EQUAL_TEXT(num_threads * num_sleeps, syscalls,
+                     "no sleep lost or counted twice by the resets");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
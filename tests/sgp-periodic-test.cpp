@@ -0,0 +1,112 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp40.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_periodic.h"
+
+#define USEC_PER_SEC 1000000ull
+#define LATE_WAKEUP_US 250
+
+/* clock which wakes up LATE_WAKEUP_US after each sleep */
+static uint64_t late_clock_now_us(sgp_clock* clock) {
+    return *(uint64_t*)clock->user_data;
+}
+
+static void late_clock_sleep_usec(sgp_clock* clock, uint32_t useconds) {
+    *(uint64_t*)clock->user_data += useconds + LATE_WAKEUP_US;
+}
+
+TEST_GROUP (SGP_Periodic_Tests) {
+    sgp_periodic periodic;
+    sgp_periodic_stats stats;
+
+    void setup() {
+        sgp_emulator_reset();
+        sensirion_i2c_init();
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_clock_set(NULL);
+    }
+};
+
+TEST (SGP_Periodic_Tests, starts_measurements_on_absolute_deadlines) {
+    uint64_t start_us = sgp_clock_now_us();
+    uint16_t sraw;
+
+    sgp_periodic_init(&periodic, USEC_PER_SEC);
+    for (uint32_t i = 0; i < 100; ++i) {
+        CHECK_EQUAL_TEXT(start_us + i * USEC_PER_SEC, sgp_clock_now_us(),
+                         "measurement time does not delay the next tick");
+        CHECK_ZERO(sgp40_measure_raw_blocking_read(&sraw));
+        CHECK_ZERO(sgp_periodic_wait(&periodic));
+    }
+
+    sgp_periodic_get_stats(&periodic, &stats, false);
+    CHECK_EQUAL(100, stats.ticks);
+    CHECK_EQUAL(0, stats.overruns);
+    CHECK_EQUAL(0, stats.missed_ticks);
+    CHECK_EQUAL(0, stats.max_jitter_us);
+}
+
+TEST (SGP_Periodic_Tests, late_wakeups_do_not_accumulate) {
+    uint64_t now_us = 0;
+    sgp_clock late_clock = {late_clock_now_us, late_clock_sleep_usec, &now_us};
+
+    sgp_clock_set(&late_clock);
+    sgp_periodic_init(&periodic, USEC_PER_SEC);
+    for (uint32_t i = 0; i < 10; ++i) {
+        sgp_clock_sleep_usec(30000); /* the measurement */
+        CHECK_ZERO(sgp_periodic_wait(&periodic));
+        CHECK_EQUAL((i + 1) * USEC_PER_SEC + LATE_WAKEUP_US, now_us);
+    }
+
+    sgp_periodic_get_stats(&periodic, &stats, true);
+    CHECK_EQUAL(10, stats.ticks);
+    CHECK_EQUAL(LATE_WAKEUP_US, stats.last_jitter_us);
+    CHECK_EQUAL(LATE_WAKEUP_US, stats.max_jitter_us);
+    CHECK_EQUAL(10 * LATE_WAKEUP_US, stats.total_jitter_us);
+
+    sgp_periodic_get_stats(&periodic, &stats, false);
+    CHECK_EQUAL_TEXT(0, stats.ticks, "statistics reset");
+    CHECK_EQUAL(0, stats.max_jitter_us);
+}
+
+TEST (SGP_Periodic_Tests, rejects_zero_period) {
+    CHECK_TRUE(sgp_periodic_init(&periodic, 0) != STATUS_OK);
+    CHECK_ZERO(sgp_periodic_init(&periodic, 1));
+}
+
+TEST (SGP_Periodic_Tests, skips_deadlines_after_overrun) {
+    uint64_t start_us = sgp_clock_now_us();
+
+    sgp_periodic_init(&periodic, USEC_PER_SEC);
+    sgp_clock_sleep_usec(1200000);
+    CHECK_EQUAL_TEXT(0, sgp_periodic_wait(&periodic), "late, but not skipped");
+    CHECK_EQUAL_TEXT(start_us + 1200000, sgp_clock_now_us(), "no sleep");
+
+    CHECK_ZERO(sgp_periodic_wait(&periodic));
+    CHECK_EQUAL_TEXT(start_us + 2 * USEC_PER_SEC, sgp_clock_now_us(),
+                     "back on the original deadlines");
+
+    sgp_clock_sleep_usec(2500000);
+    CHECK_EQUAL_TEXT(1, sgp_periodic_wait(&periodic), "deadline 3s skipped");
+    CHECK_ZERO(sgp_periodic_wait(&periodic));
+    CHECK_EQUAL(start_us + 5 * USEC_PER_SEC, sgp_clock_now_us());
+
+    sgp_periodic_get_stats(&periodic, &stats, false);
+    CHECK_EQUAL(4, stats.ticks);
+    CHECK_EQUAL(2, stats.overruns);
+    CHECK_EQUAL(1, stats.missed_ticks);
+    CHECK_EQUAL(0, stats.last_jitter_us);
+    CHECK_EQUAL(500000, stats.max_jitter_us);
+    CHECK_EQUAL(700000, stats.total_jitter_us);
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,231 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp40.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_record_ring.h"
+#include "sgpc3.h"
+#include "svm30.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stddef.h>
+#include <string.h>
+
+#define CAPACITY 8
+#define NUM_ROUNDS 2000
+#define NUM_DEVICES 4
+#define BATCH_SIZE 5
+
+TEST_GROUP (SGP_Record_Ring_Tests) {
+    sgp_record_ring ring;
+    sgp_record records[CAPACITY];
+    sgp_record_ring_stats stats;
+
+    void setup() {
+        CHECK_ZERO(sgp_record_ring_init(&ring, records, CAPACITY));
+    }
+
+    void push(uint16_t device_id, uint64_t timestamp_us) {
+        sgp_record record;
+
+        sgp_record_init(&record, device_id, timestamp_us);
+        CHECK_TRUE(sgp_record_ring_push(&ring, &record));
+    }
+};
+
+TEST (SGP_Record_Ring_Tests, records_and_indices_are_padded) {
+    CHECK_EQUAL(32, sizeof(sgp_record));
+    CHECK_TRUE(offsetof(sgp_record_ring, head) -
+                   offsetof(sgp_record_ring, mask) >=
+               SGP_RECORD_RING_CACHE_LINE_SIZE);
+    CHECK_TRUE(offsetof(sgp_record_ring, tail) -
+                   offsetof(sgp_record_ring, overflows) >=
+               SGP_RECORD_RING_CACHE_LINE_SIZE);
+}
+
+TEST (SGP_Record_Ring_Tests, rejects_capacity_that_is_no_power_of_two) {
+    CHECK_TRUE(sgp_record_ring_init(&ring, records, 0) != STATUS_OK);
+    CHECK_TRUE(sgp_record_ring_init(&ring, records, 6) != STATUS_OK);
+    CHECK_ZERO(sgp_record_ring_init(&ring, records, 1));
+}
+
+TEST (SGP_Record_Ring_Tests, pops_batches_across_the_wrap_around) {
+    sgp_record out[2 * CAPACITY];
+    sgp_record record;
+
+    for (uint16_t i = 0; i < 5; ++i)
+        push(i, 1000u * i);
+    CHECK_EQUAL(3, sgp_record_ring_pop_batch(&ring, out, 3));
+    for (uint16_t i = 0; i < 3; ++i)
+        CHECK_EQUAL(i, out[i].device_id);
+
+    /* fills the ring, the last records wrap around to the start */
+    for (uint16_t i = 5; i < 11; ++i)
+        push(i, 1000u * i);
+    sgp_record_init(&record, 11, 11000);
+    CHECK_FALSE_TEXT(sgp_record_ring_push(&ring, &record), "ring is full");
+
+    CHECK_EQUAL(CAPACITY, sgp_record_ring_pop_batch(&ring, out, 2 * CAPACITY));
+    for (uint16_t i = 0; i < CAPACITY; ++i) {
+        CHECK_EQUAL(i + 3, out[i].device_id);
+        CHECK_EQUAL(1000u * (i + 3), out[i].timestamp_us);
+        CHECK_EQUAL(STATUS_OK, out[i].error);
+        CHECK_EQUAL(0, out[i].fields);
+    }
+    CHECK_EQUAL(0, sgp_record_ring_pop_batch(&ring, out, 2 * CAPACITY));
+
+    sgp_record_ring_get_stats(&ring, &stats);
+    CHECK_EQUAL(11, stats.pushed);
+    CHECK_EQUAL(11, stats.popped);
+    CHECK_EQUAL(1, stats.overflows);
+}
+
+/*
+ * Acquisition thread measuring an SGP30, an SGPC3, an SGP40 and an SVM30 on
+ * three emulated buses and pushing the results to a small ring, while the
+ * main thread pops them in batches. The emulated time of the acquisition
+ * thread does not advance with the processing, so the ring overflows when the
+ * consumer falls behind.
+ */
+enum { DEV_SGP30, DEV_SGPC3, DEV_SGP40, DEV_SVM30 };
+
+struct acquisition {
+    sgp_record_ring* ring;
+    sgp_i2c_bus buses[3];
+    sgp30_device sgp30;
+    sgpc3_device sgpc3;
+    sgp40_device sgp40;
+    uint32_t attempts;
+    uint32_t errors;
+    bool done;
+};
+
+static void push_record(acquisition* acq, sgp_record* record, int16_t ret) {
+    record->error = ret;
+    ++acq->attempts;
+    sgp_record_ring_push(acq->ring, record);
+}
+
+static void* run_acquisition(void* arg) {
+    acquisition* acq = (acquisition*)arg;
+    sgp_record record;
+    int16_t ret;
+
+    if (sgp30_dev_iaq_init(&acq->sgp30) != STATUS_OK ||
+        sgpc3_dev_tvoc_init_no_preheat(&acq->sgpc3) != STATUS_OK ||
+        sgp_i2c_bus_select(&acq->buses[0]) != STATUS_OK ||
+        svm_probe() != STATUS_OK)
+        ++acq->errors;
+
+    for (uint32_t round = 0; round < NUM_ROUNDS; ++round) {
+        sgp_record_init(&record, DEV_SGP30, sgp_clock_now_us());
+        record.fields = SGP_RECORD_TVOC | SGP_RECORD_CO2_EQ;
+        ret = sgp30_dev_measure_iaq_blocking_read(&acq->sgp30, &record.tvoc_ppb,
+                                                  &record.co2_eq_ppm);
+        push_record(acq, &record, ret);
+
+        sgp_record_init(&record, DEV_SGPC3, sgp_clock_now_us());
+        record.fields = SGP_RECORD_TVOC | SGP_RECORD_ETHANOL;
+        ret = sgpc3_dev_measure_tvoc_and_raw_blocking_read(
+            &acq->sgpc3, &record.tvoc_ppb, &record.ethanol_signal);
+        push_record(acq, &record, ret);
+
+        sgp_record_init(&record, DEV_SGP40, sgp_clock_now_us());
+        record.fields = SGP_RECORD_SRAW;
+        ret = sgp40_dev_measure_raw_blocking_read(&acq->sgp40, &record.sraw);
+        push_record(acq, &record, ret);
+
+        /* the SVM30 driver has no device handle and uses the selected bus */
+        sgp_record_init(&record, DEV_SVM30, sgp_clock_now_us());
+        record.fields = SGP_RECORD_TVOC | SGP_RECORD_CO2_EQ | SGP_RECORD_RHT;
+        ret = sgp_i2c_bus_select(&acq->buses[0]);
+        if (ret == STATUS_OK)
+            ret = svm_measure_iaq_blocking_read(
+                &record.tvoc_ppb, &record.co2_eq_ppm, &record.temperature,
+                &record.humidity);
+        push_record(acq, &record, ret);
+    }
+    __atomic_store_n(&acq->done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+TEST (SGP_Record_Ring_Tests, decouples_acquisition_from_processing) {
+    acquisition acq;
+    pthread_t thread;
+    sgp_record batch[BATCH_SIZE];
+    uint64_t last_us[NUM_DEVICES];
+    uint32_t received[NUM_DEVICES];
+    uint32_t out_of_order = 0;
+    uint32_t bad_records = 0;
+    uint32_t popped = 0;
+    uint16_t id;
+
+    memset(&acq, 0, sizeof(acq));
+    memset(last_us, 0, sizeof(last_us));
+    memset(received, 0, sizeof(received));
+    acq.ring = &ring;
+    sgp_emulator_reset();
+    /* SVM30: SGP30 and SHTC1, the SGP40 is on the same bus */
+    sgp_emulator_add_device(0, SGP_EMULATOR_SGP30, SGP30_I2C_ADDRESS, &id);
+    sgp_emulator_add_device(0, SGP_EMULATOR_SHTC1, 0x70, &id);
+    sgp_emulator_add_device(0, SGP_EMULATOR_SGP40, SGP40_I2C_ADDRESS, &id);
+    sgp_emulator_add_device(1, SGP_EMULATOR_SGPC3, SGPC3_I2C_ADDRESS, &id);
+    sgp_emulator_add_device(2, SGP_EMULATOR_SGP30, SGP30_I2C_ADDRESS, &id);
+    for (uint8_t i = 0; i < 3; ++i) {
+        acq.buses[i].bus_idx = i;
+        acq.buses[i].select = NULL;
+        acq.buses[i].user_data = NULL;
+        acq.buses[i].lock = NULL;
+    }
+    sgp30_dev_init(&acq.sgp30, &acq.buses[2], SGP30_I2C_ADDRESS);
+    sgpc3_dev_init(&acq.sgpc3, &acq.buses[1], SGPC3_I2C_ADDRESS);
+    sgp40_dev_init(&acq.sgp40, &acq.buses[0], SGP40_I2C_ADDRESS);
+    sensirion_i2c_init();
+
+    CHECK_ZERO(pthread_create(&thread, NULL, run_acquisition, &acq));
+    for (;;) {
+        bool done = __atomic_load_n(&acq.done, __ATOMIC_ACQUIRE);
+        uint32_t n = sgp_record_ring_pop_batch(&ring, batch, BATCH_SIZE);
+
+        for (uint32_t i = 0; i < n; ++i) {
+            const sgp_record* r = &batch[i];
+
+            if (r->device_id >= NUM_DEVICES || r->error != STATUS_OK ||
+                r->fields == 0) {
+                ++bad_records;
+                continue;
+            }
+            if (received[r->device_id] &&
+                r->timestamp_us <= last_us[r->device_id])
+                ++out_of_order;
+            last_us[r->device_id] = r->timestamp_us;
+            ++received[r->device_id];
+        }
+        popped += n;
+        if (n == 0 && done)
+            break;
+        if (n == 0)
+            sched_yield();
+    }
+    pthread_join(thread, NULL);
+    sensirion_i2c_release();
+
+    sgp_record_ring_get_stats(&ring, &stats);
+    CHECK_EQUAL(0, acq.errors);
+    CHECK_EQUAL(NUM_ROUNDS * NUM_DEVICES, acq.attempts);
+    CHECK_EQUAL_TEXT(acq.attempts, stats.pushed + stats.overflows,
+                     "each record is either stored or counted as dropped");
+    CHECK_EQUAL(stats.pushed, stats.popped);
+    CHECK_EQUAL(stats.popped, popped);
+    CHECK_EQUAL(0, bad_records);
+    CHECK_EQUAL(0, out_of_order);
+    for (uint16_t i = 0; i < NUM_DEVICES; ++i)
+        CHECK_TRUE(received[i] > 0);
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
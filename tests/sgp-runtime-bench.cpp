@@ -0,0 +1,189 @@
+#include "sensirion_common.h"
+#include "sensirion_humidity_conversion.h"
+#include "sensirion_i2c.h"
+#include "sensirion_voc_algorithm.h"
+#include "sgp40.h"
+#include "sgp_emulator.h"
+#include "sgp_i2c_mux.h"
+#include "sgp_runtime.h"
+#include "shtc1.h"
+#include <chrono>
+#include <sys/prctl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/*
+ * Throughput of the runtime with 1 to 64 emulated buses. Each bus has a
+ * TCA9548A with an SGP40 and an SHTC1 on each channel. The I/O thread of each
+ * bus polls its sensors back-to-back and the work pool calculates the
+ * absolute humidity and the VOC index and encodes each sample as text.
+ *
+ * The transfers take their time on a bus with the given clock in real time,
+ * like with a blocking I2C driver, while the measurement durations of the
+ * sensors are virtual. A single bus is limited by its transfers, so the
+ * throughput grows with the number of buses until the CPUs are saturated
+ * by the processing and the thread switches.
+ *
+ * Usage: sgp-runtime-bench [bus clock in Hz] [rounds]
+ */
+#define DEFAULT_BUS_CLOCK_HZ 100000
+#define DEFAULT_ROUNDS 50
+#define MAX_BUSES 64
+#define SENSORS_PER_BUS SGP_I2C_MUX_NUM_CHANNELS
+/* the SHTC1 on each channel answers at 0x70 */
+#define MUX_ADDRESS 0x71
+#define SHTC1_ADDRESS 0x70
+
+struct sensor {
+    sgp_i2c_bus channel;
+    sgp40_device sgp40;
+    VocAlgorithmParams voc;
+    uint16_t sraw;
+    int32_t temperature;
+    int32_t humidity;
+    char line[64];
+};
+
+struct bus {
+    sgp_i2c_bus i2c_bus;
+    sgp_i2c_mux mux;
+    sensor sensors[SENSORS_PER_BUS];
+};
+
+static void wait_usec(uint32_t useconds) {
+    struct timespec duration = {0, (long)useconds * 1000};
+
+    nanosleep(&duration, NULL);
+}
+
+static void process(void* arg) {
+    sensor* s = (sensor*)arg;
+    uint32_t absolute_humidity;
+    int32_t voc_index;
+
+    absolute_humidity =
+        sensirion_calc_absolute_humidity(s->temperature, s->humidity);
+    VocAlgorithm_process(&s->voc, s->sraw, &voc_index);
+    snprintf(s->line, sizeof(s->line), "%u,%d,%d,%u", (unsigned)s->sraw,
+             (int)voc_index, (int)s->temperature, (unsigned)absolute_humidity);
+}
+
+static int16_t poll(sgp_runtime_bus* rt_bus) {
+    bus* b = (bus*)rt_bus->user_data;
+    int16_t ret;
+
+    for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch) {
+        sensor* s = &b->sensors[ch];
+
+        ret = sgp_i2c_bus_select(&s->channel);
+        if (ret != STATUS_OK)
+            return ret;
+        ret = shtc1_measure_blocking_read(&s->temperature, &s->humidity);
+        if (ret != STATUS_OK)
+            return ret;
+        ret = sgp40_dev_measure_raw_blocking_read(&s->sgp40, &s->sraw);
+        if (ret != STATUS_OK)
+            return ret;
+        sgp_runtime_submit(rt_bus, process, s);
+    }
+    return STATUS_OK;
+}
+
+static void setup(std::vector<bus>& buses, uint32_t bus_clock_hz) {
+    uint16_t mux_id;
+    uint16_t id;
+
+    sgp_emulator_reset();
+    sgp_emulator_set_transfer_time(bus_clock_hz, wait_usec);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        bus* b = &buses[i];
+
+        b->i2c_bus.bus_idx = (uint8_t)i;
+        b->i2c_bus.select = NULL;
+        b->i2c_bus.user_data = NULL;
+        b->i2c_bus.lock = NULL;
+        sgp_emulator_add_device((uint8_t)i, SGP_EMULATOR_TCA9548A, MUX_ADDRESS,
+                                &mux_id);
+        sgp_i2c_mux_init(&b->mux, &b->i2c_bus, MUX_ADDRESS);
+        for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch) {
+            sensor* s = &b->sensors[ch];
+
+            sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SGP40,
+                                           SGP40_I2C_ADDRESS, &id);
+            sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SHTC1,
+                                           SHTC1_ADDRESS, &id);
+            sgp_i2c_mux_init_bus(&b->mux, &s->channel, ch);
+            sgp40_dev_init(&s->sgp40, &s->channel, SGP40_I2C_ADDRESS);
+            VocAlgorithm_init(&s->voc);
+        }
+    }
+    sensirion_i2c_init();
+}
+
+int main(int argc, char** argv) {
+    uint32_t bus_clock_hz =
+        argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : DEFAULT_BUS_CLOCK_HZ;
+    uint32_t rounds =
+        argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : DEFAULT_ROUNDS;
+    double single_bus_rate = 0;
+
+    /* wake up at the end of each transfer, inherited by all threads */
+    prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL);
+
+    printf("%u Hz bus clock, %u sensor pairs per bus, %u rounds, %ld CPUs\n",
+           (unsigned)bus_clock_hz, (unsigned)SENSORS_PER_BUS,
+           (unsigned)rounds, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%6s %9s %13s %8s %10s %9s %8s\n", "buses", "samples", "samples/s",
+           "speedup", "efficiency", "cpu load", "stolen");
+
+    for (size_t num_buses = 1; num_buses <= MAX_BUSES; num_buses *= 2) {
+        std::vector<bus> buses(num_buses);
+        sgp_runtime_bus_stats stats;
+        sgp_work_pool_stats pool_stats;
+        sgp_emulator_stats emulator_stats;
+        sgp_runtime rt;
+
+        setup(buses, bus_clock_hz);
+        if (sgp_runtime_init(&rt, 0, poll, 0) != STATUS_OK)
+            return 1;
+        for (size_t i = 0; i < num_buses; ++i)
+            sgp_runtime_add_bus(&rt, (uint8_t)i, &buses[i]);
+
+        clock_t cpu_start = clock();
+        auto start = std::chrono::steady_clock::now();
+        if (sgp_runtime_start(&rt, rounds) != STATUS_OK)
+            return 1;
+        sgp_runtime_join(&rt);
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+        double cpu_seconds = (double)(clock() - cpu_start) / CLOCKS_PER_SEC;
+        sgp_runtime_destroy(&rt);
+        sensirion_i2c_release();
+
+        sgp_runtime_get_stats(&rt, &stats);
+        sgp_work_pool_get_stats(&rt.pool, &pool_stats);
+        sgp_emulator_get_stats(&emulator_stats, false);
+        if (stats.errors || emulator_stats.nacks) {
+            fprintf(stderr, "%u failed rounds, %u NACKs\n",
+                    (unsigned)stats.errors, (unsigned)emulator_stats.nacks);
+            return 1;
+        }
+
+        /* samples run inline by the I/O threads when the queues were full */
+        uint64_t samples = pool_stats.executed + pool_stats.inline_runs;
+        double rate = (double)samples / seconds;
+        if (num_buses == 1)
+            single_bus_rate = rate;
+        double speedup = rate / single_bus_rate;
+        printf("%6zu %9llu %13.0f %7.1fx %9.0f%% %8.0f%% %8llu\n", num_buses,
+               (unsigned long long)samples, rate, speedup,
+               100.0 * speedup / (double)num_buses,
+               100.0 * cpu_seconds / seconds,
+               (unsigned long long)pool_stats.stolen);
+    }
+    return 0;
+}
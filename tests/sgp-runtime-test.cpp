@@ -0,0 +1,289 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_humidity_conversion.h"
+#include "sensirion_i2c.h"
+#include "sensirion_voc_algorithm.h"
+#include "sgp40.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_i2c_mux.h"
+#include "sgp_runtime.h"
+#include "sgp_work_pool.h"
+#include "shtc1.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_BUSES 4
+#define SENSORS_PER_BUS 2
+/* long enough for the VOC index to settle after the blackout */
+#define NUM_ROUNDS 600
+/* the SHTC1 on each channel answers at 0x70 */
+#define MUX_ADDRESS 0x71
+#define USEC_PER_SEC 1000000ull
+
+static void wait_until_set(const bool* flag) {
+    while (!__atomic_load_n(flag, __ATOMIC_ACQUIRE))
+        sched_yield();
+}
+
+/* task blocking its worker until released */
+struct blocker {
+    pthread_t thread;
+    bool started;
+    bool released;
+};
+
+static void run_blocker(void* arg) {
+    blocker* b = (blocker*)arg;
+
+    b->thread = pthread_self();
+    __atomic_store_n(&b->started, true, __ATOMIC_RELEASE);
+    wait_until_set(&b->released);
+}
+
+static void run_count(void* arg) {
+    __atomic_add_fetch((uint32_t*)arg, 1, __ATOMIC_RELAXED);
+}
+
+TEST_GROUP (SGP_Work_Pool_Tests) {
+    sgp_work_pool pool;
+    sgp_work_pool_stats stats;
+    sgp_work_group blocked;
+    sgp_work_group group;
+    blocker b;
+    uint32_t count;
+
+    void setup() {
+        sgp_work_group_init(&blocked);
+        sgp_work_group_init(&group);
+        memset(&b, 0, sizeof(b));
+        count = 0;
+    }
+
+    /* returns the index of the blocked worker */
+    uint16_t block_worker() {
+        sgp_work_pool_submit(&pool, &blocked, run_blocker, &b, 0);
+        wait_until_set(&b.started);
+        for (uint16_t i = 0; i < pool.num_workers; ++i) {
+            if (pthread_equal(pool.workers[i].thread, b.thread))
+                return i;
+        }
+        FAIL("blocker runs on a worker");
+        return 0;
+    }
+
+    void release_worker() {
+        __atomic_store_n(&b.released, true, __ATOMIC_RELEASE);
+        sgp_work_pool_wait(&pool, &blocked);
+    }
+};
+
+TEST (SGP_Work_Pool_Tests, idle_workers_steal_from_busy_worker) {
+    uint16_t busy;
+
+    CHECK_ZERO(sgp_work_pool_init(&pool, 4));
+    busy = block_worker();
+
+    /* all tasks go to the queue of the blocked worker */
+    for (uint32_t i = 0; i < 100; ++i)
+        sgp_work_pool_submit(&pool, &group, run_count, &count, busy);
+    sgp_work_pool_wait(&pool, &group);
+    CHECK_EQUAL(100, count);
+
+    release_worker();
+    sgp_work_pool_destroy(&pool);
+    sgp_work_pool_get_stats(&pool, &stats);
+    CHECK_EQUAL(101, stats.executed);
+    /* the blocker itself was stolen unless worker 0 took it */
+    CHECK_EQUAL_TEXT(100 + (busy != 0), stats.stolen,
+                     "run by the other workers");
+    CHECK_EQUAL(0, stats.inline_runs);
+}
+
+TEST (SGP_Work_Pool_Tests, runs_task_inline_when_queues_are_full) {
+    CHECK_ZERO(sgp_work_pool_init(&pool, 1));
+    block_worker();
+
+    for (uint32_t i = 0; i < SGP_WORK_POOL_QUEUE_SIZE; ++i)
+        sgp_work_pool_submit(&pool, &group, run_count, &count, 0);
+    CHECK_EQUAL_TEXT(0, count, "queued behind the blocked worker");
+    sgp_work_pool_submit(&pool, &group, run_count, &count, 0);
+    CHECK_EQUAL_TEXT(1, count, "run by the submitting thread");
+
+    release_worker();
+    sgp_work_pool_wait(&pool, &group);
+    CHECK_EQUAL(SGP_WORK_POOL_QUEUE_SIZE + 1, count);
+    sgp_work_pool_destroy(&pool);
+    sgp_work_pool_get_stats(&pool, &stats);
+    CHECK_EQUAL(1, stats.inline_runs);
+}
+
+/*
+ * Emulated gateway with NUM_BUSES buses, each with a TCA9548A and an SGP40
+ * and an SHTC1 on each of SENSORS_PER_BUS channels.
+ */
+struct sensor {
+    sgp_i2c_bus channel;
+    sgp40_device sgp40;
+    VocAlgorithmParams voc;
+    /* result of the current round, processed on the work pool */
+    uint32_t round;
+    uint16_t sraw;
+    int32_t temperature;
+    int32_t humidity;
+    /* written by the processing */
+    uint32_t processed;
+    uint32_t out_of_order;
+    uint32_t absolute_humidity;
+    int32_t voc_index;
+    char line[64];
+};
+
+struct bus {
+    sgp_i2c_bus i2c_bus;
+    sgp_i2c_mux mux;
+    sensor sensors[SENSORS_PER_BUS];
+    uint32_t round;
+};
+
+static void process(void* arg) {
+    sensor* s = (sensor*)arg;
+
+    if (s->round != s->processed)
+        ++s->out_of_order;
+    s->absolute_humidity =
+        sensirion_calc_absolute_humidity(s->temperature, s->humidity);
+    VocAlgorithm_process(&s->voc, s->sraw, &s->voc_index);
+    snprintf(s->line, sizeof(s->line), "%u,%d,%u", (unsigned)s->sraw,
+             (int)s->voc_index, (unsigned)s->absolute_humidity);
+    ++s->processed;
+}
+
+static int16_t poll(sgp_runtime_bus* rt_bus) {
+    bus* b = (bus*)rt_bus->user_data;
+    int16_t ret;
+
+    for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch) {
+        sensor* s = &b->sensors[ch];
+
+        /* the SHTC1 driver has no device handle and uses the selected bus */
+        ret = sgp_i2c_bus_select(&s->channel);
+        if (ret != STATUS_OK)
+            return ret;
+        ret = shtc1_measure_blocking_read(&s->temperature, &s->humidity);
+        if (ret != STATUS_OK)
+            return ret;
+        ret = sgp40_dev_measure_raw_blocking_read(&s->sgp40, &s->sraw);
+        if (ret != STATUS_OK)
+            return ret;
+        s->round = b->round;
+        sgp_runtime_submit(rt_bus, process, s);
+    }
+    __atomic_add_fetch(&b->round, 1, __ATOMIC_RELAXED);
+    return STATUS_OK;
+}
+
+TEST_GROUP (SGP_Runtime_Tests) {
+    sgp_runtime rt;
+    bus buses[NUM_BUSES];
+
+    void setup() {
+        uint16_t mux_id;
+        uint16_t id;
+
+        sgp_emulator_reset();
+        memset(buses, 0, sizeof(buses));
+        for (uint8_t i = 0; i < NUM_BUSES; ++i) {
+            bus* b = &buses[i];
+
+            b->i2c_bus.bus_idx = (uint8_t)(i + 1);
+            sgp_emulator_add_device(b->i2c_bus.bus_idx, SGP_EMULATOR_TCA9548A,
+                                    MUX_ADDRESS, &mux_id);
+            sgp_i2c_mux_init(&b->mux, &b->i2c_bus, MUX_ADDRESS);
+            for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch) {
+                sensor* s = &b->sensors[ch];
+
+                sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SGP40,
+                                               SGP40_I2C_ADDRESS, &id);
+                sgp_emulator_add_device_on_mux(mux_id, ch, SGP_EMULATOR_SHTC1,
+                                               0x70, &id);
+                sgp_i2c_mux_init_bus(&b->mux, &s->channel, ch);
+                sgp40_dev_init(&s->sgp40, &s->channel, SGP40_I2C_ADDRESS);
+                VocAlgorithm_init(&s->voc);
+            }
+        }
+        sensirion_i2c_init();
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+    }
+};
+
+TEST (SGP_Runtime_Tests, polls_buses_in_parallel_and_processes_in_order) {
+    sgp_emulator_stats emulator_stats;
+    sgp_runtime_bus_stats stats;
+    uint64_t start_us = sgp_emulator_get_time_us();
+    char line[64];
+
+    CHECK_ZERO(sgp_runtime_init(&rt, 2, poll, USEC_PER_SEC));
+    for (uint8_t i = 0; i < NUM_BUSES; ++i)
+        CHECK_ZERO(sgp_runtime_add_bus(&rt, buses[i].i2c_bus.bus_idx,
+                                       &buses[i]));
+    CHECK_ZERO(sgp_runtime_start(&rt, NUM_ROUNDS));
+    sgp_runtime_join(&rt);
+    sgp_runtime_destroy(&rt);
+
+    sgp_runtime_get_stats(&rt, &stats);
+    CHECK_EQUAL(NUM_BUSES * NUM_ROUNDS, stats.rounds);
+    CHECK_EQUAL(0, stats.errors);
+    CHECK_EQUAL(0, stats.missed_periods);
+    CHECK_EQUAL_TEXT(start_us, sgp_emulator_get_time_us(),
+                     "each I/O thread has its own virtual time");
+
+    for (uint8_t i = 0; i < NUM_BUSES; ++i) {
+        CHECK_ZERO(sgp_emulator_get_bus_stats(buses[i].i2c_bus.bus_idx,
+                                              &emulator_stats, false));
+        CHECK_EQUAL(0, emulator_stats.nacks);
+        /* channel switch, SHTC1 and SGP40 command for each sensor */
+        CHECK_EQUAL(NUM_ROUNDS * SENSORS_PER_BUS * 3, emulator_stats.writes);
+        for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch) {
+            sensor* s = &buses[i].sensors[ch];
+
+            CHECK_EQUAL(NUM_ROUNDS, s->processed);
+            CHECK_EQUAL(0, s->out_of_order);
+            CHECK_EQUAL_TEXT(100, s->voc_index, "constant emulated signal");
+            CHECK_EQUAL(sensirion_calc_absolute_humidity(s->temperature,
+                                                         s->humidity),
+                        s->absolute_humidity);
+            snprintf(line, sizeof(line), "30000,100,%u",
+                     (unsigned)s->absolute_humidity);
+            CHECK_ZERO(strcmp(line, s->line));
+        }
+    }
+}
+
+TEST (SGP_Runtime_Tests, stop_ends_continuous_polling) {
+    sgp_runtime_bus_stats stats;
+
+    CHECK_ZERO(sgp_runtime_init(&rt, 1, poll, 0));
+    CHECK_ZERO(sgp_runtime_add_bus(&rt, buses[0].i2c_bus.bus_idx, &buses[0]));
+    CHECK_ZERO(sgp_runtime_start(&rt, 0));
+    while (__atomic_load_n(&buses[0].round, __ATOMIC_RELAXED) < 10)
+        sched_yield();
+    sgp_runtime_stop(&rt);
+    sgp_runtime_destroy(&rt);
+
+    sgp_runtime_get_stats(&rt, &stats);
+    CHECK_TRUE(stats.rounds >= 10);
+    CHECK_EQUAL(0, stats.errors);
+    for (uint8_t ch = 0; ch < SENSORS_PER_BUS; ++ch)
+        CHECK_EQUAL(stats.rounds, buses[0].sensors[ch].processed);
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,160 @@
+#include "sensirion_voc_algorithm.h"
+#include "sgp40.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_i2c_mux.h"
+#include "sgp_periodic.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/*
+ * Simulated deployment of SGP40 sensors behind TCA9548A multiplexers on the
+ * emulated buses, running in virtual time: every second, all sensors start a
+ * measurement, the results are read after the measurement duration and the
+ * VOC index of each sensor is calculated with a shared configuration.
+ *
+ * Usage: sgp-simulation-bench [sensors] [hours]
+ */
+#define DEFAULT_NUM_SENSORS 1000
+#define DEFAULT_HOURS 1
+#define MUXES_PER_BUS 8
+#define MUX_BASE_ADDRESS 0x70
+#define SENSORS_PER_BUS (MUXES_PER_BUS * SGP_I2C_MUX_NUM_CHANNELS)
+#define USEC_PER_SEC 1000000ull
+
+struct simulation {
+    std::vector<sgp_i2c_bus> buses;
+    std::vector<sgp_i2c_mux> muxes;
+    std::vector<sgp_i2c_bus> channels;
+    std::vector<sgp40_device> sensors;
+};
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+static bool setup(simulation& sim, size_t num_sensors) {
+    size_t num_buses = (num_sensors + SENSORS_PER_BUS - 1) / SENSORS_PER_BUS;
+    size_t num_muxes = (num_sensors + SGP_I2C_MUX_NUM_CHANNELS - 1) /
+                       SGP_I2C_MUX_NUM_CHANNELS;
+    uint16_t mux_id = 0;
+    uint16_t id;
+
+    if (num_buses > SGP_EMULATOR_MAX_BUSES ||
+        num_sensors + num_muxes > SGP_EMULATOR_MAX_DEVICES)
+        return false;
+
+    sim.buses.resize(num_buses);
+    sim.muxes.resize(num_muxes);
+    sim.channels.resize(num_sensors);
+    sim.sensors.resize(num_sensors);
+    sgp_emulator_reset();
+    for (size_t n = 0; n < num_sensors; ++n) {
+        size_t bus = n / SENSORS_PER_BUS;
+        size_t mux = n / SGP_I2C_MUX_NUM_CHANNELS;
+        uint8_t channel = (uint8_t)(n % SGP_I2C_MUX_NUM_CHANNELS);
+        uint8_t mux_address =
+            (uint8_t)(MUX_BASE_ADDRESS + mux % MUXES_PER_BUS);
+        /* slow VOC events with a different phase on each sensor */
+        sgp_emulator_signal sraw = {30000, 1500,
+                                    (uint32_t)(20 + n % 40) * 60 * 1000, 20};
+
+        if (mux % MUXES_PER_BUS == 0 && channel == 0) {
+            sim.buses[bus].bus_idx = (uint8_t)bus;
+            sim.buses[bus].select = NULL;
+            sim.buses[bus].user_data = NULL;
+            sim.buses[bus].lock = NULL;
+        }
+        if (channel == 0) {
+            sgp_emulator_add_device((uint8_t)bus, SGP_EMULATOR_TCA9548A,
+                                    mux_address, &mux_id);
+            sgp_i2c_mux_init(&sim.muxes[mux], &sim.buses[bus], mux_address);
+        }
+        sgp_emulator_add_device_on_mux(mux_id, channel, SGP_EMULATOR_SGP40,
+                                       SGP40_I2C_ADDRESS, &id);
+        sgp_emulator_set_signal(id, SGP_EMULATOR_SIGNAL_SRAW, &sraw);
+        sgp_i2c_mux_init_bus(&sim.muxes[mux], &sim.channels[n], channel);
+        sgp40_dev_init(&sim.sensors[n], &sim.channels[n], SGP40_I2C_ADDRESS);
+    }
+    sensirion_i2c_init();
+    return true;
+}
+
+/* Run one command on each sensor, one multiplexer after the other */
+template <typename F> static bool for_each_sensor(simulation& sim, F command) {
+    for (size_t n = 0; n < sim.sensors.size(); ++n) {
+        if (command(&sim.sensors[n]) != STATUS_OK)
+            return false;
+        /* disable the multiplexer before the next one on the same bus */
+        if (n % SGP_I2C_MUX_NUM_CHANNELS == SGP_I2C_MUX_NUM_CHANNELS - 1 ||
+            n + 1 == sim.sensors.size()) {
+            sgp_i2c_mux* mux = &sim.muxes[n / SGP_I2C_MUX_NUM_CHANNELS];
+            if (sgp_i2c_mux_disable(mux) != STATUS_OK)
+                return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t num_sensors = argc > 1 ? strtoul(argv[1], NULL, 0)
+                                  : DEFAULT_NUM_SENSORS;
+    uint64_t hours = argc > 2 ? strtoull(argv[2], NULL, 0) : DEFAULT_HOURS;
+    uint64_t seconds = hours * 3600;
+    simulation sim;
+    VocAlgorithmConfig config;
+    sgp_emulator_stats stats;
+
+    if (!setup(sim, num_sensors)) {
+        printf("error: at most %d sensors can be emulated\n",
+               SGP_EMULATOR_MAX_BUSES * SENSORS_PER_BUS);
+        return 1;
+    }
+
+    std::vector<VocAlgorithmState> states(num_sensors);
+    std::vector<uint16_t> sraw(num_sensors);
+    std::vector<int32_t> voc_index(num_sensors);
+    VocAlgorithm_init_config(&config, (int32_t)VocAlgorithm_SAMPLING_INTERVAL);
+    for (size_t n = 0; n < num_sensors; ++n) {
+        VocAlgorithm_init_state(&config, &states[n]);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    sgp_periodic periodic;
+    sgp_periodic_init(&periodic, USEC_PER_SEC);
+    for (uint64_t t = 0; t < seconds; ++t) {
+        size_t n = 0;
+        bool ok = for_each_sensor(sim, sgp40_dev_measure_raw);
+        sgp_clock_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
+        ok = ok && for_each_sensor(sim, [&](sgp40_device* dev) {
+                 return sgp40_dev_read_raw(dev, &sraw[n++]);
+             });
+        if (!ok) {
+            printf("error: measurement failed after %llu s\n",
+                   (unsigned long long)t);
+            return 1;
+        }
+        VocAlgorithm_process_states(&config, states.data(), sraw.data(),
+                                    voc_index.data(), (uint32_t)num_sensors);
+        sgp_periodic_wait(&periodic);
+    }
+    double wall_s = seconds_since(start);
+    double simulated_s = (double)sgp_clock_now_us() / USEC_PER_SEC;
+
+    sgp_emulator_get_stats(&stats, false);
+    printf("%zu sensors, %llu h simulated in %.2f s wall time\n", num_sensors,
+           (unsigned long long)hours, wall_s);
+    printf("speedup over real time: %10.0fx\n", simulated_s / wall_s);
+    printf("sensor samples/s:       %10.0f\n",
+           (double)num_sensors * (double)seconds / wall_s);
+    printf("I2C transfers/s:        %10.0f (%u NACKs)\n",
+           (double)(stats.reads + stats.writes) / wall_s, stats.nacks);
+    printf("30 days would take:     %10.0f s\n",
+           wall_s * 30 * 24 / (double)hours);
+    sensirion_i2c_release();
+    return 0;
+}
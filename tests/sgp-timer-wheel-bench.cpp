@@ -0,0 +1,127 @@
+#include "sgp_clock.h"
+#include "sgp_timer_wheel.h"
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+/*
+ * Cost of scheduling the issue and collect phases of a mixed fleet of
+ * SGP30 (1s), SGPC3 (2s and 30s) and SGP40 (1s) measurements in virtual time,
+ * with the timer wheel and with a sorted list of due times.
+ */
+#define SIMULATED_SECONDS 60
+/* the sorted list takes minutes for larger fleets */
+#define MAX_LIST_DEVICES 10000
+#define USEC_PER_SEC 1000000ull
+#define TICK_US 1000
+
+static const uint32_t periods_us[] = {1000000, 2000000, 1000000, 30000000};
+static const uint32_t durations_us[] = {12000, 50000, 30000, 50000};
+#define NUM_KINDS (sizeof(periods_us) / sizeof(periods_us[0]))
+
+extern "C" void sensirion_sleep_usec(uint32_t useconds) {
+    (void)useconds;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+}
+
+static int16_t bench_issue(sgp_timer_job* job, uint32_t* duration_us) {
+    *duration_us = durations_us[(uintptr_t)job->device % NUM_KINDS];
+    return STATUS_OK;
+}
+
+static int16_t bench_collect(sgp_timer_job* job) {
+    (void)job;
+    return STATUS_OK;
+}
+
+static double bench_timer_wheel(size_t num_jobs, uint32_t* fired) {
+    sgp_virtual_clock clock;
+    sgp_timer_wheel wheel;
+    sgp_timer_wheel_stats stats;
+    std::vector<sgp_timer_job> jobs(num_jobs);
+
+    sgp_virtual_clock_init(&clock, 0);
+    sgp_clock_set(&clock.clock);
+    sgp_timer_wheel_init(&wheel, TICK_US);
+    for (size_t n = 0; n < num_jobs; ++n) {
+        sgp_timer_job_init(&jobs[n], periods_us[n % NUM_KINDS], bench_issue,
+                           bench_collect, (void*)(uintptr_t)n);
+        sgp_timer_job_start(&wheel, &jobs[n], (n * 7919) % USEC_PER_SEC);
+    }
+    auto start = std::chrono::steady_clock::now();
+    sgp_timer_wheel_run(&wheel, SIMULATED_SECONDS * USEC_PER_SEC);
+    double wall_s = seconds_since(start);
+    sgp_timer_wheel_get_stats(&wheel, &stats, false);
+    sgp_clock_set(NULL);
+    *fired = stats.fired;
+    return wall_s;
+}
+
+struct list_entry {
+    uint64_t due_us;
+    uint64_t deadline_us;
+    bool collecting;
+    size_t kind;
+    list_entry* next;
+};
+
+static void list_insert(list_entry** head, list_entry* entry) {
+    while (*head && (*head)->due_us <= entry->due_us)
+        head = &(*head)->next;
+    entry->next = *head;
+    *head = entry;
+}
+
+static double bench_sorted_list(size_t num_jobs, uint32_t* fired) {
+    std::vector<list_entry> entries(num_jobs);
+    list_entry* head = NULL;
+
+    for (size_t n = 0; n < num_jobs; ++n) {
+        entries[n].deadline_us = (n * 7919) % USEC_PER_SEC;
+        entries[n].due_us = entries[n].deadline_us;
+        entries[n].collecting = false;
+        entries[n].kind = n % NUM_KINDS;
+        list_insert(&head, &entries[n]);
+    }
+    *fired = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (head && head->due_us < SIMULATED_SECONDS * USEC_PER_SEC) {
+        list_entry* entry = head;
+        head = entry->next;
+        if (entry->collecting) {
+            entry->due_us = entry->deadline_us;
+        } else {
+            entry->deadline_us += periods_us[entry->kind];
+            entry->due_us += durations_us[entry->kind];
+        }
+        entry->collecting = !entry->collecting;
+        list_insert(&head, entry);
+        ++*fired;
+    }
+    return seconds_since(start);
+}
+
+int main(void) {
+    const size_t sizes[] = {100, 1000, 10000, 100000};
+
+    printf("%d s of issue and collect phases of a mixed fleet\n",
+           SIMULATED_SECONDS);
+    printf("%8s %14s %14s\n", "devices", "wheel ns/fire", "list ns/fire");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        uint32_t wheel_fired;
+        uint32_t list_fired;
+        double wheel_s = bench_timer_wheel(sizes[i], &wheel_fired);
+        printf("%8zu %14.0f", sizes[i], wheel_s * 1e9 / wheel_fired);
+        if (sizes[i] <= MAX_LIST_DEVICES) {
+            double list_s = bench_sorted_list(sizes[i], &list_fired);
+            printf(" %14.0f", list_s * 1e9 / list_fired);
+        }
+        printf("\n");
+    }
+    return 0;
+}
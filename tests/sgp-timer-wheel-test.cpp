@@ -0,0 +1,244 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp30.h"
+#include "sgp40.h"
+#include "sgp_clock.h"
+#include "sgp_emulator.h"
+#include "sgp_timer_wheel.h"
+#include "sgpc3.h"
+
+#define TICK_US 1000
+#define USEC_PER_SEC 1000000ull
+#define NUM_TIMERS 256
+#define SENSORS_PER_TYPE 4
+
+static uint64_t fired_us[NUM_TIMERS];
+static uint32_t fire_count[NUM_TIMERS];
+
+static void record_fire(sgp_timer_wheel* wheel, sgp_timer* timer) {
+    uint32_t i = (uint32_t)(uintptr_t)timer->user_data;
+
+    (void)wheel;
+    fired_us[i] = sgp_clock_now_us();
+    ++fire_count[i];
+}
+
+static int16_t sgp30_issue(sgp_timer_job* job, uint32_t* duration_us) {
+    sgp30_device* dev = (sgp30_device*)job->device;
+    int16_t ret = sgp30_dev_measure_iaq(dev);
+    *duration_us = dev->command_duration_us;
+    return ret;
+}
+
+static int16_t sgp30_collect(sgp_timer_job* job) {
+    uint16_t tvoc_ppb;
+    uint16_t co2_eq_ppm;
+    return sgp30_dev_read_iaq((sgp30_device*)job->device, &tvoc_ppb,
+                              &co2_eq_ppm);
+}
+
+static int16_t sgpc3_issue(sgp_timer_job* job, uint32_t* duration_us) {
+    sgpc3_device* dev = (sgpc3_device*)job->device;
+    int16_t ret = sgpc3_dev_measure_tvoc(dev);
+    *duration_us = dev->command_duration_us;
+    return ret;
+}
+
+static int16_t sgpc3_collect(sgp_timer_job* job) {
+    uint16_t tvoc_ppb;
+    int16_t ret = sgpc3_dev_read_tvoc((sgpc3_device*)job->device, &tvoc_ppb);
+    /* switch to the ultra low power cadence after ten measurements */
+    if (job->stats.collected == 9)
+        job->period_us = 30 * USEC_PER_SEC;
+    return ret;
+}
+
+static int16_t sgp40_issue(sgp_timer_job* job, uint32_t* duration_us) {
+    sgp40_device* dev = (sgp40_device*)job->device;
+    int16_t ret = sgp40_dev_measure_raw(dev);
+    *duration_us = dev->command_duration_us;
+    return ret;
+}
+
+static int16_t sgp40_collect(sgp_timer_job* job) {
+    uint16_t sraw;
+    return sgp40_dev_read_raw((sgp40_device*)job->device, &sraw);
+}
+
+static int16_t slow_issue(sgp_timer_job* job, uint32_t* duration_us) {
+    (void)job;
+    *duration_us = 30000;
+    return STATUS_OK;
+}
+
+static int16_t slow_collect(sgp_timer_job* job) {
+    /* processing of the second result takes 2.5 periods */
+    if (job->stats.collected == 1)
+        sgp_clock_sleep_usec(2500000);
+    return STATUS_OK;
+}
+
+TEST_GROUP (SGP_Timer_Wheel_Tests) {
+    sgp_timer_wheel wheel;
+    sgp_timer_wheel_stats stats;
+
+    void setup() {
+        memset(fired_us, 0, sizeof(fired_us));
+        memset(fire_count, 0, sizeof(fire_count));
+        sgp_emulator_reset();
+        sensirion_i2c_init();
+        sgp_timer_wheel_init(&wheel, TICK_US);
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_clock_set(NULL);
+    }
+};
+
+TEST (SGP_Timer_Wheel_Tests, fires_timers_at_their_tick_on_all_levels) {
+    sgp_timer timers[NUM_TIMERS];
+    uint64_t expires_us[NUM_TIMERS];
+    uint64_t last_us = 0;
+
+    for (uint32_t i = 0; i < NUM_TIMERS; ++i) {
+        /* up to 6h, beyond the range of the wheel, and not on a tick */
+        expires_us[i] = wheel.start_us +
+                        (i * 2654435761u) % (6 * 3600 * USEC_PER_SEC) + 1;
+        if (expires_us[i] > last_us)
+            last_us = expires_us[i];
+        sgp_timer_init(&timers[i], record_fire, (void*)(uintptr_t)i);
+        sgp_timer_wheel_add(&wheel, &timers[i], expires_us[i]);
+        CHECK_TRUE(sgp_timer_pending(&timers[i]));
+    }
+
+    sgp_timer_wheel_run(&wheel, last_us + USEC_PER_SEC);
+    for (uint32_t i = 0; i < NUM_TIMERS; ++i) {
+        uint64_t tick = (expires_us[i] - wheel.start_us + TICK_US - 1) /
+                        TICK_US;
+        CHECK_EQUAL_TEXT(1, fire_count[i], "fired exactly once");
+        CHECK_EQUAL_TEXT(wheel.start_us + tick * TICK_US, fired_us[i],
+                         "fired at the first tick after expiry");
+        CHECK_FALSE(sgp_timer_pending(&timers[i]));
+    }
+    sgp_timer_wheel_get_stats(&wheel, &stats, false);
+    CHECK_EQUAL(NUM_TIMERS, stats.fired);
+    CHECK_TRUE_TEXT(stats.cascaded > NUM_TIMERS, "moved down several levels");
+    CHECK_EQUAL(UINT64_MAX, sgp_timer_wheel_next_us(&wheel));
+}
+
+TEST (SGP_Timer_Wheel_Tests, cancels_and_moves_timers) {
+    sgp_timer timers[3];
+    uint64_t start_us = wheel.start_us;
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        sgp_timer_init(&timers[i], record_fire, (void*)(uintptr_t)i);
+        sgp_timer_wheel_add(&wheel, &timers[i], start_us + 5 * USEC_PER_SEC);
+    }
+    CHECK_EQUAL(start_us + 64 * TICK_US, sgp_timer_wheel_next_us(&wheel));
+
+    sgp_timer_wheel_cancel(&wheel, &timers[1]);
+    CHECK_FALSE(sgp_timer_pending(&timers[1]));
+    sgp_timer_wheel_add(&wheel, &timers[2], start_us + 20 * TICK_US);
+    CHECK_EQUAL(start_us + 20 * TICK_US, sgp_timer_wheel_next_us(&wheel));
+
+    sgp_timer_wheel_run(&wheel, start_us + 10 * USEC_PER_SEC);
+    CHECK_EQUAL(1, fire_count[0]);
+    CHECK_EQUAL(0, fire_count[1]);
+    CHECK_EQUAL(1, fire_count[2]);
+    CHECK_EQUAL(start_us + 20 * TICK_US, fired_us[2]);
+
+    /* timers in the past expire at the next tick */
+    sgp_timer_wheel_add(&wheel, &timers[1], start_us);
+    sgp_timer_wheel_run(&wheel, start_us + 11 * USEC_PER_SEC);
+    CHECK_EQUAL(start_us + 10 * USEC_PER_SEC + TICK_US, fired_us[1]);
+}
+
+TEST (SGP_Timer_Wheel_Tests, issues_and_collects_mixed_fleet) {
+    sgp_i2c_bus buses[3 * SENSORS_PER_TYPE];
+    sgp30_device sgp30s[SENSORS_PER_TYPE];
+    sgpc3_device sgpc3s[SENSORS_PER_TYPE];
+    sgp40_device sgp40s[SENSORS_PER_TYPE];
+    sgp_timer_job jobs[3 * SENSORS_PER_TYPE];
+    sgp_emulator_stats emulator_stats;
+    uint64_t start_us = wheel.start_us;
+    uint16_t id;
+
+    for (uint8_t i = 0; i < 3 * SENSORS_PER_TYPE; ++i) {
+        uint8_t type = i / SENSORS_PER_TYPE;
+        uint8_t n = i % SENSORS_PER_TYPE;
+        /* bus 0 has the default devices */
+        buses[i].bus_idx = i + 1;
+        buses[i].select = NULL;
+        buses[i].user_data = NULL;
+        buses[i].lock = NULL;
+        if (type == 0) {
+            CHECK_ZERO(sgp_emulator_add_device(i + 1, SGP_EMULATOR_SGP30,
+                                               SGP30_I2C_ADDRESS, &id));
+            sgp30_dev_init(&sgp30s[n], &buses[i], SGP30_I2C_ADDRESS);
+            sgp_timer_job_init(&jobs[i], USEC_PER_SEC, sgp30_issue,
+                               sgp30_collect, &sgp30s[n]);
+        } else if (type == 1) {
+            CHECK_ZERO(sgp_emulator_add_device(i + 1, SGP_EMULATOR_SGPC3,
+                                               SGPC3_I2C_ADDRESS, &id));
+            sgpc3_dev_init(&sgpc3s[n], &buses[i], SGPC3_I2C_ADDRESS);
+            sgp_timer_job_init(&jobs[i], 2 * USEC_PER_SEC, sgpc3_issue,
+                               sgpc3_collect, &sgpc3s[n]);
+        } else {
+            CHECK_ZERO(sgp_emulator_add_device(i + 1, SGP_EMULATOR_SGP40,
+                                               SGP40_I2C_ADDRESS, &id));
+            sgp40_dev_init(&sgp40s[n], &buses[i], SGP40_I2C_ADDRESS);
+            sgp_timer_job_init(&jobs[i], USEC_PER_SEC, sgp40_issue,
+                               sgp40_collect, &sgp40s[n]);
+        }
+        /* spread the jobs over the first period */
+        sgp_timer_job_start(&wheel, &jobs[i], start_us + (i + 1) * 10000);
+    }
+    sgp_emulator_get_stats(&emulator_stats, true);
+
+    sgp_timer_wheel_run(&wheel, start_us + 120 * USEC_PER_SEC);
+    for (uint8_t i = 0; i < 3 * SENSORS_PER_TYPE; ++i) {
+        uint8_t type = i / SENSORS_PER_TYPE;
+        /* 2s until the tenth result, then 30s from the deadline at 20s */
+        uint32_t expected = type == 1 ? 10 + 4 : 120;
+        CHECK_EQUAL(expected, jobs[i].stats.issued);
+        CHECK_EQUAL(expected, jobs[i].stats.collected);
+        CHECK_EQUAL(0, jobs[i].stats.errors);
+        CHECK_EQUAL(0, jobs[i].stats.missed_deadlines);
+        CHECK_TRUE(jobs[i].stats.max_lateness_us < TICK_US);
+    }
+    sgp_emulator_get_stats(&emulator_stats, false);
+    CHECK_EQUAL_TEXT(0, emulator_stats.nacks, "never collected too early");
+    sgp_timer_wheel_get_stats(&wheel, &stats, false);
+    CHECK_EQUAL(0, stats.missed_deadlines);
+}
+
+TEST (SGP_Timer_Wheel_Tests, reports_missed_deadlines) {
+    sgp_timer_job job;
+    uint64_t start_us = wheel.start_us;
+
+    sgp_timer_job_init(&job, USEC_PER_SEC, slow_issue, slow_collect, NULL);
+    sgp_timer_job_start(&wheel, &job, start_us);
+    sgp_timer_wheel_run(&wheel, start_us + 9500000);
+
+    /* the deadline at 2s is missed, the one at 3s is late */
+    CHECK_EQUAL(1, job.stats.missed_deadlines);
+    CHECK_EQUAL(530000, job.stats.max_lateness_us);
+    CHECK_EQUAL_TEXT(9, job.stats.issued, "deadlines 0-1s and 3-9s");
+    CHECK_EQUAL(0, job.stats.errors);
+
+    sgp_timer_wheel_get_stats(&wheel, &stats, true);
+    CHECK_EQUAL(1, stats.missed_deadlines);
+    CHECK_EQUAL(job.stats.max_lateness_us, stats.max_lateness_us);
+    sgp_timer_wheel_get_stats(&wheel, &stats, false);
+    CHECK_EQUAL(0, stats.fired);
+
+    sgp_timer_job_stop(&wheel, &job);
+    CHECK_FALSE(sgp_timer_pending(&job.timer));
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
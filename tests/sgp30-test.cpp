@@ -40,6 +40,15 @@ static void sgp30_run_tests(uint16_t expected_feature_set) {
     CHECK_ZERO_TEXT(ret, "sgp30_get_serial_id");
     printf("SGP30 serial: %" PRIu64 "\n", serial);
 
+    // Non-blocking variant: the result is ready after the command duration
+    uint64_t serial_async;
+    ret = sgp30_get_serial_id_start();
+    CHECK_ZERO_TEXT(ret, "sgp30_get_serial_id_start");
+    sensirion_sleep_usec(SGP30_CMD_GET_SERIAL_ID_DURATION_US);
+    ret = sgp30_get_serial_id_read(&serial_async);
+    CHECK_ZERO_TEXT(ret, "sgp30_get_serial_id_read");
+    CHECK_TEXT(serial == serial_async, "sgp30_get_serial_id_read serial");
+
     ret = sgp30_get_feature_set_version(&fs_version, &product_type);
     CHECK_ZERO_TEXT(ret, "sgp30_get_feature_set_version");
     printf("FS: 0x%02x, Type: 0x%02x\n", fs_version, product_type);
@@ -256,3 +265,30 @@ TEST (SGP30_FS_0x22_Tests, SGP30_too_much_humidity) {
     int16_t ret = sgp30_set_absolute_humidity(MAX_VALUE_HUMIDITY + 1);
     CHECK_EQUAL_TEXT(STATUS_FAIL, ret, "sgp_set_absolute_humidity should fail");
 }
+
+TEST (SGP30_FS_0x22_Tests, SGP30_read_before_ready) {
+    sgp_clock* clock = sgp_clock_get();
+    sgp_virtual_clock virtual_clock;
+    sgp30_device dev;
+    uint64_t serial;
+    int16_t ret_start, ret_early, ret_ready;
+
+    // The virtual clock only advances together with the sleep below
+    sgp_virtual_clock_init(&virtual_clock, 0);
+    sgp_clock_set(&virtual_clock.clock);
+    sgp30_dev_init(&dev, NULL, SGP30_I2C_ADDRESS);
+    ret_start = sgp30_dev_get_serial_id_start(&dev);
+    ret_early = sgp30_dev_get_serial_id_read(&dev, &serial);
+    sensirion_sleep_usec(SGP30_CMD_GET_SERIAL_ID_DURATION_US);
+    sgp_virtual_clock_advance_us(&virtual_clock,
+                                 SGP30_CMD_GET_SERIAL_ID_DURATION_US);
+    ret_ready = sgp30_dev_get_serial_id_read(&dev, &serial);
+    sgp_clock_set(clock);
+
+    CHECK_ZERO_TEXT(ret_start, "sgp30_dev_get_serial_id_start");
+    CHECK_EQUAL_TEXT(SGP30_CMD_GET_SERIAL_ID_DURATION_US, dev.ready_at_us,
+                     "ready_at_us of sgp30_dev_get_serial_id_start");
+    CHECK_EQUAL_TEXT(SGP30_ERR_NOT_READY, ret_early,
+                     "sgp30_dev_get_serial_id_read before ready_at_us");
+    CHECK_ZERO_TEXT(ret_ready, "sgp30_dev_get_serial_id_read at ready_at_us");
+}
@@ -56,6 +56,60 @@ TEST (SGP40_Tests, SGP40_Test) {
                     "sgp40_measure_raw_blocking_read value");
 }
 
+TEST (SGP40_Tests, SGP40_Device_Test) {
+    sgp_i2c_bus bus = {0, NULL, NULL, NULL};
+    sgp40_device dev;
+    uint8_t serial_id[SGP40_SERIAL_ID_NUM_BYTES];
+    uint8_t serial_id_dev[SGP40_SERIAL_ID_NUM_BYTES];
+    int16_t ret;
+    uint16_t signal;
+
+    sgp40_dev_init(&dev, &bus, SGP40_I2C_ADDRESS);
+    ret = sgp40_dev_probe(&dev);
+    CHECK_ZERO_TEXT(ret, "sgp40_dev_probe");
+
+    ret = sgp40_get_serial_id(serial_id);
+    CHECK_ZERO_TEXT(ret, "sgp40_get_serial_id");
+    ret = sgp40_dev_get_serial_id(&dev, serial_id_dev);
+    CHECK_ZERO_TEXT(ret, "sgp40_dev_get_serial_id");
+    MEMCMP_EQUAL(serial_id, serial_id_dev, SGP40_SERIAL_ID_NUM_BYTES);
+
+    ret = sgp40_dev_measure_raw_blocking_read(&dev, &signal);
+    CHECK_ZERO_TEXT(ret, "sgp40_dev_measure_raw_blocking_read");
+    CHECK_EQUAL_TEXT(SGP40_CMD_MEASURE_RAW_DURATION_US,
+                     dev.command_duration_us,
+                     "command_duration_us of the last command");
+    CHECK_TRUE_TEXT(signal >= MIN_VALUE_ETHANOL && signal <= MAX_VALUE_ETHANOL,
+                    "sgp40_dev_measure_raw_blocking_read value");
+}
+
+TEST (SGP40_Tests, SGP40_read_before_ready) {
+    sgp_clock* clock = sgp_clock_get();
+    sgp_virtual_clock virtual_clock;
+    sgp40_device dev;
+    uint16_t signal;
+    int16_t ret_start, ret_early, ret_ready;
+
+    // The virtual clock only advances together with the sleep below
+    sgp_virtual_clock_init(&virtual_clock, 0);
+    sgp_clock_set(&virtual_clock.clock);
+    sgp40_dev_init(&dev, NULL, SGP40_I2C_ADDRESS);
+    ret_start = sgp40_dev_measure_raw(&dev);
+    ret_early = sgp40_dev_read_raw(&dev, &signal);
+    sensirion_sleep_usec(SGP40_CMD_MEASURE_RAW_DURATION_US);
+    sgp_virtual_clock_advance_us(&virtual_clock,
+                                 SGP40_CMD_MEASURE_RAW_DURATION_US);
+    ret_ready = sgp40_dev_read_raw(&dev, &signal);
+    sgp_clock_set(clock);
+
+    CHECK_ZERO_TEXT(ret_start, "sgp40_dev_measure_raw");
+    CHECK_EQUAL_TEXT(SGP40_CMD_MEASURE_RAW_DURATION_US, dev.ready_at_us,
+                     "ready_at_us of sgp40_dev_measure_raw");
+    CHECK_EQUAL_TEXT(SGP40_ERR_NOT_READY, ret_early,
+                     "sgp40_dev_read_raw before ready_at_us");
+    CHECK_ZERO_TEXT(ret_ready, "sgp40_dev_read_raw at ready_at_us");
+}
+
 TEST (SGP40_Tests, sgp40_convert_rht) {
     int32_t rh = 50000;
     int32_t t = 25000;
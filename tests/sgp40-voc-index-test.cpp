@@ -1,5 +1,6 @@
 #include "sensirion_test_setup.h"
 #include "sgp40_voc_index.h"
+#include "sgp_i2c_mux.h"
 #include <inttypes.h>
 #include <stdio.h>
 
@@ -48,3 +49,68 @@ TEST (SGP40_VOC_INDEX_Tests, SGP40_Engine_Test) {
     CHECK_TRUE_TEXT(t >= MIN_VALUE_TEMPERATURE && t <= MAX_VALUE_TEMPERATURE,
                     "sgp40_measure_voc_index_with_rh temperature");
 }
+
+TEST (SGP40_VOC_INDEX_Tests, SGP40_Engine_Context_Test) {
+    sensirion_voc_index_ctx ctx;
+    int32_t voc_index;
+    int32_t rh, t;
+    int16_t ret;
+
+    ret = sensirion_init_sensors_ctx(&ctx, 0);
+    CHECK_ZERO_TEXT(ret, "sensirion_init_sensors_ctx");
+
+    ret = sensirion_measure_voc_index_ctx(&ctx, &voc_index);
+    CHECK_ZERO_TEXT(ret, "sensirion_measure_voc_index_ctx");
+    CHECK_EQUAL_TEXT(0, voc_index, "VOC Index should be 0 during blackout");
+
+    ret = sensirion_measure_voc_index_with_rh_t_ctx(&ctx, &voc_index, &rh, &t);
+    CHECK_ZERO_TEXT(ret, "sensirion_measure_voc_index_with_rh_t_ctx");
+    CHECK_TRUE_TEXT(rh >= MIN_VALUE_HUMIDITY && rh <= MAX_VALUE_HUMIDITY,
+                    "sensirion_measure_voc_index_with_rh_t_ctx humidity");
+    CHECK_TRUE_TEXT(t >= MIN_VALUE_TEMPERATURE && t <= MAX_VALUE_TEMPERATURE,
+                    "sensirion_measure_voc_index_with_rh_t_ctx temperature");
+}
+
+TEST (SGP40_VOC_INDEX_Tests, SGP40_Engine_Mux_Channel_Test) {
+    sensirion_voc_index_ctx ctx;
+    sgp_i2c_mux mux;
+    sgp_i2c_bus channel;
+    int32_t voc_index;
+    int16_t ret;
+
+    // The context selects MUX 1 channel 0 itself
+    sgp_i2c_mux_init(&mux, NULL, 0x72);
+    ret = sgp_i2c_mux_init_bus(&mux, &channel, 0);
+    CHECK_ZERO_TEXT(ret, "sgp_i2c_mux_init_bus");
+    ret = sgp_i2c_mux_disable(&mux);
+    CHECK_ZERO_TEXT(ret, "sgp_i2c_mux_disable");
+
+    ret = sensirion_init_sensors_bus_ctx(&ctx, &channel);
+    CHECK_ZERO_TEXT(ret, "sensirion_init_sensors_bus_ctx");
+    ret = sensirion_measure_voc_index_ctx(&ctx, &voc_index);
+    CHECK_ZERO_TEXT(ret, "sensirion_measure_voc_index_ctx");
+    CHECK_EQUAL_TEXT(2, mux.channel_switches, "disabled, then selected once");
+}
+
+TEST (SGP40_VOC_INDEX_Tests, SGP40_Engine_Pipelined_Test) {
+    sensirion_voc_index_ctx ctx;
+    int32_t voc_index;
+    int32_t rh, t;
+    int16_t ret;
+
+    ret = sensirion_init_sensors_ctx(&ctx, 0);
+    CHECK_ZERO_TEXT(ret, "sensirion_init_sensors_ctx");
+    sensirion_set_pipelined_mode_ctx(&ctx, true);
+
+    // The first measurement runs sequentially, the others pipelined
+    for (int i = 0; i < 3; ++i) {
+        ret = sensirion_measure_voc_index_with_rh_t_ctx(&ctx, &voc_index, &rh,
+                                                        &t);
+        CHECK_ZERO_TEXT(ret, "sensirion_measure_voc_index_with_rh_t_ctx");
+        CHECK_TRUE_TEXT(rh >= MIN_VALUE_HUMIDITY && rh <= MAX_VALUE_HUMIDITY,
+                        "pipelined measurement humidity");
+        CHECK_TRUE_TEXT(t >= MIN_VALUE_TEMPERATURE &&
+                            t <= MAX_VALUE_TEMPERATURE,
+                        "pipelined measurement temperature");
+    }
+}
@@ -232,3 +232,30 @@ TEST (SGPC3_FS6_Tests, SGPC3Test_FS6_ULP) {
     CHECK_ZERO_TEXT(ret, "sgpc3_set_power_mode");
     sgpc3_test_all_inits(6);
 }
+
+TEST (SGPC3_FS6_Tests, SGPC3Test_read_before_ready) {
+    sgp_clock* clock = sgp_clock_get();
+    sgp_virtual_clock virtual_clock;
+    sgpc3_device dev;
+    uint64_t serial;
+    int16_t ret_start, ret_early, ret_ready;
+
+    // The virtual clock only advances together with the sleep below
+    sgp_virtual_clock_init(&virtual_clock, 0);
+    sgp_clock_set(&virtual_clock.clock);
+    sgpc3_dev_init(&dev, NULL, SGPC3_I2C_ADDRESS);
+    ret_start = sgpc3_dev_get_serial_id_start(&dev);
+    ret_early = sgpc3_dev_get_serial_id_read(&dev, &serial);
+    sensirion_sleep_usec(SGPC3_CMD_GET_SERIAL_ID_DURATION_US);
+    sgp_virtual_clock_advance_us(&virtual_clock,
+                                 SGPC3_CMD_GET_SERIAL_ID_DURATION_US);
+    ret_ready = sgpc3_dev_get_serial_id_read(&dev, &serial);
+    sgp_clock_set(clock);
+
+    CHECK_ZERO_TEXT(ret_start, "sgpc3_dev_get_serial_id_start");
+    CHECK_EQUAL_TEXT(SGPC3_CMD_GET_SERIAL_ID_DURATION_US, dev.ready_at_us,
+                     "ready_at_us of sgpc3_dev_get_serial_id_start");
+    CHECK_EQUAL_TEXT(SGPC3_ERR_NOT_READY, ret_early,
+                     "sgpc3_dev_get_serial_id_read before ready_at_us");
+    CHECK_ZERO_TEXT(ret_ready, "sgpc3_dev_get_serial_id_read at ready_at_us");
+}
@@ -0,0 +1,118 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_humidity_conversion.h"
+#include "sensirion_i2c.h"
+#include "sgp_emulator.h"
+#include "sgp_humidity_compensation.h"
+#include "sgpc3_with_shtc1.h"
+
+#define SGPC3_CMD_SET_ABSOLUTE_HUMIDITY 0x2061
+/*
+ * Ids of the default devices in the order sensirion_i2c_init() adds them. The
+ * binary is built with SGP_EMULATOR_DEFAULT_SGP=SGP_EMULATOR_SGPC3.
+ */
+#define SGPC3_ID 0
+#define SHTC1_ID 2
+#define HUMIDITY 50000
+/* 0.5 %RH change at 25 degree Celsius, about 115 mg/m^3 */
+#define HUMIDITY_CHANGED 50500
+
+TEST_GROUP (SGPC3_With_SHTC1_Emulator_Tests) {
+    void setup() {
+        uint64_t serial_id;
+
+        sgp_emulator_reset();
+        sensirion_i2c_init();
+        CHECK_ZERO(sgpc3_get_serial_id(&serial_id));
+        CHECK_EQUAL_TEXT(0x000012340000ull + SGPC3_ID, serial_id,
+                         "SGPC3 is the default SGP");
+        set_humidity(HUMIDITY);
+        sgpc3_with_shtc1_set_humidity_compensation(SGP_AH_THRESHOLD_DEFAULT,
+                                                   SGP_AH_INTERVAL_DEFAULT);
+        CHECK_ZERO(sgpc3_with_shtc1_probe());
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_emulator_reset();
+    }
+
+    void set_humidity(int32_t humidity) {
+        sgp_emulator_signal model = {humidity, 0, 0, 0};
+
+        CHECK_ZERO(sgp_emulator_set_signal(
+            SHTC1_ID, SGP_EMULATOR_SIGNAL_HUMIDITY, &model));
+    }
+
+    uint32_t measure() {
+        uint16_t ethanol_raw_signal;
+        int32_t temperature;
+        int32_t humidity;
+
+        CHECK_ZERO(sgpc3_with_shtc1_measure_raw_blocking_read(
+            &ethanol_raw_signal, &temperature, &humidity));
+        return sensirion_calc_absolute_humidity(temperature, humidity);
+    }
+
+    uint32_t humidity_writes() {
+        uint32_t count;
+
+        CHECK_ZERO(sgp_emulator_get_command_count(
+            SGPC3_ID, SGPC3_CMD_SET_ABSOLUTE_HUMIDITY, &count));
+        return count;
+    }
+};
+
+TEST (SGPC3_With_SHTC1_Emulator_Tests, sends_changes_from_the_threshold) {
+    uint16_t sensor_format;
+    uint32_t absolute_humidity;
+    uint32_t change;
+    int32_t temperature;
+    int32_t humidity;
+
+    absolute_humidity = measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "first measurement sends");
+    CHECK_ZERO(sgp_emulator_get_absolute_humidity(SGPC3_ID, &sensor_format));
+    CHECK_TRUE(sensor_format > 0);
+
+    /* the emulated SHTC1 has no noise, so the next value is known */
+    set_humidity(HUMIDITY_CHANGED);
+    CHECK_ZERO(shtc1_measure_blocking_read(&temperature, &humidity));
+    change = sensirion_calc_absolute_humidity(temperature, humidity) -
+             absolute_humidity;
+    CHECK_TRUE(change > 0);
+
+    sgpc3_with_shtc1_set_humidity_compensation(change + 1,
+                                               SGP_AH_INTERVAL_DEFAULT);
+    measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "change below the threshold");
+
+    sgpc3_with_shtc1_set_humidity_compensation(change,
+                                               SGP_AH_INTERVAL_DEFAULT);
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "change at the threshold");
+}
+
+TEST (SGPC3_With_SHTC1_Emulator_Tests, sends_after_the_interval) {
+    sgpc3_with_shtc1_set_humidity_compensation(SGP_AH_THRESHOLD_DEFAULT, 2);
+    measure();
+    measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "within the interval");
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "after the interval");
+}
+
+TEST (SGPC3_With_SHTC1_Emulator_Tests, sends_again_after_probe) {
+    measure();
+    measure();
+    CHECK_EQUAL(1, humidity_writes());
+
+    CHECK_ZERO(sgpc3_with_shtc1_probe());
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "first measurement after probe");
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,132 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestHarness.h"
+#include "sensirion_common.h"
+#include "sensirion_i2c.h"
+#include "sgp_emulator.h"
+#include "sgp_humidity_compensation.h"
+#include "svm30.h"
+
+#define SGP30_CMD_SET_ABSOLUTE_HUMIDITY 0x2061
+#define SHTC1_ADDRESS 0x70
+/* 0.3 %RH change at 25 degree Celsius, about 70 mg/m^3 */
+#define HUMIDITY_BELOW_THRESHOLD 50300
+/* 1 %RH change at 25 degree Celsius, about 230 mg/m^3 */
+#define HUMIDITY_ABOVE_THRESHOLD 51000
+
+TEST_GROUP (SVM30_Emulator_Tests) {
+    uint16_t sgp30_id;
+    uint16_t shtc1_id;
+
+    void setup() {
+        sgp_emulator_reset();
+        CHECK_ZERO(sgp_emulator_add_device(0, SGP_EMULATOR_SGP30,
+                                           SGP30_I2C_ADDRESS, &sgp30_id));
+        CHECK_ZERO(sgp_emulator_add_device(0, SGP_EMULATOR_SHTC1,
+                                           SHTC1_ADDRESS, &shtc1_id));
+        sensirion_i2c_init();
+        set_humidity(50000);
+        svm_set_humidity_compensation(SGP_AH_THRESHOLD_DEFAULT,
+                                      SGP_AH_INTERVAL_DEFAULT);
+        CHECK_ZERO(svm_probe());
+    }
+
+    void teardown() {
+        sensirion_i2c_release();
+        sgp_emulator_reset();
+    }
+
+    void set_humidity(int32_t humidity) {
+        sgp_emulator_signal model = {humidity, 0, 0, 0};
+
+        CHECK_ZERO(sgp_emulator_set_signal(
+            shtc1_id, SGP_EMULATOR_SIGNAL_HUMIDITY, &model));
+    }
+
+    void measure() {
+        uint16_t ethanol_raw_signal;
+        uint16_t h2_raw_signal;
+        int32_t temperature;
+        int32_t humidity;
+
+        CHECK_ZERO(svm_measure_raw_blocking_read(
+            &ethanol_raw_signal, &h2_raw_signal, &temperature, &humidity));
+    }
+
+    uint32_t humidity_writes() {
+        uint32_t count;
+
+        CHECK_ZERO(sgp_emulator_get_command_count(
+            sgp30_id, SGP30_CMD_SET_ABSOLUTE_HUMIDITY, &count));
+        return count;
+    }
+};
+
+TEST (SVM30_Emulator_Tests, sends_changes_beyond_the_threshold) {
+    uint16_t first_update;
+    uint16_t absolute_humidity;
+
+    measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "first measurement sends");
+    CHECK_ZERO(sgp_emulator_get_absolute_humidity(sgp30_id, &first_update));
+
+    set_humidity(HUMIDITY_BELOW_THRESHOLD);
+    measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "change below the threshold");
+
+    set_humidity(HUMIDITY_ABOVE_THRESHOLD);
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "change beyond the threshold");
+    CHECK_ZERO(
+        sgp_emulator_get_absolute_humidity(sgp30_id, &absolute_humidity));
+    CHECK_TRUE(absolute_humidity > first_update);
+
+    /* compared to the last value sent, not to the previous measurement */
+    set_humidity(HUMIDITY_ABOVE_THRESHOLD + 300);
+    measure();
+    set_humidity(HUMIDITY_ABOVE_THRESHOLD + 600);
+    measure();
+    CHECK_EQUAL_TEXT(3, humidity_writes(), "accumulated changes");
+}
+
+TEST (SVM30_Emulator_Tests, sends_after_the_interval) {
+    uint32_t writes, skipped_writes;
+    uint32_t writes_before, skipped_writes_before;
+
+    svm_get_humidity_compensation_stats(&writes_before, &skipped_writes_before);
+    svm_set_humidity_compensation(SGP_AH_THRESHOLD_DEFAULT, 3);
+    for (int i = 0; i < 3; ++i)
+        measure();
+    CHECK_EQUAL_TEXT(1, humidity_writes(), "within the interval");
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "after the interval");
+    for (int i = 0; i < 3; ++i)
+        measure();
+    CHECK_EQUAL_TEXT(3, humidity_writes(), "after the next interval");
+
+    svm_get_humidity_compensation_stats(&writes, &skipped_writes);
+    CHECK_EQUAL(3, writes - writes_before);
+    CHECK_EQUAL(4, skipped_writes - skipped_writes_before);
+}
+
+TEST (SVM30_Emulator_Tests, sends_every_measurement_without_threshold) {
+    svm_set_humidity_compensation(0, SGP_AH_INTERVAL_DEFAULT);
+    for (int i = 0; i < 3; ++i)
+        measure();
+    CHECK_EQUAL(3, humidity_writes());
+}
+
+TEST (SVM30_Emulator_Tests, sends_again_after_probe) {
+    measure();
+    measure();
+    CHECK_EQUAL(1, humidity_writes());
+
+    CHECK_ZERO(svm_probe());
+    measure();
+    CHECK_EQUAL_TEXT(2, humidity_writes(), "first measurement after probe");
+    measure();
+    CHECK_EQUAL(2, humidity_writes());
+}
+
+int main(int argc, char** argv) {
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
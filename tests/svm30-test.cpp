@@ -1,5 +1,6 @@
 #include "sensirion_test_setup.h"
 #include "svm30.h"
+#include <inttypes.h>
 #include <stdio.h>
 
 #define MIN_VALUE_TVOC 0
@@ -82,4 +83,12 @@ TEST (SVM30_Tests, SVM30_Test) {
                     "svm_measure_raw_blocking_read Temperature");
     CHECK_TRUE_TEXT(humi >= MIN_VALUE_HUMIDITY && humi <= MAX_VALUE_HUMIDITY,
                     "svm_measure_raw_blocking_read Humidity");
+
+    uint32_t writes, skipped_writes;
+    svm_get_humidity_compensation_stats(&writes, &skipped_writes);
+    printf("Humidity writes: %" PRIu32 ", skipped: %" PRIu32 "\n", writes,
+           skipped_writes);
+    CHECK_TRUE_TEXT(writes >= 1, "first measurement should set the humidity");
+    CHECK_EQUAL_TEXT(2, writes + skipped_writes,
+                     "svm_get_humidity_compensation_stats");
 }